@@ -14,7 +14,8 @@ typedef enum {
     COMM_MODE_RS485_MODBUS = 0x00,
     COMM_MODE_RS485_MITSUBISHI = 0x01,
     COMM_MODE_ETHERNET_TCP = 0x02,
-    COMM_MODE_ETHERNET_UDP = 0x03
+    COMM_MODE_ETHERNET_UDP = 0x03,
+    COMM_MODE_MODBUS_GATEWAY = 0x04     /* TCP -> RS485 网关，RS485 作为主站 */
 } comm_mode_t;
 
 /* ===== 串口配置 ===== */
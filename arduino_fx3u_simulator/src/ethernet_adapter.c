@@ -4,6 +4,143 @@
 
 #include "ethernet_adapter.h"
 #include "pico/stdlib.h"
+#include <string.h>
+
+#if PICO_ON_DEVICE
+
+#include "hardware/spi.h"
+#include "hardware/gpio.h"
+
+/* ===== W5500 通用寄存器 ===== */
+#define W5500_MR                0x0000
+#define W5500_GAR               0x0001
+#define W5500_SUBR              0x0005
+#define W5500_SHAR              0x0009
+#define W5500_SIPR              0x000F
+#define W5500_PHYCFGR           0x002E
+#define W5500_VERSIONR          0x0039
+
+#define W5500_MR_RST            0x80
+#define W5500_PHYCFGR_LNK       0x01
+#define W5500_VERSION           0x04
+
+/* ===== W5500 Socket 寄存器 ===== */
+#define W5500_Sn_MR             0x0000
+#define W5500_Sn_CR             0x0001
+#define W5500_Sn_IR             0x0002
+#define W5500_Sn_SR             0x0003
+#define W5500_Sn_PORT           0x0004
+#define W5500_Sn_RXBUF_SIZE     0x001E
+#define W5500_Sn_TXBUF_SIZE     0x001F
+#define W5500_Sn_TX_RD          0x0022
+#define W5500_Sn_TX_WR          0x0024
+#define W5500_Sn_RX_RSR         0x0026
+#define W5500_Sn_RX_RD          0x0028
+
+#define W5500_CMD_OPEN          0x01
+#define W5500_CMD_LISTEN        0x02
+#define W5500_CMD_DISCON        0x08
+#define W5500_CMD_CLOSE         0x10
+#define W5500_CMD_SEND          0x20
+#define W5500_CMD_RECV          0x40
+
+#define W5500_Sn_IR_SENDOK      0x10
+#define W5500_Sn_IR_TIMEOUT     0x08
+
+#define W5500_SOCK_CLOSED       0x00
+#define W5500_SOCK_INIT         0x13
+#define W5500_SOCK_LISTEN       0x14
+#define W5500_SOCK_SYNRECV      0x16
+#define W5500_SOCK_ESTABLISHED  0x17
+#define W5500_SOCK_CLOSE_WAIT   0x1C
+
+/* SPI 帧头: 地址(2) + 控制字节 [BSB(5) | RWB | OM(2)]，OM=00 为可变长度突发 */
+#define W5500_BSB_COMMON        0x00
+#define W5500_BSB_SOCKET(n)     ((uint8_t)((n) * 4 + 1))
+#define W5500_BSB_TX(n)         ((uint8_t)((n) * 4 + 2))
+#define W5500_BSB_RX(n)         ((uint8_t)((n) * 4 + 3))
+#define W5500_CTRL_READ         0x00
+#define W5500_CTRL_WRITE        0x04
+
+static bool g_eth_ready = false;
+static bool g_tx_dirty[ETH_MAX_SOCKETS];    /* 已写入发送缓冲但未 SEND */
+static bool g_send_busy[ETH_MAX_SOCKETS];   /* 上一次 SEND 尚未完成 */
+
+static void w5500_begin(uint8_t bsb, uint16_t addr, uint8_t rw)
+{
+    uint8_t header[3] = {
+        (uint8_t)(addr >> 8),
+        (uint8_t)(addr & 0xFF),
+        (uint8_t)((bsb << 3) | rw)
+    };
+    gpio_put(PICO_W5500_CS_GPIO, 0);
+    spi_write_blocking(PICO_W5500_SPI_INSTANCE, header, sizeof(header));
+}
+
+static void w5500_end(void)
+{
+    gpio_put(PICO_W5500_CS_GPIO, 1);
+}
+
+/* 一次片选内完成整段读取，缓冲区内的偏移由芯片自动回绕 */
+static void w5500_read(uint8_t bsb, uint16_t addr, uint8_t *data, uint16_t length)
+{
+    w5500_begin(bsb, addr, W5500_CTRL_READ);
+    spi_read_blocking(PICO_W5500_SPI_INSTANCE, 0x00, data, length);
+    w5500_end();
+}
+
+static void w5500_write(uint8_t bsb, uint16_t addr, const uint8_t *data, uint16_t length)
+{
+    w5500_begin(bsb, addr, W5500_CTRL_WRITE);
+    spi_write_blocking(PICO_W5500_SPI_INSTANCE, data, length);
+    w5500_end();
+}
+
+static uint8_t w5500_read8(uint8_t bsb, uint16_t addr)
+{
+    uint8_t value;
+    w5500_read(bsb, addr, &value, 1);
+    return value;
+}
+
+static void w5500_write8(uint8_t bsb, uint16_t addr, uint8_t value)
+{
+    w5500_write(bsb, addr, &value, 1);
+}
+
+static uint16_t w5500_read16(uint8_t bsb, uint16_t addr)
+{
+    uint8_t buf[2];
+    w5500_read(bsb, addr, buf, 2);
+    return ((uint16_t)buf[0] << 8) | buf[1];
+}
+
+static void w5500_write16(uint8_t bsb, uint16_t addr, uint16_t value)
+{
+    uint8_t buf[2] = { (uint8_t)(value >> 8), (uint8_t)(value & 0xFF) };
+    w5500_write(bsb, addr, buf, 2);
+}
+
+/* 芯片侧会异步更新的16位寄存器，两次读取一致才可信 */
+static uint16_t w5500_read16_stable(uint8_t bsb, uint16_t addr)
+{
+    uint16_t a, b;
+    do {
+        a = w5500_read16(bsb, addr);
+        b = w5500_read16(bsb, addr);
+    } while (a != b);
+    return a;
+}
+
+static void w5500_command(uint8_t socket, uint8_t cmd)
+{
+    w5500_write8(W5500_BSB_SOCKET(socket), W5500_Sn_CR, cmd);
+    /* 命令被接受后 Sn_CR 自动清零 */
+    while (w5500_read8(W5500_BSB_SOCKET(socket), W5500_Sn_CR) != 0) {
+        tight_loop_contents();
+    }
+}
 
 /**
  * 初始化以太网接口
@@ -11,9 +148,48 @@
 void ethernet_init(ethernet_config_t *config)
 {
     if (!config) return;
-    
-    /* W5500初始化 - 需要SPI接口 */
-    /* 实现细节取决于W5500库的集成 */
+
+    g_eth_ready = false;
+    memset(g_tx_dirty, 0, sizeof(g_tx_dirty));
+    memset(g_send_busy, 0, sizeof(g_send_busy));
+
+    spi_init(PICO_W5500_SPI_INSTANCE, PICO_W5500_SPI_BAUDRATE);
+    gpio_set_function(PICO_W5500_MISO_GPIO, GPIO_FUNC_SPI);
+    gpio_set_function(PICO_W5500_SCK_GPIO, GPIO_FUNC_SPI);
+    gpio_set_function(PICO_W5500_MOSI_GPIO, GPIO_FUNC_SPI);
+
+    gpio_init(PICO_W5500_CS_GPIO);
+    gpio_set_dir(PICO_W5500_CS_GPIO, GPIO_OUT);
+    gpio_put(PICO_W5500_CS_GPIO, 1);
+
+    /* 硬件复位，PLL 锁定约需 1ms */
+    gpio_init(PICO_W5500_RST_GPIO);
+    gpio_set_dir(PICO_W5500_RST_GPIO, GPIO_OUT);
+    gpio_put(PICO_W5500_RST_GPIO, 0);
+    sleep_us(500);
+    gpio_put(PICO_W5500_RST_GPIO, 1);
+    sleep_ms(2);
+
+    if (w5500_read8(W5500_BSB_COMMON, W5500_VERSIONR) != W5500_VERSION) {
+        return;  /* 未检测到 W5500 */
+    }
+
+    w5500_write8(W5500_BSB_COMMON, W5500_MR, W5500_MR_RST);
+    while (w5500_read8(W5500_BSB_COMMON, W5500_MR) & W5500_MR_RST) {
+        tight_loop_contents();
+    }
+
+    w5500_write(W5500_BSB_COMMON, W5500_GAR, config->gateway, 4);
+    w5500_write(W5500_BSB_COMMON, W5500_SUBR, config->netmask, 4);
+    w5500_write(W5500_BSB_COMMON, W5500_SHAR, config->mac, 6);
+    w5500_write(W5500_BSB_COMMON, W5500_SIPR, config->ip, 4);
+
+    for (uint8_t s = 0; s < ETH_MAX_SOCKETS; s++) {
+        w5500_write8(W5500_BSB_SOCKET(s), W5500_Sn_RXBUF_SIZE, ETH_SOCKET_BUFFER_SIZE / 1024);
+        w5500_write8(W5500_BSB_SOCKET(s), W5500_Sn_TXBUF_SIZE, ETH_SOCKET_BUFFER_SIZE / 1024);
+    }
+
+    g_eth_ready = true;
 }
 
 /**
@@ -21,8 +197,10 @@ void ethernet_init(ethernet_config_t *config)
  */
 bool ethernet_is_connected(void)
 {
+    if (!g_eth_ready) return false;
+
     /* 检查PHY连接状态 */
-    return true;
+    return (w5500_read8(W5500_BSB_COMMON, W5500_PHYCFGR) & W5500_PHYCFGR_LNK) != 0;
 }
 
 /**
@@ -31,9 +209,12 @@ bool ethernet_is_connected(void)
 int ethernet_send(uint8_t socket, uint8_t *buffer, uint16_t length)
 {
     if (!buffer || length == 0) return 0;
-    
-    /* 通过W5500发送数据 */
-    return length;
+
+    int written = ethernet_write(socket, buffer, length);
+    if (written > 0) {
+        ethernet_flush(socket);
+    }
+    return written;
 }
 
 /**
@@ -42,9 +223,17 @@ int ethernet_send(uint8_t socket, uint8_t *buffer, uint16_t length)
 int ethernet_receive(uint8_t socket, uint8_t *buffer, uint16_t max_len)
 {
     if (!buffer || max_len == 0) return 0;
-    
-    /* 从W5500接收数据 */
-    return 0;
+
+    uint16_t available = ethernet_rx_available(socket);
+    if (available == 0) return 0;
+
+    uint16_t length = available < max_len ? available : max_len;
+    uint16_t ptr = w5500_read16(W5500_BSB_SOCKET(socket), W5500_Sn_RX_RD);
+    w5500_read(W5500_BSB_RX(socket), ptr, buffer, length);
+    w5500_write16(W5500_BSB_SOCKET(socket), W5500_Sn_RX_RD, (uint16_t)(ptr + length));
+    w5500_command(socket, W5500_CMD_RECV);
+
+    return length;
 }
 
 /**
@@ -52,5 +241,386 @@ int ethernet_receive(uint8_t socket, uint8_t *buffer, uint16_t max_len)
  */
 void ethernet_set_socket_mode(uint8_t socket, uint8_t mode)
 {
-    /* TCP或UDP模式设置 */
+    if (!g_eth_ready || socket >= ETH_MAX_SOCKETS) return;
+
+    /* ETH_SOCKET_MODE_* 与 Sn_MR 协议位取值一致 */
+    w5500_write8(W5500_BSB_SOCKET(socket), W5500_Sn_MR, mode & 0x0F);
+}
+
+/**
+ * 打开 TCP socket 并监听端口
+ */
+bool ethernet_socket_listen(uint8_t socket, uint16_t port)
+{
+    if (!g_eth_ready || socket >= ETH_MAX_SOCKETS) return false;
+
+    w5500_command(socket, W5500_CMD_CLOSE);
+    ethernet_set_socket_mode(socket, ETH_SOCKET_MODE_TCP);
+    w5500_write16(W5500_BSB_SOCKET(socket), W5500_Sn_PORT, port);
+    g_tx_dirty[socket] = false;
+    g_send_busy[socket] = false;
+
+    w5500_command(socket, W5500_CMD_OPEN);
+    if (w5500_read8(W5500_BSB_SOCKET(socket), W5500_Sn_SR) != W5500_SOCK_INIT) {
+        return false;
+    }
+    w5500_command(socket, W5500_CMD_LISTEN);
+    return w5500_read8(W5500_BSB_SOCKET(socket), W5500_Sn_SR) == W5500_SOCK_LISTEN;
+}
+
+/**
+ * 查询 socket 状态
+ */
+ethernet_socket_state_t ethernet_socket_state(uint8_t socket)
+{
+    if (!g_eth_ready || socket >= ETH_MAX_SOCKETS) return ETH_SOCKET_CLOSED;
+
+    switch (w5500_read8(W5500_BSB_SOCKET(socket), W5500_Sn_SR)) {
+        case W5500_SOCK_CLOSED:
+            return ETH_SOCKET_CLOSED;
+        case W5500_SOCK_LISTEN:
+        case W5500_SOCK_SYNRECV:
+            return ETH_SOCKET_LISTEN;
+        case W5500_SOCK_ESTABLISHED:
+            return ETH_SOCKET_ESTABLISHED;
+        default:
+            return ETH_SOCKET_CLOSING;
+    }
+}
+
+/**
+ * 关闭 socket (已连接时先发送 FIN)
+ */
+void ethernet_socket_close(uint8_t socket)
+{
+    if (!g_eth_ready || socket >= ETH_MAX_SOCKETS) return;
+
+    uint8_t sr = w5500_read8(W5500_BSB_SOCKET(socket), W5500_Sn_SR);
+    if (sr == W5500_SOCK_ESTABLISHED || sr == W5500_SOCK_CLOSE_WAIT) {
+        w5500_command(socket, W5500_CMD_DISCON);
+    } else {
+        w5500_command(socket, W5500_CMD_CLOSE);
+    }
+    g_tx_dirty[socket] = false;
+    g_send_busy[socket] = false;
+}
+
+/**
+ * 接收缓冲中的可读字节数
+ */
+uint16_t ethernet_rx_available(uint8_t socket)
+{
+    if (!g_eth_ready || socket >= ETH_MAX_SOCKETS) return 0;
+
+    return w5500_read16_stable(W5500_BSB_SOCKET(socket), W5500_Sn_RX_RSR);
+}
+
+/**
+ * 发送缓冲剩余空间 (含已写入未发送的部分)
+ */
+uint16_t ethernet_tx_free(uint8_t socket)
+{
+    if (!g_eth_ready || socket >= ETH_MAX_SOCKETS) return 0;
+
+    uint16_t rd = w5500_read16_stable(W5500_BSB_SOCKET(socket), W5500_Sn_TX_RD);
+    uint16_t wr = w5500_read16(W5500_BSB_SOCKET(socket), W5500_Sn_TX_WR);
+    return (uint16_t)(ETH_SOCKET_BUFFER_SIZE - (uint16_t)(wr - rd));
+}
+
+/**
+ * 写入发送缓冲 (不发送)；空间不足时整段拒绝
+ */
+int ethernet_write(uint8_t socket, const uint8_t *buffer, uint16_t length)
+{
+    if (!buffer || length == 0) return 0;
+    if (length > ethernet_tx_free(socket)) return 0;
+
+    uint16_t ptr = w5500_read16(W5500_BSB_SOCKET(socket), W5500_Sn_TX_WR);
+    w5500_write(W5500_BSB_TX(socket), ptr, buffer, length);
+    w5500_write16(W5500_BSB_SOCKET(socket), W5500_Sn_TX_WR, (uint16_t)(ptr + length));
+    g_tx_dirty[socket] = true;
+
+    return length;
+}
+
+/**
+ * 发出发送缓冲中的数据
+ *
+ * 上一次 SEND 未完成时返回 false，数据留在缓冲中，下次调用时合并发出。
+ */
+bool ethernet_flush(uint8_t socket)
+{
+    if (!g_eth_ready || socket >= ETH_MAX_SOCKETS) return false;
+    if (!g_tx_dirty[socket]) return true;
+
+    if (g_send_busy[socket]) {
+        uint8_t ir = w5500_read8(W5500_BSB_SOCKET(socket), W5500_Sn_IR);
+        if (!(ir & (W5500_Sn_IR_SENDOK | W5500_Sn_IR_TIMEOUT))) {
+            return false;
+        }
+        w5500_write8(W5500_BSB_SOCKET(socket), W5500_Sn_IR,
+                     ir & (W5500_Sn_IR_SENDOK | W5500_Sn_IR_TIMEOUT));
+        g_send_busy[socket] = false;
+    }
+
+    w5500_command(socket, W5500_CMD_SEND);
+    g_tx_dirty[socket] = false;
+    g_send_busy[socket] = true;
+    return true;
+}
+
+#else /* !PICO_ON_DEVICE */
+
+/*
+ * 主机端后端: 以 Linux 非阻塞 socket 模拟 W5500 的 socket 模型，
+ * 所有 LISTEN 状态的 socket 共享同一个监听描述符，先到先得。
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+typedef struct {
+    int fd;
+    ethernet_socket_state_t state;
+    uint8_t tx[ETH_SOCKET_BUFFER_SIZE];
+    uint16_t tx_len;
+} host_socket_t;
+
+static bool g_eth_ready = false;
+static host_socket_t g_sockets[ETH_MAX_SOCKETS];
+static int g_listen_fd = -1;
+static uint16_t g_listen_port = 0;
+
+static bool host_set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static bool host_open_listener(uint16_t port)
+{
+    if (g_listen_fd >= 0 && g_listen_port == port) return true;
+    if (g_listen_fd >= 0) {
+        close(g_listen_fd);
+        g_listen_fd = -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(fd, ETH_MAX_SOCKETS) != 0 || !host_set_nonblocking(fd)) {
+        close(fd);
+        return false;
+    }
+
+    g_listen_fd = fd;
+    g_listen_port = port;
+    return true;
+}
+
+static host_socket_t *host_socket(uint8_t socket)
+{
+    if (!g_eth_ready || socket >= ETH_MAX_SOCKETS) return NULL;
+    return &g_sockets[socket];
+}
+
+/**
+ * 初始化以太网接口
+ */
+void ethernet_init(ethernet_config_t *config)
+{
+    if (!config) return;
+
+    for (uint8_t s = 0; s < ETH_MAX_SOCKETS; s++) {
+        g_sockets[s].fd = -1;
+        g_sockets[s].state = ETH_SOCKET_CLOSED;
+        g_sockets[s].tx_len = 0;
+    }
+    g_eth_ready = true;
+}
+
+/**
+ * 检查以太网连接状态
+ */
+bool ethernet_is_connected(void)
+{
+    return g_eth_ready;
+}
+
+/**
+ * 以太网发送
+ */
+int ethernet_send(uint8_t socket, uint8_t *buffer, uint16_t length)
+{
+    if (!buffer || length == 0) return 0;
+
+    int written = ethernet_write(socket, buffer, length);
+    if (written > 0) {
+        ethernet_flush(socket);
+    }
+    return written;
+}
+
+/**
+ * 以太网接收
+ */
+int ethernet_receive(uint8_t socket, uint8_t *buffer, uint16_t max_len)
+{
+    host_socket_t *s = host_socket(socket);
+    if (!s || !buffer || max_len == 0 || s->state != ETH_SOCKET_ESTABLISHED) return 0;
+
+    ssize_t n = recv(s->fd, buffer, max_len, MSG_DONTWAIT);
+    if (n > 0) return (int)n;
+    if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+        s->state = ETH_SOCKET_CLOSING;
+    }
+    return 0;
+}
+
+/**
+ * 设置Socket模式 (主机端仅支持 TCP)
+ */
+void ethernet_set_socket_mode(uint8_t socket, uint8_t mode)
+{
+    (void)socket;
+    (void)mode;
+}
+
+/**
+ * 打开 TCP socket 并监听端口
+ */
+bool ethernet_socket_listen(uint8_t socket, uint16_t port)
+{
+    host_socket_t *s = host_socket(socket);
+    if (!s) return false;
+
+    ethernet_socket_close(socket);
+    if (!host_open_listener(port)) return false;
+    s->state = ETH_SOCKET_LISTEN;
+    return true;
 }
+
+/**
+ * 查询 socket 状态 (LISTEN 状态下尝试接受新连接)
+ */
+ethernet_socket_state_t ethernet_socket_state(uint8_t socket)
+{
+    host_socket_t *s = host_socket(socket);
+    if (!s) return ETH_SOCKET_CLOSED;
+
+    if (s->state == ETH_SOCKET_LISTEN && g_listen_fd >= 0) {
+        int fd = accept(g_listen_fd, NULL, NULL);
+        if (fd >= 0) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            host_set_nonblocking(fd);
+            s->fd = fd;
+            s->tx_len = 0;
+            s->state = ETH_SOCKET_ESTABLISHED;
+        }
+    }
+    return s->state;
+}
+
+/**
+ * 关闭 socket
+ */
+void ethernet_socket_close(uint8_t socket)
+{
+    host_socket_t *s = host_socket(socket);
+    if (!s) return;
+
+    if (s->fd >= 0) {
+        close(s->fd);
+        s->fd = -1;
+    }
+    s->tx_len = 0;
+    s->state = ETH_SOCKET_CLOSED;
+}
+
+/**
+ * 接收缓冲中的可读字节数
+ */
+uint16_t ethernet_rx_available(uint8_t socket)
+{
+    host_socket_t *s = host_socket(socket);
+    if (!s || s->state != ETH_SOCKET_ESTABLISHED) return 0;
+
+    uint8_t probe;
+    ssize_t n = recv(s->fd, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        s->state = ETH_SOCKET_CLOSING;
+        return 0;
+    }
+    if (n < 0) return 0;
+
+    int pending = 0;
+    if (ioctl(s->fd, FIONREAD, &pending) != 0 || pending <= 0) return 1;
+    return pending > 0xFFFF ? 0xFFFF : (uint16_t)pending;
+}
+
+/**
+ * 发送缓冲剩余空间
+ */
+uint16_t ethernet_tx_free(uint8_t socket)
+{
+    host_socket_t *s = host_socket(socket);
+    if (!s) return 0;
+    return (uint16_t)(ETH_SOCKET_BUFFER_SIZE - s->tx_len);
+}
+
+/**
+ * 写入发送缓冲 (不发送)；空间不足时整段拒绝
+ */
+int ethernet_write(uint8_t socket, const uint8_t *buffer, uint16_t length)
+{
+    host_socket_t *s = host_socket(socket);
+    if (!s || !buffer || length == 0) return 0;
+    if (length > ethernet_tx_free(socket)) return 0;
+
+    memcpy(&s->tx[s->tx_len], buffer, length);
+    s->tx_len += length;
+    return length;
+}
+
+/**
+ * 发出发送缓冲中的数据
+ */
+bool ethernet_flush(uint8_t socket)
+{
+    host_socket_t *s = host_socket(socket);
+    if (!s) return false;
+    if (s->tx_len == 0) return true;
+    if (s->state != ETH_SOCKET_ESTABLISHED) return false;
+
+    ssize_t n = send(s->fd, s->tx, s->tx_len, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (n < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            s->state = ETH_SOCKET_CLOSING;
+        }
+        return false;
+    }
+
+    s->tx_len -= (uint16_t)n;
+    if (s->tx_len > 0) {
+        memmove(s->tx, &s->tx[n], s->tx_len);
+    }
+    return s->tx_len == 0;
+}
+
+#endif /* PICO_ON_DEVICE */
@@ -1,5 +1,11 @@
 /**
  * 以太网适配器接口 (W5500支持)
+ *
+ * 设备端: W5500 经 SPI 突发读写 (可变长度模式，一次片选完成整段缓冲)
+ * 主机端 (PICO_ON_DEVICE == 0): 同一接口由 Linux 非阻塞 socket 实现，便于联调
+ *
+ * Socket 模型沿用 W5500: 8 个独立 socket，各自 LISTEN 于同一端口，
+ * 每个 socket 承载一个 TCP 连接。
  */
 
 #ifndef __ETHERNET_ADAPTER_H__
@@ -8,6 +14,39 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/* 默认不启用: W5500-EVB-Pico 的 SPI 引脚与本板 Y0-Y6 输出重叠，需改板或重映射后开启 */
+#ifndef PICO_ETHERNET_ENABLED
+#define PICO_ETHERNET_ENABLED   0
+#endif
+
+/* ===== W5500 SPI 引脚 (默认与 W5500-EVB-Pico 一致) ===== */
+#ifndef PICO_W5500_SPI_INSTANCE
+#define PICO_W5500_SPI_INSTANCE spi0
+#endif
+#define PICO_W5500_MISO_GPIO    16
+#define PICO_W5500_CS_GPIO      17
+#define PICO_W5500_SCK_GPIO     18
+#define PICO_W5500_MOSI_GPIO    19
+#define PICO_W5500_RST_GPIO     20
+#define PICO_W5500_INT_GPIO     21
+#define PICO_W5500_SPI_BAUDRATE (33 * 1000 * 1000)
+
+#define ETH_MAX_SOCKETS         8
+#define ETH_SOCKET_BUFFER_SIZE  2048    /* 每个 socket 的收/发缓冲 (W5500 共 16KB) */
+
+/* ===== Socket 模式 ===== */
+#define ETH_SOCKET_MODE_CLOSED  0x00
+#define ETH_SOCKET_MODE_TCP     0x01
+#define ETH_SOCKET_MODE_UDP     0x02
+
+/* ===== Socket 状态 ===== */
+typedef enum {
+    ETH_SOCKET_CLOSED = 0,
+    ETH_SOCKET_LISTEN = 1,
+    ETH_SOCKET_ESTABLISHED = 2,
+    ETH_SOCKET_CLOSING = 3          /* 对端已关闭或连接异常，需 close 后重新 listen */
+} ethernet_socket_state_t;
+
 typedef struct {
     uint8_t ip[4];
     uint8_t netmask[4];
@@ -22,4 +61,15 @@ int ethernet_send(uint8_t socket, uint8_t *buffer, uint16_t length);
 int ethernet_receive(uint8_t socket, uint8_t *buffer, uint16_t max_len);
 void ethernet_set_socket_mode(uint8_t socket, uint8_t mode);
 
+/* TCP 服务端 socket 管理 */
+bool ethernet_socket_listen(uint8_t socket, uint16_t port);
+ethernet_socket_state_t ethernet_socket_state(uint8_t socket);
+void ethernet_socket_close(uint8_t socket);
+uint16_t ethernet_rx_available(uint8_t socket);
+uint16_t ethernet_tx_free(uint8_t socket);
+
+/* 分段发送: write 仅写入发送缓冲，flush 一次性发出 (多个响应合并为一个报文段) */
+int ethernet_write(uint8_t socket, const uint8_t *buffer, uint16_t length);
+bool ethernet_flush(uint8_t socket);
+
 #endif
@@ -0,0 +1,28 @@
+/**
+ * 位区批量操作
+ *
+ * 位按 LSB 优先打包在 32 位字中 (第 n 位位于 words[n / 32] 的 bit n % 32)，
+ * 与 MODBUS 线格式的字节打包顺序一致。起始位不要求对齐，
+ * 按字移位/掩码处理，32 个位一次完成。
+ */
+
+#ifndef __FX3U_BITS_H__
+#define __FX3U_BITS_H__
+
+#include <stdint.h>
+
+#define FX3U_BITS_WORDS(n)  (((n) + 31) / 32)
+
+/* 读取/写入任意起始位的 count (1-32) 个位 */
+uint32_t fx3u_bits_read(const uint32_t *words, uint32_t start, uint8_t count);
+void fx3u_bits_write(uint32_t *words, uint32_t start, uint8_t count, uint32_t value);
+
+/* 字打包位区 <-> LSB 优先字节流 (MODBUS 数据区) */
+void fx3u_bits_to_bytes(uint8_t *dst, const uint32_t *words, uint32_t start, uint32_t count);
+void fx3u_bits_from_bytes(uint32_t *words, uint32_t start, const uint8_t *src, uint32_t count);
+
+/* 每元素一字节 (取值 0/1，PLC 核心的存储格式) <-> 字打包 */
+void fx3u_bits_pack(uint32_t *words, const uint8_t *flags, uint32_t count);
+void fx3u_bits_unpack(uint8_t *flags, uint32_t value, uint8_t count);
+
+#endif /* __FX3U_BITS_H__ */
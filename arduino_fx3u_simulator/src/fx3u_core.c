@@ -4,13 +4,18 @@
 
 #include "fx3u_core.h"
 #include "fx3u_instructions.h"
+#include "fx3u_image.h"
+#include "fx3u_profile.h"
 #include "pico/time.h"
+#include "hardware/sync.h"
 #include <limits.h>
 #include <string.h>
 
 static fx3u_core_t *g_plc_instance = NULL;
 
 static void update_timers(fx3u_core_t *plc, uint32_t elapsed_us);
+static void apply_forces(uint8_t *bits, const volatile uint32_t *mask, const uint32_t *value,
+                         uint16_t words);
 
 /**
  * 初始化PLC核心
@@ -32,16 +37,17 @@ void fx3u_core_init(fx3u_core_t *plc)
     plc->last_scan_time_us = 0;
     
     /* 初始化特殊寄存器 */
-    plc->registers[D8000 - 8000] = 200;   /* 扫描时间 */
-    plc->registers[D8001 - 8000] = 0x5EF6; /* FX3U版本 */
-    plc->registers[D8002 - 8000] = 16;    /* 内存容量 16KB */
-    plc->registers[D8003 - 8000] = 0x0010; /* 存储模式 */
-    plc->registers[D8006 - 8000] = 0;     /* CPU错误码 */
-    plc->registers[D8010 - 8000] = 0;    /* 扫描次数 */
-    plc->registers[D8120 - 8000] = 0x4096; /* 通信方式 */
-    plc->registers[D8121 - 8000] = 0;     /* 站号 */
+    fx3u_set_special_register(plc, D8000, 200);   /* 看门狗时间 */
+    fx3u_set_special_register(plc, D8001, 0x5EF6); /* FX3U版本 */
+    fx3u_set_special_register(plc, D8002, 16);    /* 内存容量 16KB */
+    fx3u_set_special_register(plc, D8003, 0x0010); /* 存储模式 */
+    fx3u_set_special_register(plc, D8006, 0);     /* CPU错误码 */
+    fx3u_set_special_register(plc, D8010, 0);    /* 当前扫描时间 */
+    fx3u_set_special_register(plc, D8120, 0x4096); /* 通信方式 */
+    fx3u_set_special_register(plc, D8121, 0);     /* 站号 */
     
     g_plc_instance = plc;
+    fx3u_image_init(plc);
 }
 
 /**
@@ -62,18 +68,50 @@ void fx3u_core_stop(fx3u_core_t *plc)
     plc->state = PLC_STOP;
 }
 
+/* 扫描时间寄存器单位为 0.1ms，饱和到 32767 */
+static int16_t scan_time_reg(uint32_t us)
+{
+    uint32_t value = us / 100;
+    return (int16_t)(value > INT16_MAX ? INT16_MAX : value);
+}
+
 /**
  * 运行一个扫描周期
  */
 void fx3u_core_run_cycle(fx3u_core_t *plc)
 {
-    if (!plc || plc->state != PLC_RUN) return;
+    if (!plc) return;
+    
+    /* 扫描开始: 切换通信侧提交的新程序，应用排队的写入 */
+    const fx3u_instruction_t *pending = plc->pending_program;
+    if (pending) {
+        __dmb();
+        fx3u_core_load_program(plc, pending, plc->pending_size);
+        plc->pending_program = NULL;
+    }
+    fx3u_image_apply_writes(plc);
+    if (plc->input_word_bits) {
+        /* 输入刷新: 本次扫描使用同一时刻的全部物理输入 */
+        fx3u_bits_unpack(plc->inputs, plc->input_word, plc->input_word_bits);
+    }
+    apply_forces(plc->inputs, plc->force_x_mask, plc->force_x_value,
+                 FX3U_FORCE_WORDS(PLC_MAX_INPUTS));
+    apply_forces(plc->outputs, plc->force_y_mask, plc->force_y_value,
+                 FX3U_FORCE_WORDS(PLC_MAX_OUTPUTS));
+    
+    if (plc->state != PLC_RUN) {
+        /* STOP 状态下仍接受通信写入并刷新映像 */
+        fx3u_image_publish(plc);
+        return;
+    }
     
     uint64_t scan_start_us = time_us_64();
     plc->cycle_count++;
     
     /* 执行用户程序 */
     fx3u_core_execute_program(plc);
+    apply_forces(plc->outputs, plc->force_y_mask, plc->force_y_value,
+                 FX3U_FORCE_WORDS(PLC_MAX_OUTPUTS));
     
     uint64_t elapsed_us = time_us_64() - scan_start_us;
     update_timers(plc, (uint32_t)elapsed_us);
@@ -99,14 +137,47 @@ void fx3u_core_run_cycle(fx3u_core_t *plc)
         plc->max_scan_time_us = elapsed_us;
     }
     
-    plc->registers[D8000 - 8000] = (int16_t)plc->scan_time_ms;
-    plc->registers[D8010 - 8000] = (int16_t)(plc->cycle_count & 0xFFFF);
-    plc->registers[D8011 - 8000] = (int16_t)(plc->min_scan_time_us / 1000);
-    plc->registers[D8012 - 8000] = (int16_t)(plc->max_scan_time_us / 1000);
+    fx3u_set_special_register(plc, D8010, scan_time_reg(plc->last_scan_time_us));
+    fx3u_set_special_register(plc, D8011, scan_time_reg(plc->min_scan_time_us));
+    fx3u_set_special_register(plc, D8012, scan_time_reg(plc->max_scan_time_us));
+    
+    /* 扫描结束: 发布一致性快照 */
+    fx3u_image_publish(plc);
+}
+
+/**
+ * 执行一步，出错时置错误码并暂停 (返回 false)
+ */
+static inline bool execute_step(fx3u_core_t *plc, uint32_t idx)
+{
+    plc->program_counter = idx;
+    fx3u_instruction_t inst = plc->program[idx];
+    inst_result_t result = fx3u_execute_instruction(plc, &inst);
+    
+    if (result != INST_OK) {
+        fx3u_set_error(plc, 0x2000 | inst.opcode);
+        plc->state = PLC_PAUSE;
+        return false;
+    }
+    return true;
 }
 
+#if PICO_PROFILER_ENABLED
+/* 分析运行: 每步前后读计数器，累计到步与指令 */
+static void execute_program_profiled(fx3u_core_t *plc)
+{
+    for (uint32_t idx = 0; idx < plc->program_size; idx++) {
+        uint32_t start = fx3u_profile_now();
+        bool ok = execute_step(plc, idx);
+        fx3u_profile_step(idx, plc->program[idx].opcode,
+                          fx3u_profile_elapsed(start, fx3u_profile_now()));
+        if (!ok) break;
+    }
+}
+#endif
+
 /**
- * 执行用户程序 (占位符)
+ * 执行用户程序
  */
 void fx3u_core_execute_program(fx3u_core_t *plc)
 {
@@ -114,16 +185,16 @@ void fx3u_core_execute_program(fx3u_core_t *plc)
         return;
     }
     
+#if PICO_PROFILER_ENABLED
+    if (fx3u_profile_scan_begin(plc)) {
+        execute_program_profiled(plc);
+        plc->program_counter = 0;
+        return;
+    }
+#endif
+    
     for (uint32_t idx = 0; idx < plc->program_size; idx++) {
-        plc->program_counter = idx;
-        fx3u_instruction_t inst = plc->program[idx];
-        inst_result_t result = fx3u_execute_instruction(plc, &inst);
-        
-        if (result != INST_OK) {
-            fx3u_set_error(plc, 0x2000 | inst->opcode);
-            plc->state = PLC_PAUSE;
-            break;
-        }
+        if (!execute_step(plc, idx)) break;
     }
     
     plc->program_counter = 0;
@@ -146,6 +217,103 @@ bool fx3u_core_load_program(fx3u_core_t *plc,
     return true;
 }
 
+/**
+ * 请求在下一扫描开始时切换程序 (主循环调用，扫描中断中生效)
+ */
+void fx3u_core_request_program(fx3u_core_t *plc,
+                               const fx3u_instruction_t *program,
+                               uint32_t instruction_count)
+{
+    if (!plc || !program || instruction_count == 0) return;
+    
+    plc->pending_size = instruction_count;
+    __dmb();
+    plc->pending_program = program;
+}
+
+/**
+ * 是否有尚未生效的程序切换
+ */
+bool fx3u_core_program_pending(const fx3u_core_t *plc)
+{
+    return plc && plc->pending_program != NULL;
+}
+
+/**
+ * 交付物理输入字 (bit n 对应 Xn)
+ */
+void fx3u_core_set_input_word(fx3u_core_t *plc, uint32_t value, uint8_t count)
+{
+    if (!plc) return;
+    if (count > 32) count = 32;
+    
+    plc->input_word = value;
+    plc->input_word_bits = count;
+}
+
+/**
+ * 强制 / 解除强制单个 X 或 Y
+ */
+bool fx3u_core_force(fx3u_core_t *plc, bool output, uint16_t addr, fx3u_force_t mode)
+{
+    if (!plc || addr >= (output ? PLC_MAX_OUTPUTS : PLC_MAX_INPUTS)) return false;
+    
+    volatile uint32_t *mask = output ? plc->force_y_mask : plc->force_x_mask;
+    uint32_t *value = output ? plc->force_y_value : plc->force_x_value;
+    uint32_t bit = 1u << (addr % 32);
+    
+    switch (mode) {
+        case FX3U_FORCE_RELEASE:
+            mask[addr / 32] &= ~bit;
+            break;
+        case FX3U_FORCE_OFF:
+        case FX3U_FORCE_ON:
+            /* 先写值再置掩码，扫描中断不会看到未定的强制值 */
+            if (mode == FX3U_FORCE_ON) {
+                value[addr / 32] |= bit;
+            } else {
+                value[addr / 32] &= ~bit;
+            }
+            mask[addr / 32] |= bit;
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+/**
+ * 解除全部强制
+ */
+void fx3u_core_release_forces(fx3u_core_t *plc)
+{
+    if (!plc) return;
+    
+    for (int i = 0; i < FX3U_FORCE_WORDS(PLC_MAX_INPUTS); i++) {
+        plc->force_x_mask[i] = 0;
+    }
+    for (int i = 0; i < FX3U_FORCE_WORDS(PLC_MAX_OUTPUTS); i++) {
+        plc->force_y_mask[i] = 0;
+    }
+}
+
+/**
+ * 当前强制点数
+ */
+uint16_t fx3u_core_force_count(const fx3u_core_t *plc)
+{
+    if (!plc) return 0;
+    
+    uint16_t count = 0;
+    for (int i = 0; i < FX3U_FORCE_WORDS(PLC_MAX_INPUTS); i++) {
+        count += (uint16_t)__builtin_popcount(plc->force_x_mask[i]);
+    }
+    for (int i = 0; i < FX3U_FORCE_WORDS(PLC_MAX_OUTPUTS); i++) {
+        count += (uint16_t)__builtin_popcount(plc->force_y_mask[i]);
+    }
+    return count;
+}
+
 /**
  * 判断是否已加载程序
  */
@@ -233,13 +401,73 @@ uint8_t fx3u_get_internal(fx3u_core_t *plc, uint16_t addr)
     return plc->internals[addr];
 }
 
+/**
+ * 设置状态继电器
+ */
+void fx3u_set_state(fx3u_core_t *plc, uint16_t addr, uint8_t value)
+{
+    if (!plc || addr >= PLC_MAX_STATES) return;
+    plc->states[addr] = value ? 1 : 0;
+}
+
+/**
+ * 获取状态继电器
+ */
+uint8_t fx3u_get_state(fx3u_core_t *plc, uint16_t addr)
+{
+    if (!plc || addr >= PLC_MAX_STATES) return 0;
+    return plc->states[addr];
+}
+
+/**
+ * 设置特殊继电器 (M8000-M8511)
+ */
+void fx3u_set_special_relay(fx3u_core_t *plc, uint16_t addr, uint8_t value)
+{
+    if (!plc || addr < PLC_SPECIAL_BASE || addr >= PLC_SPECIAL_BASE + PLC_MAX_SPECIAL) return;
+    plc->special_relays[addr - PLC_SPECIAL_BASE] = value ? 1 : 0;
+}
+
+/**
+ * 获取特殊继电器
+ */
+uint8_t fx3u_get_special_relay(fx3u_core_t *plc, uint16_t addr)
+{
+    if (!plc || addr < PLC_SPECIAL_BASE || addr >= PLC_SPECIAL_BASE + PLC_MAX_SPECIAL) return 0;
+    return plc->special_relays[addr - PLC_SPECIAL_BASE];
+}
+
+/**
+ * 设置特殊寄存器 (D8000-D8511)
+ */
+void fx3u_set_special_register(fx3u_core_t *plc, uint16_t addr, int16_t value)
+{
+    if (!plc || addr < PLC_SPECIAL_BASE || addr >= PLC_SPECIAL_BASE + PLC_MAX_SPECIAL) return;
+    if (plc->special_registers[addr - PLC_SPECIAL_BASE] != value) {
+        plc->special_registers[addr - PLC_SPECIAL_BASE] = value;
+        fx3u_image_mark_changed(FX3U_IMAGE_SD, addr - PLC_SPECIAL_BASE);
+    }
+}
+
+/**
+ * 获取特殊寄存器
+ */
+int16_t fx3u_get_special_register(fx3u_core_t *plc, uint16_t addr)
+{
+    if (!plc || addr < PLC_SPECIAL_BASE || addr >= PLC_SPECIAL_BASE + PLC_MAX_SPECIAL) return 0;
+    return plc->special_registers[addr - PLC_SPECIAL_BASE];
+}
+
 /**
  * 设置数据寄存器
  */
 void fx3u_set_register(fx3u_core_t *plc, uint16_t addr, int16_t value)
 {
     if (!plc || addr >= PLC_MAX_REGISTERS) return;
-    plc->registers[addr] = value;
+    if (plc->registers[addr] != value) {
+        plc->registers[addr] = value;
+        fx3u_image_mark_changed(FX3U_IMAGE_D, addr);
+    }
 }
 
 /**
@@ -323,9 +551,7 @@ void fx3u_set_error(fx3u_core_t *plc, uint16_t error_code)
 {
     if (!plc) return;
     plc->error_code = error_code;
-    if (D8006 >= 8000) {
-        plc->registers[D8006 - 8000] = error_code;
-    }
+    fx3u_set_special_register(plc, D8006, (int16_t)error_code);
 }
 
 /**
@@ -344,7 +570,21 @@ void fx3u_clear_error(fx3u_core_t *plc)
 {
     if (!plc) return;
     plc->error_code = 0;
-    if (D8006 >= 8000) {
-        plc->registers[D8006 - 8000] = 0;
+    fx3u_set_special_register(plc, D8006, 0);
+}
+
+/**
+ * 按掩码覆盖位区 (无强制时每字只做一次判断)
+ */
+static void apply_forces(uint8_t *bits, const volatile uint32_t *mask, const uint32_t *value,
+                         uint16_t words)
+{
+    for (uint16_t w = 0; w < words; w++) {
+        uint32_t m = mask[w];
+        while (m) {
+            uint32_t b = (uint32_t)__builtin_ctz(m);
+            bits[w * 32 + b] = (value[w] >> b) & 1u;
+            m &= m - 1;
+        }
     }
 }
@@ -0,0 +1,426 @@
+/**
+ * I/O 扩展总线实现
+ *
+ * PIO 程序 (8 条，side-set 2 位: bit0 = CLK，bit1 = LATCH，装入任意地址):
+ *
+ *      0       pull block          side 0      位数 - 1；LATCH 低: 165 装入并行输入
+ *      1       mov x, osr          side 2      LATCH 升: 595 重新锁存 (移位寄存器未变，输出不变)
+ *      2       out null, 32        side 2      丢弃计数字，下一个 out 自动取数据字
+ *   bit:
+ *      3       out pins, 1         side 2      CLK 低，DOUT = 下一位输出
+ *      4       in pins, 1          side 2      读 165 Q7
+ *      5       jmp x--, bit        side 3      CLK 升: 两条链同时移一位
+ *      6       nop                 side 0      LATCH 低
+ *      7       nop                 side 2      LATCH 升: 595 输出更新 (.wrap -> 0)
+ *
+ * 输入 / 输出都按 MSB 优先移位，自动取数 / 自动推送阈值 32 位。每帧移位数取 32 的倍数:
+ * 输出流的填充字节在前 (移出链尾丢弃)，输入流的填充在后 (链尾 DS 接地，读到 0)。
+ * 流字节 k 位于字 k / 4 的高位起第 k % 4 个字节:
+ * - 输入流: 字节 m 为模块 m (D7 先到)，字节 input_modules 为链尾校验字节
+ * - 输出流: 最后一个字节为模块 0 (Q7 先移)，向前依次为模块 1、2...
+ *
+ * 每位 3 个状态机时钟 (CLK 高 1 个、低 2 个)，分频按实际 clk_sys 取整数。
+ * 帧结束以 RX DMA 完成判断；帧的启动与收取都在关中断或扫描中断内进行。
+ */
+
+#include "fx3u_expansion.h"
+#include "fx3u_bits.h"
+#include "logger.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include <string.h>
+
+#if PICO_ON_DEVICE
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#endif
+
+#define BLOCK_COUNT         2
+#define PROG_BIT            3
+#define PROG_LENGTH         8
+#define CYCLES_PER_BIT      3
+#define FRAME_OVERHEAD      5           /* 每帧除移位外的状态机时钟 */
+#define TAIL_BYTES          1
+#define FRAME_WORDS         FX3U_BITS_WORDS(FX3U_EXPANSION_MODULES * 8 + TAIL_BYTES * 8)
+
+static fx3u_core_t *g_plc = NULL;
+static fx3u_expansion_config_t g_config;
+static fx3u_expansion_module_t g_modules[FX3U_EXPANSION_MODULES];
+static uint8_t g_before[FX3U_EXPANSION_MODULES];    /* 上上帧输入，判断单帧变化 */
+static uint8_t g_out[FX3U_EXPANSION_MODULES];       /* 下一帧送出 (扫描结束写入) */
+static fx3u_expansion_stats_t g_stats;
+static uint32_t g_tx[FRAME_WORDS + 1];              /* [0] = 位数 - 1 */
+static uint32_t g_rx[FRAME_WORDS];
+static uint8_t g_words = 0;
+static volatile bool g_busy = false;                /* 帧进行中 */
+static bool g_fault = false;
+static bool g_ready = false;
+
+static inline void stream_put(uint32_t *words, uint32_t k, uint8_t value)
+{
+    words[k / 4] |= (uint32_t)value << (24 - 8 * (k % 4));
+}
+
+static inline uint8_t stream_get(const uint32_t *words, uint32_t k)
+{
+    return (uint8_t)(words[k / 4] >> (24 - 8 * (k % 4)));
+}
+
+/* ===== 硬件 ===== */
+
+#if PICO_ON_DEVICE
+static uint8_t g_block;
+static uint8_t g_sm;
+static int g_tx_dma = -1;
+static int g_rx_dma = -1;
+
+static inline PIO block_pio(uint8_t block)
+{
+    return block ? pio1 : pio0;
+}
+
+static inline uint32_t sys_hz(void)
+{
+    return clock_get_hz(clk_sys);
+}
+
+static inline uint16_t side(uint8_t value)
+{
+    return (uint16_t)pio_encode_sideset(2, value);
+}
+
+/**
+ * 装入程序并分配状态机与 DMA: 先试 PIO1 (高速计数器从 PIO0 开始装入)
+ */
+static bool hw_claim(uint16_t div)
+{
+    uint16_t code[PROG_LENGTH];
+    code[0] = (uint16_t)(pio_encode_pull(false, true) | side(0));
+    code[1] = (uint16_t)(pio_encode_mov(pio_x, pio_osr) | side(2));
+    code[2] = (uint16_t)(pio_encode_out(pio_null, 32) | side(2));
+    code[3] = (uint16_t)(pio_encode_out(pio_pins, 1) | side(2));
+    code[4] = (uint16_t)(pio_encode_in(pio_pins, 1) | side(2));
+    code[5] = (uint16_t)(pio_encode_jmp_x_dec(PROG_BIT) | side(3));
+    code[6] = (uint16_t)(pio_encode_nop() | side(0));
+    code[7] = (uint16_t)(pio_encode_nop() | side(2));
+
+    const pio_program_t program = {
+        .instructions = code,
+        .length = PROG_LENGTH,
+        .origin = -1,
+    };
+
+    for (int b = BLOCK_COUNT - 1; b >= 0; b--) {
+        PIO pio = block_pio((uint8_t)b);
+        if (!pio_can_add_program(pio, &program)) continue;
+        int sm = pio_claim_unused_sm(pio, false);
+        if (sm < 0) continue;
+
+        g_tx_dma = dma_claim_unused_channel(false);
+        g_rx_dma = g_tx_dma >= 0 ? dma_claim_unused_channel(false) : -1;
+        if (g_rx_dma < 0) {
+            if (g_tx_dma >= 0) dma_channel_unclaim((uint)g_tx_dma);
+            pio_sm_unclaim(pio, (uint)sm);
+            return false;
+        }
+        g_block = (uint8_t)b;
+        g_sm = (uint8_t)sm;
+
+        uint offset = pio_add_program(pio, &program);
+        pio_sm_config cfg = pio_get_default_sm_config();
+        sm_config_set_wrap(&cfg, offset, offset + PROG_LENGTH - 1);
+        sm_config_set_sideset(&cfg, 2, false, false);
+        sm_config_set_sideset_pins(&cfg, PICO_EXP_CLK_GPIO);
+        sm_config_set_out_pins(&cfg, PICO_EXP_DOUT_GPIO, 1);
+        sm_config_set_in_pins(&cfg, PICO_EXP_DIN_GPIO);
+        sm_config_set_out_shift(&cfg, false, true, 32);
+        sm_config_set_in_shift(&cfg, false, true, 32);
+        sm_config_set_clkdiv_int_frac(&cfg, div, 0);
+
+        /* 引脚交给 PIO: 板载 X8/X9/Y7/Y8 不再由 SIO 读写 */
+        pio_sm_set_pins_with_mask(pio, g_sm, 0,
+                                  (1u << PICO_EXP_CLK_GPIO) | (1u << PICO_EXP_LATCH_GPIO) |
+                                  (1u << PICO_EXP_DOUT_GPIO));
+        pio_sm_set_consecutive_pindirs(pio, g_sm, PICO_EXP_CLK_GPIO, 2, true);
+        pio_sm_set_consecutive_pindirs(pio, g_sm, PICO_EXP_DOUT_GPIO, 1, true);
+        pio_sm_set_consecutive_pindirs(pio, g_sm, PICO_EXP_DIN_GPIO, 1, false);
+        pio_gpio_init(pio, PICO_EXP_CLK_GPIO);
+        pio_gpio_init(pio, PICO_EXP_LATCH_GPIO);
+        pio_gpio_init(pio, PICO_EXP_DOUT_GPIO);
+
+        pio_sm_init(pio, g_sm, offset, &cfg);
+        pio_sm_set_enabled(pio, g_sm, true);
+        return true;
+    }
+    return false;
+}
+
+/* 先启动接收，再送出位数与输出字 */
+static void hw_start(void)
+{
+    PIO pio = block_pio(g_block);
+
+    dma_channel_config rc = dma_channel_get_default_config((uint)g_rx_dma);
+    channel_config_set_transfer_data_size(&rc, DMA_SIZE_32);
+    channel_config_set_read_increment(&rc, false);
+    channel_config_set_write_increment(&rc, true);
+    channel_config_set_dreq(&rc, pio_get_dreq(pio, g_sm, false));
+    dma_channel_configure((uint)g_rx_dma, &rc, g_rx, &pio->rxf[g_sm], g_words, true);
+
+    dma_channel_config tc = dma_channel_get_default_config((uint)g_tx_dma);
+    channel_config_set_transfer_data_size(&tc, DMA_SIZE_32);
+    channel_config_set_read_increment(&tc, true);
+    channel_config_set_write_increment(&tc, false);
+    channel_config_set_dreq(&tc, pio_get_dreq(pio, g_sm, true));
+    dma_channel_configure((uint)g_tx_dma, &tc, &pio->txf[g_sm], g_tx, g_words + 1u, true);
+}
+
+static inline bool hw_done(void)
+{
+    return !dma_channel_is_busy((uint)g_rx_dma);
+}
+#else
+/* 主机构建: 165 / 595 链的位级模型，一帧在 hw_start 内完成 */
+static uint8_t g_sim_inputs[FX3U_EXPANSION_MODULES];
+static uint8_t g_sim_shift[FX3U_EXPANSION_MODULES];     /* 595 移位寄存器 */
+static uint8_t g_sim_latched[FX3U_EXPANSION_MODULES];   /* 595 输出端 */
+static uint8_t g_sim_break = 0xFF;
+
+static inline uint32_t sys_hz(void)
+{
+    return 125000000u;
+}
+
+static bool hw_claim(uint16_t div)
+{
+    (void)div;
+    return true;
+}
+
+static bool sim_din(uint32_t t, const uint8_t *loaded)
+{
+    uint32_t m = t / 8;
+    if (m >= g_sim_break || !g_config.input_modules) return true;   /* 断线: 上拉 */
+    if (m >= g_config.input_modules) return false;                   /* 链尾 DS 接地 */
+    return (loaded[m] >> (7 - t % 8)) & 1u;
+}
+
+static void hw_start(void)
+{
+    uint8_t loaded[FX3U_EXPANSION_MODULES];
+    uint8_t n = g_config.output_modules;
+    uint32_t bits = g_tx[0] + 1;
+
+    /* LATCH 低: 165 装入；LATCH 升: 595 重新锁存 */
+    memcpy(loaded, g_sim_inputs, sizeof(loaded));
+    memcpy(g_sim_latched, g_sim_shift, n);
+
+    for (uint32_t t = 0; t < bits; t++) {
+        uint8_t dout = (uint8_t)((g_tx[1 + t / 32] >> (31 - t % 32)) & 1u);
+        if (sim_din(t, loaded)) {
+            g_rx[t / 32] |= 1u << (31 - t % 32);
+        }
+        for (int m = n - 1; m > 0; m--) {
+            g_sim_shift[m] = (uint8_t)((g_sim_shift[m] << 1) | (g_sim_shift[m - 1] >> 7));
+        }
+        if (n) g_sim_shift[0] = (uint8_t)((g_sim_shift[0] << 1) | dout);
+    }
+    memcpy(g_sim_latched, g_sim_shift, n);
+}
+
+static inline bool hw_done(void)
+{
+    return true;
+}
+
+void fx3u_expansion_sim_set_inputs(uint8_t module, uint8_t value)
+{
+    if (module < FX3U_EXPANSION_MODULES) g_sim_inputs[module] = value;
+}
+
+uint8_t fx3u_expansion_sim_get_outputs(uint8_t module)
+{
+    return module < FX3U_EXPANSION_MODULES ? g_sim_latched[module] : 0;
+}
+
+void fx3u_expansion_sim_break(uint8_t module)
+{
+    g_sim_break = module;
+}
+#endif
+
+/* ===== 帧 ===== */
+
+static void start_frame(void)
+{
+    uint32_t bytes = g_words * 4u;
+
+    memset(g_tx, 0, sizeof(g_tx));
+    memset(g_rx, 0, sizeof(g_rx));
+    g_tx[0] = bytes * 8u - 1u;
+    for (uint8_t m = 0; m < g_config.output_modules; m++) {
+        stream_put(&g_tx[1], bytes - 1u - m, g_out[m]);
+        g_modules[m].outputs = g_out[m];
+    }
+    g_busy = true;
+    hw_start();
+}
+
+/**
+ * 收取已完成的帧: 链尾字节不为 0 时整帧丢弃
+ */
+static void collect_frame(void)
+{
+    g_busy = false;
+    g_stats.frames++;
+
+    uint8_t n = g_config.input_modules;
+    if (!n) return;
+    if (stream_get(g_rx, n) != 0) {
+        g_stats.chain_faults++;
+        g_fault = true;
+        return;
+    }
+    g_fault = false;
+
+    for (uint8_t m = 0; m < n; m++) {
+        fx3u_expansion_module_t *mod = &g_modules[m];
+        uint8_t value = stream_get(g_rx, m);
+        if (value != mod->inputs) {
+            mod->changes++;
+            if (value == g_before[m]) mod->glitches++;
+        }
+        g_before[m] = mod->inputs;
+        mod->inputs = value;
+    }
+}
+
+/**
+ * 初始化 (I/O 管理器之后调用): 送出全 OFF 并等第一帧读回输入
+ */
+bool fx3u_expansion_init(fx3u_core_t *plc, const fx3u_expansion_config_t *config)
+{
+    g_ready = false;
+    g_busy = false;
+    g_fault = false;
+    memset(g_modules, 0, sizeof(g_modules));
+    memset(g_before, 0, sizeof(g_before));
+    memset(g_out, 0, sizeof(g_out));
+    memset(&g_stats, 0, sizeof(g_stats));
+    if (!plc || !config) return false;
+    if (config->input_modules > FX3U_EXPANSION_MODULES ||
+        config->output_modules > FX3U_EXPANSION_MODULES) return false;
+    if (!config->input_modules && !config->output_modules) return false;
+
+    g_plc = plc;
+    g_config = *config;
+    if (!g_config.bit_rate_hz) g_config.bit_rate_hz = FX3U_EXPANSION_BIT_RATE_HZ;
+
+    uint32_t in_bits = g_config.input_modules ? (g_config.input_modules + TAIL_BYTES) * 8u : 0;
+    uint32_t out_bits = g_config.output_modules * 8u;
+    g_words = (uint8_t)FX3U_BITS_WORDS(in_bits > out_bits ? in_bits : out_bits);
+
+    /* 每位 3 个时钟，分频向上取整 (移位时钟不超过设定值) */
+    uint32_t hz = sys_hz();
+    uint32_t step = g_config.bit_rate_hz * CYCLES_PER_BIT;
+    uint32_t div = (hz + step - 1) / step;
+    if (div < 1) div = 1;
+    if (div > 0xFFFF) div = 0xFFFF;
+    uint32_t cycles = g_words * 32u * CYCLES_PER_BIT + FRAME_OVERHEAD;
+    g_stats.frame_us = (uint32_t)(((uint64_t)cycles * div * 1000000u + hz - 1) / hz);
+
+    if (!hw_claim((uint16_t)div)) {
+        LOG_WARN("[EXP] no free PIO state machine / DMA channel\r\n");
+        return false;
+    }
+    g_ready = true;
+
+    start_frame();
+    busy_wait_us(g_stats.frame_us + 10);
+    if (hw_done()) {
+        collect_frame();
+    }
+    for (uint8_t m = 0; m < FX3U_EXPANSION_MODULES; m++) {
+        g_modules[m].changes = 0;
+        g_modules[m].glitches = 0;
+        g_before[m] = g_modules[m].inputs;
+    }
+    LOG_INFO("[EXP] %u in / %u out modules, %lu us per frame\r\n",
+             g_config.input_modules, g_config.output_modules, (unsigned long)g_stats.frame_us);
+    return true;
+}
+
+/**
+ * 扫描开始: 最近一次正确读入的输入写入 X (强制点随后覆盖)
+ */
+void fx3u_expansion_scan_begin(void)
+{
+    if (!g_ready) return;
+
+    if (g_busy && hw_done()) {
+        collect_frame();
+    }
+    for (uint8_t m = 0; m < g_config.input_modules; m++) {
+        fx3u_bits_unpack(&g_plc->inputs[FX3U_EXPANSION_X_BASE + m * 8u], g_modules[m].inputs, 8);
+    }
+    fx3u_set_special_relay(g_plc, M8060, g_fault);
+}
+
+/**
+ * 扫描结束: 取出 Y，每次扫描一帧时立即启动
+ */
+void fx3u_expansion_scan_end(void)
+{
+    if (!g_ready) return;
+
+    for (uint8_t m = 0; m < g_config.output_modules; m++) {
+        const uint8_t *y = &g_plc->outputs[FX3U_EXPANSION_Y_BASE + m * 8u];
+        uint8_t value = 0;
+        for (uint8_t q = 0; q < 8; q++) {
+            value |= (uint8_t)((y[q] ? 1u : 0u) << q);
+        }
+        g_out[m] = value;
+    }
+    if (g_config.continuous) return;
+
+    if (g_busy) {
+        if (!hw_done()) {
+            g_stats.overruns++;
+            return;
+        }
+        collect_frame();
+    }
+    start_frame();
+}
+
+/**
+ * 主循环轮询: 连续刷新时上一帧结束即启动下一帧
+ */
+void fx3u_expansion_poll(void)
+{
+    if (!g_ready || !g_config.continuous) return;
+
+    uint32_t ints = save_and_disable_interrupts();
+    if (g_busy && hw_done()) {
+        collect_frame();
+    }
+    if (!g_busy) {
+        start_frame();
+    }
+    restore_interrupts(ints);
+}
+
+bool fx3u_expansion_get_module(uint8_t module, fx3u_expansion_module_t *diag)
+{
+    uint8_t n = g_config.input_modules > g_config.output_modules ?
+                g_config.input_modules : g_config.output_modules;
+    if (!diag || module >= n) return false;
+    *diag = g_modules[module];
+    return true;
+}
+
+void fx3u_expansion_get_stats(fx3u_expansion_stats_t *stats)
+{
+    if (stats) *stats = g_stats;
+}
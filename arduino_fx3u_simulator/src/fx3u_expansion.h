@@ -0,0 +1,96 @@
+/**
+ * I/O 扩展总线 (74HC165 输入链 / 74HC595 输出链，PIO + DMA)
+ *
+ * 两条菊花链共用移位时钟与锁存线，一个 PIO 状态机在同一帧内移出输出、移入输入:
+ * 锁存线为低时 165 装入并行输入，锁存线上升时 595 把移位寄存器送到输出端。
+ * 一帧 = 锁存 (装入输入) -> 移位 N 位 -> 锁存 (更新输出)，DMA 送出输出字并取回输入字，
+ * 移位期间不需要 CPU；16 个模块 (128 点) 在 4MHz 移位时钟下一帧约 40us。
+ *
+ * 模块 0 为离 Pico 最近的一片 (165 的 Q7 接 DIN，595 的 SER 接 DOUT)，
+ * 模块 m 的 D0-D7 / Q0-Q7 对应 X / Y (FX3U_EXPANSION_X_BASE + 8m + 0..7)。
+ * 最后一片 165 的 DS 接地: 链尾多移入的一个字节应为 0，否则判为链路故障 (M8060，如 DIN 断线被上拉)，
+ * 故障帧的输入不写入 X，保持上一次的正确值。
+ *
+ * 刷新方式:
+ * - 每次扫描一帧: 扫描开始取上一帧的输入，扫描结束送出本次输出并启动下一帧
+ * - 连续刷新: 主循环轮询时帧结束即启动下一帧，扫描只交换缓冲
+ *
+ * 主机构建没有 PIO，一帧按同一位序在移位寄存器模型上同步完成，
+ * 由 fx3u_expansion_sim_*() 设置输入、读取输出。
+ */
+
+#ifndef __FX3U_EXPANSION_H__
+#define __FX3U_EXPANSION_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fx3u_core.h"
+#include "fx3u_io.h"
+
+/* 默认不启用: 本板没有空闲 GPIO，扩展总线占用 X8/X9/Y7/Y8 */
+#ifndef PICO_EXPANSION_ENABLED
+#define PICO_EXPANSION_ENABLED  0
+#endif
+
+/* ===== 扩展总线引脚 (CLK 与 LATCH 须相邻，作为 side-set 引脚) ===== */
+#define PICO_EXP_CLK_GPIO       PICO_OUTPUT_Y7_GPIO    /* GPIO4: 165 CP / 595 SHCP */
+#define PICO_EXP_LATCH_GPIO     PICO_OUTPUT_Y8_GPIO    /* GPIO5: 165 PL / 595 STCP */
+#define PICO_EXP_DOUT_GPIO      PICO_INPUT_X8_GPIO     /* GPIO14: 595 DS (SER) */
+#define PICO_EXP_DIN_GPIO       PICO_INPUT_X9_GPIO     /* GPIO15: 165 Q7，保留内部上拉 */
+
+/* 启用后板载输入只剩 X0-X7 (主循环按此位数交付输入字) */
+#if PICO_EXPANSION_ENABLED
+#define FX3U_EXPANSION_LOCAL_INPUTS 8
+#else
+#define FX3U_EXPANSION_LOCAL_INPUTS PICO_TOTAL_INPUTS
+#endif
+
+#define FX3U_EXPANSION_MODULES      16          /* 每条链最多 16 片 (128 点) */
+#define FX3U_EXPANSION_X_BASE       16          /* 扩展输入从 X16 起 */
+#define FX3U_EXPANSION_Y_BASE       16          /* 扩展输出从 Y16 起 */
+#define FX3U_EXPANSION_BIT_RATE_HZ  4000000     /* 默认移位时钟 */
+
+#define M8060   8060    /* I/O 构成错误 (扩展链尾校验失败) */
+
+typedef struct {
+    uint8_t input_modules;              /* 74HC165 片数 (0-16) */
+    uint8_t output_modules;             /* 74HC595 片数 (0-16) */
+    bool continuous;                    /* true: 主循环连续刷新；false: 每次扫描一帧 */
+    uint32_t bit_rate_hz;               /* 移位时钟，0 为默认 */
+} fx3u_expansion_config_t;
+
+/* 单个模块的诊断 */
+typedef struct {
+    uint8_t inputs;                     /* 最近一次正确读入 (bit n = Dn) */
+    uint8_t outputs;                    /* 最近一次送出 (bit n = Qn) */
+    uint32_t changes;                   /* 输入变化次数 */
+    uint32_t glitches;                  /* 只保持一帧又恢复的变化 (疑似干扰) */
+} fx3u_expansion_module_t;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t overruns;                  /* 上一帧未结束，本次刷新跳过 */
+    uint32_t chain_faults;              /* 链尾字节不为 0 的帧 */
+    uint32_t frame_us;                  /* 按移位时钟计算的一帧时长 */
+} fx3u_expansion_stats_t;
+
+/* 分配 PIO 状态机与 DMA 并完成第一帧 (输出全 OFF)，无可用资源或参数无效时返回 false */
+bool fx3u_expansion_init(fx3u_core_t *plc, const fx3u_expansion_config_t *config);
+
+/* 扫描中断内调用: 运行扫描之前把最近完成的帧写入 X，之后把 Y 送出 */
+void fx3u_expansion_scan_begin(void);
+void fx3u_expansion_scan_end(void);
+
+/* 主循环调用: 连续刷新时启动下一帧 */
+void fx3u_expansion_poll(void);
+
+/* module 超出两条链中较长的一条时返回 false */
+bool fx3u_expansion_get_module(uint8_t module, fx3u_expansion_module_t *diag);
+void fx3u_expansion_get_stats(fx3u_expansion_stats_t *stats);
+
+/* 模拟模块 (仅主机构建 PICO_ON_DEVICE == 0) */
+void fx3u_expansion_sim_set_inputs(uint8_t module, uint8_t value);
+uint8_t fx3u_expansion_sim_get_outputs(uint8_t module);         /* 595 输出端 (已锁存) */
+void fx3u_expansion_sim_break(uint8_t module);                  /* 模块 module 起断开 (DIN 被上拉)，0xFF 恢复 */
+
+#endif /* __FX3U_EXPANSION_H__ */
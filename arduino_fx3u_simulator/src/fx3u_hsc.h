@@ -0,0 +1,93 @@
+/**
+ * 高速计数器 C235-C255 (PIO 硬件计数)
+ *
+ * 每个计数器占用一个 PIO 状态机: 状态机按 (上次电平, 本次电平) 查跳转表加减 Y 寄存器，
+ * 计数变化时把 Y 推入 RX FIFO，由 DMA 搬到内存，CPU 读取当前值只是一次内存读；
+ * 比较值保存在 X 寄存器，Y == X 时置 PIO 中断，DHSCS / DHSCR 的动作在中断中执行。
+ *
+ * 计数输入 (与 FX3U 相同，复位 / 启动输入未实现，用 RST 指令复位):
+ * - C235-C245 1相1输入: C235-C240 = X0-X5，C241 = X0，C242 = X2，C243 = X3，C244 = X0，C245 = X2
+ *   方向由 M8235-M8245 决定 (ON = 减计数)
+ * - C246-C250 1相2输入: 加计数 / 减计数输入 C246/C247/C249 = X0/X1，C248/C250 = X3/X4
+ * - C251-C255 2相2输入 (A/B 相，A 超前为加计数): C251/C252/C254 = X0/X1，C253/C255 = X3/X4
+ *   默认 1 倍频，M8198 (C251/C252/C254) / M8199 (C253/C255) 为 ON 时 4 倍频，
+ *   也可用 fx3u_hsc_set_multiplier() 选择 1/2/4 倍频
+ *
+ * 同一 PIO 块共用一张跳转表，因此同时使用的计数方式最多两种 (PIO0 / PIO1 各一种)，
+ * 同时运行的计数器最多 8 个。M8246-M8255 反映 C246-C255 的计数方向 (ON = 减)。
+ *
+ * 计数器开始计数后，其输入 X 从快速输入沿中断中移除 (io_claim_inputs，默认 X0 开沿中断)，
+ * 编码器脉冲不会触发周期外扫描，也不计入输入响应统计；X 字仍由周期采样更新。
+ *
+ * 主机构建没有 PIO，由 fx3u_hsc_sim_*() 模拟脉冲源，按同一张跳转表计数。
+ */
+
+#ifndef __FX3U_HSC_H__
+#define __FX3U_HSC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fx3u_core.h"
+
+#define FX3U_HSC_FIRST          235
+#define FX3U_HSC_LAST           255
+#define FX3U_HSC_CHANNELS       8       /* 2 个 PIO 块 x 4 个状态机 */
+
+#define FX3U_HSC_IS_COUNTER(n)  ((n) >= FX3U_HSC_FIRST && (n) <= FX3U_HSC_LAST)
+
+#define M8198   8198    /* C251/C252/C254 4 倍频 */
+#define M8199   8199    /* C253/C255 4 倍频 */
+#define M8235   8235    /* C235 减计数 (至 M8245) */
+#define M8246   8246    /* C246 计数方向监视 (至 M8255) */
+
+/* ===== 计数方式 (即 PIO 跳转表) ===== */
+typedef enum {
+    FX3U_HSC_MODE_SINGLE = 0,           /* A 上升沿计数，方向由软件决定 */
+    FX3U_HSC_MODE_UPDOWN = 1,           /* A 上升沿加，B 上升沿减 */
+    FX3U_HSC_MODE_QUAD1 = 2,            /* A/B 相 1 倍频 */
+    FX3U_HSC_MODE_QUAD2 = 3,            /* A/B 相 2 倍频 (A 相双沿) */
+    FX3U_HSC_MODE_QUAD4 = 4,            /* A/B 相 4 倍频 (全部沿) */
+    FX3U_HSC_MODE_COUNT
+} fx3u_hsc_mode_t;
+
+/* 比较动作发生 (中断中调用)，主程序可在此立即刷新输出 */
+typedef void (*fx3u_hsc_event_callback_t)(uint16_t counter);
+
+typedef struct {
+    uint32_t compare_events;            /* DHSCS / DHSCR 动作次数 */
+    uint32_t allocations;               /* 分配状态机次数 */
+    uint32_t allocation_failures;       /* 状态机或跳转表不足 */
+    uint32_t dma_restarts;              /* DMA 计数将尽时的重新启动 */
+} fx3u_hsc_stats_t;
+
+void fx3u_hsc_init(fx3u_core_t *plc);
+void fx3u_hsc_set_event_callback(fx3u_hsc_event_callback_t callback);
+
+/* OUT Cnnn: 驱动为 ON 时计数 (首次驱动时分配状态机)，preset 为 32 位设定值 */
+void fx3u_hsc_drive(uint16_t counter, bool enable, int32_t preset);
+void fx3u_hsc_reset(uint16_t counter);
+int32_t fx3u_hsc_read(uint16_t counter);
+void fx3u_hsc_write(uint16_t counter, int32_t value);
+bool fx3u_hsc_done(uint16_t counter);
+
+/* 在首次驱动前调用，1 / 2 / 4，仅 C251-C255 */
+bool fx3u_hsc_set_multiplier(uint16_t counter, uint8_t multiplier);
+
+/*
+ * DHSCS / DHSCR: 当前值变为 target 时在中断中执行 "device = value"
+ * device 为位地址 (FX3U_ADDR_*)，指向高速计数器本身时为复位该计数器；
+ * 每个计数器一个比较，armed = false 时撤销
+ */
+bool fx3u_hsc_compare(uint16_t counter, bool armed, int32_t target, uint16_t device, uint8_t value);
+
+/* 主循环调用: DMA 计数将尽时重新启动 */
+void fx3u_hsc_poll(void);
+
+void fx3u_hsc_get_stats(fx3u_hsc_stats_t *stats);
+
+/* 模拟脉冲源 (仅主机构建 PICO_ON_DEVICE == 0): 设置 X 电平，受影响的计数器立即计数 */
+void fx3u_hsc_sim_input(uint8_t x, bool level);
+void fx3u_hsc_sim_pulses(uint8_t x, uint32_t count);                 /* count 个上升沿 */
+void fx3u_hsc_sim_quadrature(uint8_t x_a, int32_t edges);           /* A 在 x_a，B 在 x_a + 1，正数 A 超前 */
+
+#endif /* __FX3U_HSC_H__ */
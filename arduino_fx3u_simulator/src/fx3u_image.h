@@ -0,0 +1,132 @@
+/**
+ * FX3U 过程映像 (Process Image)
+ *
+ * 扫描结束时发布一份不可变快照 (双缓冲 + seqlock)，
+ * 通信侧从快照读取，无需锁定扫描；
+ * 通信侧的写入进入队列，在下一次扫描开始时统一生效。
+ */
+
+#ifndef __FX3U_IMAGE_H__
+#define __FX3U_IMAGE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fx3u_core.h"
+#include "fx3u_bits.h"
+
+#define FX3U_IMAGE_WRITE_QUEUE_SIZE     512     /* 写队列深度 (2的幂) */
+
+/* ===== 映像区域 ===== */
+typedef enum {
+    FX3U_IMAGE_X = 0,   /* 输入继电器 */
+    FX3U_IMAGE_Y = 1,   /* 输出继电器 */
+    FX3U_IMAGE_M = 2,   /* 内部继电器 */
+    FX3U_IMAGE_D = 3,   /* 数据寄存器 */
+    FX3U_IMAGE_S = 4,   /* 状态继电器 */
+    FX3U_IMAGE_TS = 5,  /* 定时器触点 (只读) */
+    FX3U_IMAGE_CS = 6,  /* 计数器触点 (只读) */
+    FX3U_IMAGE_SM = 7,  /* 特殊继电器 M8000- */
+    FX3U_IMAGE_TN = 8,  /* 定时器当前值 (ms，上限 32767) */
+    FX3U_IMAGE_CN = 9,  /* 计数器当前值 (32位) */
+    FX3U_IMAGE_SD = 10  /* 特殊寄存器 D8000- */
+} fx3u_image_area_t;
+
+#define FX3U_IMAGE_AREA_COUNT           11
+#define FX3U_IMAGE_IS_BIT_AREA(a)       ((a) <= FX3U_IMAGE_SM && (a) != FX3U_IMAGE_D)
+
+/* ===== 快照 ===== */
+typedef struct {
+    volatile uint32_t seq;              /* 奇数表示正在写入 */
+    uint32_t scan_count;                /* 发布时的扫描计数 */
+    uint32_t change_seq;                /* 变化序号: 每次发布加一，从 1 开始 */
+    uint32_t inputs[FX3U_BITS_WORDS(PLC_MAX_INPUTS)];       /* 位区按字打包 */
+    uint32_t outputs[FX3U_BITS_WORDS(PLC_MAX_OUTPUTS)];
+    uint32_t internals[FX3U_BITS_WORDS(PLC_MAX_INTERNALS)];
+    uint32_t states[FX3U_BITS_WORDS(PLC_MAX_STATES)];
+    uint32_t timer_contacts[FX3U_BITS_WORDS(PLC_MAX_TIMERS)];
+    uint32_t counter_contacts[FX3U_BITS_WORDS(PLC_MAX_COUNTERS)];
+    uint32_t special_relays[FX3U_BITS_WORDS(PLC_MAX_SPECIAL)];
+    int16_t registers[PLC_MAX_REGISTERS];
+    int16_t timer_values[PLC_MAX_TIMERS];
+    int32_t counter_values[PLC_MAX_COUNTERS];
+    int16_t special_registers[PLC_MAX_SPECIAL];
+} fx3u_image_snapshot_t;
+
+#define FX3U_IMAGE_BITS_PER_WRITE       16      /* 位区写入每项最多携带的位数 */
+#define FX3U_IMAGE_MAX_SPAN_BITS        2048    /* 单次多区段位读取上限 */
+
+/* ===== 变化检测 =====
+ * D 与 D8000- 每个寄存器一个脏标志，由 fx3u_set_register / fx3u_set_special_register
+ * 在值改变时置位，发布时折算为该寄存器最近一次变化的序号 (低 16 位)。
+ * 客户端给出上次看到的序号即可查询其后变化的寄存器；序号过旧 (超出窗口) 或
+ * 大于当前序号 (本机重启) 时须全量重读。
+ */
+#define FX3U_IMAGE_CHANGE_BLOCK         32      /* 块内任一寄存器变化即记录块序号，用于快速跳过 */
+#define FX3U_IMAGE_CHANGE_WINDOW        0x8000u
+
+/* ===== 位区段 (多区段请求按顺序首尾相接) ===== */
+typedef struct {
+    fx3u_image_area_t area;
+    uint16_t start;
+    uint16_t count;
+} fx3u_image_span_t;
+
+/* ===== 延迟写入项 ===== */
+typedef struct {
+    uint8_t area;
+    uint8_t count;                      /* 位区: value 中自 addr 起的位数；寄存器: 1；CN: 见下 */
+    uint16_t addr;
+    int16_t value;
+} fx3u_image_write_t;
+
+/* CN 写入项的 count 字段: 选择写入 32 位当前值的哪一部分 */
+#define FX3U_IMAGE_CN_SIGNED            0       /* 16 位值符号扩展为 32 位 */
+#define FX3U_IMAGE_CN_LOW               1       /* 仅低字 */
+#define FX3U_IMAGE_CN_HIGH              2       /* 仅高字 */
+
+/* ===== 统计 ===== */
+typedef struct {
+    uint32_t publish_count;
+    uint32_t read_retries;
+    uint32_t writes_applied;
+    uint32_t writes_rejected;
+} fx3u_image_stats_t;
+
+/* 扫描侧 */
+void fx3u_image_init(fx3u_core_t *plc);
+uint32_t fx3u_image_apply_writes(fx3u_core_t *plc);     /* 扫描开始 */
+void fx3u_image_publish(const fx3u_core_t *plc);        /* 扫描结束 */
+
+/* 通信侧读取 - 位按 LSB 优先打包输出，返回快照对应的扫描计数 */
+uint32_t fx3u_image_read_bits(fx3u_image_area_t area, uint16_t start,
+                              uint16_t count, uint8_t *packed);
+uint32_t fx3u_image_read_bit_spans(const fx3u_image_span_t *spans, uint8_t span_count,
+                                   uint8_t *packed);
+uint32_t fx3u_image_read_registers(uint16_t start, uint16_t count, int16_t *out);
+
+/* 快照直接访问 (seqlock): 在 begin/retry 之间读取，retry 返回 true 时须整体重读 */
+const fx3u_image_snapshot_t *fx3u_image_snapshot_begin(uint32_t *seq);
+bool fx3u_image_snapshot_retry(const fx3u_image_snapshot_t *snap, uint32_t seq);
+uint32_t fx3u_image_snapshot_bits(const fx3u_image_snapshot_t *snap, fx3u_image_area_t area,
+                                  uint16_t start, uint8_t count);
+int32_t fx3u_image_snapshot_value(const fx3u_image_snapshot_t *snap, fx3u_image_area_t area,
+                                  uint16_t index);
+uint16_t fx3u_image_area_size(fx3u_image_area_t area);
+
+/* 变化检测 - 扫描侧标记，通信侧在快照读取期间查询 */
+void fx3u_image_mark_changed(fx3u_image_area_t area, uint16_t index);
+bool fx3u_image_changes_valid(const fx3u_image_snapshot_t *snap, uint32_t since);
+bool fx3u_image_changed_since(const fx3u_image_snapshot_t *snap, fx3u_image_area_t area,
+                              uint16_t index, uint32_t since);
+
+/* 通信侧写入 (主循环单生产者) - 整批入队，扫描开始时原子生效；队列满返回 false */
+bool fx3u_image_queue_bits(fx3u_image_area_t area, uint16_t start,
+                           const uint8_t *packed, uint16_t count);
+bool fx3u_image_queue_bit_spans(const fx3u_image_span_t *spans, uint8_t span_count,
+                                const uint8_t *packed);
+bool fx3u_image_queue_registers(uint16_t start, const int16_t *values, uint16_t count);
+bool fx3u_image_queue_writes(const fx3u_image_write_t *writes, uint16_t count);
+
+const fx3u_image_stats_t *fx3u_image_get_stats(void);
+
+#endif /* __FX3U_IMAGE_H__ */
@@ -0,0 +1,272 @@
+/**
+ * 扫描时间分析实现
+ *
+ * 扫描上下文只做累加；控制请求以标志交给下一扫描开始处理，
+ * 清零与累加不会交错。读取侧不加锁，运行中读到的是近似值。
+ */
+
+#include "fx3u_profile.h"
+#include "fx3u_instructions.h"
+#include "pico/stdlib.h"
+#include <string.h>
+
+#if PICO_PROFILER_ENABLED
+
+#if PICO_ON_DEVICE
+#include "hardware/clocks.h"
+#else
+#include <time.h>
+#endif
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_cycles;
+    uint64_t cycles;
+} profile_counter_t;
+
+static profile_counter_t g_steps[FX3U_PROFILE_MAX_STEPS];
+static profile_counter_t g_opcodes[FX3U_PROFILE_OPCODES];
+static uint32_t g_scans = 0;
+static uint64_t g_total_cycles = 0;
+static uint64_t g_uncovered_cycles = 0;
+
+static volatile bool g_request_on = false;
+static volatile bool g_request_reset = false;
+static bool g_on = false;
+static const fx3u_instruction_t *g_program = NULL;
+
+static void clear(void)
+{
+    memset(g_steps, 0, sizeof(g_steps));
+    memset(g_opcodes, 0, sizeof(g_opcodes));
+    g_scans = 0;
+    g_total_cycles = 0;
+    g_uncovered_cycles = 0;
+}
+
+static inline void counter_add(profile_counter_t *c, uint32_t cycles)
+{
+    c->count++;
+    c->cycles += cycles;
+    if (cycles > c->max_cycles) c->max_cycles = cycles;
+}
+
+/* ===== 扫描上下文 ===== */
+
+#if !PICO_ON_DEVICE
+uint32_t fx3u_profile_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+#endif
+
+/**
+ * 扫描开始: 程序切换或清零请求时丢弃旧统计，再应用启动 / 停止
+ */
+bool fx3u_profile_scan_begin(const fx3u_core_t *plc)
+{
+    if (g_request_reset || plc->program != g_program) {
+        g_request_reset = false;
+        g_program = plc->program;
+        clear();
+    }
+
+    if (g_request_on != g_on) {
+        g_on = g_request_on;
+#if PICO_ON_DEVICE
+        if (g_on) {
+            /* SysTick 自由运行: 重装 0xFFFFFF，时钟源为处理器时钟，不开中断 */
+            systick_hw->rvr = 0x00FFFFFFu;
+            systick_hw->cvr = 0;
+            systick_hw->csr = 0x5;
+        }
+#endif
+    }
+
+    if (g_on) g_scans++;
+    return g_on;
+}
+
+void fx3u_profile_step(uint32_t step, uint8_t opcode, uint32_t cycles)
+{
+    counter_add(&g_opcodes[opcode], cycles);
+    if (step < FX3U_PROFILE_MAX_STEPS) {
+        counter_add(&g_steps[step], cycles);
+    } else {
+        g_uncovered_cycles += cycles;
+    }
+    g_total_cycles += cycles;
+}
+
+/* ===== 控制 ===== */
+
+bool fx3u_profile_start(void)
+{
+    g_request_on = true;
+    return true;
+}
+
+void fx3u_profile_stop(void)
+{
+    g_request_on = false;
+}
+
+void fx3u_profile_reset(void)
+{
+    g_request_reset = true;
+}
+
+/* ===== 读取 ===== */
+
+static uint16_t cycles_per_us(void)
+{
+#if PICO_ON_DEVICE
+    return (uint16_t)(clock_get_hz(clk_sys) / 1000000u);
+#else
+    return 1000;
+#endif
+}
+
+static bool is_contact(uint8_t opcode)
+{
+    return opcode == OP_LD || opcode == OP_AND || opcode == OP_OR || opcode == OP_NOT;
+}
+
+/* 梯级从第 0 步、以及紧跟非触点指令的 LD 开始 */
+static bool rung_start(const fx3u_instruction_t *program, uint32_t step)
+{
+    return step == 0 || (program[step].opcode == OP_LD && !is_contact(program[step - 1].opcode));
+}
+
+static uint16_t covered_steps(const fx3u_core_t *plc)
+{
+    if (!plc || !plc->program || plc->program != g_program) return 0;
+    return (uint16_t)(plc->program_size < FX3U_PROFILE_MAX_STEPS ?
+                      plc->program_size : FX3U_PROFILE_MAX_STEPS);
+}
+
+static uint16_t count_rungs(const fx3u_core_t *plc)
+{
+    uint16_t steps = covered_steps(plc);
+    uint16_t rungs = 0;
+    for (uint16_t s = 0; s < steps; s++) {
+        if (rung_start(plc->program, s)) rungs++;
+    }
+    return rungs;
+}
+
+void fx3u_profile_get_summary(const fx3u_core_t *plc, fx3u_profile_summary_t *summary)
+{
+    if (!summary) return;
+
+    summary->enabled = g_on;
+    summary->cycles_per_us = cycles_per_us();
+    summary->scans = g_scans;
+    summary->total_cycles = g_total_cycles;
+    summary->uncovered_cycles = g_uncovered_cycles;
+    summary->steps = covered_steps(plc);
+    summary->rungs = count_rungs(plc);
+}
+
+uint16_t fx3u_profile_entries(const fx3u_core_t *plc, fx3u_profile_view_t view)
+{
+    switch (view) {
+        case FX3U_PROFILE_VIEW_STEPS:   return covered_steps(plc);
+        case FX3U_PROFILE_VIEW_OPCODES: return FX3U_PROFILE_OPCODES;
+        case FX3U_PROFILE_VIEW_RUNGS:   return count_rungs(plc);
+        default:                        return 0;
+    }
+}
+
+static void fill(fx3u_profile_entry_t *e, uint16_t index, const profile_counter_t *c)
+{
+    e->index = index;
+    e->count = c->count;
+    e->cycles = c->cycles;
+    e->max_cycles = c->max_cycles;
+}
+
+/**
+ * 梯级汇总: 一次遍历程序，落在 [first, first + count) 的梯级累加其各步
+ */
+static uint16_t read_rungs(const fx3u_core_t *plc, uint16_t first, uint16_t count,
+                           fx3u_profile_entry_t *entries)
+{
+    uint16_t steps = covered_steps(plc);
+    uint16_t produced = 0;
+    int32_t rung = -1;
+
+    for (uint16_t s = 0; s < steps; s++) {
+        if (rung_start(plc->program, s)) rung++;
+        if (rung < first) continue;
+        if (rung >= (int32_t)first + count) break;
+
+        fx3u_profile_entry_t *e = &entries[rung - first];
+        const profile_counter_t *c = &g_steps[s];
+        if (rung - first == produced) {
+            fill(e, s, c);
+            produced++;
+        } else {
+            e->cycles += c->cycles;
+            e->max_cycles += c->max_cycles;
+        }
+    }
+    return produced;
+}
+
+uint16_t fx3u_profile_read(const fx3u_core_t *plc, fx3u_profile_view_t view, uint16_t first,
+                           uint16_t count, fx3u_profile_entry_t *entries)
+{
+    if (!entries) return 0;
+    if (view == FX3U_PROFILE_VIEW_RUNGS) {
+        return read_rungs(plc, first, count, entries);
+    }
+
+    uint16_t total = fx3u_profile_entries(plc, view);
+    if (first >= total) return 0;
+    if (count > total - first) count = (uint16_t)(total - first);
+
+    const profile_counter_t *table = view == FX3U_PROFILE_VIEW_STEPS ? g_steps : g_opcodes;
+    for (uint16_t i = 0; i < count; i++) {
+        fill(&entries[i], (uint16_t)(first + i), &table[first + i]);
+    }
+    return count;
+}
+
+#else /* !PICO_PROFILER_ENABLED */
+
+bool fx3u_profile_start(void)
+{
+    return false;
+}
+
+void fx3u_profile_stop(void) {}
+void fx3u_profile_reset(void) {}
+
+void fx3u_profile_get_summary(const fx3u_core_t *plc, fx3u_profile_summary_t *summary)
+{
+    (void)plc;
+    if (summary) memset(summary, 0, sizeof(*summary));
+}
+
+uint16_t fx3u_profile_entries(const fx3u_core_t *plc, fx3u_profile_view_t view)
+{
+    (void)plc;
+    (void)view;
+    return 0;
+}
+
+uint16_t fx3u_profile_read(const fx3u_core_t *plc, fx3u_profile_view_t view, uint16_t first,
+                           uint16_t count, fx3u_profile_entry_t *entries)
+{
+    (void)plc;
+    (void)view;
+    (void)first;
+    (void)count;
+    (void)entries;
+    return 0;
+}
+
+#endif /* PICO_PROFILER_ENABLED */
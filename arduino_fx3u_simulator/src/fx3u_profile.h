@@ -0,0 +1,99 @@
+/**
+ * 扫描时间分析 (按程序步 / 指令 / 梯级累计执行时间)
+ *
+ * 不采样: 分析运行时每条指令前后各读一次计数器，累计到该步与该指令上。
+ * - 设备: SysTick 24 位递减计数，时钟为 clk_sys (单位为 CPU 周期)
+ * - 主机: timespec_get (单位为 ns)
+ * 梯级在读取时由程序推出: 第 0 步以及紧跟在非触点指令之后的 LD 开始新梯级，
+ * 梯级的统计为其各步之和。
+ *
+ * PICO_PROFILER_ENABLED 为 0 (默认) 时执行循环中没有任何分析代码，
+ * 接口保留但始终报告未启用；编译进来后也默认停止，停止时走原执行循环。
+ * 启动 / 停止 / 清零与程序切换都在下一扫描开始时生效。
+ *
+ * 读取: USB 监视命令 PROFILE (0x0B)，MODBUS 文件记录 0x0003-0x0006。
+ */
+
+#ifndef __FX3U_PROFILE_H__
+#define __FX3U_PROFILE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fx3u_core.h"
+
+#ifndef PICO_PROFILER_ENABLED
+#define PICO_PROFILER_ENABLED   0
+#endif
+
+#define FX3U_PROFILE_MAX_STEPS  1024    /* 逐步统计的步数，之后的步只计入指令与合计 */
+#define FX3U_PROFILE_OPCODES    256
+
+typedef enum {
+    FX3U_PROFILE_VIEW_STEPS = 0,        /* 条目 n = 第 n 步 */
+    FX3U_PROFILE_VIEW_OPCODES = 1,      /* 条目 n = 操作码 n */
+    FX3U_PROFILE_VIEW_RUNGS = 2,        /* 条目 n = 第 n 个梯级，index 为其首步 */
+    FX3U_PROFILE_VIEW_COUNT
+} fx3u_profile_view_t;
+
+typedef struct {
+    uint16_t index;
+    uint32_t count;                     /* 执行次数 */
+    uint64_t cycles;                    /* 累计计数 */
+    uint32_t max_cycles;                /* 单次最大 (梯级为各步最大值之和) */
+} fx3u_profile_entry_t;
+
+typedef struct {
+    bool enabled;
+    uint16_t cycles_per_us;             /* 计数换算 (主机为 1000) */
+    uint32_t scans;                     /* 分析期间的扫描 */
+    uint64_t total_cycles;              /* 全部指令合计 */
+    uint64_t uncovered_cycles;          /* 超出 FX3U_PROFILE_MAX_STEPS 的步 */
+    uint16_t steps;                     /* 步视图条目数 */
+    uint16_t rungs;
+} fx3u_profile_summary_t;
+
+/* 控制 (主循环调用，下一扫描开始生效)；未编译分析时返回 false */
+bool fx3u_profile_start(void);
+void fx3u_profile_stop(void);
+void fx3u_profile_reset(void);
+
+/* 读取 (主循环调用，运行中读取的是近似值) */
+void fx3u_profile_get_summary(const fx3u_core_t *plc, fx3u_profile_summary_t *summary);
+uint16_t fx3u_profile_entries(const fx3u_core_t *plc, fx3u_profile_view_t view);
+/* 从条目 first 起读取至多 count 个，返回读取个数 */
+uint16_t fx3u_profile_read(const fx3u_core_t *plc, fx3u_profile_view_t view, uint16_t first,
+                           uint16_t count, fx3u_profile_entry_t *entries);
+
+/* ===== 执行循环接口 (扫描上下文) ===== */
+#if PICO_PROFILER_ENABLED
+#include "pico/stdlib.h"
+
+#if PICO_ON_DEVICE
+#include "hardware/structs/systick.h"
+
+/* SysTick 递减计数，相减顺序与主机相反 */
+static inline uint32_t fx3u_profile_now(void)
+{
+    return systick_hw->cvr;
+}
+
+static inline uint32_t fx3u_profile_elapsed(uint32_t start, uint32_t end)
+{
+    return (start - end) & 0x00FFFFFFu;
+}
+#else
+uint32_t fx3u_profile_now(void);        /* 单调时钟 ns (低 32 位) */
+
+static inline uint32_t fx3u_profile_elapsed(uint32_t start, uint32_t end)
+{
+    return end - start;
+}
+#endif
+
+/* 扫描开始: 应用控制请求，返回本次扫描是否分析 */
+bool fx3u_profile_scan_begin(const fx3u_core_t *plc);
+void fx3u_profile_step(uint32_t step, uint8_t opcode, uint32_t cycles);
+
+#endif /* PICO_PROFILER_ENABLED */
+
+#endif /* __FX3U_PROFILE_H__ */
@@ -1,8 +1,21 @@
 /**
- * 默认 PLC 程序与初始化
+ * 默认 PLC 程序、Flash 程序存储与在线下载
  */
 
 #include "fx3u_program.h"
+#include "fx3u_watchdog.h"
+#include <stddef.h>
+#include "pico/stdlib.h"
+#include <string.h>
+
+#if PICO_ON_DEVICE
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#endif
+
+/* 程序镜像即指令数组本身，可直接在 Flash 中执行 */
+_Static_assert(sizeof(fx3u_instruction_t) == FX3U_PROGRAM_STEP_SIZE,
+               "fx3u_instruction_t layout must match the program image step");
 
 static const fx3u_instruction_t g_default_program[] = {
     /* Y0 直接跟随 X0 */
@@ -58,3 +71,407 @@ void fx3u_program_apply_defaults(fx3u_core_t *plc)
     fx3u_set_register(plc, 121, 50);   /* D121: 累加偏移 */
     fx3u_set_register(plc, 122, 0);    /* D122: 运算结果 */
 }
+
+/* ===== Flash 程序槽 ===== */
+
+#define STORE_PAGE_SIZE     256
+#define STORE_SECTOR_SIZE   4096
+#define SLOT_DATA_OFFSET    STORE_SECTOR_SIZE                   /* 头扇区之后 */
+#define SLOT_SIZE           (SLOT_DATA_OFFSET + FX3U_PROGRAM_MAX_BYTES)
+#define SLOT_COUNT          2
+#define SLOT_MAGIC          0x47505846u                         /* "FXPG" */
+#define NO_SLOT             0xFF
+#define STORE_ERASE_MAX_MS  400                                 /* 扇区擦除最长时间 */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t generation;
+    uint32_t steps;
+    uint32_t crc;                       /* 程序数据 CRC32 */
+    uint32_t header_crc;                /* 以上字段 CRC32 */
+} slot_header_t;
+
+#if PICO_ON_DEVICE
+
+/* Flash 末尾的两个槽，通过 XIP 直接读取 */
+#define STORE_OFFSET        (PICO_FLASH_SIZE_BYTES - SLOT_COUNT * SLOT_SIZE)
+
+static const uint8_t *store_data(uint32_t offset)
+{
+    return (const uint8_t *)(uintptr_t)(XIP_BASE + STORE_OFFSET + offset);
+}
+
+/* 擦除一个扇区，扫描最多被推迟一个扇区的擦除时间 */
+static void store_erase(uint32_t offset)
+{
+    uint32_t ints = save_and_disable_interrupts();
+    flash_range_erase(STORE_OFFSET + offset, STORE_SECTOR_SIZE);
+    restore_interrupts(ints);
+}
+
+static void store_program(uint32_t offset, const uint8_t *page)
+{
+    uint32_t ints = save_and_disable_interrupts();
+    flash_range_program(STORE_OFFSET + offset, page, STORE_PAGE_SIZE);
+    restore_interrupts(ints);
+}
+
+#else /* !PICO_ON_DEVICE */
+
+/* 主机构建: 以内存模拟 Flash，编程只能把 1 变为 0 */
+static uint8_t g_store[SLOT_COUNT * SLOT_SIZE];
+static bool g_store_ready = false;
+
+static const uint8_t *store_data(uint32_t offset)
+{
+    if (!g_store_ready) {
+        memset(g_store, 0xFF, sizeof(g_store));
+        g_store_ready = true;
+    }
+    return &g_store[offset];
+}
+
+#define STORE_ERASE_US      45000       /* 扇区擦除典型时间 */
+
+/* 按典型擦除时间推进时钟，看门狗与调度看到的耗时与设备相同 */
+static void store_erase(uint32_t offset)
+{
+    store_data(0);
+    memset(&g_store[offset], 0xFF, STORE_SECTOR_SIZE);
+    busy_wait_us(STORE_ERASE_US);
+}
+
+static void store_program(uint32_t offset, const uint8_t *page)
+{
+    store_data(0);
+    for (uint32_t i = 0; i < STORE_PAGE_SIZE; i++) {
+        g_store[offset + i] &= page[i];
+    }
+}
+
+#endif /* PICO_ON_DEVICE */
+
+static fx3u_program_stage_t g_stage;
+static uint8_t g_active_slot = NO_SLOT;
+static uint8_t g_page[STORE_PAGE_SIZE];
+static uint16_t g_page_fill = 0;        /* g_page 中尚未写入 Flash 的字节数 */
+static uint32_t g_erase_next = 0;       /* 下一个待擦除扇区 (槽内偏移) */
+static uint32_t g_erase_end = 0;
+
+/**
+ * CRC32 (多项式 0xEDB88320，半字节查表)
+ */
+uint32_t fx3u_program_crc32(uint32_t crc, const uint8_t *data, uint32_t length)
+{
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+        0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    
+    if (!data) return crc;
+    
+    crc = ~crc;
+    for (uint32_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+static uint32_t slot_offset(uint8_t slot)
+{
+    return (uint32_t)slot * SLOT_SIZE;
+}
+
+static const slot_header_t *slot_header(uint8_t slot)
+{
+    return (const slot_header_t *)store_data(slot_offset(slot));
+}
+
+static const uint8_t *slot_program(uint8_t slot)
+{
+    return store_data(slot_offset(slot) + SLOT_DATA_OFFSET);
+}
+
+/* 槽头与程序数据均校验通过 */
+static bool slot_valid(uint8_t slot)
+{
+    const slot_header_t *h = slot_header(slot);
+    
+    if (h->magic != SLOT_MAGIC || h->steps == 0 || h->steps > FX3U_PROGRAM_MAX_STEPS) {
+        return false;
+    }
+    if (fx3u_program_crc32(0, (const uint8_t *)h, offsetof(slot_header_t, header_crc)) !=
+        h->header_crc) {
+        return false;
+    }
+    return fx3u_program_crc32(0, slot_program(slot), h->steps * FX3U_PROGRAM_STEP_SIZE) ==
+           h->crc;
+}
+
+/**
+ * 上电加载 Flash 中代数最新的有效程序
+ */
+bool fx3u_program_load_stored(fx3u_core_t *plc)
+{
+    if (!plc) return false;
+    
+    uint8_t best = NO_SLOT;
+    for (uint8_t slot = 0; slot < SLOT_COUNT; slot++) {
+        if (slot_valid(slot) &&
+            (best == NO_SLOT || slot_header(slot)->generation > slot_header(best)->generation)) {
+            best = slot;
+        }
+    }
+    if (best == NO_SLOT) {
+        return false;
+    }
+    
+    const slot_header_t *h = slot_header(best);
+    if (!fx3u_core_load_program(plc, (const fx3u_instruction_t *)slot_program(best), h->steps)) {
+        return false;
+    }
+    g_active_slot = best;
+    g_stage.generation = h->generation;
+    return true;
+}
+
+static fx3u_program_result_t stage_fail(fx3u_program_result_t result)
+{
+    g_stage.state = FX3U_PROGRAM_FAILED;
+    g_stage.last_error = result;
+    return result;
+}
+
+/* 写入 g_page 并回读校验 */
+static fx3u_program_result_t flush_page(void)
+{
+    if (g_page_fill == 0) return FX3U_PROGRAM_OK;
+    
+    uint32_t base = g_stage.received_bytes - g_page_fill;
+    uint32_t offset = slot_offset(g_stage.slot) + SLOT_DATA_OFFSET + base;
+    memset(&g_page[g_page_fill], 0xFF, STORE_PAGE_SIZE - g_page_fill);
+    store_program(offset, g_page);
+    
+    if (memcmp(store_data(offset), g_page, g_page_fill) != 0) {
+        return stage_fail(FX3U_PROGRAM_ERR_FLASH);
+    }
+    g_page_fill = 0;
+    return FX3U_PROGRAM_OK;
+}
+
+/* 已接收的第 index 个字节 (已写入 Flash 或仍在页缓冲中) */
+static uint8_t staged_byte(uint32_t index)
+{
+    uint32_t flushed = g_stage.received_bytes - g_page_fill;
+    if (index >= flushed) {
+        return g_page[index - flushed];
+    }
+    return slot_program(g_stage.slot)[index];
+}
+
+/**
+ * 开始下载: 选定非运行槽后立即返回，擦除由 fx3u_program_poll() 逐扇区完成
+ */
+fx3u_program_result_t fx3u_program_stage_begin(const fx3u_core_t *plc, uint32_t steps,
+                                               uint32_t crc)
+{
+    /* 上一次提交尚未生效时，非运行槽可能正是即将运行的程序 */
+    if (fx3u_core_program_pending(plc)) {
+        g_stage.last_error = FX3U_PROGRAM_ERR_BUSY;
+        return FX3U_PROGRAM_ERR_BUSY;
+    }
+    if (steps == 0 || steps > FX3U_PROGRAM_MAX_STEPS) {
+        g_stage.last_error = FX3U_PROGRAM_ERR_RANGE;
+        return FX3U_PROGRAM_ERR_RANGE;
+    }
+    
+    g_stage.slot = g_active_slot == 0 ? 1 : 0;
+    g_stage.expected_bytes = steps * FX3U_PROGRAM_STEP_SIZE;
+    g_stage.expected_crc = crc;
+    g_stage.received_bytes = 0;
+    g_stage.erased_bytes = 0;
+    g_stage.crc = 0;
+    g_stage.last_error = FX3U_PROGRAM_OK;
+    g_page_fill = 0;
+    
+    /* 头扇区先擦除，下载中途掉电时该槽无效，另一槽不受影响 */
+    uint32_t data_sectors = (g_stage.expected_bytes + STORE_SECTOR_SIZE - 1) / STORE_SECTOR_SIZE;
+    g_erase_next = 0;
+    g_erase_end = SLOT_DATA_OFFSET + data_sectors * STORE_SECTOR_SIZE;
+    
+    g_stage.state = FX3U_PROGRAM_ERASING;
+    return FX3U_PROGRAM_OK;
+}
+
+/**
+ * 后台擦除: 每次一个扇区，全部擦除后进入接收状态
+ */
+void fx3u_program_poll(void)
+{
+    if (g_stage.state != FX3U_PROGRAM_ERASING) return;
+    
+    /* 擦除期间关中断，扫描与主循环心跳都停顿，看门狗按最长擦除时间放宽 */
+    fx3u_watchdog_extend(STORE_ERASE_MAX_MS);
+    store_erase(slot_offset(g_stage.slot) + g_erase_next);
+    g_erase_next += STORE_SECTOR_SIZE;
+    if (g_erase_next > SLOT_DATA_OFFSET) {
+        g_stage.erased_bytes = g_erase_next - SLOT_DATA_OFFSET;
+    }
+    if (g_erase_next >= g_erase_end) {
+        g_stage.state = FX3U_PROGRAM_RECEIVING;
+    }
+}
+
+/**
+ * 写入一段镜像数据
+ *
+ * 数据须从已接收位置处连续写入；与已接收部分重叠的数据 (主站超时重发)
+ * 逐字节比较，一致则视为成功，因此主站可放心重发未得到应答的请求。
+ * 擦除期间只接受落在已擦除部分内的数据，超出部分返回 BUSY，主站稍后重发。
+ */
+fx3u_program_result_t fx3u_program_stage_write(uint32_t offset, const uint8_t *data,
+                                               uint16_t length)
+{
+    if (!data || (g_stage.state != FX3U_PROGRAM_RECEIVING &&
+                  g_stage.state != FX3U_PROGRAM_ERASING)) {
+        g_stage.last_error = FX3U_PROGRAM_ERR_STATE;
+        return FX3U_PROGRAM_ERR_STATE;
+    }
+    if (offset + length > g_stage.expected_bytes) {
+        g_stage.last_error = FX3U_PROGRAM_ERR_RANGE;
+        return FX3U_PROGRAM_ERR_RANGE;
+    }
+    if (g_stage.state == FX3U_PROGRAM_ERASING && offset + length > g_stage.erased_bytes) {
+        g_stage.last_error = FX3U_PROGRAM_ERR_BUSY;
+        return FX3U_PROGRAM_ERR_BUSY;
+    }
+    if (offset > g_stage.received_bytes) {
+        g_stage.last_error = FX3U_PROGRAM_ERR_SEQUENCE;
+        return FX3U_PROGRAM_ERR_SEQUENCE;
+    }
+    
+    /* 重叠部分 */
+    uint16_t i = 0;
+    for (; i < length && offset + i < g_stage.received_bytes; i++) {
+        if (staged_byte(offset + i) != data[i]) {
+            g_stage.last_error = FX3U_PROGRAM_ERR_MISMATCH;
+            return FX3U_PROGRAM_ERR_MISMATCH;
+        }
+    }
+    
+    /* 新数据: 填满一页即写入 */
+    while (i < length) {
+        uint16_t n = STORE_PAGE_SIZE - g_page_fill;
+        if (n > length - i) n = length - i;
+        
+        memcpy(&g_page[g_page_fill], &data[i], n);
+        g_stage.crc = fx3u_program_crc32(g_stage.crc, &data[i], n);
+        g_page_fill += n;
+        g_stage.received_bytes += n;
+        i += n;
+        
+        if (g_page_fill == STORE_PAGE_SIZE) {
+            fx3u_program_result_t result = flush_page();
+            if (result != FX3U_PROGRAM_OK) return result;
+        }
+    }
+    return FX3U_PROGRAM_OK;
+}
+
+/**
+ * 提交: 校验整体 CRC，写槽头，请求在下一扫描开始时切换
+ */
+fx3u_program_result_t fx3u_program_stage_commit(fx3u_core_t *plc)
+{
+    if (plc && g_stage.state == FX3U_PROGRAM_ERASING) {
+        g_stage.last_error = FX3U_PROGRAM_ERR_BUSY;
+        return FX3U_PROGRAM_ERR_BUSY;
+    }
+    if (!plc || g_stage.state != FX3U_PROGRAM_RECEIVING) {
+        g_stage.last_error = FX3U_PROGRAM_ERR_STATE;
+        return FX3U_PROGRAM_ERR_STATE;
+    }
+    if (g_stage.received_bytes != g_stage.expected_bytes) {
+        g_stage.last_error = FX3U_PROGRAM_ERR_SEQUENCE;
+        return FX3U_PROGRAM_ERR_SEQUENCE;
+    }
+    if (g_stage.crc != g_stage.expected_crc) {
+        return stage_fail(FX3U_PROGRAM_ERR_MISMATCH);
+    }
+    
+    fx3u_program_result_t result = flush_page();
+    if (result != FX3U_PROGRAM_OK) return result;
+    
+    /* 整槽回读复核 */
+    const uint8_t *program = slot_program(g_stage.slot);
+    if (fx3u_program_crc32(0, program, g_stage.expected_bytes) != g_stage.expected_crc) {
+        return stage_fail(FX3U_PROGRAM_ERR_FLASH);
+    }
+    
+    /* 代数须高于另一槽，即使当前运行的是内置程序 */
+    uint32_t generation = g_stage.generation;
+    uint8_t other = g_stage.slot ^ 1;
+    if (slot_valid(other) && slot_header(other)->generation > generation) {
+        generation = slot_header(other)->generation;
+    }
+    
+    slot_header_t header;
+    header.magic = SLOT_MAGIC;
+    header.generation = generation + 1;
+    header.steps = g_stage.expected_bytes / FX3U_PROGRAM_STEP_SIZE;
+    header.crc = g_stage.expected_crc;
+    header.header_crc = fx3u_program_crc32(0, (const uint8_t *)&header,
+                                           offsetof(slot_header_t, header_crc));
+    
+    memset(g_page, 0xFF, sizeof(g_page));
+    memcpy(g_page, &header, sizeof(header));
+    store_program(slot_offset(g_stage.slot), g_page);
+    if (!slot_valid(g_stage.slot)) {
+        return stage_fail(FX3U_PROGRAM_ERR_FLASH);
+    }
+    
+    fx3u_core_request_program(plc, (const fx3u_instruction_t *)program, header.steps);
+    g_active_slot = g_stage.slot;
+    g_stage.generation = header.generation;
+    g_stage.state = FX3U_PROGRAM_COMMITTED;
+    g_stage.last_error = FX3U_PROGRAM_OK;
+    return FX3U_PROGRAM_OK;
+}
+
+/**
+ * 放弃下载 (目标槽保持无效，运行程序不受影响)
+ */
+void fx3u_program_stage_abort(void)
+{
+    g_stage.state = FX3U_PROGRAM_IDLE;
+    g_page_fill = 0;
+}
+
+/**
+ * 获取下载状态
+ */
+const fx3u_program_stage_t *fx3u_program_get_stage(void)
+{
+    return &g_stage;
+}
+
+/**
+ * 上传: 读取当前运行程序的镜像
+ */
+fx3u_program_result_t fx3u_program_read(const fx3u_core_t *plc, uint32_t offset,
+                                        uint8_t *data, uint16_t length)
+{
+    if (!plc || !data || !fx3u_core_has_program(plc)) {
+        return FX3U_PROGRAM_ERR_STATE;
+    }
+    if (offset + length > plc->program_size * FX3U_PROGRAM_STEP_SIZE) {
+        return FX3U_PROGRAM_ERR_RANGE;
+    }
+    
+    memcpy(data, (const uint8_t *)plc->program + offset, length);
+    return FX3U_PROGRAM_OK;
+}
@@ -1,15 +1,78 @@
 /**
- * 预置 PLC 程序与辅助初始化
+ * 预置 PLC 程序、Flash 程序存储与在线下载
+ *
+ * Flash 末尾划分 A/B 两个程序槽，每槽为 1 个头扇区 + 程序区。
+ * 下载总是写入当前未运行的槽: 开始后由主循环逐扇区擦除 (每次一个扇区，
+ * 先头扇区后程序区)，已擦除部分即可写入；数据按页写入并回读校验，
+ * 整体 CRC32 校验通过后才写槽头，随后在下一扫描开始时切换到新程序。
+ * 程序直接在 XIP Flash 中执行，不占用 RAM；上电时选择代数最新的有效槽。
  */
 
 #ifndef __FX3U_PROGRAM_H__
 #define __FX3U_PROGRAM_H__
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "fx3u_instructions.h"
 
+/* ===== 程序镜像 ===== */
+#define FX3U_PROGRAM_MAX_STEPS          16384
+#define FX3U_PROGRAM_STEP_SIZE          8       /* 操作码(1) 保留(1) 操作数1-3 (各 2 字节小端)，即 fx3u_instruction_t */
+#define FX3U_PROGRAM_MAX_BYTES          ((uint32_t)FX3U_PROGRAM_MAX_STEPS * FX3U_PROGRAM_STEP_SIZE)
+
+typedef enum {
+    FX3U_PROGRAM_OK = 0,
+    FX3U_PROGRAM_ERR_STATE,             /* 未开始下载 */
+    FX3U_PROGRAM_ERR_BUSY,              /* 上一次切换尚未生效 / 目标区域尚未擦除 */
+    FX3U_PROGRAM_ERR_RANGE,             /* 步数 / 偏移越界 */
+    FX3U_PROGRAM_ERR_SEQUENCE,          /* 数据不连续或未接收完整 */
+    FX3U_PROGRAM_ERR_MISMATCH,          /* 重发数据与已接收内容不符 / 整体 CRC 不符 */
+    FX3U_PROGRAM_ERR_FLASH              /* Flash 回读校验失败 */
+} fx3u_program_result_t;
+
+/* ===== 下载状态 ===== */
+typedef enum {
+    FX3U_PROGRAM_IDLE = 0,
+    FX3U_PROGRAM_RECEIVING = 1,
+    FX3U_PROGRAM_COMMITTED = 2,         /* 已写槽头并请求切换 */
+    FX3U_PROGRAM_FAILED = 3,
+    FX3U_PROGRAM_ERASING = 4            /* 后台擦除中，已擦除部分可写入 */
+} fx3u_program_stage_state_t;
+
+typedef struct {
+    uint8_t state;                      /* fx3u_program_stage_state_t */
+    uint8_t last_error;                 /* fx3u_program_result_t */
+    uint8_t slot;                       /* 下载目标槽 */
+    uint32_t expected_bytes;
+    uint32_t received_bytes;
+    uint32_t erased_bytes;              /* 程序区已擦除字节数 (扇区对齐) */
+    uint32_t expected_crc;
+    uint32_t crc;                       /* 已接收部分的滚动 CRC32 (与 zlib crc32 相同) */
+    uint32_t generation;                /* 运行中 Flash 程序的代数，0 为内置程序 */
+} fx3u_program_stage_t;
+
 void fx3u_program_get_default(const fx3u_instruction_t **program,
                               uint32_t *instruction_count);
 void fx3u_program_apply_defaults(fx3u_core_t *plc);
 
+/* 上电加载 Flash 中最新的有效程序，无有效程序返回 false */
+bool fx3u_program_load_stored(fx3u_core_t *plc);
+
+/* 在线下载 (主循环调用) */
+fx3u_program_result_t fx3u_program_stage_begin(const fx3u_core_t *plc, uint32_t steps,
+                                               uint32_t crc);
+fx3u_program_result_t fx3u_program_stage_write(uint32_t offset, const uint8_t *data,
+                                               uint16_t length);
+fx3u_program_result_t fx3u_program_stage_commit(fx3u_core_t *plc);
+void fx3u_program_stage_abort(void);
+/* 推进后台擦除，每次调用至多擦除一个扇区 (主循环任务) */
+void fx3u_program_poll(void);
+const fx3u_program_stage_t *fx3u_program_get_stage(void);
+
+/* 上传: 读取当前运行程序的镜像字节 */
+fx3u_program_result_t fx3u_program_read(const fx3u_core_t *plc, uint32_t offset,
+                                        uint8_t *data, uint16_t length);
+
+uint32_t fx3u_program_crc32(uint32_t crc, const uint8_t *data, uint32_t length);
+
 #endif /* __FX3U_PROGRAM_H__ */
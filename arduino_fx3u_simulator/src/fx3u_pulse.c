@@ -0,0 +1,868 @@
+/**
+ * 脉冲输出实现
+ *
+ * PIO 程序 (11 条，装入任意地址，跳转目标由 pio_add_program 重定位):
+ *
+ *      0       pull block          段脉冲数 - 1
+ *      1       mov y, osr
+ *      2       pull block          半周期循环次数 (留在 OSR)
+ *   pulse:
+ *      3       mov x, osr
+ *      4       set pins, 1
+ *      5       jmp x--, 5
+ *      6       mov x, osr
+ *      7       set pins, 0
+ *      8       jmp x--, 8
+ *      9       jmp y--, pulse
+ *     10       irq nowait 0 rel    段结束 (.wrap -> 0)
+ *
+ * 周期 = 2 * 半周期 + 7 个系统时钟，段间低电平多 4 个时钟；
+ * 状态机时钟不分频，200kHz 时半周期约 309，频率按实际 clk_sys 计算。
+ *
+ * 已完成的段数由 DMA 剩余计数、TX FIFO 深度和 PC 推算 (下限)，段结束中断只作通知，
+ * 中断被扫描推迟而合并也不会丢计数；停止时先让状态机停在低电平处，
+ * 再按 PC 与 Y 算出当前段已输出的脉冲，位置精确到脉冲。
+ */
+
+#include "fx3u_pulse.h"
+#include "fx3u_instructions.h"
+#include "fx3u_io.h"
+#include "logger.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include <string.h>
+
+#if PICO_ON_DEVICE
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
+#endif
+
+#define BLOCK_COUNT         2
+#define PROG_PULSE          3
+#define PROG_HIGH_FIRST     5           /* 5-7: 引脚为高 */
+#define PROG_HIGH_LAST      7
+#define PROG_LOW_LOOP       8
+#define PROG_END            10
+#define PROG_LENGTH         11
+#define PERIOD_OVERHEAD     7
+#define HALT_SPIN_US        20          /* 停止时等待高电平结束的上限 */
+#define DIRECTION_SETUP_US  5           /* 方向改变后到第一个脉冲 */
+
+enum { REQ_NONE = 0, REQ_IMMEDIATE, REQ_DECEL, REQ_CREEP, REQ_HOME };
+enum { ZRN_NONE = 0, ZRN_FAST, ZRN_CREEP };
+
+typedef struct {
+    uint32_t count;                     /* 脉冲数 - 1 (0xFFFFFFFF 即 2^32，视为无限) */
+    uint32_t delay;                     /* 半周期循环次数 */
+} pulse_segment_t;
+
+typedef struct {
+    uint32_t hz;
+    uint32_t pulses;
+} ramp_step_t;
+
+typedef struct {
+    pulse_segment_t table[FX3U_PULSE_SEGMENTS];     /* DMA 源 */
+    uint32_t hz[FX3U_PULSE_SEGMENTS];
+    uint16_t segments;
+    bool unlimited;                     /* 最后一段无限 */
+
+    volatile uint8_t state;
+    uint32_t move;
+    int8_t dir;
+    int32_t origin;                     /* 运动起点 */
+    uint32_t emitted;                   /* 之前各张段表已输出的脉冲 */
+    uint16_t done_segments;
+    bool stopping;                      /* 减速停止中，结束时为 STOPPED */
+    uint8_t request;
+    uint8_t zrn;
+    uint16_t dog;
+
+    bool claimed;
+#if PICO_ON_DEVICE
+    uint8_t block;
+    uint8_t sm;
+    int dma;
+#else
+    uint16_t sim_segment;
+    uint32_t sim_in_segment;
+#endif
+} pulse_channel_t;
+
+static fx3u_core_t *g_plc = NULL;
+static pulse_channel_t g_channels[FX3U_PULSE_CHANNELS];
+static fx3u_pulse_stats_t g_stats;
+static uint32_t g_move_seq = 0;
+
+static void update(uint8_t index, pulse_channel_t *ch);
+
+static inline uint16_t device_of(uint16_t base, uint8_t index)
+{
+    return (uint16_t)(base + index * FX3U_PULSE_DEVICE_STEP);
+}
+
+/* ===== 硬件 ===== */
+
+#if PICO_ON_DEVICE
+static const uint8_t g_pins[FX3U_PULSE_CHANNELS] = {
+    PICO_OUTPUT_Y0_GPIO, PICO_OUTPUT_Y1_GPIO, PICO_OUTPUT_Y2_GPIO
+};
+static int g_offsets[BLOCK_COUNT] = {-1, -1};
+
+static void pulse_irq(void);
+
+static inline PIO block_pio(uint8_t block)
+{
+    return block ? pio1 : pio0;
+}
+
+static inline uint32_t sys_hz(void)
+{
+    return clock_get_hz(clk_sys);
+}
+
+/**
+ * 装入程序 (高速计数器的程序占满地址 0 起 31 条，不能共用一个块)
+ */
+static bool hw_load_block(uint8_t block)
+{
+    if (g_offsets[block] >= 0) return true;
+
+    uint16_t code[PROG_LENGTH];
+    code[0] = pio_encode_pull(false, true);
+    code[1] = pio_encode_mov(pio_y, pio_osr);
+    code[2] = pio_encode_pull(false, true);
+    code[3] = pio_encode_mov(pio_x, pio_osr);
+    code[4] = pio_encode_set(pio_pins, 1);
+    code[5] = pio_encode_jmp_x_dec(5);
+    code[6] = pio_encode_mov(pio_x, pio_osr);
+    code[7] = pio_encode_set(pio_pins, 0);
+    code[8] = pio_encode_jmp_x_dec(8);
+    code[9] = pio_encode_jmp_y_dec(PROG_PULSE);
+    code[10] = pio_encode_irq_set(true, 0);
+
+    const pio_program_t program = {
+        .instructions = code,
+        .length = PROG_LENGTH,
+        .origin = -1,
+    };
+    PIO pio = block_pio(block);
+    if (!pio_can_add_program(pio, &program)) return false;
+    g_offsets[block] = (int)pio_add_program(pio, &program);
+
+    uint irq_num = block ? PIO1_IRQ_1 : PIO0_IRQ_1;
+    irq_add_shared_handler(irq_num, pulse_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(irq_num, true);
+    return true;
+}
+
+/**
+ * 分配状态机与 DMA: 先试 PIO1 (高速计数器从 PIO0 开始装入)
+ */
+static bool hw_claim(pulse_channel_t *ch, uint8_t index)
+{
+    for (int b = BLOCK_COUNT - 1; b >= 0; b--) {
+        if (!hw_load_block((uint8_t)b)) continue;
+
+        PIO pio = block_pio((uint8_t)b);
+        int sm = pio_claim_unused_sm(pio, false);
+        if (sm < 0) continue;
+
+        ch->dma = dma_claim_unused_channel(false);
+        if (ch->dma < 0) {
+            pio_sm_unclaim(pio, (uint)sm);
+            return false;
+        }
+        ch->block = (uint8_t)b;
+        ch->sm = (uint8_t)sm;
+
+        uint offset = (uint)g_offsets[b];
+        pio_sm_config cfg = pio_get_default_sm_config();
+        sm_config_set_wrap(&cfg, offset, offset + PROG_END);
+        sm_config_set_set_pins(&cfg, g_pins[index], 1);
+        sm_config_set_out_shift(&cfg, true, false, 32);
+        sm_config_set_in_shift(&cfg, false, false, 32);
+        sm_config_set_clkdiv(&cfg, 1.0f);
+        pio_sm_init(pio, ch->sm, offset, &cfg);
+        return true;
+    }
+    return false;
+}
+
+static void hw_start(pulse_channel_t *ch, uint8_t index)
+{
+    PIO pio = block_pio(ch->block);
+    uint offset = (uint)g_offsets[ch->block];
+    uint pin = g_pins[index];
+
+    pio_sm_set_enabled(pio, ch->sm, false);
+    pio_sm_clear_fifos(pio, ch->sm);
+    pio_sm_restart(pio, ch->sm);
+    pio_sm_exec(pio, ch->sm, pio_encode_jmp(offset));
+    pio_sm_set_pins_with_mask(pio, ch->sm, 0, 1u << pin);
+    pio_sm_set_consecutive_pindirs(pio, ch->sm, pin, 1, true);
+    pio_gpio_init(pio, pin);
+
+    pio_interrupt_clear(pio, ch->sm);
+    pio_set_irq1_source_enabled(pio, (enum pio_interrupt_source)(pis_interrupt0 + ch->sm), true);
+
+    dma_channel_config dc = dma_channel_get_default_config(ch->dma);
+    channel_config_set_transfer_data_size(&dc, DMA_SIZE_32);
+    channel_config_set_read_increment(&dc, true);
+    channel_config_set_write_increment(&dc, false);
+    channel_config_set_dreq(&dc, pio_get_dreq(pio, ch->sm, true));
+    dma_channel_configure(ch->dma, &dc, &pio->txf[ch->sm], ch->table, ch->segments * 2u, true);
+
+    pio_sm_set_enabled(pio, ch->sm, true);
+}
+
+/**
+ * 停止输出，引脚交还 SIO (输出刷新恢复控制该 Y)
+ */
+static void hw_release(pulse_channel_t *ch, uint8_t index)
+{
+    PIO pio = block_pio(ch->block);
+    pio_sm_set_enabled(pio, ch->sm, false);
+    pio_set_irq1_source_enabled(pio, (enum pio_interrupt_source)(pis_interrupt0 + ch->sm), false);
+    dma_channel_abort(ch->dma);
+    pio_sm_clear_fifos(pio, ch->sm);
+    gpio_set_function(g_pins[index], GPIO_FUNC_SIO);
+}
+
+/* 状态机已取走的字数 (先读 DMA 再读 FIFO，结果只会偏小) */
+static uint32_t hw_pulled(const pulse_channel_t *ch)
+{
+    PIO pio = block_pio(ch->block);
+    uint32_t moved = ch->segments * 2u - dma_channel_hw_addr(ch->dma)->transfer_count;
+    return moved - pio_sm_get_tx_fifo_level(pio, ch->sm);
+}
+
+static inline uint8_t hw_pc(const pulse_channel_t *ch)
+{
+    return (uint8_t)(pio_sm_get_pc(block_pio(ch->block), ch->sm) - g_offsets[ch->block]);
+}
+
+/**
+ * 已完成的段数 (下限)；全部段输出完毕时 finished = true
+ */
+static uint16_t hw_progress(const pulse_channel_t *ch, bool *finished)
+{
+    uint32_t pulled = hw_pulled(ch);
+    uint8_t pc = hw_pc(ch);         /* 后读 PC: 取完最后一段后回到 0 才算结束 */
+
+    *finished = pulled == ch->segments * 2u && pc == 0;
+    if (pulled & 1u) return (uint16_t)(pulled / 2);
+    if (!pulled) return 0;
+    return (uint16_t)((pc == 0 || pc == PROG_END) ? pulled / 2 : pulled / 2 - 1);
+}
+
+/**
+ * 在低电平处停住状态机，给出当前段号与该段已输出的脉冲数
+ * 返回 false: 正处于一个长脉冲的高电平，由轮询重试
+ */
+static bool hw_halt(pulse_channel_t *ch, uint16_t *segment, uint32_t *emitted)
+{
+    PIO pio = block_pio(ch->block);
+    uint32_t start = time_us_32();
+    uint8_t pc = hw_pc(ch);
+    while (pc >= PROG_HIGH_FIRST && pc <= PROG_HIGH_LAST && time_us_32() - start < HALT_SPIN_US) {
+        pc = hw_pc(ch);
+    }
+
+    pio_sm_set_enabled(pio, ch->sm, false);
+    pc = hw_pc(ch);
+    if (pc >= PROG_HIGH_FIRST && pc <= PROG_HIGH_LAST) {
+        pio_sm_set_enabled(pio, ch->sm, true);
+        return false;
+    }
+    dma_channel_abort(ch->dma);
+
+    uint32_t pulled = hw_pulled(ch);
+    pio_sm_exec(pio, ch->sm, pio_encode_mov(pio_isr, pio_y));
+    pio_sm_exec(pio, ch->sm, pio_encode_push(false, false));
+    uint32_t y = pio_sm_get(pio, ch->sm);
+
+    *segment = (uint16_t)(pulled / 2);
+    *emitted = 0;
+    if (pulled && !(pulled & 1u)) {
+        uint16_t current = (uint16_t)(pulled / 2 - 1);
+        uint32_t count = ch->table[current].count;
+        if (pc == PROG_PULSE || pc == PROG_PULSE + 1) {
+            *segment = current;
+            *emitted = count - y;
+        } else if (pc == PROG_LOW_LOOP || pc == PROG_LOW_LOOP + 1) {
+            *segment = current;
+            *emitted = count - y + 1;
+        }
+        /* PC 为 0 / 10: 当前段已输出完毕 */
+    }
+    return true;
+}
+
+/* 方向输出立即写 GPIO，不等扫描结束的输出刷新 */
+static void set_direction_pin(uint8_t y, bool forward)
+{
+    io_write_output_relay(y, forward ? 1 : 0);
+    busy_wait_us(DIRECTION_SETUP_US);
+}
+
+/**
+ * PIO 中断: 段结束
+ */
+static void pulse_irq(void)
+{
+    for (uint8_t i = 0; i < FX3U_PULSE_CHANNELS; i++) {
+        pulse_channel_t *ch = &g_channels[i];
+        if (!ch->claimed) continue;
+
+        PIO pio = block_pio(ch->block);
+        if (!pio_interrupt_get(pio, ch->sm)) continue;
+        pio_interrupt_clear(pio, ch->sm);
+        update(i, ch);
+    }
+}
+#else
+/* 主机构建: fx3u_pulse_sim_run() 按段表推进 */
+static inline uint32_t sys_hz(void)
+{
+    return 125000000u;
+}
+
+static bool hw_claim(pulse_channel_t *ch, uint8_t index)
+{
+    (void)ch;
+    (void)index;
+    return true;
+}
+
+static void hw_start(pulse_channel_t *ch, uint8_t index)
+{
+    (void)index;
+    ch->sim_segment = 0;
+    ch->sim_in_segment = 0;
+}
+
+static void hw_release(pulse_channel_t *ch, uint8_t index)
+{
+    (void)ch;
+    (void)index;
+}
+
+static uint16_t hw_progress(const pulse_channel_t *ch, bool *finished)
+{
+    *finished = ch->sim_segment == ch->segments;
+    return ch->sim_segment;
+}
+
+static bool hw_halt(pulse_channel_t *ch, uint16_t *segment, uint32_t *emitted)
+{
+    *segment = ch->sim_segment;
+    *emitted = ch->sim_in_segment;
+    return true;
+}
+
+static void set_direction_pin(uint8_t y, bool forward)
+{
+    (void)y;
+    (void)forward;
+}
+#endif
+
+/* ===== 段表规划 ===== */
+
+static void plan_add(pulse_channel_t *ch, uint32_t hz, uint32_t pulses)
+{
+    if (ch->segments >= FX3U_PULSE_SEGMENTS || !hz) return;
+
+    uint32_t cycles = (sys_hz() + hz / 2) / hz;
+    pulse_segment_t *seg = &ch->table[ch->segments];
+    seg->count = pulses - 1u;
+    seg->delay = cycles > PERIOD_OVERHEAD + 2 ? (cycles - PERIOD_OVERHEAD) / 2 : 1;
+    ch->hz[ch->segments] = hz;
+    ch->segments++;
+}
+
+/**
+ * 线性斜坡: 在 ms 内从 f0 变到 f1，每段取中点频率
+ */
+static uint8_t plan_ramp(ramp_step_t *steps, uint32_t f0, uint32_t f1, uint16_t ms)
+{
+    if (!ms || f0 == f1) return 0;
+
+    for (uint8_t k = 0; k < FX3U_PULSE_RAMP_STEPS; k++) {
+        int64_t hz = (int64_t)f0 + ((int64_t)f1 - f0) * (2 * k + 1) / (2 * FX3U_PULSE_RAMP_STEPS);
+        if (hz < 1) hz = 1;
+        uint32_t pulses = (uint32_t)(((uint64_t)hz * ms + FX3U_PULSE_RAMP_STEPS * 500u) /
+                                     (FX3U_PULSE_RAMP_STEPS * 1000u));
+        steps[k].hz = (uint32_t)hz;
+        steps[k].pulses = pulses ? pulses : 1;
+    }
+    return FX3U_PULSE_RAMP_STEPS;
+}
+
+/**
+ * 梯形运动: from 加速到 cruise，减速到 to；total = 0 为无限 (无减速)
+ * 距离不足时从最高的斜坡段开始截去，剩余脉冲以截去段的频率输出
+ */
+static void plan_move(pulse_channel_t *ch, uint32_t total, uint32_t from, uint32_t cruise,
+                      uint32_t to, uint16_t accel_ms, uint16_t decel_ms)
+{
+    ramp_step_t up[FX3U_PULSE_RAMP_STEPS];
+    ramp_step_t down[FX3U_PULSE_RAMP_STEPS];
+    uint8_t a = plan_ramp(up, from, cruise, accel_ms);
+    uint8_t d = total ? plan_ramp(down, cruise, to, decel_ms) : 0;
+    uint8_t d0 = 0;
+    uint32_t sum_a = 0, sum_d = 0;
+    for (uint8_t i = 0; i < a; i++) sum_a += up[i].pulses;
+    for (uint8_t i = 0; i < d; i++) sum_d += down[i].pulses;
+
+    uint32_t top = cruise;
+    while (total && sum_a + sum_d > total) {
+        if (a && (d0 == d || up[a - 1].hz >= down[d0].hz)) {
+            a--;
+            top = up[a].hz;
+            sum_a -= up[a].pulses;
+        } else {
+            top = down[d0].hz;
+            sum_d -= down[d0].pulses;
+            d0++;
+        }
+    }
+
+    ch->segments = 0;
+    ch->unlimited = !total;
+    for (uint8_t i = 0; i < a; i++) {
+        plan_add(ch, up[i].hz, up[i].pulses);
+    }
+    if (!total) {
+        plan_add(ch, top, 0);
+        return;
+    }
+
+    /* 巡航按约 FX3U_PULSE_CRUISE_MS 分段，段表不够时加大每段 */
+    uint32_t cruise_pulses = total - sum_a - sum_d;
+    uint32_t slots = FX3U_PULSE_SEGMENTS - ch->segments - (uint32_t)(d - d0);
+    uint32_t chunk = (uint32_t)((uint64_t)top * FX3U_PULSE_CRUISE_MS / 1000u);
+    if (!chunk) chunk = 1;
+    if (cruise_pulses / chunk >= slots) {
+        chunk = cruise_pulses / slots + 1;
+    }
+    while (cruise_pulses) {
+        uint32_t n = cruise_pulses < chunk ? cruise_pulses : chunk;
+        plan_add(ch, top, n);
+        cruise_pulses -= n;
+    }
+
+    for (uint8_t i = d0; i < d; i++) {
+        plan_add(ch, down[i].hz, down[i].pulses);
+    }
+}
+
+/* ===== 位置与状态 ===== */
+
+static uint32_t pulses_before(const pulse_channel_t *ch, uint16_t segment)
+{
+    uint32_t sum = 0;
+    for (uint16_t i = 0; i < segment && i < ch->segments; i++) {
+        sum += ch->table[i].count + 1u;
+    }
+    return sum;
+}
+
+static int32_t read_position(uint8_t index)
+{
+    uint16_t addr = device_of(D8340, index);
+    uint16_t low = (uint16_t)fx3u_get_special_register(g_plc, addr);
+    uint16_t high = (uint16_t)fx3u_get_special_register(g_plc, (uint16_t)(addr + 1));
+    return (int32_t)(((uint32_t)high << 16) | low);
+}
+
+static void write_position(uint8_t index, int32_t value)
+{
+    uint16_t addr = device_of(D8340, index);
+    fx3u_set_special_register(g_plc, addr, (int16_t)(value & 0xFFFF));
+    fx3u_set_special_register(g_plc, (uint16_t)(addr + 1), (int16_t)((uint32_t)value >> 16));
+}
+
+static int32_t position_of(const pulse_channel_t *ch, uint32_t pulses)
+{
+    return (int32_t)((uint32_t)ch->origin + (ch->dir < 0 ? 0u - pulses : pulses));
+}
+
+static uint32_t read_dword_hz(uint16_t addr)
+{
+    uint16_t low = (uint16_t)fx3u_get_special_register(g_plc, addr);
+    uint16_t high = (uint16_t)fx3u_get_special_register(g_plc, (uint16_t)(addr + 1));
+    return ((uint32_t)high << 16) | low;
+}
+
+static void finish(uint8_t index, pulse_channel_t *ch, fx3u_pulse_state_t state)
+{
+    hw_release(ch, index);
+    write_position(index, position_of(ch, ch->emitted));
+    g_stats.pulses += ch->emitted;
+    if (state == FX3U_PULSE_STOPPED) {
+        g_stats.stops++;
+    }
+    ch->state = state;
+    ch->request = REQ_NONE;
+    ch->zrn = ZRN_NONE;
+    ch->stopping = false;
+    fx3u_set_special_relay(g_plc, device_of(M8340, index), 0);
+}
+
+/**
+ * 段表输出完毕: 无限段重新装入，否则运动结束
+ */
+static void complete(uint8_t index, pulse_channel_t *ch)
+{
+    ch->emitted += pulses_before(ch, ch->segments);
+    if (ch->unlimited) {
+        uint16_t last = (uint16_t)(ch->segments - 1);
+        ch->table[0] = ch->table[last];
+        ch->hz[0] = ch->hz[last];
+        ch->segments = 1;
+        ch->done_segments = 0;
+        hw_start(ch, index);
+        return;
+    }
+    finish(index, ch, ch->stopping ? FX3U_PULSE_STOPPED : FX3U_PULSE_DONE);
+}
+
+/**
+ * 更新当前位置 (段结束中断与主循环，调用者已与扫描互斥)
+ */
+static void update(uint8_t index, pulse_channel_t *ch)
+{
+    if (ch->state != FX3U_PULSE_RUNNING) return;
+
+    bool finished;
+    uint16_t done = hw_progress(ch, &finished);
+    if (finished) {
+        complete(index, ch);
+        return;
+    }
+    ch->done_segments = done;
+    write_position(index, position_of(ch, ch->emitted + pulses_before(ch, done)));
+}
+
+/**
+ * 处理停止请求与 ZRN 的 DOG 信号: 停住状态机后按当前频率重新规划
+ */
+static void service(uint8_t index, pulse_channel_t *ch)
+{
+    update(index, ch);
+    if (ch->state != FX3U_PULSE_RUNNING) return;
+
+    uint8_t request = ch->request;
+    if (!request && ch->zrn) {
+        bool dog = fx3u_get_bit(g_plc, ch->dog) != 0;
+        if (ch->zrn == ZRN_FAST && dog) request = REQ_CREEP;
+        if (ch->zrn == ZRN_CREEP && !dog) request = REQ_HOME;
+    }
+    if (!request) return;
+
+    uint16_t segment;
+    uint32_t in_segment;
+    if (!hw_halt(ch, &segment, &in_segment)) {
+        g_stats.halt_retries++;
+        return;
+    }
+    uint32_t hz = ch->hz[segment < ch->segments ? segment : ch->segments - 1];
+    ch->emitted += pulses_before(ch, segment) + in_segment;
+    ch->done_segments = 0;
+
+    uint32_t bias = (uint16_t)fx3u_get_special_register(g_plc, device_of(D8342, index));
+    uint16_t decel_ms = (uint16_t)fx3u_get_special_register(g_plc, device_of(D8349, index));
+
+    switch (request) {
+        case REQ_DECEL: {
+            ramp_step_t down[FX3U_PULSE_RAMP_STEPS];
+            uint8_t d = hz > bias ? plan_ramp(down, hz, bias, decel_ms) : 0;
+            if (!d) break;
+            ch->segments = 0;
+            ch->unlimited = false;
+            for (uint8_t i = 0; i < d; i++) {
+                plan_add(ch, down[i].hz, down[i].pulses);
+            }
+            ch->request = REQ_NONE;
+            ch->stopping = true;
+            ch->zrn = ZRN_NONE;
+            hw_start(ch, index);
+            return;
+        }
+        case REQ_CREEP: {
+            uint32_t creep = (uint16_t)fx3u_get_special_register(g_plc, device_of(D8345, index));
+            if (!creep) creep = 1;
+            ramp_step_t down[FX3U_PULSE_RAMP_STEPS];
+            uint8_t d = hz > creep ? plan_ramp(down, hz, creep, decel_ms) : 0;
+            ch->segments = 0;
+            ch->unlimited = true;
+            for (uint8_t i = 0; i < d; i++) {
+                plan_add(ch, down[i].hz, down[i].pulses);
+            }
+            plan_add(ch, creep, 0);
+            ch->zrn = ZRN_CREEP;
+            hw_start(ch, index);
+            return;
+        }
+        case REQ_HOME:
+            finish(index, ch, FX3U_PULSE_DONE);
+            write_position(index, 0);
+            return;
+        default:
+            break;
+    }
+    finish(index, ch, FX3U_PULSE_STOPPED);
+}
+
+/* ===== 启动 ===== */
+
+static uint32_t fail(void)
+{
+    if (g_plc) {
+        fx3u_set_special_relay(g_plc, M8329, 1);
+    }
+    return 0;
+}
+
+/**
+ * 检查通道并取得限幅后的频率 (0 = 不能启动)
+ */
+static pulse_channel_t *prepare(uint8_t index, uint32_t *hz)
+{
+    if (!g_plc || index >= FX3U_PULSE_CHANNELS) return NULL;
+
+    pulse_channel_t *ch = &g_channels[index];
+    if (ch->state == FX3U_PULSE_RUNNING) return NULL;
+
+    uint32_t max = read_dword_hz(device_of(D8343, index));
+    if (!max || max > FX3U_PULSE_MAX_HZ) max = FX3U_PULSE_MAX_HZ;
+    if (*hz > max) *hz = max;
+    if (!*hz) return NULL;
+
+    if (!ch->claimed) {
+        if (!hw_claim(ch, index)) {
+            g_stats.allocation_failures++;
+            LOG_WARN("[PULSE] Y%d: no free PIO block\r\n", index);
+            return NULL;
+        }
+        ch->claimed = true;
+    }
+    return ch;
+}
+
+static uint32_t next_move(void)
+{
+    if (++g_move_seq == 0) g_move_seq = 1;
+    return g_move_seq;
+}
+
+static uint32_t launch(uint8_t index, pulse_channel_t *ch, int8_t dir, bool direction_output)
+{
+    if (direction_output) {
+        uint8_t y = (uint8_t)(FX3U_PULSE_DIR_BASE + index);
+        fx3u_set_output(g_plc, y, dir > 0);
+        set_direction_pin(y, dir > 0);
+    }
+
+    ch->dir = dir;
+    ch->origin = read_position(index);
+    ch->emitted = 0;
+    ch->done_segments = 0;
+    ch->stopping = false;
+    ch->request = REQ_NONE;
+    ch->move = next_move();
+    ch->state = FX3U_PULSE_RUNNING;
+    fx3u_set_special_relay(g_plc, device_of(M8340, index), 1);
+    g_stats.moves++;
+    hw_start(ch, index);
+    return ch->move;
+}
+
+/**
+ * 初始化 (PLC 核心初始化之后调用)，写入 D8342-D8349 默认值
+ */
+void fx3u_pulse_init(fx3u_core_t *plc)
+{
+    g_plc = plc;
+    memset(g_channels, 0, sizeof(g_channels));
+    memset(&g_stats, 0, sizeof(g_stats));
+    if (!plc) return;
+
+    for (uint8_t i = 0; i < FX3U_PULSE_CHANNELS; i++) {
+        fx3u_set_special_register(plc, device_of(D8342, i), 0);
+        fx3u_set_special_register(plc, device_of(D8343, i), (int16_t)(FX3U_PULSE_MAX_HZ & 0xFFFF));
+        fx3u_set_special_register(plc, device_of(D8343 + 1, i), (int16_t)(FX3U_PULSE_MAX_HZ >> 16));
+        fx3u_set_special_register(plc, device_of(D8345, i), 1000);
+        fx3u_set_special_register(plc, device_of(D8348, i), 100);
+        fx3u_set_special_register(plc, device_of(D8349, i), 100);
+    }
+}
+
+uint32_t fx3u_pulse_plsy(uint8_t channel, uint32_t hz, uint32_t pulses)
+{
+    uint32_t ints = save_and_disable_interrupts();
+    pulse_channel_t *ch = prepare(channel, &hz);
+    uint32_t move = 0;
+    if (ch) {
+        plan_move(ch, pulses, hz, hz, hz, 0, 0);
+        move = launch(channel, ch, 1, false);
+    }
+    restore_interrupts(ints);
+    return move ? move : fail();
+}
+
+uint32_t fx3u_pulse_plsr(uint8_t channel, uint32_t hz, uint32_t pulses)
+{
+    uint32_t ints = save_and_disable_interrupts();
+    pulse_channel_t *ch = prepare(channel, &hz);
+    uint32_t move = 0;
+    if (ch && pulses) {
+        uint16_t ramp_ms = (uint16_t)fx3u_get_special_register(g_plc, device_of(D8348, channel));
+        plan_move(ch, pulses, 1, hz, 1, ramp_ms, ramp_ms);
+        move = launch(channel, ch, 1, false);
+    }
+    restore_interrupts(ints);
+    return move ? move : fail();
+}
+
+uint32_t fx3u_pulse_drvi(uint8_t channel, int32_t distance, uint32_t hz)
+{
+    uint32_t ints = save_and_disable_interrupts();
+    pulse_channel_t *ch = prepare(channel, &hz);
+    uint32_t move = 0;
+    if (ch && !distance) {
+        /* 已在目标位置: 直接结束 */
+        ch->move = move = next_move();
+        ch->state = FX3U_PULSE_DONE;
+    } else if (ch) {
+        uint32_t bias = (uint16_t)fx3u_get_special_register(g_plc, device_of(D8342, channel));
+        if (bias > hz) bias = hz;
+        uint16_t accel_ms = (uint16_t)fx3u_get_special_register(g_plc, device_of(D8348, channel));
+        uint16_t decel_ms = (uint16_t)fx3u_get_special_register(g_plc, device_of(D8349, channel));
+        uint32_t pulses = distance < 0 ? 0u - (uint32_t)distance : (uint32_t)distance;
+        plan_move(ch, pulses, bias ? bias : 1, hz, bias ? bias : 1, accel_ms, decel_ms);
+        move = launch(channel, ch, distance < 0 ? -1 : 1, true);
+    }
+    restore_interrupts(ints);
+    return move ? move : fail();
+}
+
+uint32_t fx3u_pulse_drva(uint8_t channel, int32_t position, uint32_t hz)
+{
+    if (!g_plc || channel >= FX3U_PULSE_CHANNELS) return fail();
+    return fx3u_pulse_drvi(channel, (int32_t)((uint32_t)position - (uint32_t)read_position(channel)), hz);
+}
+
+uint32_t fx3u_pulse_zrn(uint8_t channel, uint32_t hz, uint16_t dog)
+{
+    uint32_t ints = save_and_disable_interrupts();
+    pulse_channel_t *ch = prepare(channel, &hz);
+    uint32_t move = 0;
+    if (ch) {
+        uint32_t bias = (uint16_t)fx3u_get_special_register(g_plc, device_of(D8342, channel));
+        if (bias > hz) bias = hz;
+        uint16_t accel_ms = (uint16_t)fx3u_get_special_register(g_plc, device_of(D8348, channel));
+        plan_move(ch, 0, bias ? bias : 1, hz, 0, accel_ms, 0);
+        bool forward = fx3u_get_special_relay(g_plc, device_of(M8342, channel)) != 0;
+        move = launch(channel, ch, forward ? 1 : -1, true);
+        ch->zrn = ZRN_FAST;
+        ch->dog = dog;
+        service(channel, ch);       /* 启动时 DOG 已为 ON: 直接减速到爬行速度 */
+    }
+    restore_interrupts(ints);
+    return move ? move : fail();
+}
+
+void fx3u_pulse_stop(uint8_t channel, uint32_t move, bool decelerate)
+{
+    if (channel >= FX3U_PULSE_CHANNELS) return;
+
+    pulse_channel_t *ch = &g_channels[channel];
+    uint32_t ints = save_and_disable_interrupts();
+    if (ch->state == FX3U_PULSE_RUNNING && (!move || move == ch->move) && !ch->stopping) {
+        ch->request = decelerate ? REQ_DECEL : REQ_IMMEDIATE;
+        service(channel, ch);
+    }
+    restore_interrupts(ints);
+}
+
+fx3u_pulse_state_t fx3u_pulse_state(uint8_t channel, uint32_t move)
+{
+    if (channel >= FX3U_PULSE_CHANNELS) return FX3U_PULSE_IDLE;
+
+    const pulse_channel_t *ch = &g_channels[channel];
+    if (move && move != ch->move) return FX3U_PULSE_STOPPED;
+    return (fx3u_pulse_state_t)ch->state;
+}
+
+int32_t fx3u_pulse_position(uint8_t channel)
+{
+    if (!g_plc || channel >= FX3U_PULSE_CHANNELS) return 0;
+    return read_position(channel);
+}
+
+uint32_t fx3u_pulse_frequency(uint8_t channel)
+{
+    if (channel >= FX3U_PULSE_CHANNELS) return 0;
+
+    const pulse_channel_t *ch = &g_channels[channel];
+    if (ch->state != FX3U_PULSE_RUNNING || !ch->segments) return 0;
+    uint16_t segment = ch->done_segments < ch->segments ? ch->done_segments : ch->segments - 1;
+    return ch->hz[segment];
+}
+
+/**
+ * 主循环轮询
+ */
+void fx3u_pulse_poll(void)
+{
+    if (!g_plc) return;
+
+    for (uint8_t i = 0; i < FX3U_PULSE_CHANNELS; i++) {
+        pulse_channel_t *ch = &g_channels[i];
+        if (ch->state != FX3U_PULSE_RUNNING) continue;
+
+        uint32_t ints = save_and_disable_interrupts();
+        if (g_plc->state != PLC_RUN || fx3u_get_special_relay(g_plc, device_of(M8349, i))) {
+            ch->request = REQ_IMMEDIATE;
+        }
+        service(i, ch);
+        restore_interrupts(ints);
+    }
+}
+
+void fx3u_pulse_get_stats(fx3u_pulse_stats_t *stats)
+{
+    if (!stats) return;
+    *stats = g_stats;
+}
+
+/* ===== 模拟输出 ===== */
+
+#if !PICO_ON_DEVICE
+uint32_t fx3u_pulse_sim_run(uint8_t channel, uint32_t pulses)
+{
+    if (channel >= FX3U_PULSE_CHANNELS) return 0;
+
+    pulse_channel_t *ch = &g_channels[channel];
+    uint32_t emitted = 0;
+    while (pulses && ch->state == FX3U_PULSE_RUNNING && ch->sim_segment < ch->segments) {
+        uint32_t left = ch->table[ch->sim_segment].count - ch->sim_in_segment + 1u;
+        uint32_t take = (left && left < pulses) ? left : pulses;
+        ch->sim_in_segment += take;
+        emitted += take;
+        pulses -= take;
+        if (take == left) {
+            ch->sim_segment++;
+            ch->sim_in_segment = 0;
+            update(channel, ch);    /* 即段结束中断 */
+        }
+    }
+    return emitted;
+}
+#endif
@@ -0,0 +1,652 @@
+/**
+ * PLC 运行时实现
+ *
+ * 扫描入口只有 scan()，常规节拍、快速输入沿都经过它:
+ * 以关中断的测试置位占用扫描，占用失败的请求记为待补做，由当前扫描结束前再执行一次。
+ * 定时器策略下扫描与沿中断同优先级，不会发生占用失败；
+ * 主循环策略下扫描在线程上下文执行，沿中断可能在扫描中到达，由补做保证不丢。
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/time.h"
+#include "hardware/sync.h"
+#include "fx3u_runtime.h"
+#include "fx3u_image.h"
+#include "fx3u_instructions.h"
+#include "fx3u_io.h"
+#include "fx3u_analog.h"
+#include "fx3u_hsc.h"
+#include "fx3u_pulse.h"
+#include "fx3u_expansion.h"
+#include "communication.h"
+#include "modbus_protocol.h"
+#include "rs485_driver.h"
+#include "timer.h"
+#include "fx3u_program.h"
+#include "ethernet_adapter.h"
+#include "modbus_tcp.h"
+#include "modbus_gateway.h"
+#include "mitsubishi_link.h"
+#include "logger.h"
+#include "usb_monitor.h"
+#include "fx3u_tasks.h"
+#include "fx3u_watchdog.h"
+
+/* PLC 与外设对象 */
+static fx3u_core_t g_plc;
+static comm_config_t g_comm_config;
+static modbus_config_t g_modbus_config;
+static usb_monitor_t g_monitor;
+static rs485_config_t g_rs485_config;
+static io_manager_t g_io_mgr;
+
+#if !PICO_MODBUS_GATEWAY_ENABLED
+/* RS485 从站 (MODBUS RTU / 三菱计算机链接) 与通信缓冲区 */
+static mitsubishi_link_t g_link;
+static uint8_t rx_buffer[MITSUBISHI_LINK_MAX_FRAME];
+static uint8_t tx_buffer[MITSUBISHI_LINK_MAX_FRAME];
+static rs485_frame_t g_rx_frame;
+#endif
+
+#if PICO_ETHERNET_ENABLED
+static ethernet_config_t g_eth_config = {
+    .ip = {192, 168, 1, 250},
+    .netmask = {255, 255, 255, 0},
+    .gateway = {192, 168, 1, 1},
+    .mac = {0x02, 0x46, 0x58, 0x33, 0x55, 0x01},
+    .port = MODBUS_TCP_PORT
+};
+static modbus_tcp_server_t g_modbus_tcp;
+#endif
+
+#if PICO_EXPANSION_ENABLED
+static const fx3u_expansion_config_t g_expansion_config = {
+    .input_modules = 4,
+    .output_modules = 4,
+    .continuous = false,
+    .bit_rate_hz = FX3U_EXPANSION_BIT_RATE_HZ
+};
+#endif
+
+#if PICO_MODBUS_GATEWAY_ENABLED
+static modbus_master_t g_rtu_master;
+static modbus_gateway_t g_gateway;
+static const modbus_master_transport_t g_rs485_transport = {
+    .send = rs485_send,
+    .receive = rs485_receive
+};
+#endif
+
+/* 调度 */
+static const fx3u_runtime_scheduler_t *g_scheduler = &fx3u_runtime_timer_scheduler;
+static uint32_t g_period_us = FX3U_RUNTIME_SCAN_PERIOD_US;
+static uint64_t g_last_tick_us = 0;
+static volatile bool g_in_scan = false;
+static volatile bool g_rescan = false;
+static bool g_started = false;
+static fx3u_runtime_stats_t g_stats;
+static int g_task_outputs = -1;
+static int g_task_timers = -1;
+
+/* 看门狗跳闸时的输出 */
+static uint32_t g_safe_outputs = 0;
+static bool g_hold_outputs = false;
+
+/* ===== 调度策略 ===== */
+
+static timer_config_t g_cycle_timer_cfg = {
+    .period_us = FX3U_RUNTIME_SCAN_PERIOD_US,
+    .callback = NULL,
+    .is_running = false
+};
+
+static void timer_sched_start(uint32_t period_us, void (*tick)(void))
+{
+    g_cycle_timer_cfg.period_us = period_us;
+    g_cycle_timer_cfg.callback = tick;
+    timer_init(&g_cycle_timer_cfg);
+    timer_start(&g_cycle_timer_cfg);
+}
+
+static void timer_sched_stop(void)
+{
+    timer_stop(&g_cycle_timer_cfg);
+}
+
+const fx3u_runtime_scheduler_t fx3u_runtime_timer_scheduler = {
+    .start = timer_sched_start,
+    .stop = timer_sched_stop,
+    .poll = NULL
+};
+
+static void (*g_loop_tick)(void) = NULL;
+static uint32_t g_loop_period_us = 0;
+static uint64_t g_loop_due_us = 0;
+
+static void loop_sched_start(uint32_t period_us, void (*tick)(void))
+{
+    g_loop_period_us = period_us;
+    g_loop_due_us = time_us_64() + period_us;
+    g_loop_tick = tick;
+}
+
+static void loop_sched_stop(void)
+{
+    g_loop_tick = NULL;
+}
+
+/* 到期执行一次；落后超过一个周期时从当前时刻重新对齐，不连续补扫 */
+static void loop_sched_poll(void)
+{
+    if (!g_loop_tick) return;
+
+    uint64_t now = time_us_64();
+    if (now < g_loop_due_us) return;
+    g_loop_due_us += g_loop_period_us;
+    if (g_loop_due_us <= now) {
+        g_loop_due_us = now + g_loop_period_us;
+    }
+    g_loop_tick();
+}
+
+const fx3u_runtime_scheduler_t fx3u_runtime_loop_scheduler = {
+    .start = loop_sched_start,
+    .stop = loop_sched_stop,
+    .poll = loop_sched_poll
+};
+
+/* ===== 输出 ===== */
+
+/**
+ * 输出最近一次发布的 Y0-Y8 整字，未变化时不访问 GPIO
+ *
+ * 关中断读取并写出，避免线程上下文在中断扫描之后写回旧值
+ */
+static void write_published_outputs(void)
+{
+    if (fx3u_watchdog_tripped()) return;
+
+    uint32_t ints = save_and_disable_interrupts();
+    const fx3u_image_snapshot_t *snap;
+    uint32_t seq;
+    uint32_t outputs;
+    do {
+        snap = fx3u_image_snapshot_begin(&seq);
+        outputs = fx3u_image_snapshot_bits(snap, FX3U_IMAGE_Y, 0, PICO_OUTPUT_COUNT);
+    } while (fx3u_image_snapshot_retry(snap, seq));
+    io_write_output_word((uint16_t)outputs);
+    restore_interrupts(ints);
+}
+
+/* ===== 扫描 ===== */
+
+static bool scan_enter(void)
+{
+    uint32_t ints = save_and_disable_interrupts();
+    bool ok = !g_in_scan;
+    if (ok) {
+        g_in_scan = true;
+    } else {
+        g_rescan = true;
+    }
+    restore_interrupts(ints);
+    return ok;
+}
+
+/**
+ * 执行扫描: 扩展输入 -> 程序 (含输入展开与发布) -> 扩展输出 -> 写出 Y
+ *
+ * STOP 时也需执行，以应用通信写入并刷新过程映像
+ */
+static void scan(void)
+{
+    if (!scan_enter()) {
+        g_stats.merged++;
+        return;
+    }
+
+    for (;;) {
+        fx3u_watchdog_scan_begin();
+        fx3u_expansion_scan_begin();
+        fx3u_watchdog_phase(FX3U_WATCHDOG_PHASE_PROGRAM);
+        fx3u_core_run_cycle(&g_plc);
+        fx3u_watchdog_phase(FX3U_WATCHDOG_PHASE_OUTPUT);
+        fx3u_expansion_scan_end();
+        write_published_outputs();
+        fx3u_watchdog_scan_end();
+
+        /* 释放与检查补做在同一关中断区内，之间到达的请求不会丢 */
+        uint32_t ints = save_and_disable_interrupts();
+        bool again = g_rescan;
+        g_rescan = false;
+        if (!again) g_in_scan = false;
+        restore_interrupts(ints);
+        if (!again) break;
+    }
+    fx3u_tasks_signal(g_task_outputs);
+}
+
+/* 调度节拍: 距上次常规扫描不足半个周期的是追赶积压，丢弃 */
+static void scan_tick(void)
+{
+    uint64_t now = time_us_64();
+    if (g_last_tick_us && now - g_last_tick_us < g_period_us / 2) {
+        g_stats.late_ticks++;
+        return;
+    }
+    g_last_tick_us = now;
+    g_stats.scans++;
+    scan();
+}
+
+/**
+ * 快速输入沿回调 (GPIO 中断)
+ *
+ * 立即交付输入并执行一次周期外扫描，输出当场刷新，常规扫描周期不变
+ */
+static void input_edge_callback(uint32_t changed, uint32_t stamp_us)
+{
+    (void)changed;
+    (void)stamp_us;
+    fx3u_core_set_input_word(&g_plc, io_read_input_word(), FX3U_EXPANSION_LOCAL_INPUTS);
+    g_stats.edge_scans++;
+    scan();
+}
+
+/**
+ * 高速计数器比较动作回调 (PIO 中断)
+ *
+ * DHSCS / DHSCR 已改写软元件，立即发布并刷新输出；
+ * 扫描进行中 (仅主循环策略) 时由扫描结束时的发布带出
+ */
+static void hsc_event_callback(uint16_t counter)
+{
+    (void)counter;
+    if (g_in_scan) return;
+    fx3u_image_publish(&g_plc);
+    write_published_outputs();
+}
+
+/**
+ * 看门狗跳闸 (最高优先级中断): 脉冲立即停止，Y0-Y8 写安全值，ERR 灯亮
+ *
+ * 扩展总线的 Y 保持 595 最后锁存的状态直到复位
+ */
+static void watchdog_safe_state(void)
+{
+    for (uint8_t ch = 0; ch < FX3U_PULSE_CHANNELS; ch++) {
+        fx3u_pulse_stop(ch, 0, false);
+    }
+    if (!g_hold_outputs) {
+        io_write_output_word((uint16_t)g_safe_outputs);
+    }
+    io_set_led_err(true);
+}
+
+/**
+ * 上一次看门狗复位的记录: 打印并置错误码 (D8006)
+ */
+static void report_watchdog_reset(void)
+{
+    fx3u_watchdog_record_t rec;
+    if (!fx3u_watchdog_last_record(&rec)) return;
+
+    printf("Warning: watchdog reset #%lu (%s), phase %s, step %lu (opcode 0x%04X), "
+           "task %s, scan %lu, D8000 %u ms\r\n",
+           (unsigned long)rec.resets, fx3u_watchdog_cause_name(rec.cause),
+           fx3u_watchdog_phase_name(rec.phase), (unsigned long)rec.step, rec.opcode,
+           rec.task >= 0 ? fx3u_tasks_name(rec.task) : "-", (unsigned long)rec.scan_count,
+           rec.limit_ms);
+    fx3u_set_error(&g_plc, FX3U_WATCHDOG_ERROR);
+}
+
+/* ===== 输入 / 输出 / 通信 ===== */
+
+/**
+ * 输入锁存: 去抖后的板载 X 整字交付 (扫描开始时展开，强制点随后覆盖)，RUN 开关
+ */
+static void latch_inputs(void)
+{
+    io_manager_update();
+
+    fx3u_core_set_input_word(&g_plc, io_read_input_word(), FX3U_EXPANSION_LOCAL_INPUTS);
+
+    static bool last_run_switch = false;
+    static bool switch_initialized = false;
+    bool run_switch = io_get_switch_run();
+
+    if (!switch_initialized) {
+        switch_initialized = true;
+        last_run_switch = run_switch;
+    }
+
+    if (run_switch != last_run_switch) {
+        if (run_switch) {
+            fx3u_core_start(&g_plc);
+            LOG_INFO("[IO] RUN开关闭合，PLC启动\r\n");
+        } else {
+            fx3u_core_stop(&g_plc);
+            LOG_INFO("[IO] RUN开关断开，PLC停止\r\n");
+        }
+        last_run_switch = run_switch;
+    } else if (!run_switch && g_plc.state == PLC_RUN) {
+        /* 未检测到切换但RUN开关断开，强制停止使物理开关优先 */
+        fx3u_core_stop(&g_plc);
+    } else if (run_switch && g_plc.state != PLC_RUN) {
+        fx3u_core_start(&g_plc);
+    }
+}
+
+/**
+ * 输出刷新: Y 已在扫描结束写出，这里只更新指示灯
+ */
+static void refresh_outputs(void)
+{
+    io_set_led_run(g_plc.state == PLC_RUN);
+    io_set_led_err(g_plc.error_code != 0);
+}
+
+#if !PICO_MODBUS_GATEWAY_ENABLED
+/**
+ * 处理 RS485 上接收到的帧 (静默 t3.5 之后整帧交付)
+ */
+static void process_communication(void)
+{
+    uint16_t rx_len = rs485_frame_poll(&g_rx_frame);
+    if (rx_len == 0) return;
+
+    LOG_DEBUG("Received %d bytes\r\n", rx_len);
+
+    int tx_len;
+    if (mitsubishi_link_is_frame(rx_buffer, rx_len)) {
+        /* ENQ 开头的 ASCII 帧: 计算机链接 */
+        tx_len = mitsubishi_link_process(&g_link, rx_buffer, rx_len, tx_buffer);
+    } else {
+        /* 处理MODBUS帧 (CRC已在接收时累计) */
+        tx_len = modbus_slave_process_crc(&g_plc, rx_buffer, rx_len, tx_buffer,
+                                          &g_rx_frame.crc);
+    }
+    rs485_frame_reset(&g_rx_frame);
+
+    if (tx_len > 0) {
+        LOG_DEBUG("Sending %d bytes\r\n", tx_len);
+        rs485_send(tx_buffer, tx_len);
+    }
+}
+#endif
+
+/* ===== 主循环任务 ===== */
+
+static void task_scheduler(void)
+{
+    if (g_started) g_scheduler->poll();
+}
+
+static void task_rs485(void)
+{
+#if PICO_MODBUS_GATEWAY_ENABLED
+    modbus_gateway_poll(&g_gateway);
+    modbus_master_poll(&g_rtu_master);
+#else
+    process_communication();
+#endif
+}
+
+#if PICO_ETHERNET_ENABLED
+static void task_tcp(void)
+{
+    modbus_tcp_server_poll(&g_modbus_tcp);
+}
+#endif
+
+static void task_usb(void)
+{
+    usb_monitor_poll(&g_monitor);
+}
+
+/* 延迟日志每轮条数受限，USB 阻塞不拖慢通信 */
+static void task_log(void)
+{
+    log_flush(4);
+}
+
+/*
+ * 任务表: 名称, 函数, 优先级 (0 最高), 周期, 期限, 预算 (us)
+ * 输入锁存最先；USB / 日志最低
+ */
+static const fx3u_task_config_t g_task_table[] = {
+    { "inputs",    latch_inputs,        0, 1000,   1000,  200  },
+    { "pulse",     fx3u_pulse_poll,     1, 1000,   2000,  200  },
+#if PICO_ETHERNET_ENABLED
+    { "tcp",       task_tcp,            2, 1000,   5000,  1000 },
+#endif
+    { "expansion", fx3u_expansion_poll, 2, 1000,   5000,  100  },
+    { "analog",    fx3u_analog_poll,    3, 10000,  20000, 1000 },
+    { "usb",       task_usb,            3, 2000,   20000, 2000 },
+    { "hsc",       fx3u_hsc_poll,       4, 100000, 0,     200  },
+    { "program",   fx3u_program_poll,   4, 1000,   0,     50000 },
+    { "log",       task_log,            5, 10000,  0,     5000 },
+    { "watchdog",  fx3u_watchdog_poll,  5, 100000, 0,     50   },
+};
+
+/*
+ * RS485 轮询周期取 t1.5 (9600 波特约 1.56ms，高于 19200 波特为 750us)，期限取 t3.5，
+ * 在 add_tasks() 中按波特率填入: 字节以收取时刻计时，轮询间隔不超过 t1.5 时
+ * 帧内字符间隔 (至多 t1.5) 量得的静默不会达到 t3.5
+ */
+static fx3u_task_config_t g_rs485_task = {
+    "rs485", task_rs485, 1, 0, 0, 1000
+};
+
+/* 输出刷新 (指示灯) 由扫描结束触发 */
+static const fx3u_task_config_t g_outputs_task = {
+    "outputs", refresh_outputs, 2, 0, 10000, 200
+};
+
+/* 定时器服务的 TASK 上下文回调，到期时由 alarm 中断触发 */
+static const fx3u_task_config_t g_timers_task = {
+    "timers", timer_service_poll, 1, 0, 2000, 500
+};
+
+static void timers_notify(void)
+{
+    fx3u_tasks_signal(g_task_timers);
+}
+
+/* 主循环调度策略的节拍检查 */
+static const fx3u_task_config_t g_scheduler_task = {
+    "scan", task_scheduler, 0, 1000, 1000, 0
+};
+
+static void add_tasks(void)
+{
+    fx3u_tasks_init(&g_plc);
+    if (g_scheduler->poll) {
+        fx3u_tasks_add(&g_scheduler_task);
+    }
+    for (uint32_t i = 0; i < sizeof(g_task_table) / sizeof(g_task_table[0]); i++) {
+        fx3u_tasks_add(&g_task_table[i]);
+    }
+    g_rs485_task.period_us = rs485_char_gap_us(&g_rs485_config);
+    g_rs485_task.deadline_us = rs485_frame_gap_us(&g_rs485_config);
+    fx3u_tasks_add(&g_rs485_task);
+    g_task_outputs = fx3u_tasks_add(&g_outputs_task);
+    g_task_timers = fx3u_tasks_add(&g_timers_task);
+    timer_service_set_notify(timers_notify);
+}
+
+/* ===== 接口 ===== */
+
+/**
+ * 初始化所有模块
+ */
+void fx3u_runtime_init(const fx3u_runtime_config_t *config)
+{
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_period_us = FX3U_RUNTIME_SCAN_PERIOD_US;
+    g_scheduler = &fx3u_runtime_timer_scheduler;
+    if (config) {
+        if (config->scan_period_us) g_period_us = config->scan_period_us;
+        if (config->scheduler) g_scheduler = config->scheduler;
+        g_safe_outputs = config->safe_outputs;
+        g_hold_outputs = config->hold_outputs;
+    }
+
+    /* 标准输入输出初始化 */
+    stdio_init_all();
+    sleep_ms(1000);
+    printf("=== %s ===\r\n", config && config->banner ? config->banner : "Pico FX3U Simulator");
+
+    /* PLC核心初始化 */
+    printf("Initializing PLC core...\r\n");
+    fx3u_core_init(&g_plc);
+
+    /* 扫描看门狗 (D8000)，读取上一次复位留下的故障记录 */
+    fx3u_watchdog_config_t watchdog_config = {
+        .scan_period_us = g_period_us,
+        .loop_limit_ms = 0,
+        .safe_state = watchdog_safe_state
+    };
+    fx3u_watchdog_init(&g_plc, &watchdog_config);
+
+    const fx3u_instruction_t *program = NULL;
+    uint32_t instruction_count = 0;
+    fx3u_program_get_default(&program, &instruction_count);
+    /* 优先使用在线下载到 Flash 的程序 */
+    if (fx3u_program_load_stored(&g_plc)) {
+        printf("Loaded stored ladder program (%lu instructions)\r\n",
+               (unsigned long)g_plc.program_size);
+    } else if (fx3u_core_load_program(&g_plc, program, instruction_count)) {
+        fx3u_program_apply_defaults(&g_plc);
+        printf("Loaded default ladder program (%lu instructions)\r\n",
+               (unsigned long)instruction_count);
+    } else {
+        printf("Warning: no PLC program loaded\r\n");
+    }
+
+    /* I/O管理器初始化 */
+    printf("Initializing I/O manager...\r\n");
+    io_manager_init(&g_io_mgr);
+
+    /* 急停等快速输入: 沿中断触发周期外扫描，不缩短常规扫描周期 */
+    io_enable_input_irq(PICO_INPUT_FAST_MASK, input_edge_callback);
+
+    /* 高速计数器 C235-C255 (PIO)，首次 OUT Cnnn 时分配状态机 */
+    fx3u_hsc_init(&g_plc);
+    fx3u_hsc_set_event_callback(hsc_event_callback);
+
+    /* 脉冲输出 Y0-Y2 (PIO + DMA 段表)，首次定位指令时分配状态机 */
+    fx3u_pulse_init(&g_plc);
+
+#if PICO_EXPANSION_ENABLED
+    /* 扩展总线 X16- / Y16- (74HC165 / 74HC595 链，PIO + DMA)，每次扫描一帧 */
+    if (!fx3u_expansion_init(&g_plc, &g_expansion_config)) {
+        printf("Warning: expansion bus unavailable\r\n");
+    }
+#endif
+
+    /* 模拟量后台采集 (DMA)，工程值每次扫描发布到 D110-D112 */
+    fx3u_analog_init();
+
+    /* RS485通信初始化 */
+    printf("Initializing RS485 communication...\r\n");
+    g_rs485_config.baudrate = 9600;
+    g_rs485_config.data_bits = 8;
+    g_rs485_config.stop_bits = 1;
+    g_rs485_config.parity = 0;  /* NONE */
+    g_rs485_config.rts_enabled = true;
+    rs485_init(&g_rs485_config);
+#if !PICO_MODBUS_GATEWAY_ENABLED
+    rs485_frame_init(&g_rx_frame, rx_buffer, sizeof(rx_buffer),
+                     rs485_frame_gap_us(&g_rs485_config));
+#endif
+
+    /* 通信配置初始化 */
+    printf("Initializing communication interface...\r\n");
+    comm_init(&g_comm_config, COMM_MODE_RS485_MODBUS);
+    g_comm_config.station_id = 1;
+
+    /* MODBUS协议初始化 */
+    printf("Initializing MODBUS protocol...\r\n");
+    modbus_init(&g_modbus_config, 1);
+    modbus_crc_init();
+    modbus_set_master(&g_modbus_config, false);  /* 从机模式 */
+
+#if !PICO_MODBUS_GATEWAY_ENABLED
+    /* 三菱计算机链接 (与 MODBUS RTU 共用 RS485，按帧识别) */
+    mitsubishi_link_init(&g_link, &g_plc);
+#endif
+
+    /* USB 监视 (上位机调试软件) */
+    usb_monitor_init(&g_monitor, &g_plc, &usb_monitor_cdc_transport);
+
+#if PICO_ETHERNET_ENABLED
+    /* MODBUS TCP 服务端 (W5500) */
+    printf("Initializing Ethernet (MODBUS TCP)...\r\n");
+    ethernet_init(&g_eth_config);
+    modbus_tcp_server_init(&g_modbus_tcp, &g_plc, g_eth_config.port,
+                           g_modbus_config.slave_id);
+#endif
+#if PICO_MODBUS_GATEWAY_ENABLED
+    /* 网关模式: 非本机单元的 TCP 请求转发到 RS485 下游 */
+    g_comm_config.mode = COMM_MODE_MODBUS_GATEWAY;
+    modbus_master_init(&g_rtu_master, &g_rs485_transport);
+    g_rtu_master.frame_gap_us = rs485_frame_gap_us(&g_rs485_config);
+    modbus_gateway_init(&g_gateway, &g_rtu_master, &g_modbus_tcp);
+#endif
+
+    /* 主循环任务 */
+    add_tasks();
+    report_watchdog_reset();
+
+    printf("System initialization completed.\r\n");
+    printf("PLC Status: Ready\r\n");
+    printf("RS485 Baudrate: 9600, Station ID: 1\r\n\r\n");
+}
+
+/**
+ * 进入 RUN 并启动扫描调度 (重复调用不会启动第二个调度)
+ */
+void fx3u_runtime_start(void)
+{
+    fx3u_core_start(&g_plc);
+    if (g_started) return;
+
+    g_last_tick_us = 0;
+    g_scheduler->start(g_period_us, scan_tick);
+    fx3u_watchdog_start();
+    g_started = true;
+}
+
+/**
+ * 停止调度，PLC 进入 STOP (正在进行的扫描照常完成)
+ */
+void fx3u_runtime_stop(void)
+{
+    if (g_started) {
+        fx3u_watchdog_stop();
+        g_scheduler->stop();
+        g_started = false;
+    }
+    fx3u_core_stop(&g_plc);
+}
+
+/**
+ * 主循环调用: 执行一个就绪任务，空闲时休眠
+ */
+void fx3u_runtime_poll(void)
+{
+    fx3u_tasks_run();
+}
+
+fx3u_core_t *fx3u_runtime_plc(void)
+{
+    return &g_plc;
+}
+
+void fx3u_runtime_get_stats(fx3u_runtime_stats_t *stats)
+{
+    if (stats) *stats = g_stats;
+}
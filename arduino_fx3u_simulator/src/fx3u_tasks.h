@@ -0,0 +1,62 @@
+/**
+ * 主循环协作式任务调度 (运行至完成，不抢占)
+ *
+ * 每次 fx3u_tasks_run() 在就绪任务中选优先级最高者执行一次 (同优先级先就绪者优先)，
+ * 执行完再重新挑选，慢任务不会连续占用主循环。任务就绪条件:
+ * - 周期任务: 到达下一周期 (落后超过一个周期时重新对齐，不连续补跑)
+ * - 事件任务: fx3u_tasks_signal() (可在中断中调用)
+ *
+ * 没有就绪任务时以 __wfe 休眠到最近的周期或下一个中断，
+ * 休眠时间按 1 秒窗口折算为 CPU 负载，写入 D8490 (当前) / D8491 (峰值)。
+ */
+
+#ifndef __FX3U_TASKS_H__
+#define __FX3U_TASKS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fx3u_core.h"
+
+#define FX3U_TASKS_MAX              16
+#define FX3U_TASKS_LOAD_WINDOW_US   1000000     /* 负载统计窗口 */
+#define FX3U_TASKS_IDLE_MAX_US      10000       /* 单次休眠上限 */
+
+#define D8490   8490    /* CPU 负载 (%)，最近一个窗口 */
+#define D8491   8491    /* CPU 负载峰值 (%) */
+
+typedef struct {
+    const char *name;
+    void (*run)(void);
+    uint8_t priority;                   /* 0 最高 */
+    uint32_t period_us;                 /* 0 = 仅由事件触发 */
+    uint32_t deadline_us;               /* 就绪后须在此时间内开始执行，0 = 不检查 */
+    uint32_t budget_us;                 /* 单次执行时间预算，0 = 不检查 */
+} fx3u_task_config_t;
+
+typedef struct {
+    uint32_t runs;
+    uint32_t deadline_misses;           /* 就绪到开始执行超过 deadline_us */
+    uint32_t overruns;                  /* 单次执行超过 budget_us */
+    uint32_t max_latency_us;
+    uint32_t max_run_us;
+} fx3u_task_stats_t;
+
+/* plc 用于发布负载寄存器，可为 NULL */
+void fx3u_tasks_init(fx3u_core_t *plc);
+
+/* 返回任务号，任务表满或参数无效时返回 -1 */
+int fx3u_tasks_add(const fx3u_task_config_t *config);
+
+/* 事件触发: 置就绪并唤醒 __wfe (中断安全) */
+void fx3u_tasks_signal(int task);
+
+/* 执行一个就绪任务；没有就绪任务时休眠 */
+void fx3u_tasks_run(void);
+
+uint8_t fx3u_tasks_load(void);          /* 最近一个窗口的 CPU 负载 (%) */
+uint8_t fx3u_tasks_peak_load(void);
+bool fx3u_tasks_get_stats(int task, fx3u_task_stats_t *stats);
+const char *fx3u_tasks_name(int task);
+int fx3u_tasks_current(void);           /* 正在执行的任务 (可在中断中调用)，-1 = 无 */
+
+#endif /* __FX3U_TASKS_H__ */
@@ -0,0 +1,163 @@
+/**
+ * 延迟日志实现
+ *
+ * Cortex-M0+ 没有 LDREX/STREX，因此不用 CAS 预留槽位:
+ * 每个内核独占一个环，预留 (读写 head) 时关闭本核中断，只有几条指令；
+ * 记录内容在开中断后填写，最后置 ready。消费者按顺序取 ready 的记录，
+ * 遇到已预留但尚未写完的槽位 (被中断打断的生产者) 时停下，下次再取。
+ */
+
+#include "logger.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include <stdio.h>
+
+#define LOG_RING_MASK   (LOG_RING_SIZE - 1)
+#define LOG_LINE_MAX    160
+
+typedef struct {
+    log_record_t records[LOG_RING_SIZE];
+    volatile uint32_t head;             /* 生产者预留位置 (本核关中断下修改) */
+    volatile uint32_t tail;             /* 消费者位置 */
+    volatile uint32_t written;
+    volatile uint32_t dropped;
+} log_ring_t;
+
+static log_ring_t g_rings[LOG_CORE_COUNT];
+static uint32_t g_dropped_reported[LOG_CORE_COUNT];
+static uint32_t g_flushed = 0;
+static log_output_t g_output = NULL;
+
+static const char g_level_tags[] = "-EWID";
+
+static inline uint32_t current_core(void)
+{
+#if PICO_ON_DEVICE
+    return get_core_num();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * 写入一条日志记录 (任意内核 / 中断)
+ */
+void log_write(uint8_t level, const char *fmt, int32_t a0, int32_t a1, int32_t a2)
+{
+    if (!fmt) return;
+
+    log_ring_t *ring = &g_rings[current_core()];
+
+    uint32_t ints = save_and_disable_interrupts();
+    uint32_t head = ring->head;
+    if (head - ring->tail >= LOG_RING_SIZE) {
+        ring->dropped++;
+        restore_interrupts(ints);
+        return;
+    }
+    ring->head = head + 1;
+    ring->written++;
+    restore_interrupts(ints);
+
+    log_record_t *rec = &ring->records[head & LOG_RING_MASK];
+    rec->fmt = fmt;
+    rec->timestamp_us = time_us_32();
+    rec->args[0] = a0;
+    rec->args[1] = a1;
+    rec->args[2] = a2;
+    rec->level = level;
+    __dmb();
+    rec->ready = 1;
+}
+
+/**
+ * 取出一条就绪记录，没有则返回 false
+ */
+static bool ring_take(log_ring_t *ring, log_record_t *out)
+{
+    uint32_t tail = ring->tail;
+    if (tail == ring->head) return false;
+
+    log_record_t *rec = &ring->records[tail & LOG_RING_MASK];
+    if (!rec->ready) return false;
+    __dmb();
+
+    *out = *rec;
+    rec->ready = 0;
+    __dmb();
+    ring->tail = tail + 1;
+    return true;
+}
+
+static void emit(const char *text, int length)
+{
+    if (length <= 0) return;
+    if (length >= LOG_LINE_MAX) length = LOG_LINE_MAX - 1;
+
+    if (g_output) {
+        g_output(text, (uint16_t)length);
+    } else {
+        fwrite(text, 1, (size_t)length, stdout);
+    }
+}
+
+/**
+ * 格式化并输出已就绪的记录
+ */
+uint32_t log_flush(uint32_t max_records)
+{
+    uint32_t count = 0;
+
+    for (uint32_t core = 0; core < LOG_CORE_COUNT; core++) {
+        log_ring_t *ring = &g_rings[core];
+
+        uint32_t dropped = ring->dropped;
+        if (dropped != g_dropped_reported[core] && count < max_records) {
+            char line[LOG_LINE_MAX];
+            emit(line, snprintf(line, sizeof(line), "[log] core%lu: %lu records dropped\r\n",
+                                (unsigned long)core,
+                                (unsigned long)(dropped - g_dropped_reported[core])));
+            g_dropped_reported[core] = dropped;
+            count++;
+        }
+
+        log_record_t rec;
+        while (count < max_records && ring_take(ring, &rec)) {
+            uint32_t ms = rec.timestamp_us / 1000;
+            char tag = rec.level < sizeof(g_level_tags) - 1 ? g_level_tags[rec.level] : '?';
+            char line[LOG_LINE_MAX];
+            int n = snprintf(line, sizeof(line), "%lu.%03lu %c ", (unsigned long)(ms / 1000),
+                             (unsigned long)(ms % 1000), tag);
+            n += snprintf(&line[n], sizeof(line) - n, rec.fmt,
+                          rec.args[0], rec.args[1], rec.args[2]);
+            emit(line, n);
+            g_flushed++;
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * 设置输出目标
+ */
+void log_set_output(log_output_t output)
+{
+    g_output = output;
+}
+
+/**
+ * 获取统计
+ */
+void log_get_stats(log_stats_t *stats)
+{
+    if (!stats) return;
+
+    stats->written = 0;
+    stats->dropped = 0;
+    for (uint32_t core = 0; core < LOG_CORE_COUNT; core++) {
+        stats->written += g_rings[core].written;
+        stats->dropped += g_rings[core].dropped;
+    }
+    stats->flushed = g_flushed;
+}
@@ -0,0 +1,94 @@
+/**
+ * 延迟日志
+ *
+ * 热路径只把 [格式串指针, 时间戳, 3 个整数参数] 写入环形缓冲，
+ * 格式化与 USB 输出由主循环低优先级处 log_flush() 完成，
+ * USB CDC 阻塞不再影响通信与扫描时序。
+ *
+ * - 每个内核一个环，生产者只在预留槽位时短暂关本核中断，内核之间无锁；
+ *   可在任一内核的任务或中断中调用
+ * - 环满时丢弃新记录并计数，生产者从不等待
+ * - 格式串必须为常量 (指针即格式 ID)，参数仅支持整数 (%d / %u / %X 等)
+ * - 低于 LOG_LEVEL 的级别在编译期移除，不产生任何代码
+ */
+
+#ifndef __LOGGER_H__
+#define __LOGGER_H__
+
+#include <stdint.h>
+
+/* ===== 日志级别 ===== */
+#define LOG_LEVEL_NONE      0
+#define LOG_LEVEL_ERROR     1
+#define LOG_LEVEL_WARN      2
+#define LOG_LEVEL_INFO      3
+#define LOG_LEVEL_DEBUG     4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL           LOG_LEVEL_INFO
+#endif
+
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE       64      /* 每核记录数，须为 2 的幂 */
+#endif
+
+#define LOG_CORE_COUNT      2
+
+/* ===== 日志记录 ===== */
+typedef struct {
+    const char *fmt;
+    uint32_t timestamp_us;
+    int32_t args[3];
+    uint8_t level;
+    volatile uint8_t ready;             /* 写完后置 1，消费后清 0 */
+} log_record_t;
+
+/* 输出函数: text 为一条已格式化的日志 (含行尾)，不以 0 结尾 */
+typedef void (*log_output_t)(const char *text, uint16_t length);
+
+typedef struct {
+    uint32_t written;
+    uint32_t dropped;
+    uint32_t flushed;
+} log_stats_t;
+
+/* 生产者 - 请使用下面的宏 */
+void log_write(uint8_t level, const char *fmt, int32_t a0, int32_t a1, int32_t a2);
+
+/* 消费者 (主循环低优先级处调用): 最多输出 max_records 条，返回实际条数 */
+uint32_t log_flush(uint32_t max_records);
+
+/* 替换输出目标 (如 USB 监视会话期间封装为监视帧)，NULL 恢复为 stdout */
+void log_set_output(log_output_t output);
+
+void log_get_stats(log_stats_t *stats);
+
+/* 参数不足 3 个时补 0 */
+#define LOG_EMIT_(level, fmt, a0, a1, a2, ...) \
+    log_write((level), (fmt), (int32_t)(a0), (int32_t)(a1), (int32_t)(a2))
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...)      LOG_EMIT_(LOG_LEVEL_ERROR, __VA_ARGS__, 0, 0, 0, 0)
+#else
+#define LOG_ERROR(...)      ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...)       LOG_EMIT_(LOG_LEVEL_WARN, __VA_ARGS__, 0, 0, 0, 0)
+#else
+#define LOG_WARN(...)       ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...)       LOG_EMIT_(LOG_LEVEL_INFO, __VA_ARGS__, 0, 0, 0, 0)
+#else
+#define LOG_INFO(...)       ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...)      LOG_EMIT_(LOG_LEVEL_DEBUG, __VA_ARGS__, 0, 0, 0, 0)
+#else
+#define LOG_DEBUG(...)      ((void)0)
+#endif
+
+#endif /* __LOGGER_H__ */
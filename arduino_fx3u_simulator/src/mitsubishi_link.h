@@ -0,0 +1,90 @@
+/**
+ * 三菱计算机链接 (FX 专用协议，格式1 / 格式4)
+ *
+ * 请求: ENQ 站号(2) PC号(2) 命令(2) 报文等待(1) 数据 [和校验(2)] [CR LF]
+ * 应答: STX 站号 PC号 数据 ETX [和校验] / ACK 站号 PC号 / NAK 站号 PC号 错误码(2)
+ *
+ * - 站号取自 D8121，和校验与格式由 D8120 的 b13 / b15 决定 (每帧重新读取)
+ * - 读取来自过程映像快照，写入进入过程映像写队列，与 MODBUS 一致
+ * - 监视登记 (MS/MN) 后，HMI 只需发送 MM 即可读回整组软元件
+ * - 报文等待时间仅做解析，应答在处理完成后立即发出
+ */
+
+#ifndef __MITSUBISHI_LINK_H__
+#define __MITSUBISHI_LINK_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fx3u_core.h"
+#include "fx3u_image.h"
+
+#define MITSUBISHI_LINK_MAX_FRAME       300     /* WW 64 字请求 / WR 64 字应答 */
+
+/* ===== 控制码 ===== */
+#define MITSUBISHI_LINK_STX             0x02
+#define MITSUBISHI_LINK_ETX             0x03
+#define MITSUBISHI_LINK_ENQ             0x05
+#define MITSUBISHI_LINK_ACK             0x06
+#define MITSUBISHI_LINK_NAK             0x15
+
+/* ===== NAK 错误码 ===== */
+#define MITSUBISHI_LINK_ERR_SUM         0x02    /* 和校验错误 */
+#define MITSUBISHI_LINK_ERR_PROTOCOL    0x03    /* 协议错误 (命令/长度不符) */
+#define MITSUBISHI_LINK_ERR_AREA        0x06    /* 字符区错误 (软元件/点数越界、不可写、写队列满) */
+#define MITSUBISHI_LINK_ERR_CHARACTER   0x07    /* 字符错误 (非十六进制等) */
+#define MITSUBISHI_LINK_ERR_PC_NUMBER   0x10    /* PC 号错误 */
+
+/* ===== D8120 相关位 ===== */
+#define MITSUBISHI_LINK_D8120_SUM       (1u << 13)
+#define MITSUBISHI_LINK_D8120_FORMAT4   (1u << 15)
+
+/* ===== 单次命令点数上限 ===== */
+#define MITSUBISHI_LINK_BR_MAX          256
+#define MITSUBISHI_LINK_WR_MAX          64
+#define MITSUBISHI_LINK_BW_MAX          160
+#define MITSUBISHI_LINK_WW_MAX          64
+#define MITSUBISHI_LINK_BT_MAX          20
+#define MITSUBISHI_LINK_WT_MAX          10
+#define MITSUBISHI_LINK_MS_MAX          40
+#define MITSUBISHI_LINK_MN_MAX          20
+
+/* ===== 软元件 ===== */
+typedef struct {
+    uint8_t area;                       /* fx3u_image_area_t */
+    uint16_t index;
+} mitsubishi_link_device_t;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t naks;
+    uint32_t monitor_polls;
+    uint32_t ignored;                   /* 站号不符或无法解析站号 */
+} mitsubishi_link_stats_t;
+
+typedef struct {
+    fx3u_core_t *plc;
+
+    /* 每帧由 D8120 / D8121 刷新 */
+    uint8_t station;
+    bool sum_check;
+    bool format4;
+
+    /* 监视登记 */
+    mitsubishi_link_device_t monitor_bits[MITSUBISHI_LINK_MS_MAX];
+    mitsubishi_link_device_t monitor_words[MITSUBISHI_LINK_MN_MAX];
+    uint8_t monitor_bit_count;
+    uint8_t monitor_word_count;
+
+    mitsubishi_link_stats_t stats;
+} mitsubishi_link_t;
+
+void mitsubishi_link_init(mitsubishi_link_t *link, fx3u_core_t *plc);
+
+/* 判断接收到的帧是否为计算机链接请求 (ENQ 开头且其余均为 ASCII) */
+bool mitsubishi_link_is_frame(const uint8_t *rx, uint16_t rx_len);
+
+/* 处理一帧请求，返回应答长度 (0 表示不应答) */
+int mitsubishi_link_process(mitsubishi_link_t *link, const uint8_t *rx, uint16_t rx_len,
+                            uint8_t *tx);
+
+#endif /* __MITSUBISHI_LINK_H__ */
@@ -0,0 +1,46 @@
+/**
+ * MODBUS CRC16 计算引擎
+ * 可插拔的CRC实现：逐字节查表 / Slicing-by-4 / Slicing-by-8
+ * 支持增量计算，字节到达时即累计，帧尾校验为 O(1)
+ */
+
+#ifndef __MODBUS_CRC_H__
+#define __MODBUS_CRC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MODBUS_CRC_INIT     0xFFFF
+
+/* ===== CRC引擎类型 ===== */
+typedef enum {
+    MODBUS_CRC_ENGINE_BYTEWISE = 0,     /* 逐字节查表 (512B 表) */
+    MODBUS_CRC_ENGINE_SLICE4 = 1,       /* Slicing-by-4 (2KB 表) */
+    MODBUS_CRC_ENGINE_SLICE8 = 2,       /* Slicing-by-8 (4KB 表) */
+    MODBUS_CRC_ENGINE_COUNT
+} modbus_crc_engine_t;
+
+/* ===== 增量CRC上下文 ===== */
+typedef struct {
+    uint16_t crc;       /* 当前累计值 */
+    uint16_t length;    /* 已累计字节数 */
+} modbus_crc_ctx_t;
+
+/* 引擎管理 */
+void modbus_crc_init(void);
+void modbus_crc_set_engine(modbus_crc_engine_t engine);
+modbus_crc_engine_t modbus_crc_get_engine(void);
+const char *modbus_crc_engine_name(modbus_crc_engine_t engine);
+
+/* 计算: 以 crc 为初值继续累计 length 字节 */
+uint16_t modbus_crc_update(uint16_t crc, const uint8_t *data, uint16_t length);
+uint16_t modbus_crc_update_with(modbus_crc_engine_t engine, uint16_t crc,
+                                const uint8_t *data, uint16_t length);
+
+/* 增量接口 */
+void modbus_crc_begin(modbus_crc_ctx_t *ctx);
+void modbus_crc_feed(modbus_crc_ctx_t *ctx, const uint8_t *data, uint16_t length);
+void modbus_crc_feed_byte(modbus_crc_ctx_t *ctx, uint8_t byte);
+bool modbus_crc_frame_ok(const modbus_crc_ctx_t *ctx);
+
+#endif /* __MODBUS_CRC_H__ */
@@ -0,0 +1,94 @@
+/**
+ * MODBUS 地址映射表
+ *
+ * 四张表 (线圈 / 离散输入 / 保持寄存器 / 输入寄存器) 各自由若干区段组成，
+ * 每个区段把一段连续的 MODBUS 地址映射到一种软元件 (过程映像区域)。
+ * 区段按起始地址排序，查找为二分查找；一次请求可跨越多个相邻区段，
+ * 全部区段在同一次快照读取 / 同一批写入中完成。区段之间的空隙返回非法地址。
+ *
+ * 映射表可在运行时整体替换 (modbus_map_load / modbus_map_load_image)，
+ * 默认映射与早期固定布局兼容: 线圈 0 起为 Y、256 起为 M，离散输入为 X，
+ * 保持/输入寄存器 0 起为 D。
+ */
+
+#ifndef __MODBUS_MAP_H__
+#define __MODBUS_MAP_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fx3u_image.h"
+
+#define MODBUS_MAP_MAX_REGIONS          16      /* 每张表的区段上限 */
+
+/* ===== 映射表 ===== */
+typedef enum {
+    MODBUS_MAP_COILS = 0,               /* FC01 / FC05 / FC0F */
+    MODBUS_MAP_DISCRETE_INPUTS = 1,     /* FC02 */
+    MODBUS_MAP_HOLDING_REGISTERS = 2,   /* FC03 / FC06 / FC10 / FC17 */
+    MODBUS_MAP_INPUT_REGISTERS = 3,     /* FC04 */
+    MODBUS_MAP_TABLE_COUNT = 4
+} modbus_map_table_t;
+
+/* ===== 区段属性 ===== */
+#define MODBUS_MAP_32BIT                0x01    /* 两个 MODBUS 地址组成一个 32 位值，默认低字在前 */
+#define MODBUS_MAP_WORD_SWAP            0x02    /* 与 32BIT 合用: 高字在前 */
+#define MODBUS_MAP_READ_ONLY            0x04    /* 拒绝写入 (触点区自动带此属性) */
+
+/* ===== 区段 ===== */
+typedef struct {
+    uint16_t start;                     /* MODBUS 起始地址 (0 起) */
+    uint16_t count;                     /* MODBUS 地址个数 (位或 16 位字) */
+    uint16_t device_start;              /* 软元件起始编号 (区域内下标，M8000 / D8000 记为 0) */
+    uint8_t area;                       /* fx3u_image_area_t */
+    uint8_t flags;                      /* MODBUS_MAP_* */
+} modbus_map_region_t;
+
+/*
+ * 映射表二进制镜像 (运行时下载):
+ *   重复若干段: [表号(1)][区段数(1)] + 区段数 x [起始(2) 个数(2) 软元件起始(2) 区域(1) 属性(1)]
+ *   多字节字段为大端，与 MODBUS 线格式一致。整个镜像校验通过后才替换，镜像中未出现的表保持不变。
+ */
+#define MODBUS_MAP_IMAGE_REGION_SIZE    8
+#define MODBUS_MAP_IMAGE_MAX_SIZE       (MODBUS_MAP_TABLE_COUNT * \
+                                         (2 + MODBUS_MAP_MAX_REGIONS * MODBUS_MAP_IMAGE_REGION_SIZE))
+
+/* ===== 变化查询结果 ===== */
+#define MODBUS_MAP_CHANGES_MORE         0x01    /* 条目已满，从 next 继续查询 (since 不变) */
+#define MODBUS_MAP_CHANGES_FULL         0x02    /* since 无效，范围内全部地址均被报告 */
+
+typedef struct {
+    uint32_t seq;                       /* 快照变化序号 */
+    uint16_t next;                      /* MORE 时下一次查询的起始地址 */
+    uint8_t count;                      /* 条目数，每条 [地址(2)][值(2)] 大端 */
+    uint8_t flags;
+} modbus_map_changes_t;
+
+/* 加载 */
+void modbus_map_load_defaults(void);
+bool modbus_map_load(modbus_map_table_t table, const modbus_map_region_t *regions,
+                     uint8_t count);
+bool modbus_map_load_image(const uint8_t *data, uint16_t length);
+uint16_t modbus_map_save_image(uint8_t *data, uint16_t max_length);
+
+/* 查询 */
+const modbus_map_region_t *modbus_map_find(modbus_map_table_t table, uint16_t address);
+const modbus_map_region_t *modbus_map_regions(modbus_map_table_t table, uint8_t *count);
+
+/* 访问 - 返回 0 表示成功，否则为 MODBUS 异常码 */
+uint8_t modbus_map_check(modbus_map_table_t table, uint16_t start, uint16_t quantity,
+                         bool write);
+uint8_t modbus_map_read_bits(modbus_map_table_t table, uint16_t start, uint16_t quantity,
+                             uint8_t *packed);
+uint8_t modbus_map_write_bits(modbus_map_table_t table, uint16_t start, uint16_t quantity,
+                              const uint8_t *packed);
+uint8_t modbus_map_read_registers(modbus_map_table_t table, uint16_t start, uint16_t quantity,
+                                  uint8_t *data);
+uint8_t modbus_map_write_registers(modbus_map_table_t table, uint16_t start, uint16_t quantity,
+                                   const uint8_t *data);
+
+/* 变化查询: 报告 since 之后变化的寄存器 (仅 D / D8000- 区段跟踪变化，其余区段每次都报告) */
+uint8_t modbus_map_read_changes(modbus_map_table_t table, uint16_t start, uint16_t quantity,
+                                uint32_t since, uint8_t max_entries, uint8_t *data,
+                                modbus_map_changes_t *result);
+
+#endif /* __MODBUS_MAP_H__ */
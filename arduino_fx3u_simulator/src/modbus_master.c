@@ -0,0 +1,427 @@
+/**
+ * MODBUS RTU 主站引擎实现
+ */
+
+#include "modbus_master.h"
+#include "pico/time.h"
+#include <string.h>
+
+#define MASTER_DEFAULT_TIMEOUT_US   100000  /* 响应超时 100ms */
+#define MASTER_DEFAULT_GAP_US       4000    /* 9600bps 下 t3.5 约 4ms */
+#define MASTER_DEFAULT_RETRIES      2
+
+static bool poll_entry_valid(const modbus_poll_entry_t *e);
+static uint16_t function_limit(uint8_t function);
+static void sort_poll_table(modbus_poll_entry_t *entries, uint8_t count);
+static modbus_slave_stats_t *slave_stats(modbus_master_t *master, uint8_t slave_id);
+static void start_transaction(modbus_master_t *master, uint64_t now);
+static void finish_transaction(modbus_master_t *master, modbus_master_result_t result);
+static void apply_block_response(modbus_master_t *master, const modbus_poll_block_t *block);
+static void extract_bits(uint8_t *dst, const uint8_t *src, uint16_t offset, uint16_t count);
+
+/**
+ * 初始化主站引擎
+ */
+void modbus_master_init(modbus_master_t *master, const modbus_master_transport_t *transport)
+{
+    if (!master) return;
+
+    memset(master, 0, sizeof(*master));
+    if (transport) {
+        master->transport = *transport;
+    }
+    master->timeout_us = MASTER_DEFAULT_TIMEOUT_US;
+    master->frame_gap_us = MASTER_DEFAULT_GAP_US;
+    master->max_retries = MASTER_DEFAULT_RETRIES;
+    master->state = MODBUS_IDLE;
+    master->active_block = -1;
+}
+
+/**
+ * 设置轮询表并合并相邻/重叠的范围
+ */
+bool modbus_master_set_poll_table(modbus_master_t *master,
+                                  const modbus_poll_entry_t *entries, uint8_t count)
+{
+    if (!master || (!entries && count > 0) || count > MODBUS_MASTER_MAX_POLLS) {
+        return false;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (!poll_entry_valid(&entries[i])) {
+            return false;
+        }
+    }
+
+    memcpy(master->polls, entries, (size_t)count * sizeof(modbus_poll_entry_t));
+    master->poll_count = count;
+    sort_poll_table(master->polls, count);
+
+    uint64_t now = time_us_64();
+    modbus_poll_block_t *block = NULL;
+    master->block_count = 0;
+
+    for (uint8_t i = 0; i < count; i++) {
+        const modbus_poll_entry_t *e = &master->polls[i];
+        uint32_t e_end = (uint32_t)e->address + e->quantity;
+        uint32_t period_us = e->period_ms * 1000u;
+
+        if (block && block->slave_id == e->slave_id && block->function == e->function) {
+            uint32_t b_end = (uint32_t)block->address + block->quantity;
+            uint32_t new_end = e_end > b_end ? e_end : b_end;
+            if (e->address <= b_end + MODBUS_MASTER_MAX_GAP &&
+                new_end - block->address <= function_limit(e->function)) {
+                block->quantity = (uint16_t)(new_end - block->address);
+                block->member_count++;
+                if (period_us < block->period_us) {
+                    block->period_us = period_us;
+                }
+                continue;
+            }
+        }
+
+        if (master->block_count >= MODBUS_MASTER_MAX_BLOCKS) {
+            master->block_count = 0;
+            master->poll_count = 0;
+            return false;
+        }
+        block = &master->blocks[master->block_count++];
+        block->slave_id = e->slave_id;
+        block->function = e->function;
+        block->address = e->address;
+        block->quantity = e->quantity;
+        block->period_us = period_us;
+        block->next_due_us = now;
+        block->first_member = i;
+        block->member_count = 1;
+    }
+
+    return true;
+}
+
+/**
+ * 主站轮询 - 在主循环中调用
+ */
+void modbus_master_poll(modbus_master_t *master)
+{
+    if (!master || !master->transport.send || !master->transport.receive) return;
+
+    uint64_t now = time_us_64();
+
+    if (master->state == MODBUS_WAIT_RESPONSE) {
+        uint16_t room = MODBUS_MASTER_FRAME_SIZE - master->rx_len;
+        int n = room ? master->transport.receive(&master->rx[master->rx_len], room) : 0;
+        if (n > 0) {
+            modbus_crc_feed(&master->rx_crc, &master->rx[master->rx_len], (uint16_t)n);
+            master->rx_len += (uint16_t)n;
+            master->last_rx_us = now;
+        }
+
+        bool complete = false;
+        if (master->rx_len >= 5 && (master->rx[1] & 0x80)) {
+            master->expected_len = 5;       /* 异常应答 */
+            complete = true;
+        } else if (master->expected_len) {
+            complete = master->rx_len >= master->expected_len;
+        } else if (master->rx_len >= 4) {
+            complete = now - master->last_rx_us >= master->frame_gap_us;
+        }
+
+        modbus_slave_stats_t *stats = slave_stats(master, master->tx[0]);
+        bool failed = false;
+
+        if (complete) {
+            bool crc_ok = (master->expected_len == 0 ||
+                           master->rx_len == master->expected_len) &&
+                          modbus_crc_frame_ok(&master->rx_crc);
+            bool match = master->rx[0] == master->tx[0] &&
+                         (master->rx[1] & 0x7F) == master->tx[1];
+
+            if (crc_ok && match) {
+                uint32_t latency = (uint32_t)(now - master->sent_us);
+                if (stats) {
+                    stats->responses++;
+                    stats->last_latency_us = latency;
+                    if (latency < stats->min_latency_us) stats->min_latency_us = latency;
+                    if (latency > stats->max_latency_us) stats->max_latency_us = latency;
+                    stats->avg_latency_us = stats->avg_latency_us
+                        ? stats->avg_latency_us - (stats->avg_latency_us >> 3) + (latency >> 3)
+                        : latency;
+                }
+                if (master->rx[1] & 0x80) {
+                    if (stats) stats->exceptions++;
+                    finish_transaction(master, MODBUS_MASTER_EXCEPTION);
+                } else {
+                    finish_transaction(master, MODBUS_MASTER_OK);
+                }
+                return;
+            }
+
+            /* 校验失败或应答错位: 视同未应答，按重试策略处理 */
+            if (stats && !crc_ok) stats->crc_errors++;
+            failed = true;
+        }
+
+        if (failed || now - master->sent_us >= master->timeout_us) {
+            if (master->retries_left > 0) {
+                master->retries_left--;
+                if (stats) {
+                    stats->retries++;
+                    stats->requests++;
+                }
+                master->rx_len = 0;
+                modbus_crc_begin(&master->rx_crc);
+                master->transport.send(master->tx, master->tx_len);
+                master->sent_us = time_us_64();
+                master->last_rx_us = master->sent_us;
+            } else {
+                if (stats && !failed) stats->timeouts++;
+                finish_transaction(master, failed ? MODBUS_MASTER_BAD_RESPONSE
+                                                  : MODBUS_MASTER_TIMEOUT);
+            }
+        }
+        return;
+    }
+
+    /* 空闲: 选择最早到期的请求块 */
+    int16_t best = -1;
+    for (uint8_t i = 0; i < master->block_count; i++) {
+        const modbus_poll_block_t *b = &master->blocks[i];
+        if (b->next_due_us > now) continue;
+        if (best < 0 || b->next_due_us < master->blocks[best].next_due_us) {
+            best = i;
+        }
+    }
+    if (best < 0) return;
+
+    modbus_poll_block_t *block = &master->blocks[best];
+    block->next_due_us += block->period_us;
+    if (block->next_due_us <= now) {
+        /* 落后超过一个周期时不追赶，避免总线被积压请求占满 */
+        block->next_due_us = now + block->period_us;
+    }
+
+    master->tx[0] = block->slave_id;
+    master->tx[1] = block->function;
+    master->tx[2] = (block->address >> 8) & 0xFF;
+    master->tx[3] = block->address & 0xFF;
+    master->tx[4] = (block->quantity >> 8) & 0xFF;
+    master->tx[5] = block->quantity & 0xFF;
+    uint16_t crc = modbus_crc16(master->tx, 6);
+    master->tx[6] = crc & 0xFF;
+    master->tx[7] = (crc >> 8) & 0xFF;
+    master->tx_len = 8;
+    master->active_block = best;
+    master->callback = NULL;
+    master->callback_user = NULL;
+
+    start_transaction(master, now);
+}
+
+/**
+ * 主站是否空闲
+ */
+bool modbus_master_is_idle(const modbus_master_t *master)
+{
+    return master && master->state != MODBUS_WAIT_RESPONSE;
+}
+
+/**
+ * 提交外部事务 (原样转发请求帧，需含CRC)
+ */
+bool modbus_master_submit(modbus_master_t *master, const uint8_t *request, uint16_t length,
+                          modbus_master_callback_t callback, void *user)
+{
+    if (!master || !request || length < 4 || length > MODBUS_MASTER_FRAME_SIZE) {
+        return false;
+    }
+    if (!modbus_master_is_idle(master) || !master->transport.send) {
+        return false;
+    }
+
+    memcpy(master->tx, request, length);
+    master->tx_len = length;
+    master->active_block = -1;
+    master->callback = callback;
+    master->callback_user = user;
+
+    start_transaction(master, time_us_64());
+    return true;
+}
+
+/**
+ * 根据请求推算正常响应长度
+ */
+uint16_t modbus_expected_response_length(const uint8_t *request, uint16_t length)
+{
+    if (!request || length < 6) return 0;
+
+    uint16_t quantity = ((uint16_t)request[4] << 8) | request[5];
+
+    switch (request[1]) {
+        case MODBUS_READ_COIL_STATUS:
+        case MODBUS_READ_INPUT_STATUS:
+            return (uint16_t)(5 + (quantity + 7) / 8);
+        case MODBUS_READ_HOLDING_REGISTERS:
+        case MODBUS_READ_INPUT_REGISTERS:
+        case MODBUS_READ_WRITE_MULTIPLE_REGISTERS:
+            return (uint16_t)(5 + quantity * 2);
+        case MODBUS_WRITE_SINGLE_COIL:
+        case MODBUS_WRITE_SINGLE_REGISTER:
+        case MODBUS_WRITE_MULTIPLE_COILS:
+        case MODBUS_WRITE_MULTIPLE_REGISTERS:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * 获取从站统计
+ */
+const modbus_slave_stats_t *modbus_master_get_stats(const modbus_master_t *master,
+                                                    uint8_t slave_id)
+{
+    if (!master) return NULL;
+    for (uint8_t i = 0; i < master->slave_count; i++) {
+        if (master->slaves[i].slave_id == slave_id) {
+            return &master->slaves[i];
+        }
+    }
+    return NULL;
+}
+
+static void start_transaction(modbus_master_t *master, uint64_t now)
+{
+    modbus_slave_stats_t *stats = slave_stats(master, master->tx[0]);
+    if (stats) stats->requests++;
+
+    master->expected_len = modbus_expected_response_length(master->tx, master->tx_len);
+    master->rx_len = 0;
+    modbus_crc_begin(&master->rx_crc);
+    master->retries_left = master->max_retries;
+    master->state = MODBUS_WAIT_RESPONSE;
+
+    master->transport.send(master->tx, master->tx_len);
+    master->sent_us = now;
+    master->last_rx_us = now;
+}
+
+static void finish_transaction(modbus_master_t *master, modbus_master_result_t result)
+{
+    master->state = result == MODBUS_MASTER_OK ? MODBUS_IDLE : MODBUS_ERROR;
+
+    if (result == MODBUS_MASTER_OK && master->active_block >= 0) {
+        apply_block_response(master, &master->blocks[master->active_block]);
+    }
+    if (master->callback) {
+        modbus_master_callback_t cb = master->callback;
+        master->callback = NULL;
+        cb(master->callback_user, result, master->rx, master->rx_len);
+    }
+    master->active_block = -1;
+}
+
+/* 将合并请求的响应拆分回各轮询项并写入过程映像 */
+static void apply_block_response(modbus_master_t *master, const modbus_poll_block_t *block)
+{
+    const uint8_t *data = &master->rx[3];
+
+    for (uint8_t k = 0; k < block->member_count; k++) {
+        const modbus_poll_entry_t *e = &master->polls[block->first_member + k];
+        uint16_t offset = e->address - block->address;
+
+        if (e->function == MODBUS_READ_HOLDING_REGISTERS ||
+            e->function == MODBUS_READ_INPUT_REGISTERS) {
+            int16_t values[MODBUS_MAX_READ_REGISTERS];
+            for (uint16_t i = 0; i < e->quantity; i++) {
+                const uint8_t *p = &data[(offset + i) * 2];
+                values[i] = (int16_t)(((uint16_t)p[0] << 8) | p[1]);
+            }
+            fx3u_image_queue_registers(e->local_address, values, e->quantity);
+        } else {
+            uint8_t bits[(MODBUS_MASTER_MAX_READ_BITS + 7) / 8];
+            extract_bits(bits, data, offset, e->quantity);
+            fx3u_image_queue_bits(e->local_area, e->local_address, bits, e->quantity);
+        }
+    }
+}
+
+/* 按字节移位拼接，起始位不对齐时每个输出字节取相邻两个输入字节 */
+static void extract_bits(uint8_t *dst, const uint8_t *src, uint16_t offset, uint16_t count)
+{
+    uint16_t bytes = (count + 7) / 8;
+    const uint8_t *in = &src[offset >> 3];
+    uint8_t shift = offset & 7;
+
+    for (uint16_t i = 0; i < bytes; i++) {
+        uint16_t pair = in[i];
+        if (shift && (i + 1) * 8 < count + shift) {
+            pair |= (uint16_t)in[i + 1] << 8;
+        }
+        dst[i] = (uint8_t)(pair >> shift);
+    }
+    if (count & 7) {
+        dst[bytes - 1] &= (uint8_t)((1u << (count & 7)) - 1u);
+    }
+}
+
+static bool poll_entry_valid(const modbus_poll_entry_t *e)
+{
+    uint16_t limit = function_limit(e->function);
+    if (limit == 0 || e->quantity == 0 || e->quantity > limit || e->period_ms == 0) {
+        return false;
+    }
+    bool is_register = e->function == MODBUS_READ_HOLDING_REGISTERS ||
+                       e->function == MODBUS_READ_INPUT_REGISTERS;
+    return is_register == (e->local_area == FX3U_IMAGE_D);
+}
+
+static uint16_t function_limit(uint8_t function)
+{
+    switch (function) {
+        case MODBUS_READ_COIL_STATUS:
+        case MODBUS_READ_INPUT_STATUS:
+            return MODBUS_MASTER_MAX_READ_BITS;
+        case MODBUS_READ_HOLDING_REGISTERS:
+        case MODBUS_READ_INPUT_REGISTERS:
+            return MODBUS_MAX_READ_REGISTERS;
+        default:
+            return 0;
+    }
+}
+
+/* 按 (从站, 功能码, 地址) 排序，插入排序足以应对表的规模 */
+static void sort_poll_table(modbus_poll_entry_t *entries, uint8_t count)
+{
+    for (uint8_t i = 1; i < count; i++) {
+        modbus_poll_entry_t key = entries[i];
+        int j = i - 1;
+        while (j >= 0) {
+            const modbus_poll_entry_t *p = &entries[j];
+            bool greater = p->slave_id != key.slave_id ? p->slave_id > key.slave_id :
+                           p->function != key.function ? p->function > key.function :
+                           p->address > key.address;
+            if (!greater) break;
+            entries[j + 1] = entries[j];
+            j--;
+        }
+        entries[j + 1] = key;
+    }
+}
+
+static modbus_slave_stats_t *slave_stats(modbus_master_t *master, uint8_t slave_id)
+{
+    for (uint8_t i = 0; i < master->slave_count; i++) {
+        if (master->slaves[i].slave_id == slave_id) {
+            return &master->slaves[i];
+        }
+    }
+    if (master->slave_count >= MODBUS_MASTER_MAX_SLAVES) {
+        return NULL;
+    }
+    modbus_slave_stats_t *stats = &master->slaves[master->slave_count++];
+    memset(stats, 0, sizeof(*stats));
+    stats->slave_id = slave_id;
+    stats->min_latency_us = UINT32_MAX;
+    return stats;
+}
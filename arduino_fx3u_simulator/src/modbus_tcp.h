@@ -0,0 +1,66 @@
+/**
+ * MODBUS TCP 服务端 (MBAP)
+ *
+ * - 每个以太网 socket 承载一个客户端连接，最多 ETH_MAX_SOCKETS 个并发
+ * - 同一连接上可有多个未应答事务 (流水线)，按到达顺序处理，
+ *   本次轮询产生的响应合并为一次发送
+ * - PDU 处理与 RTU 从站共用 modbus_slave_process_pdu，数据来自过程映像
+ */
+
+#ifndef __MODBUS_TCP_H__
+#define __MODBUS_TCP_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fx3u_core.h"
+#include "ethernet_adapter.h"
+
+#define MODBUS_TCP_PORT                 502
+#define MODBUS_TCP_MAX_CONNECTIONS      ETH_MAX_SOCKETS
+#define MODBUS_TCP_MBAP_SIZE            7       /* 事务(2) 协议(2) 长度(2) 单元(1) */
+#define MODBUS_TCP_MAX_ADU              260     /* MBAP + 最大 PDU (253) */
+#define MODBUS_TCP_RX_BUFFER_SIZE       (MODBUS_TCP_MAX_ADU * 2)
+#define MODBUS_TCP_IDLE_TIMEOUT_MS      60000   /* 空闲连接回收，释放稀缺的 socket */
+
+/* ===== 单个连接 ===== */
+typedef struct {
+    ethernet_socket_state_t state;
+    uint8_t rx[MODBUS_TCP_RX_BUFFER_SIZE];
+    uint16_t rx_len;
+    uint64_t last_activity_us;
+    uint32_t generation;            /* 每接受一个新连接加一，用于丢弃过期的异步应答 */
+    uint32_t requests;
+    uint32_t errors;                /* MBAP 头非法，连接被断开 */
+} modbus_tcp_conn_t;
+
+struct modbus_gateway;
+
+/* ===== 服务端 ===== */
+typedef struct {
+    fx3u_core_t *plc;
+    uint16_t port;
+    uint8_t unit_id;                /* 本机单元标识，0 与 0xFF 亦视为本机 */
+    uint32_t idle_timeout_ms;
+    struct modbus_gateway *gateway; /* 非空时非本机单元的请求交由网关转发 */
+
+    modbus_tcp_conn_t conns[MODBUS_TCP_MAX_CONNECTIONS];
+    uint8_t tx[MODBUS_TCP_MAX_ADU];
+
+    uint32_t accepted;
+    uint32_t requests;
+    uint16_t max_pipeline;          /* 单次轮询在一个连接上处理的最多请求数 */
+} modbus_tcp_server_t;
+
+void modbus_tcp_server_init(modbus_tcp_server_t *server, fx3u_core_t *plc,
+                            uint16_t port, uint8_t unit_id);
+void modbus_tcp_server_poll(modbus_tcp_server_t *server);
+uint8_t modbus_tcp_server_connections(const modbus_tcp_server_t *server);
+
+/* 异步应答 (网关): 连接仍为同一代次时写入并发送 */
+uint32_t modbus_tcp_server_generation(const modbus_tcp_server_t *server, uint8_t socket);
+bool modbus_tcp_server_is_current(const modbus_tcp_server_t *server, uint8_t socket,
+                                  uint32_t generation);
+bool modbus_tcp_server_deliver(modbus_tcp_server_t *server, uint8_t socket,
+                               uint32_t generation, const uint8_t *response, uint16_t length);
+
+#endif /* __MODBUS_TCP_H__ */
@@ -73,3 +73,100 @@ int rs485_receive(uint8_t *buffer, uint16_t max_len)
     
     return count;
 }
+
+/* ===== 帧间隔 ===== */
+
+#define RS485_FIXED_GAP_BAUDRATE    19200
+#define RS485_FIXED_T15_US          750
+#define RS485_FIXED_T35_US          1750
+
+/**
+ * 一个字符的传输时间 (us，向上取整)
+ */
+uint32_t rs485_char_time_us(const rs485_config_t *config)
+{
+    if (!config || config->baudrate == 0) return 0;
+
+    uint32_t data_bits = config->data_bits ? config->data_bits : 8;
+    uint32_t stop_bits = config->stop_bits ? config->stop_bits : 1;
+    uint32_t bits = 1 + data_bits + (config->parity ? 1 : 0) + stop_bits;
+    return (bits * 1000000u + config->baudrate - 1) / config->baudrate;
+}
+
+/**
+ * 帧间静默 t3.5: 超过即为帧结束
+ */
+uint32_t rs485_frame_gap_us(const rs485_config_t *config)
+{
+    if (config && config->baudrate > RS485_FIXED_GAP_BAUDRATE) return RS485_FIXED_T35_US;
+    return (rs485_char_time_us(config) * 7 + 1) / 2;
+}
+
+/**
+ * 字符间静默 t1.5: 帧内字符的最大间隔
+ */
+uint32_t rs485_char_gap_us(const rs485_config_t *config)
+{
+    if (config && config->baudrate > RS485_FIXED_GAP_BAUDRATE) return RS485_FIXED_T15_US;
+    return (rs485_char_time_us(config) * 3 + 1) / 2;
+}
+
+/* ===== RTU 帧接收 ===== */
+
+void rs485_frame_init(rs485_frame_t *frame, uint8_t *buffer, uint16_t size, uint32_t gap_us)
+{
+    if (!frame) return;
+
+    frame->buffer = buffer;
+    frame->size = size;
+    frame->gap_us = gap_us;
+    rs485_frame_reset(frame);
+    rs485_set_receive_mode();
+}
+
+void rs485_frame_reset(rs485_frame_t *frame)
+{
+    if (!frame) return;
+
+    frame->length = 0;
+    frame->overflow = false;
+    frame->last_rx_us = 0;
+    modbus_crc_begin(&frame->crc);
+}
+
+/**
+ * 收取 FIFO 中的字节并判定帧结束
+ *
+ * 到达时刻取收取时刻 (晚于实际到达)，量得的静默只会偏短，帧内不会被误切；
+ * 帧结束最迟在 t3.5 之后一个轮询周期交付。
+ */
+uint16_t rs485_frame_poll(rs485_frame_t *frame)
+{
+    if (!frame || !frame->buffer) return 0;
+
+    uint64_t now = time_us_64();
+    bool received = false;
+    while (uart_is_readable(uart0)) {
+        uint8_t byte = (uint8_t)uart_getc(uart0);
+        received = true;
+        if (frame->length < frame->size) {
+            frame->buffer[frame->length++] = byte;
+            modbus_crc_feed_byte(&frame->crc, byte);
+        } else {
+            frame->overflow = true;
+        }
+    }
+
+    if (received) {
+        frame->last_rx_us = now;
+        return 0;
+    }
+    if (frame->length == 0 || now - frame->last_rx_us < frame->gap_us) {
+        return 0;
+    }
+    if (frame->overflow) {
+        rs485_frame_reset(frame);
+        return 0;
+    }
+    return frame->length;
+}
@@ -1,31 +1,364 @@
 /**
  * 定时器实现（基于 Pico SDK）
+ *
+ * 槽位表 + 按到期时刻排序的最小堆 (存槽位号，槽位记录自己在堆中的位置，取消时原地删除)。
+ * 堆的修改都在关中断区内完成，任务上下文与 alarm 中断可以同时启动 / 取消定时器。
+ * 硬件 alarm 设为堆顶时刻；设置时已过期则立即在当前中断中继续处理。
  */
 
 #include "timer.h"
 #include "pico/stdlib.h"
 #include "pico/time.h"
 #include "hardware/timer.h"
+#include "hardware/sync.h"
+#include <string.h>
 
-static timer_config_t *g_timer_config = NULL;
-static struct repeating_timer g_repeating_timer;
+typedef struct {
+    uint64_t deadline_us;
+    uint32_t period_us;                 /* 0 = 单次 */
+    timer_callback_t callback;
+    void *arg;
+    uint8_t context;
+    bool active;
+    uint8_t heap_pos;
+    uint16_t generation;
+} timer_slot_t;
+
+static timer_slot_t g_slots[TIMER_MAX_TIMERS];
+static uint8_t g_heap[TIMER_MAX_TIMERS];
+static uint8_t g_heap_size = 0;
+static volatile uint32_t g_pending = 0;         /* bit n: 槽位 n 的 TASK 回调待执行 */
+static void (*g_notify)(void) = NULL;
+static timer_service_stats_t g_stats;
 static uint64_t g_timer_ticks = 0;
 
-static bool timer_callback_adapter(repeating_timer_t *rt)
+_Static_assert(TIMER_MAX_TIMERS <= 32, "pending mask is one word");
+
+/* ===== 时基与硬件 alarm ===== */
+
+#if PICO_ON_DEVICE
+static int g_alarm = -1;
+
+static void service_expired(void);
+
+static void alarm_callback(uint alarm_num)
+{
+    (void)alarm_num;
+    service_expired();
+}
+
+static inline uint64_t now_us(void)
 {
-    (void)rt;
-    
-    if (!g_timer_config || !g_timer_config->is_running) {
-        return false;
+    return time_us_64();
+}
+
+static void hw_init(void)
+{
+    if (g_alarm >= 0) return;
+    g_alarm = hardware_alarm_claim_unused(true);
+    hardware_alarm_set_callback((uint)g_alarm, alarm_callback);
+}
+
+/* 返回 false 表示时刻已过，需要立即处理 */
+static bool hw_arm(uint64_t at_us)
+{
+    return !hardware_alarm_set_target((uint)g_alarm, from_us_since_boot(at_us));
+}
+
+static void hw_disarm(void)
+{
+    hardware_alarm_cancel((uint)g_alarm);
+}
+#else
+/* 主机构建: 虚拟时钟，只由 timer_sim_advance 推进 */
+static uint64_t g_virtual_us = 0;
+
+static inline uint64_t now_us(void)
+{
+    return g_virtual_us;
+}
+
+static void hw_init(void) {}
+static bool hw_arm(uint64_t at_us) { return at_us > g_virtual_us; }
+static void hw_disarm(void) {}
+#endif
+
+/* ===== 最小堆 ===== */
+
+static inline uint64_t key(uint8_t pos)
+{
+    return g_slots[g_heap[pos]].deadline_us;
+}
+
+static inline void heap_set(uint8_t pos, uint8_t slot)
+{
+    g_heap[pos] = slot;
+    g_slots[slot].heap_pos = pos;
+}
+
+static void sift_up(uint8_t pos)
+{
+    uint8_t slot = g_heap[pos];
+    uint64_t k = g_slots[slot].deadline_us;
+    while (pos > 0) {
+        uint8_t parent = (uint8_t)((pos - 1) / 2);
+        if (key(parent) <= k) break;
+        heap_set(pos, g_heap[parent]);
+        pos = parent;
+    }
+    heap_set(pos, slot);
+}
+
+static void sift_down(uint8_t pos)
+{
+    uint8_t slot = g_heap[pos];
+    uint64_t k = g_slots[slot].deadline_us;
+    for (;;) {
+        uint8_t child = (uint8_t)(pos * 2 + 1);
+        if (child >= g_heap_size) break;
+        if (child + 1 < g_heap_size && key(child + 1) < key(child)) child++;
+        if (key(child) >= k) break;
+        heap_set(pos, g_heap[child]);
+        pos = child;
+    }
+    heap_set(pos, slot);
+}
+
+static void heap_push(uint8_t slot)
+{
+    heap_set(g_heap_size, slot);
+    sift_up(g_heap_size++);
+}
+
+static void heap_remove(uint8_t slot)
+{
+    uint8_t pos = g_slots[slot].heap_pos;
+    uint8_t last = g_heap[--g_heap_size];
+    if (pos == g_heap_size) return;
+
+    heap_set(pos, last);
+    if (pos > 0 && key((uint8_t)((pos - 1) / 2)) > g_slots[last].deadline_us) {
+        sift_up(pos);
+    } else {
+        sift_down(pos);
     }
-    
+}
+
+/* 堆顶变化后重设 alarm (关中断调用)；堆顶已过期返回 false */
+static bool rearm(void)
+{
+    if (!g_heap_size) {
+        hw_disarm();
+        return true;
+    }
+    return hw_arm(key(0));
+}
+
+/* ===== 到期处理 ===== */
+
+/**
+ * 处理全部已到期的定时器 (alarm 中断 / 虚拟时钟推进)
+ */
+static void service_expired(void)
+{
+    for (;;) {
+        uint32_t ints = save_and_disable_interrupts();
+        uint64_t now = now_us();
+        if (!g_heap_size || key(0) > now) {
+            bool armed = rearm();
+            restore_interrupts(ints);
+            if (armed) return;
+            continue;
+        }
+
+        uint8_t slot = g_heap[0];
+        timer_slot_t *t = &g_slots[slot];
+        uint32_t late = (uint32_t)(now - t->deadline_us);
+        if (late > g_stats.max_late_us) g_stats.max_late_us = late;
+        g_stats.fired++;
+
+        heap_remove(slot);
+        if (t->period_us) {
+            /* 绝对周期: 在原到期时刻上累加，落后时跳到下一个未来的整周期 */
+            t->deadline_us += t->period_us;
+            if (t->deadline_us <= now) {
+                uint64_t skip = (now - t->deadline_us) / t->period_us + 1;
+                t->deadline_us += skip * t->period_us;
+                g_stats.missed += (uint32_t)skip;
+            }
+            heap_push(slot);
+        } else {
+            t->active = false;
+            g_stats.active--;
+        }
+
+        timer_callback_t callback = t->callback;
+        void *arg = t->arg;
+        bool deferred = t->context == TIMER_CONTEXT_TASK;
+        if (deferred) {
+            uint32_t bit = 1u << slot;
+            if (g_pending & bit) {
+                g_stats.coalesced++;
+            }
+            g_pending |= bit;
+            g_stats.deferred++;
+        }
+        restore_interrupts(ints);
+
+        /* 回调内可以启动 / 取消定时器 */
+        if (!deferred) {
+            callback(arg);
+        } else if (g_notify) {
+            g_notify();
+        }
+    }
+}
+
+static timer_handle_t add_timer(uint64_t deadline_us, uint32_t period_us, timer_callback_t callback,
+                                void *arg, timer_context_t context)
+{
+    if (!callback) return 0;
+    hw_init();
+
+    uint32_t ints = save_and_disable_interrupts();
+    for (uint8_t i = 0; i < TIMER_MAX_TIMERS; i++) {
+        timer_slot_t *t = &g_slots[i];
+        if (t->active || (g_pending & (1u << i))) continue;
+
+        t->deadline_us = deadline_us;
+        t->period_us = period_us;
+        t->callback = callback;
+        t->arg = arg;
+        t->context = (uint8_t)context;
+        t->active = true;
+        if (++t->generation == 0) t->generation = 1;
+        heap_push(i);
+        g_stats.active++;
+
+        bool armed = rearm();
+        restore_interrupts(ints);
+        if (!armed) service_expired();
+        return ((timer_handle_t)t->generation << 8) | i;
+    }
+    restore_interrupts(ints);
+    return 0;
+}
+
+/* 句柄对应的槽位 (已失效返回 NULL) */
+static timer_slot_t *lookup(timer_handle_t handle, uint8_t *slot)
+{
+    uint8_t i = (uint8_t)(handle & 0xFF);
+    if (!handle || i >= TIMER_MAX_TIMERS) return NULL;
+    timer_slot_t *t = &g_slots[i];
+    if (!t->generation || t->generation != (uint16_t)(handle >> 8)) return NULL;
+    *slot = i;
+    return t;
+}
+
+/* ===== 定时器服务接口 ===== */
+
+timer_handle_t timer_add_oneshot(uint32_t delay_us, timer_callback_t callback, void *arg,
+                                 timer_context_t context)
+{
+    return add_timer(now_us() + delay_us, 0, callback, arg, context);
+}
+
+timer_handle_t timer_add_periodic(uint32_t period_us, timer_callback_t callback, void *arg,
+                                  timer_context_t context)
+{
+    if (!period_us) return 0;
+    return add_timer(now_us() + period_us, period_us, callback, arg, context);
+}
+
+timer_handle_t timer_add_at(uint64_t at_us, timer_callback_t callback, void *arg,
+                            timer_context_t context)
+{
+    return add_timer(at_us, 0, callback, arg, context);
+}
+
+bool timer_cancel(timer_handle_t handle)
+{
+    uint8_t slot;
+    uint32_t ints = save_and_disable_interrupts();
+    timer_slot_t *t = lookup(handle, &slot);
+    bool was_active = t && t->active;
+    if (t) {
+        g_pending &= ~(1u << slot);
+        if (t->active) {
+            t->active = false;
+            g_stats.active--;
+            bool top = t->heap_pos == 0;
+            heap_remove(slot);
+            if (top) rearm();
+        }
+    }
+    restore_interrupts(ints);
+    return was_active;
+}
+
+bool timer_is_active(timer_handle_t handle)
+{
+    uint8_t slot;
+    timer_slot_t *t = lookup(handle, &slot);
+    return t && t->active;
+}
+
+void timer_service_set_notify(void (*notify)(void))
+{
+    g_notify = notify;
+}
+
+/**
+ * 任务上下文: 执行已到期的 TASK 回调 (每个槽位一次，合并的到期只执行一次)
+ */
+void timer_service_poll(void)
+{
+    while (g_pending) {
+        uint32_t ints = save_and_disable_interrupts();
+        uint32_t pending = g_pending;
+        uint8_t slot = (uint8_t)__builtin_ctz(pending);
+        g_pending = pending & ~(1u << slot);
+        timer_callback_t callback = g_slots[slot].callback;
+        void *arg = g_slots[slot].arg;
+        restore_interrupts(ints);
+
+        callback(arg);
+    }
+}
+
+uint64_t timer_now_us(void)
+{
+    return now_us();
+}
+
+void timer_service_get_stats(timer_service_stats_t *stats)
+{
+    if (stats) *stats = g_stats;
+}
+
+#if !PICO_ON_DEVICE
+void timer_sim_advance(uint64_t us)
+{
+    uint64_t end = g_virtual_us + us;
+    while (g_heap_size && key(0) <= end) {
+        if (key(0) > g_virtual_us) g_virtual_us = key(0);
+        service_expired();
+    }
+    g_virtual_us = end;
+}
+#endif
+
+/* ===== 周期扫描定时器 (兼容接口) ===== */
+
+static void config_callback_adapter(void *arg)
+{
+    timer_config_t *config = (timer_config_t *)arg;
+    if (!config->is_running) return;
+
     g_timer_ticks++;
-    
-    if (g_timer_config->callback) {
-        g_timer_config->callback();
+    if (config->callback) {
+        config->callback();
     }
-    
-    return g_timer_config->is_running;
 }
 
 /**
@@ -34,28 +367,28 @@ static bool timer_callback_adapter(repeating_timer_t *rt)
 void timer_init(timer_config_t *config)
 {
     if (!config) return;
-    
-    g_timer_config = config;
+
     g_timer_ticks = 0;
     config->is_running = false;
+    config->handle = 0;
 }
 
 /**
- * 启动定时器（在本实现中为占位符，使用主循环的定时方式）
+ * 启动定时器: 在 alarm 中断中按绝对周期回调
  */
 void timer_start(timer_config_t *config)
 {
     if (!config || config->period_us == 0 || !config->callback) {
         return;
     }
-    
+
     timer_stop(config);
-    
-    bool ok = add_repeating_timer_us((int64_t)(-((int64_t)config->period_us)),
-                                     timer_callback_adapter, NULL,
-                                     &g_repeating_timer);
-    if (ok) {
-        config->is_running = true;
+
+    config->is_running = true;
+    config->handle = timer_add_periodic(config->period_us, config_callback_adapter, config,
+                                        TIMER_CONTEXT_IRQ);
+    if (!config->handle) {
+        config->is_running = false;
     }
 }
 
@@ -65,8 +398,9 @@ void timer_start(timer_config_t *config)
 void timer_stop(timer_config_t *config)
 {
     if (!config) return;
-    if (config->is_running) {
-        cancel_repeating_timer(&g_repeating_timer);
+    if (config->handle) {
+        timer_cancel(config->handle);
+        config->handle = 0;
     }
     config->is_running = false;
 }
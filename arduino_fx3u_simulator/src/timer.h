@@ -1,5 +1,16 @@
 /**
  * 定时器管理
+ *
+ * 软件定时器服务: 任意多个单次 / 周期定时器共用一个硬件 alarm，
+ * 到期时刻按绝对时间保存在最小堆中 (启动 / 取消 O(log n))，alarm 始终指向堆顶。
+ * 周期定时器的下次到期 = 上次到期 + 周期，不随回调延迟漂移；
+ * 落后超过一个周期时跳到下一个未过去的整周期，跳过的次数计入 missed。
+ *
+ * 回调可以在 alarm 中断中执行 (TIMER_CONTEXT_IRQ)，也可以延迟到任务上下文
+ * (TIMER_CONTEXT_TASK): 中断只置待执行标志并调用通知函数，由 timer_service_poll() 执行。
+ *
+ * 主机构建 (PICO_ON_DEVICE == 0) 没有硬件 alarm，定时器运行在虚拟时钟上，
+ * 由 timer_sim_advance() 推进，到期按时间顺序逐个触发。
  */
 
 #ifndef __TIMER_H__
@@ -8,10 +19,33 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#define TIMER_MAX_TIMERS        32
+
+typedef enum {
+    TIMER_CONTEXT_IRQ = 0,              /* alarm 中断中直接回调 */
+    TIMER_CONTEXT_TASK = 1              /* 延迟到 timer_service_poll() */
+} timer_context_t;
+
+typedef void (*timer_callback_t)(void *arg);
+
+/* 定时器句柄: 槽位 + 代数，槽位复用后旧句柄失效；0 为无效 */
+typedef uint32_t timer_handle_t;
+
+typedef struct {
+    uint32_t fired;                     /* 到期次数 */
+    uint32_t missed;                    /* 周期定时器落后跳过的周期 */
+    uint32_t deferred;                  /* 延迟到任务上下文的到期 */
+    uint32_t coalesced;                 /* 任务上下文执行前重复到期被合并 */
+    uint32_t max_late_us;               /* 到期时刻到中断处理的最大延迟 */
+    uint8_t active;                     /* 当前运行的定时器数 */
+} timer_service_stats_t;
+
+/* 周期扫描定时器 (兼容接口，基于定时器服务) */
 typedef struct {
     uint32_t period_us;
     void (*callback)(void);
     bool is_running;
+    timer_handle_t handle;
 } timer_config_t;
 
 void timer_init(timer_config_t *config);
@@ -20,4 +54,30 @@ void timer_stop(timer_config_t *config);
 uint64_t timer_get_ticks(void);
 void timer_delay_ms(uint32_t ms);
 
+/* ===== 定时器服务 ===== */
+
+/* delay_us 后到期一次；定时器表满返回 0 */
+timer_handle_t timer_add_oneshot(uint32_t delay_us, timer_callback_t callback, void *arg,
+                                 timer_context_t context);
+/* 每 period_us 到期一次，首次在一个周期之后 */
+timer_handle_t timer_add_periodic(uint32_t period_us, timer_callback_t callback, void *arg,
+                                  timer_context_t context);
+/* 在绝对时刻 at_us 到期一次 (timer_now_us 时基) */
+timer_handle_t timer_add_at(uint64_t at_us, timer_callback_t callback, void *arg,
+                            timer_context_t context);
+/* 取消后回调不会再执行 (包括已到期尚未在任务上下文执行的) */
+bool timer_cancel(timer_handle_t handle);
+bool timer_is_active(timer_handle_t handle);
+
+/* TASK 上下文回调有待执行时在中断中调用 (如置任务就绪)，可为 NULL */
+void timer_service_set_notify(void (*notify)(void));
+/* 任务上下文调用: 执行已到期的 TASK 回调 */
+void timer_service_poll(void);
+
+uint64_t timer_now_us(void);            /* 定时器服务的时基 (主机构建为虚拟时钟) */
+void timer_service_get_stats(timer_service_stats_t *stats);
+
+/* 推进虚拟时钟 (仅主机构建 PICO_ON_DEVICE == 0)，期间到期的定时器按顺序触发 */
+void timer_sim_advance(uint64_t us);
+
 #endif
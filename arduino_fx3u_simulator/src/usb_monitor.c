@@ -0,0 +1,647 @@
+/**
+ * USB 二进制监视协议实现
+ *
+ * 全部工作在主循环中完成: 读取来自过程映像快照，写入与强制在下一扫描生效，
+ * 扫描中断中没有任何监视相关代码。发送缓冲不足时暂停解析请求，
+ * 上位机发得再快也不会丢应答；趋势与日志则直接丢弃并计数。
+ */
+
+#include "usb_monitor.h"
+#include "fx3u_profile.h"
+#include "modbus_crc.h"
+#include "logger.h"
+#include "pico/stdlib.h"
+#include <string.h>
+#include <stdio.h>
+
+#if PICO_ON_DEVICE
+#include "tusb.h"
+#endif
+
+#define TX_MASK     (USB_MONITOR_TX_BUFFER - 1)
+
+static uint8_t g_reply[USB_MONITOR_MAX_PAYLOAD];
+static fx3u_image_write_t g_write_batch[USB_MONITOR_WRITE_MAX * 2];
+static usb_monitor_t *g_log_monitor = NULL;
+
+#define PROFILE_ENTRY_SIZE  18          /* 编号(2) 次数(4) 累计(8) 最大(4) */
+static fx3u_profile_entry_t g_profile_entries[(USB_MONITOR_MAX_PAYLOAD - 4) / PROFILE_ENTRY_SIZE];
+
+/* ===== 默认传输: USB CDC ===== */
+
+#if PICO_ON_DEVICE
+static int cdc_read(uint8_t *buffer, uint16_t max_len)
+{
+    if (!tud_cdc_available()) return 0;
+    return (int)tud_cdc_read(buffer, max_len);
+}
+
+static int cdc_write(const uint8_t *buffer, uint16_t length)
+{
+    uint32_t n = tud_cdc_write_available();
+    if (n > length) n = length;
+    if (n == 0) return 0;
+
+    n = tud_cdc_write(buffer, n);
+    tud_cdc_write_flush();
+    return (int)n;
+}
+
+static bool cdc_connected(void)
+{
+    return tud_cdc_connected();
+}
+#else
+static int cdc_read(uint8_t *buffer, uint16_t max_len)
+{
+    (void)buffer;
+    (void)max_len;
+    return 0;
+}
+
+static int cdc_write(const uint8_t *buffer, uint16_t length)
+{
+    return (int)fwrite(buffer, 1, length, stdout);
+}
+
+static bool cdc_connected(void)
+{
+    return false;
+}
+#endif
+
+const usb_monitor_transport_t usb_monitor_cdc_transport = {
+    .read = cdc_read,
+    .write = cdc_write,
+    .connected = cdc_connected
+};
+
+/* ===== 字节序 ===== */
+
+static inline uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint8_t *put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static inline uint8_t *put32(uint8_t *p, uint32_t v)
+{
+    p = put16(p, (uint16_t)v);
+    return put16(p, (uint16_t)(v >> 16));
+}
+
+static inline uint8_t *put64(uint8_t *p, uint64_t v)
+{
+    p = put32(p, (uint32_t)v);
+    return put32(p, (uint32_t)(v >> 32));
+}
+
+/* ===== 发送缓冲 ===== */
+
+static uint32_t tx_free(const usb_monitor_t *mon)
+{
+    return USB_MONITOR_TX_BUFFER - (mon->tx_head - mon->tx_tail);
+}
+
+static void tx_put(usb_monitor_t *mon, const uint8_t *data, uint16_t length)
+{
+    for (uint16_t i = 0; i < length; i++) {
+        mon->tx[(mon->tx_head + i) & TX_MASK] = data[i];
+    }
+    mon->tx_head += length;
+}
+
+/* 整帧放入发送缓冲，空间不足返回 false (不写入任何字节) */
+static bool tx_frame(usb_monitor_t *mon, uint8_t cmd, uint8_t seq,
+                     const uint8_t *payload, uint16_t length)
+{
+    if (tx_free(mon) < (uint32_t)USB_MONITOR_HEADER_SIZE + length + 2) return false;
+
+    uint8_t header[USB_MONITOR_HEADER_SIZE] = {
+        USB_MONITOR_SYNC0, USB_MONITOR_SYNC1, cmd, seq,
+        (uint8_t)length, (uint8_t)(length >> 8)
+    };
+    uint16_t crc = modbus_crc_update(MODBUS_CRC_INIT, &header[2], 4);
+    crc = modbus_crc_update(crc, payload, length);
+
+    uint8_t trailer[2];
+    put16(trailer, crc);
+
+    tx_put(mon, header, sizeof(header));
+    tx_put(mon, payload, length);
+    tx_put(mon, trailer, sizeof(trailer));
+    return true;
+}
+
+static void tx_drain(usb_monitor_t *mon)
+{
+    while (mon->tx_head != mon->tx_tail) {
+        uint32_t offset = mon->tx_tail & TX_MASK;
+        uint32_t chunk = mon->tx_head - mon->tx_tail;
+        if (chunk > USB_MONITOR_TX_BUFFER - offset) {
+            chunk = USB_MONITOR_TX_BUFFER - offset;
+        }
+
+        int n = mon->transport.write(&mon->tx[offset], (uint16_t)chunk);
+        if (n <= 0) break;
+        mon->tx_tail += (uint32_t)n;
+        if ((uint32_t)n < chunk) break;
+    }
+}
+
+/* ===== 会话 ===== */
+
+static void log_sink(const char *text, uint16_t length)
+{
+    usb_monitor_t *mon = g_log_monitor;
+    if (!mon) return;
+
+    if (!tx_frame(mon, USB_MONITOR_CMD_LOG, mon->event_seq++, (const uint8_t *)text, length)) {
+        mon->stats.log_dropped++;
+    }
+}
+
+static void session_open(usb_monitor_t *mon)
+{
+    mon->session = true;
+    g_log_monitor = mon;
+    log_set_output(log_sink);
+}
+
+static void session_close(usb_monitor_t *mon)
+{
+    mon->session = false;
+    mon->trend_count = 0;
+    if (g_log_monitor == mon) {
+        g_log_monitor = NULL;
+        log_set_output(NULL);
+    }
+}
+
+/* ===== 区段编码 ===== */
+
+/* 解析并校验 [区(1) 起始(2) 个数(2)] */
+static bool parse_span(const uint8_t *p, fx3u_image_span_t *span)
+{
+    if (p[0] >= FX3U_IMAGE_AREA_COUNT) return false;
+
+    span->area = (fx3u_image_area_t)p[0];
+    span->start = get16(&p[1]);
+    span->count = get16(&p[3]);
+    return span->count > 0 &&
+           (uint32_t)span->start + span->count <= fx3u_image_area_size(span->area);
+}
+
+/* 位区按 LSB 优先打包，字区每个 2 字节，CN 每个 4 字节 */
+static uint32_t span_bytes(const fx3u_image_span_t *span)
+{
+    if (FX3U_IMAGE_IS_BIT_AREA(span->area)) return (span->count + 7u) / 8u;
+    return (uint32_t)span->count * (span->area == FX3U_IMAGE_CN ? 4u : 2u);
+}
+
+static uint8_t *encode_span(const fx3u_image_snapshot_t *snap, const fx3u_image_span_t *span,
+                            uint8_t *out)
+{
+    if (FX3U_IMAGE_IS_BIT_AREA(span->area)) {
+        for (uint16_t k = 0; k < span->count; k += 32) {
+            uint8_t n = (uint8_t)(span->count - k < 32 ? span->count - k : 32);
+            uint32_t bits = fx3u_image_snapshot_bits(snap, span->area, span->start + k, n);
+            for (uint8_t b = 0; b < (n + 7) / 8; b++) {
+                *out++ = (uint8_t)(bits >> (b * 8));
+            }
+        }
+    } else {
+        for (uint16_t i = 0; i < span->count; i++) {
+            int32_t value = fx3u_image_snapshot_value(snap, span->area, span->start + i);
+            out = span->area == FX3U_IMAGE_CN ? put32(out, (uint32_t)value)
+                                              : put16(out, (uint16_t)value);
+        }
+    }
+    return out;
+}
+
+/* ===== 命令处理 (返回应答数据长度，g_reply[0] 为状态码) ===== */
+
+static uint16_t reply_status(uint8_t status)
+{
+    g_reply[0] = status;
+    return 1;
+}
+
+static uint16_t cmd_hello(usb_monitor_t *mon)
+{
+    session_open(mon);
+
+    uint8_t *p = g_reply;
+    *p++ = USB_MONITOR_OK;
+    *p++ = USB_MONITOR_VERSION;
+    p = put16(p, USB_MONITOR_MAX_PAYLOAD);
+    *p++ = FX3U_IMAGE_AREA_COUNT;
+    for (uint8_t a = 0; a < FX3U_IMAGE_AREA_COUNT; a++) {
+        p = put16(p, fx3u_image_area_size((fx3u_image_area_t)a));
+    }
+    return (uint16_t)(p - g_reply);
+}
+
+static uint16_t cmd_read(const uint8_t *req, uint16_t len)
+{
+    if (len == 0 || len % 5 != 0) return reply_status(USB_MONITOR_ERR_BAD_FRAME);
+
+    uint32_t total = 9;
+    for (uint16_t i = 0; i < len; i += 5) {
+        fx3u_image_span_t span;
+        if (!parse_span(&req[i], &span)) return reply_status(USB_MONITOR_ERR_RANGE);
+        total += span_bytes(&span);
+    }
+    if (total > USB_MONITOR_MAX_PAYLOAD) return reply_status(USB_MONITOR_ERR_TOO_LARGE);
+
+    /* 所有区段在同一次 seqlock 读取中完成 */
+    const fx3u_image_snapshot_t *snap;
+    uint32_t seq;
+    uint8_t *p;
+    do {
+        snap = fx3u_image_snapshot_begin(&seq);
+        p = g_reply;
+        *p++ = USB_MONITOR_OK;
+        p = put32(p, snap->scan_count);
+        p = put32(p, snap->change_seq);
+        for (uint16_t i = 0; i < len; i += 5) {
+            fx3u_image_span_t span;
+            parse_span(&req[i], &span);
+            p = encode_span(snap, &span, p);
+        }
+    } while (fx3u_image_snapshot_retry(snap, seq));
+
+    return (uint16_t)(p - g_reply);
+}
+
+static uint16_t cmd_write(const uint8_t *req, uint16_t len)
+{
+    fx3u_image_span_t span;
+    if (len < 5) return reply_status(USB_MONITOR_ERR_BAD_FRAME);
+    if (!parse_span(req, &span)) return reply_status(USB_MONITOR_ERR_RANGE);
+    if (span.area == FX3U_IMAGE_TS || span.area == FX3U_IMAGE_CS) {
+        return reply_status(USB_MONITOR_ERR_NOT_WRITABLE);
+    }
+    if (len - 5u != span_bytes(&span)) return reply_status(USB_MONITOR_ERR_BAD_FRAME);
+
+    const uint8_t *data = &req[5];
+    if (FX3U_IMAGE_IS_BIT_AREA(span.area)) {
+        if (!fx3u_image_queue_bits(span.area, span.start, data, span.count)) {
+            return reply_status(USB_MONITOR_ERR_QUEUE_FULL);
+        }
+        return reply_status(USB_MONITOR_OK);
+    }
+
+    if (span.count > USB_MONITOR_WRITE_MAX) return reply_status(USB_MONITOR_ERR_TOO_LARGE);
+
+    /* CN 分高低字两项写入，同批入队，扫描开始时一起生效 */
+    uint16_t n = 0;
+    for (uint16_t i = 0; i < span.count; i++) {
+        fx3u_image_write_t *w = &g_write_batch[n++];
+        w->area = (uint8_t)span.area;
+        w->addr = span.start + i;
+        if (span.area == FX3U_IMAGE_CN) {
+            w->count = FX3U_IMAGE_CN_LOW;
+            w->value = (int16_t)get16(&data[i * 4]);
+            w = &g_write_batch[n++];
+            w->area = (uint8_t)span.area;
+            w->addr = span.start + i;
+            w->count = FX3U_IMAGE_CN_HIGH;
+            w->value = (int16_t)get16(&data[i * 4 + 2]);
+        } else {
+            w->count = 1;
+            w->value = (int16_t)get16(&data[i * 2]);
+        }
+    }
+
+    if (!fx3u_image_queue_writes(g_write_batch, n)) {
+        return reply_status(USB_MONITOR_ERR_QUEUE_FULL);
+    }
+    return reply_status(USB_MONITOR_OK);
+}
+
+static uint16_t cmd_force(usb_monitor_t *mon, const uint8_t *req, uint16_t len)
+{
+    if (len == 0 || len % 4 != 0) return reply_status(USB_MONITOR_ERR_BAD_FRAME);
+
+    /* 先整体校验，避免只生效一部分 */
+    for (uint16_t i = 0; i < len; i += 4) {
+        uint16_t limit = req[i] ? PLC_MAX_OUTPUTS : PLC_MAX_INPUTS;
+        if (req[i] > 1 || get16(&req[i + 1]) >= limit || req[i + 3] > FX3U_FORCE_ON) {
+            return reply_status(USB_MONITOR_ERR_RANGE);
+        }
+    }
+    for (uint16_t i = 0; i < len; i += 4) {
+        fx3u_core_force(mon->plc, req[i] != 0, get16(&req[i + 1]), (fx3u_force_t)req[i + 3]);
+    }
+
+    g_reply[0] = USB_MONITOR_OK;
+    put16(&g_reply[1], fx3u_core_force_count(mon->plc));
+    return 3;
+}
+
+static uint16_t cmd_trend_start(usb_monitor_t *mon, const uint8_t *req, uint16_t len)
+{
+    if (len < 7 || (len - 2) % 5 != 0) return reply_status(USB_MONITOR_ERR_BAD_FRAME);
+
+    uint8_t count = (uint8_t)((len - 2) / 5);
+    if (count > USB_MONITOR_TREND_RANGES) return reply_status(USB_MONITOR_ERR_TOO_LARGE);
+
+    fx3u_image_span_t spans[USB_MONITOR_TREND_RANGES];
+    uint32_t total = 8;
+    for (uint8_t i = 0; i < count; i++) {
+        if (!parse_span(&req[2 + i * 5], &spans[i])) return reply_status(USB_MONITOR_ERR_RANGE);
+        total += span_bytes(&spans[i]);
+    }
+    if (total > USB_MONITOR_MAX_PAYLOAD) return reply_status(USB_MONITOR_ERR_TOO_LARGE);
+
+    uint32_t seq;
+    const fx3u_image_snapshot_t *snap = fx3u_image_snapshot_begin(&seq);
+
+    memcpy(mon->trend, spans, count * sizeof(spans[0]));
+    mon->trend_count = count;
+    mon->trend_period = get16(req) ? get16(req) : 1;
+    mon->trend_last = snap->change_seq;
+    return reply_status(USB_MONITOR_OK);
+}
+
+static uint16_t cmd_stats(usb_monitor_t *mon)
+{
+    const fx3u_core_t *plc = mon->plc;
+    const fx3u_image_stats_t *image = fx3u_image_get_stats();
+
+    uint8_t *p = g_reply;
+    *p++ = USB_MONITOR_OK;
+    *p++ = (uint8_t)plc->state;
+    p = put16(p, plc->error_code);
+    p = put32(p, plc->cycle_count);
+    p = put32(p, plc->last_scan_time_us);
+    p = put32(p, plc->min_scan_time_us);
+    p = put32(p, plc->max_scan_time_us);
+    p = put32(p, image->publish_count);
+    p = put32(p, image->read_retries);
+    p = put32(p, image->writes_applied);
+    p = put32(p, image->writes_rejected);
+    p = put16(p, fx3u_core_force_count(plc));
+    p = put32(p, mon->stats.frames);
+    p = put32(p, mon->stats.bad_frames);
+    p = put32(p, mon->stats.trend_samples);
+    p = put32(p, mon->stats.trend_skipped);
+    p = put32(p, mon->stats.log_dropped);
+    return (uint16_t)(p - g_reply);
+}
+
+static uint16_t cmd_profile(usb_monitor_t *mon, const uint8_t *req, uint16_t len)
+{
+    if (len < 1) return reply_status(USB_MONITOR_ERR_BAD_FRAME);
+
+    uint8_t *p = g_reply;
+    switch (req[0]) {
+        case USB_MONITOR_PROFILE_SUMMARY: {
+            fx3u_profile_summary_t summary;
+            fx3u_profile_get_summary(mon->plc, &summary);
+            *p++ = USB_MONITOR_OK;
+            *p++ = summary.enabled ? 1 : 0;
+            p = put16(p, summary.cycles_per_us);
+            p = put32(p, summary.scans);
+            p = put64(p, summary.total_cycles);
+            p = put64(p, summary.uncovered_cycles);
+            p = put16(p, summary.steps);
+            p = put16(p, summary.rungs);
+            return (uint16_t)(p - g_reply);
+        }
+
+        case USB_MONITOR_PROFILE_READ: {
+            if (len != 6) return reply_status(USB_MONITOR_ERR_BAD_FRAME);
+            uint8_t view = req[1];
+            uint16_t first = get16(&req[2]);
+            uint16_t count = get16(&req[4]);
+            if (view >= FX3U_PROFILE_VIEW_COUNT) return reply_status(USB_MONITOR_ERR_RANGE);
+            if (4u + (uint32_t)count * PROFILE_ENTRY_SIZE > USB_MONITOR_MAX_PAYLOAD) {
+                return reply_status(USB_MONITOR_ERR_TOO_LARGE);
+            }
+
+            fx3u_profile_entry_t *entries = g_profile_entries;
+            uint16_t n = fx3u_profile_read(mon->plc, (fx3u_profile_view_t)view, first, count,
+                                           entries);
+            *p++ = USB_MONITOR_OK;
+            *p++ = view;
+            p = put16(p, fx3u_profile_entries(mon->plc, (fx3u_profile_view_t)view));
+            for (uint16_t i = 0; i < n; i++) {
+                p = put16(p, entries[i].index);
+                p = put32(p, entries[i].count);
+                p = put64(p, entries[i].cycles);
+                p = put32(p, entries[i].max_cycles);
+            }
+            return (uint16_t)(p - g_reply);
+        }
+
+        case USB_MONITOR_PROFILE_START:
+            if (!fx3u_profile_start()) return reply_status(USB_MONITOR_ERR_UNAVAILABLE);
+            return reply_status(USB_MONITOR_OK);
+
+        case USB_MONITOR_PROFILE_STOP:
+            fx3u_profile_stop();
+            return reply_status(USB_MONITOR_OK);
+
+        case USB_MONITOR_PROFILE_RESET:
+            fx3u_profile_reset();
+            return reply_status(USB_MONITOR_OK);
+
+        default:
+            return reply_status(USB_MONITOR_ERR_RANGE);
+    }
+}
+
+static uint16_t dispatch(usb_monitor_t *mon, uint8_t cmd, const uint8_t *req, uint16_t len)
+{
+    switch (cmd) {
+        case USB_MONITOR_CMD_HELLO:
+            return cmd_hello(mon);
+
+        case USB_MONITOR_CMD_READ:
+            return cmd_read(req, len);
+
+        case USB_MONITOR_CMD_WRITE:
+            return cmd_write(req, len);
+
+        case USB_MONITOR_CMD_FORCE:
+            return cmd_force(mon, req, len);
+
+        case USB_MONITOR_CMD_RELEASE_FORCES:
+            fx3u_core_release_forces(mon->plc);
+            return reply_status(USB_MONITOR_OK);
+
+        case USB_MONITOR_CMD_TREND_START:
+            return cmd_trend_start(mon, req, len);
+
+        case USB_MONITOR_CMD_TREND_STOP:
+            mon->trend_count = 0;
+            return reply_status(USB_MONITOR_OK);
+
+        case USB_MONITOR_CMD_STATS:
+            return cmd_stats(mon);
+
+        case USB_MONITOR_CMD_RUN:
+            if (len != 1 || req[0] > 1) return reply_status(USB_MONITOR_ERR_RANGE);
+            if (req[0]) {
+                fx3u_core_start(mon->plc);
+            } else {
+                fx3u_core_stop(mon->plc);
+            }
+            return reply_status(USB_MONITOR_OK);
+
+        case USB_MONITOR_CMD_PROFILE:
+            return cmd_profile(mon, req, len);
+
+        case USB_MONITOR_CMD_CLOSE:
+            /* 应答已在发送缓冲中，会话关闭后照常发出 */
+            return reply_status(USB_MONITOR_OK);
+
+        default:
+            return reply_status(USB_MONITOR_ERR_UNKNOWN_CMD);
+    }
+}
+
+/* ===== 接收解析 ===== */
+
+static void rx_consume(usb_monitor_t *mon, uint16_t count)
+{
+    if (count >= mon->rx_len) {
+        mon->rx_len = 0;
+        return;
+    }
+    memmove(mon->rx, &mon->rx[count], mon->rx_len - count);
+    mon->rx_len -= count;
+}
+
+static void process_rx(usb_monitor_t *mon)
+{
+    while (mon->rx_len > 0) {
+        /* 同步到帧头 */
+        if (mon->rx[0] != USB_MONITOR_SYNC0) {
+            uint16_t skip = 1;
+            while (skip < mon->rx_len && mon->rx[skip] != USB_MONITOR_SYNC0) skip++;
+            rx_consume(mon, skip);
+            continue;
+        }
+        if (mon->rx_len >= 2 && mon->rx[1] != USB_MONITOR_SYNC1) {
+            rx_consume(mon, 1);
+            continue;
+        }
+        if (mon->rx_len < USB_MONITOR_HEADER_SIZE) return;
+
+        uint16_t len = get16(&mon->rx[4]);
+        if (len > USB_MONITOR_MAX_PAYLOAD) {
+            mon->stats.bad_frames++;
+            rx_consume(mon, 1);
+            continue;
+        }
+        uint16_t total = USB_MONITOR_HEADER_SIZE + len + 2;
+        if (mon->rx_len < total) return;
+
+        /* 发送缓冲容不下最大应答时暂停，请求留待下次 */
+        if (tx_free(mon) < USB_MONITOR_MAX_FRAME) return;
+
+        uint8_t cmd = mon->rx[2];
+        uint8_t seq = mon->rx[3];
+        uint16_t crc = modbus_crc_update(MODBUS_CRC_INIT, &mon->rx[2], 4 + len);
+        uint16_t reply_len;
+        if (crc != get16(&mon->rx[USB_MONITOR_HEADER_SIZE + len])) {
+            mon->stats.bad_frames++;
+            reply_len = reply_status(USB_MONITOR_ERR_BAD_FRAME);
+        } else {
+            mon->stats.frames++;
+            reply_len = dispatch(mon, cmd, &mon->rx[USB_MONITOR_HEADER_SIZE], len);
+        }
+
+        tx_frame(mon, cmd | USB_MONITOR_REPLY, seq, g_reply, reply_len);
+        if (cmd == USB_MONITOR_CMD_CLOSE && g_reply[0] == USB_MONITOR_OK) {
+            session_close(mon);
+        }
+        rx_consume(mon, total);
+    }
+}
+
+/* ===== 趋势 ===== */
+
+static void sample_trend(usb_monitor_t *mon)
+{
+    if (mon->trend_count == 0) return;
+
+    uint32_t seq;
+    const fx3u_image_snapshot_t *snap = fx3u_image_snapshot_begin(&seq);
+    if (snap->change_seq - mon->trend_last < mon->trend_period) return;
+
+    uint32_t size = 8;
+    for (uint8_t i = 0; i < mon->trend_count; i++) {
+        size += span_bytes(&mon->trend[i]);
+    }
+    if (tx_free(mon) < USB_MONITOR_HEADER_SIZE + size + 2) {
+        mon->trend_last = snap->change_seq;
+        mon->stats.trend_skipped++;
+        return;
+    }
+
+    uint8_t *p;
+    uint32_t change_seq;
+    do {
+        snap = fx3u_image_snapshot_begin(&seq);
+        change_seq = snap->change_seq;
+        p = put32(g_reply, snap->scan_count);
+        p = put32(p, change_seq);
+        for (uint8_t i = 0; i < mon->trend_count; i++) {
+            p = encode_span(snap, &mon->trend[i], p);
+        }
+    } while (fx3u_image_snapshot_retry(snap, seq));
+
+    mon->trend_last = change_seq;
+    tx_frame(mon, USB_MONITOR_CMD_TREND, mon->event_seq++, g_reply, (uint16_t)(p - g_reply));
+    mon->stats.trend_samples++;
+}
+
+/**
+ * 初始化监视器
+ */
+void usb_monitor_init(usb_monitor_t *mon, fx3u_core_t *plc,
+                      const usb_monitor_transport_t *transport)
+{
+    if (!mon) return;
+
+    memset(mon, 0, sizeof(usb_monitor_t));
+    mon->plc = plc;
+    mon->transport = transport ? *transport : usb_monitor_cdc_transport;
+}
+
+/**
+ * 主循环轮询
+ */
+void usb_monitor_poll(usb_monitor_t *mon)
+{
+    if (!mon || !mon->plc) return;
+
+    if (!mon->transport.connected()) {
+        /* 断开: 丢弃未完成的收发，日志恢复到 stdout */
+        if (mon->session) session_close(mon);
+        mon->rx_len = 0;
+        mon->tx_tail = mon->tx_head;
+        return;
+    }
+
+    if (mon->rx_len < sizeof(mon->rx)) {
+        int n = mon->transport.read(&mon->rx[mon->rx_len],
+                                    (uint16_t)(sizeof(mon->rx) - mon->rx_len));
+        if (n > 0) mon->rx_len += (uint16_t)n;
+    }
+    process_rx(mon);
+
+    if (mon->session) sample_trend(mon);
+    tx_drain(mon);
+}
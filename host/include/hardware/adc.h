@@ -0,0 +1,19 @@
+/**
+ * 主机构建: hardware/adc.h 替身 (读数恒为 pico_host_set_adc 设定值)
+ */
+
+#ifndef __HOST_HARDWARE_ADC_H__
+#define __HOST_HARDWARE_ADC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef unsigned int uint;
+
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+uint16_t adc_read(void);
+void adc_set_temp_sensor_enabled(bool enable);
+
+#endif /* __HOST_HARDWARE_ADC_H__ */
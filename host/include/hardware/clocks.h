@@ -0,0 +1,18 @@
+/**
+ * 主机构建: hardware/clocks.h 替身 (clk_sys 固定 125MHz)
+ */
+
+#ifndef __HOST_HARDWARE_CLOCKS_H__
+#define __HOST_HARDWARE_CLOCKS_H__
+
+#include <stdint.h>
+
+enum clock_index {
+    clk_ref = 4,
+    clk_sys = 5,
+    clk_peri = 6
+};
+
+uint32_t clock_get_hz(enum clock_index clk_index);
+
+#endif /* __HOST_HARDWARE_CLOCKS_H__ */
@@ -0,0 +1,13 @@
+/**
+ * 主机构建: hardware/pio.h 替身
+ *
+ * 使用该外设的代码都在 PICO_ON_DEVICE 分支内，主机构建只需要头文件存在。
+ */
+
+#ifndef __HOST_HARDWARE_PIO_H__
+#define __HOST_HARDWARE_PIO_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#endif /* __HOST_HARDWARE_PIO_H__ */
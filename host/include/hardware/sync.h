@@ -0,0 +1,24 @@
+/**
+ * 主机构建: hardware/sync.h 替身 (单线程，开关中断为空操作)
+ */
+
+#ifndef __HOST_HARDWARE_SYNC_H__
+#define __HOST_HARDWARE_SYNC_H__
+
+#include <stdint.h>
+
+static inline void __dmb(void) {}
+static inline void __wfe(void) {}
+static inline void __sev(void) {}
+
+static inline uint32_t save_and_disable_interrupts(void)
+{
+    return 0;
+}
+
+static inline void restore_interrupts(uint32_t status)
+{
+    (void)status;
+}
+
+#endif /* __HOST_HARDWARE_SYNC_H__ */
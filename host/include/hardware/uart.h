@@ -0,0 +1,25 @@
+/**
+ * 主机构建: hardware/uart.h 替身
+ *
+ * 每个 UART 一个接收 FIFO 与一个发送记录，测试经 pico_host_uart_* 注入 / 取出字节。
+ */
+
+#ifndef __HOST_HARDWARE_UART_H__
+#define __HOST_HARDWARE_UART_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef unsigned int uint;
+typedef struct uart_inst uart_inst_t;
+
+extern uart_inst_t *const uart0;
+extern uart_inst_t *const uart1;
+
+uint uart_init(uart_inst_t *uart, uint baudrate);
+void uart_set_hw_flow(uart_inst_t *uart, bool cts, bool rts);
+bool uart_is_readable(uart_inst_t *uart);
+char uart_getc(uart_inst_t *uart);
+void uart_putc(uart_inst_t *uart, char c);
+
+#endif /* __HOST_HARDWARE_UART_H__ */
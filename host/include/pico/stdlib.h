@@ -0,0 +1,33 @@
+/**
+ * 主机构建: Pico SDK pico/stdlib.h 的替身
+ *
+ * 只声明本仓库用到的接口，实现见 host/pico_host.c。
+ */
+
+#ifndef __HOST_PICO_STDLIB_H__
+#define __HOST_PICO_STDLIB_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#ifndef PICO_ON_DEVICE
+#define PICO_ON_DEVICE  0
+#endif
+
+typedef unsigned int uint;
+
+#define __uninitialized_ram(x)  x
+#define __not_in_flash_func(x)  x
+#define __time_critical_func(x) x
+
+static inline void tight_loop_contents(void) {}
+
+bool stdio_init_all(void);
+
+#include "pico/time.h"
+#include "hardware/gpio.h"
+#include "hardware/uart.h"
+
+#endif /* __HOST_PICO_STDLIB_H__ */
@@ -0,0 +1,40 @@
+/**
+ * 主机构建: pico/time.h 替身
+ *
+ * 时钟 = 单调时钟 + 休眠累计: sleep / busy_wait / wfe 超时不真正等待，而是把时钟向前拨，
+ * 测试可以不花真实时间推进到任意时刻 (pico_host_advance_us)。
+ */
+
+#ifndef __HOST_PICO_TIME_H__
+#define __HOST_PICO_TIME_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef uint64_t absolute_time_t;
+
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+absolute_time_t get_absolute_time(void);
+
+static inline absolute_time_t from_us_since_boot(uint64_t us)
+{
+    return us;
+}
+
+static inline uint64_t to_us_since_boot(absolute_time_t t)
+{
+    return t;
+}
+
+static inline uint32_t to_ms_since_boot(absolute_time_t t)
+{
+    return (uint32_t)(t / 1000u);
+}
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void busy_wait_us(uint64_t us);
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp);
+
+#endif /* __HOST_PICO_TIME_H__ */
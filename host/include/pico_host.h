@@ -0,0 +1,29 @@
+/**
+ * 主机构建的测试接口: 推进时钟、注入 / 取出 UART 字节、设定输入引脚
+ */
+
+#ifndef __PICO_HOST_H__
+#define __PICO_HOST_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/uart.h"
+
+#define PICO_HOST_UART_FIFO_SIZE    4096
+
+/* 时钟向前拨 us (不等待) */
+void pico_host_advance_us(uint64_t us);
+
+/* 放入接收 FIFO，返回放入的字节数 (FIFO 满时截断) */
+uint16_t pico_host_uart_inject(uart_inst_t *uart, const uint8_t *data, uint16_t length);
+uint16_t pico_host_uart_rx_pending(uart_inst_t *uart);
+
+/* 取出已发送的字节，返回取出的字节数 */
+uint16_t pico_host_uart_take(uart_inst_t *uart, uint8_t *data, uint16_t max_len);
+
+void pico_host_set_gpio_input(uint32_t mask, uint32_t value);
+uint32_t pico_host_gpio_outputs(void);
+uint32_t pico_host_gpio_irq_mask(void);             /* bit n = GPIOn 的沿中断已开启 */
+void pico_host_set_adc(uint8_t input, uint16_t value);
+
+#endif /* __PICO_HOST_H__ */
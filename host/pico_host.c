@@ -0,0 +1,324 @@
+/**
+ * 主机构建: Pico SDK 替身实现
+ *
+ * 单线程，没有中断；外设只保存状态，供测试读取或注入。
+ */
+
+#include "pico/stdlib.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+#include "hardware/uart.h"
+#include "hardware/pwm.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "pico_host.h"
+#include <string.h>
+#include <time.h>
+
+/* ===== 时钟 ===== */
+
+static uint64_t g_start_us = 0;
+static uint64_t g_offset_us = 0;
+
+static uint64_t monotonic_us(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+uint64_t time_us_64(void)
+{
+    uint64_t now = monotonic_us();
+    if (!g_start_us) g_start_us = now;
+    return now - g_start_us + g_offset_us;
+}
+
+uint32_t time_us_32(void)
+{
+    return (uint32_t)time_us_64();
+}
+
+absolute_time_t get_absolute_time(void)
+{
+    return time_us_64();
+}
+
+void pico_host_advance_us(uint64_t us)
+{
+    g_offset_us += us;
+}
+
+void sleep_us(uint64_t us)
+{
+    pico_host_advance_us(us);
+}
+
+void sleep_ms(uint32_t ms)
+{
+    pico_host_advance_us((uint64_t)ms * 1000u);
+}
+
+void busy_wait_us(uint64_t us)
+{
+    pico_host_advance_us(us);
+}
+
+/* 没有中断能唤醒，直接拨到超时时刻 */
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp)
+{
+    uint64_t now = time_us_64();
+    if (timeout_timestamp > now) {
+        pico_host_advance_us(timeout_timestamp - now);
+    }
+    return true;
+}
+
+bool stdio_init_all(void)
+{
+    return true;
+}
+
+/* ===== GPIO ===== */
+
+static uint32_t g_gpio_out = 0;
+static uint32_t g_gpio_in = 0;
+static uint32_t g_gpio_dir = 0;
+static uint32_t g_gpio_irq = 0;
+
+void gpio_init(uint gpio)
+{
+    g_gpio_dir &= ~(1u << gpio);
+    g_gpio_out &= ~(1u << gpio);
+}
+
+void gpio_set_dir(uint gpio, bool out)
+{
+    if (out) {
+        g_gpio_dir |= 1u << gpio;
+    } else {
+        g_gpio_dir &= ~(1u << gpio);
+    }
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn)
+{
+    (void)gpio;
+    (void)fn;
+}
+
+void gpio_pull_up(uint gpio)
+{
+    (void)gpio;
+}
+
+void gpio_pull_down(uint gpio)
+{
+    (void)gpio;
+}
+
+void gpio_put(uint gpio, bool value)
+{
+    if (value) {
+        g_gpio_out |= 1u << gpio;
+    } else {
+        g_gpio_out &= ~(1u << gpio);
+    }
+}
+
+void gpio_put_masked(uint32_t mask, uint32_t value)
+{
+    g_gpio_out = (g_gpio_out & ~mask) | (value & mask);
+}
+
+bool gpio_get(uint gpio)
+{
+    return (gpio_get_all() >> gpio) & 1u;
+}
+
+uint32_t gpio_get_all(void)
+{
+    return (g_gpio_in & ~g_gpio_dir) | (g_gpio_out & g_gpio_dir);
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled,
+                                        gpio_irq_callback_t callback)
+{
+    (void)event_mask;
+    (void)callback;
+    if (gpio >= 32) return;
+    if (enabled) {
+        g_gpio_irq |= 1u << gpio;
+    } else {
+        g_gpio_irq &= ~(1u << gpio);
+    }
+}
+
+uint32_t pico_host_gpio_irq_mask(void)
+{
+    return g_gpio_irq;
+}
+
+void pico_host_set_gpio_input(uint32_t mask, uint32_t value)
+{
+    g_gpio_in = (g_gpio_in & ~mask) | (value & mask);
+}
+
+uint32_t pico_host_gpio_outputs(void)
+{
+    return g_gpio_out & g_gpio_dir;
+}
+
+/* ===== UART ===== */
+
+struct uart_inst {
+    uint8_t rx[PICO_HOST_UART_FIFO_SIZE];
+    uint16_t rx_head;
+    uint16_t rx_count;
+    uint8_t tx[PICO_HOST_UART_FIFO_SIZE];
+    uint16_t tx_count;
+};
+
+static struct uart_inst g_uarts[2];
+uart_inst_t *const uart0 = &g_uarts[0];
+uart_inst_t *const uart1 = &g_uarts[1];
+
+uint uart_init(uart_inst_t *uart, uint baudrate)
+{
+    memset(uart, 0, sizeof(*uart));
+    return baudrate;
+}
+
+void uart_set_hw_flow(uart_inst_t *uart, bool cts, bool rts)
+{
+    (void)uart;
+    (void)cts;
+    (void)rts;
+}
+
+bool uart_is_readable(uart_inst_t *uart)
+{
+    return uart->rx_count > 0;
+}
+
+char uart_getc(uart_inst_t *uart)
+{
+    if (!uart->rx_count) return 0;
+    uint8_t c = uart->rx[uart->rx_head];
+    uart->rx_head = (uint16_t)((uart->rx_head + 1) % PICO_HOST_UART_FIFO_SIZE);
+    uart->rx_count--;
+    return (char)c;
+}
+
+/* 发送记录满时丢弃新字节，测试应及时取出 */
+void uart_putc(uart_inst_t *uart, char c)
+{
+    if (uart->tx_count < PICO_HOST_UART_FIFO_SIZE) {
+        uart->tx[uart->tx_count++] = (uint8_t)c;
+    }
+}
+
+uint16_t pico_host_uart_inject(uart_inst_t *uart, const uint8_t *data, uint16_t length)
+{
+    uint16_t n = 0;
+    while (n < length && uart->rx_count < PICO_HOST_UART_FIFO_SIZE) {
+        uint16_t tail = (uint16_t)((uart->rx_head + uart->rx_count) % PICO_HOST_UART_FIFO_SIZE);
+        uart->rx[tail] = data[n++];
+        uart->rx_count++;
+    }
+    return n;
+}
+
+uint16_t pico_host_uart_rx_pending(uart_inst_t *uart)
+{
+    return uart->rx_count;
+}
+
+uint16_t pico_host_uart_take(uart_inst_t *uart, uint8_t *data, uint16_t max_len)
+{
+    uint16_t n = uart->tx_count < max_len ? uart->tx_count : max_len;
+    memcpy(data, uart->tx, n);
+    memmove(uart->tx, &uart->tx[n], uart->tx_count - n);
+    uart->tx_count -= n;
+    return n;
+}
+
+/* ===== PWM / ADC / 时钟 ===== */
+
+uint pwm_gpio_to_slice_num(uint gpio)
+{
+    return (gpio >> 1) & 7u;
+}
+
+pwm_config pwm_get_default_config(void)
+{
+    pwm_config c = {0, 1u << 4, 0xFFFF};
+    return c;
+}
+
+void pwm_config_set_clkdiv(pwm_config *c, float div)
+{
+    c->div = (uint32_t)(div * 16.0f);
+}
+
+void pwm_config_set_wrap(pwm_config *c, uint16_t wrap)
+{
+    c->top = wrap;
+}
+
+void pwm_init(uint slice_num, pwm_config *c, bool start)
+{
+    (void)slice_num;
+    (void)c;
+    (void)start;
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level)
+{
+    (void)gpio;
+    (void)level;
+}
+
+void pwm_set_enabled(uint slice_num, bool enabled)
+{
+    (void)slice_num;
+    (void)enabled;
+}
+
+static uint16_t g_adc[5];
+static uint g_adc_input = 0;
+
+void adc_init(void)
+{
+}
+
+void adc_gpio_init(uint gpio)
+{
+    (void)gpio;
+}
+
+void adc_select_input(uint input)
+{
+    g_adc_input = input < 5 ? input : 0;
+}
+
+uint16_t adc_read(void)
+{
+    return g_adc[g_adc_input];
+}
+
+void adc_set_temp_sensor_enabled(bool enable)
+{
+    (void)enable;
+}
+
+void pico_host_set_adc(uint8_t input, uint16_t value)
+{
+    if (input < 5) g_adc[input] = value & 0x0FFF;
+}
+
+uint32_t clock_get_hz(enum clock_index clk_index)
+{
+    (void)clk_index;
+    return 125000000u;
+}
@@ -0,0 +1,59 @@
+/**
+ * 模拟量后台采集
+ *
+ * ADC 自由运行，轮流转换通道 0-2 (AI0 / AI1 / PVD) 送入 FIFO，由 DMA 搬入环形缓冲；
+ * 主循环从环中取样，做过采样抽取与定点滤波，CPU 从不等待转换。
+ * 工程值每次扫描发布一次到 D110-D112 (经过程映像写队列，扫描开始时生效)。
+ */
+
+#ifndef __FX3U_ANALOG_H__
+#define __FX3U_ANALOG_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FX3U_ANALOG_CHANNELS        3
+#define FX3U_ANALOG_SAMPLE_RATE_HZ  12000   /* 三通道合计转换速率 */
+#define FX3U_ANALOG_OVERSAMPLE      16      /* 每通道抽取比: 16 次累加多出 2 位 */
+#define FX3U_ANALOG_RESULT_BITS     14      /* 抽取后分辨率 */
+#define FX3U_ANALOG_RING_SIZE       1024    /* DMA 环样本数 (2的幂)，12 kS/s 下约 85ms */
+#define FX3U_ANALOG_AVERAGE_MAX     16      /* 滑动平均最大窗口 */
+#define FX3U_ANALOG_D_BASE          110     /* 工程值发布到 D110 起 */
+
+/* ===== 滤波器 ===== */
+typedef enum {
+    FX3U_ANALOG_FILTER_NONE = 0,
+    FX3U_ANALOG_FILTER_IIR = 1,         /* 一阶低通 y += (x - y) / 2^strength */
+    FX3U_ANALOG_FILTER_AVERAGE = 2      /* 滑动平均，窗口 2^strength */
+} fx3u_analog_filter_t;
+
+/* 工程值 = (滤波值 * scale_mul >> scale_shift) + offset，滤波值为 14 位 */
+typedef struct {
+    fx3u_analog_filter_t filter;
+    uint8_t strength;
+    int32_t scale_mul;
+    uint8_t scale_shift;
+    int16_t offset;
+} fx3u_analog_channel_config_t;
+
+typedef struct {
+    uint32_t samples;                   /* 已处理的原始样本 */
+    uint32_t overruns;                  /* 主循环来不及处理，环被覆盖 */
+    uint32_t restarts;                  /* DMA 计数将尽时的重新同步 */
+    uint32_t publishes;
+} fx3u_analog_stats_t;
+
+/* 启动采集；默认 IIR 1/8，换算为 mV (与原 D110-D112 含义一致) */
+void fx3u_analog_init(void);
+void fx3u_analog_stop(void);
+bool fx3u_analog_running(void);
+bool fx3u_analog_configure(uint8_t channel, const fx3u_analog_channel_config_t *config);
+
+/* 主循环调用: 处理新样本，扫描推进后发布工程值 */
+void fx3u_analog_poll(void);
+
+uint16_t fx3u_analog_get_raw(uint8_t channel);      /* 最近一次抽取的平均值 (12 位刻度) */
+int16_t fx3u_analog_get_value(uint8_t channel);     /* 工程值 */
+const fx3u_analog_stats_t *fx3u_analog_get_stats(void);
+
+#endif /* __FX3U_ANALOG_H__ */
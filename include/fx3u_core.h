@@ -21,16 +21,19 @@ typedef struct fx3u_instruction_t fx3u_instruction_t;
 #define PLC_MAX_TIMERS      128     /* 定时器 T */
 #define PLC_MAX_COUNTERS    128     /* 计数器 C */
 #define PLC_MAX_REGISTERS   4096    /* 数据寄存器 D */
+#define PLC_MAX_STATES      1024    /* 状态继电器 S */
+#define PLC_SPECIAL_BASE    8000    /* 特殊软元件起始编号 (M8000 / D8000) */
+#define PLC_MAX_SPECIAL     512     /* 特殊继电器 M8000-M8511 / 特殊寄存器 D8000-D8511 */
 
 /* 特殊寄存器定义 */
-#define D8000   8000    /* 扫描时间 */
+#define D8000   8000    /* 看门狗时间 (ms) */
 #define D8001   8001    /* PLC版本 */
 #define D8002   8002    /* 内存容量 */
 #define D8003   8003    /* 存储模式 */
 #define D8006   8006    /* CPU错误代码 */
-#define D8010   8010    /* 扫描次数 */
-#define D8011   8011    /* 扫描最小时间 */
-#define D8012   8012    /* 扫描最大时间 */
+#define D8010   8010    /* 当前扫描时间 (0.1ms) */
+#define D8011   8011    /* 最小扫描时间 (0.1ms) */
+#define D8012   8012    /* 最大扫描时间 (0.1ms) */
 #define D8120   8120    /* 通信方式 */
 #define D8121   8121    /* 站号 */
 #define D8127   8127    /* 数据长度设置 */
@@ -71,6 +74,15 @@ typedef enum {
     INST_OVERFLOW = 3
 } inst_result_t;
 
+/* ===== 强制 (调试) ===== */
+typedef enum {
+    FX3U_FORCE_RELEASE = 0,
+    FX3U_FORCE_OFF = 1,
+    FX3U_FORCE_ON = 2
+} fx3u_force_t;
+
+#define FX3U_FORCE_WORDS(n)     (((n) + 31) / 32)
+
 /* ===== PLC核心结构体 ===== */
 typedef struct {
     /* 运行状态 */
@@ -83,6 +95,7 @@ typedef struct {
     uint8_t inputs[PLC_MAX_INPUTS];
     uint8_t outputs[PLC_MAX_OUTPUTS];
     uint8_t internals[PLC_MAX_INTERNALS];
+    uint8_t states[PLC_MAX_STATES];
     
     /* 定时器和计数器 */
     fx3u_timer_t timers[PLC_MAX_TIMERS];
@@ -91,10 +104,28 @@ typedef struct {
     /* 数据寄存器 */
     int16_t registers[PLC_MAX_REGISTERS];
     
+    /* 特殊软元件 (按 编号 - PLC_SPECIAL_BASE 索引) */
+    uint8_t special_relays[PLC_MAX_SPECIAL];
+    int16_t special_registers[PLC_MAX_SPECIAL];
+    
+    /* 物理输入 (自 X0 起): 主循环整字写入，扫描开始时展开到输入映像 */
+    volatile uint32_t input_word;
+    uint8_t input_word_bits;            /* 0 表示不由物理输入刷新 */
+    
+    /* 强制 X / Y: 掩码为 1 的点在扫描开始 (X / Y) 与程序执行后 (Y) 取强制值 */
+    volatile uint32_t force_x_mask[FX3U_FORCE_WORDS(PLC_MAX_INPUTS)];
+    uint32_t force_x_value[FX3U_FORCE_WORDS(PLC_MAX_INPUTS)];
+    volatile uint32_t force_y_mask[FX3U_FORCE_WORDS(PLC_MAX_OUTPUTS)];
+    uint32_t force_y_value[FX3U_FORCE_WORDS(PLC_MAX_OUTPUTS)];
+    
     /* 执行位置 */
     uint32_t program_counter;
     uint32_t program_size;
     
+    /* 待切换程序 (通信侧提交，下一扫描开始时生效) */
+    const fx3u_instruction_t * volatile pending_program;
+    uint32_t pending_size;
+    
     /* 错误处理 */
     uint16_t error_code;
     
@@ -114,6 +145,18 @@ bool fx3u_core_load_program(fx3u_core_t *plc,
                             const fx3u_instruction_t *program,
                             uint32_t instruction_count);
 bool fx3u_core_has_program(const fx3u_core_t *plc);
+void fx3u_core_request_program(fx3u_core_t *plc,
+                               const fx3u_instruction_t *program,
+                               uint32_t instruction_count);
+bool fx3u_core_program_pending(const fx3u_core_t *plc);
+
+/* 物理输入整字交付 (主循环调用，下一扫描开始时生效，count <= 32) */
+void fx3u_core_set_input_word(fx3u_core_t *plc, uint32_t value, uint8_t count);
+
+/* 强制 (主循环调用，下一扫描生效) */
+bool fx3u_core_force(fx3u_core_t *plc, bool output, uint16_t addr, fx3u_force_t mode);
+void fx3u_core_release_forces(fx3u_core_t *plc);
+uint16_t fx3u_core_force_count(const fx3u_core_t *plc);
 
 /* 继电器访问函数 */
 void fx3u_set_input(fx3u_core_t *plc, uint16_t addr, uint8_t value);
@@ -122,6 +165,14 @@ void fx3u_set_output(fx3u_core_t *plc, uint16_t addr, uint8_t value);
 uint8_t fx3u_get_output(fx3u_core_t *plc, uint16_t addr);
 void fx3u_set_internal(fx3u_core_t *plc, uint16_t addr, uint8_t value);
 uint8_t fx3u_get_internal(fx3u_core_t *plc, uint16_t addr);
+void fx3u_set_state(fx3u_core_t *plc, uint16_t addr, uint8_t value);
+uint8_t fx3u_get_state(fx3u_core_t *plc, uint16_t addr);
+
+/* 特殊软元件访问函数 - addr 为完整编号 (如 M8002 / D8010) */
+void fx3u_set_special_relay(fx3u_core_t *plc, uint16_t addr, uint8_t value);
+uint8_t fx3u_get_special_relay(fx3u_core_t *plc, uint16_t addr);
+void fx3u_set_special_register(fx3u_core_t *plc, uint16_t addr, int16_t value);
+int16_t fx3u_get_special_register(fx3u_core_t *plc, uint16_t addr);
 
 /* 数据寄存器访问函数 */
 void fx3u_set_register(fx3u_core_t *plc, uint16_t addr, int16_t value);
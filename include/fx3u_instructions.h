@@ -19,6 +19,9 @@
 #define FX3U_ADDR_T(index)      FX3U_ADDR(0x3, index)
 #define FX3U_ADDR_C(index)      FX3U_ADDR(0x4, index)
 #define FX3U_ADDR_D(index)      FX3U_ADDR(0x5, index)
+#define FX3U_ADDR_S(index)      FX3U_ADDR(0x6, index)
+#define FX3U_ADDR_SM(number)    FX3U_ADDR(0x7, (number) - PLC_SPECIAL_BASE)    /* 如 FX3U_ADDR_SM(8002) */
+#define FX3U_ADDR_SD(number)    FX3U_ADDR(0x8, (number) - PLC_SPECIAL_BASE)
 
 /* ===== 指令操作码 ===== */
 typedef enum {
@@ -46,12 +49,23 @@ typedef enum {
     OP_RST = 0x31,     /* 复位 */
     OP_PLS = 0x32,     /* 脉冲 */
     
+    /* 高速计数器 (operand1 = 比较值 D 对，operand2 = C235-C255，operand3 = 位软元件) */
+    OP_DHSCS = 0x40,   /* 比较置位 */
+    OP_DHSCR = 0x41,   /* 比较复位 */
+    
+    /* 脉冲输出与定位 (operand3 = Y0-Y2，32 位参数为 D 对) */
+    OP_PLSY = 0x50,    /* 脉冲输出: operand1 = 频率，operand2 = 脉冲数 (0 为无限) */
+    OP_PLSR = 0x51,    /* 带加减速: operand1 = 最高频率，operand2 = 脉冲数 */
+    OP_DRVI = 0x52,    /* 相对定位: operand1 = 移动量，operand2 = 频率 */
+    OP_DRVA = 0x53,    /* 绝对定位: operand1 = 目标位置，operand2 = 频率 */
+    OP_ZRN = 0x54,     /* 原点回归: operand1 = 回归速度，operand2 = 近点信号 DOG */
+    
     /* 其他 */
     OP_NOP = 0xFF      /* 无操作 */
 } fx3u_opcode_t;
 
 /* ===== 指令格式 ===== */
-typedef struct {
+typedef struct fx3u_instruction_t {
     uint8_t opcode;
     uint16_t operand1;  /* 第一个操作数 (继电器地址等) */
     uint16_t operand2;  /* 第二个操作数 */
@@ -66,7 +80,10 @@ typedef enum {
     REG_TIMER = 0x03,   /* 定时器 T */
     REG_COUNTER = 0x04, /* 计数器 C */
     REG_DATA = 0x05,    /* 数据寄存器 D */
-    REG_PULSE = 0x06    /* 脉冲 P */
+    REG_STATE = 0x06,   /* 状态 S */
+    REG_SPECIAL_RELAY = 0x07,    /* 特殊继电器 M8000- */
+    REG_SPECIAL_DATA = 0x08,     /* 特殊寄存器 D8000- */
+    REG_PULSE = 0x09    /* 脉冲 P */
 } fx3u_register_type_t;
 
 /* ===== 函数声明 ===== */
@@ -96,6 +113,19 @@ inst_result_t fx3u_set(fx3u_core_t *plc, uint16_t address);
 inst_result_t fx3u_rst(fx3u_core_t *plc, uint16_t address);
 inst_result_t fx3u_pls(fx3u_core_t *plc, uint16_t address);
 
+/* 高速计数器比较指令 */
+inst_result_t fx3u_dhscs(fx3u_core_t *plc, uint16_t target_addr, uint16_t counter_addr,
+                         uint16_t device);
+inst_result_t fx3u_dhscr(fx3u_core_t *plc, uint16_t target_addr, uint16_t counter_addr,
+                         uint16_t device);
+
+/* 脉冲输出与定位指令 */
+inst_result_t fx3u_plsy(fx3u_core_t *plc, uint16_t freq_addr, uint16_t count_addr, uint16_t output);
+inst_result_t fx3u_plsr(fx3u_core_t *plc, uint16_t freq_addr, uint16_t count_addr, uint16_t output);
+inst_result_t fx3u_drvi(fx3u_core_t *plc, uint16_t distance_addr, uint16_t freq_addr, uint16_t output);
+inst_result_t fx3u_drva(fx3u_core_t *plc, uint16_t position_addr, uint16_t freq_addr, uint16_t output);
+inst_result_t fx3u_zrn(fx3u_core_t *plc, uint16_t speed_addr, uint16_t dog, uint16_t output);
+
 /* 辅助函数 */
 uint8_t fx3u_get_bit(fx3u_core_t *plc, uint16_t address);
 void fx3u_set_bit(fx3u_core_t *plc, uint16_t address, uint8_t value);
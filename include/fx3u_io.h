@@ -92,6 +92,8 @@
 #define PICO_INPUT_X9_GPIO      PICO_PIN20_X9          /* GPIO15 */
 #define PICO_INPUT_PULL_UP      true   /* 建议使用内部上拉（若接地闭合） */
 #define PICO_INPUT_DEBOUNCE_MS  20     /* 去抖动延迟(ms) */
+#define PICO_INPUT_SAMPLE_MS    (PICO_INPUT_DEBOUNCE_MS / 4)   /* 连续 4 次采样一致才确认 */
+#define PICO_INPUT_FAST_MASK    0x0001 /* 启用沿中断快速响应的 X (bit n = Xn)，默认 X0 (急停) */
 
 /* 数字输出组合 (Y0-Y8) */
 #define PICO_OUTPUT_Y0_GPIO     PICO_PIN29_Y0          /* GPIO22 */
@@ -146,6 +148,21 @@ typedef struct {
     bool initialized;
 } io_manager_t;
 
+/* ===== 输入响应时间统计 ===== */
+#define IO_REACTION_BUCKETS     20     /* 桶 i: [2^i, 2^(i+1)) us，桶 0 含 0us，末桶含更长 */
+
+typedef struct {
+    uint32_t count;                     /* 已测量次数 */
+    uint32_t min_us;
+    uint32_t max_us;
+    uint32_t buckets[IO_REACTION_BUCKETS];
+    uint32_t edges;                     /* 接受的输入沿 */
+    uint32_t bounces;                   /* 锁定期内忽略的沿 */
+} io_reaction_stats_t;
+
+/* 输入沿回调 (GPIO 中断中调用): changed 为翻转的 X 位，stamp_us 为沿时刻 */
+typedef void (*io_input_edge_callback_t)(uint32_t changed, uint32_t stamp_us);
+
 /* ===== 函数声明 ===== */
 
 /* 初始化与维护 */
@@ -170,7 +187,15 @@ bool io_get_switch_run(void);
 
 /* 数字输入/输出 (批量) */
 void io_write_output_word(uint16_t value);  /* 写 Y0-Y8 (9 bit) */
-uint16_t io_read_input_word(void);          /* 读 X0-X9 (10 bit) */
+uint16_t io_read_input_word(void);          /* 读 X0-X9 (10 bit，去抖后) */
+uint32_t io_sample_inputs(void);            /* 采样一次全部输入并去抖，返回去抖后的 X 字 */
+
+/* 输入沿中断: 首沿立即生效，其后 PICO_INPUT_DEBOUNCE_MS 内的沿视为抖动 */
+void io_enable_input_irq(uint32_t x_mask, io_input_edge_callback_t callback);
+/* 高速计数器等占用的 X: 关闭其沿中断 (占用后不再释放) */
+void io_claim_inputs(uint32_t x_mask);
+void io_get_reaction_stats(io_reaction_stats_t *stats);
+void io_reset_reaction_stats(void);
 
 /* ADC (模拟输入) */
 uint16_t io_read_adc_ai0(void);     /* 读 AI0 (GPIO26) */
@@ -183,7 +208,7 @@ uint16_t io_adc_to_millivolts(uint16_t adc_value);  /* ADC 转换为 mV */
 void io_rs485_set_de(bool enable);  /* 驱动使能 (发送/接收切换) */
 void io_rs485_set_re(bool enable);  /* 接收使能 */
 
-/* 脉冲输出 (PWM) */
+/* 脉冲输出 (PWM，定频不计数；定位用 fx3u_pulse.h) */
 void io_enable_pwm(uint8_t gpio_num, uint16_t frequency_hz, uint8_t duty_percent);
 void io_disable_pwm(uint8_t gpio_num);
 
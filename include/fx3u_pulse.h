@@ -0,0 +1,93 @@
+/**
+ * 脉冲输出与定位 Y0-Y2 (PIO 硬件脉冲串)
+ *
+ * 每个输出占用一个 PIO 状态机，运动在启动时规划为 "段" 表 (脉冲数, 半周期)，
+ * DMA 把段表送入 TX FIFO，状态机按段输出精确个数的脉冲，加减速和脉冲计数全程不需要 CPU。
+ * 加速 / 减速各分为 FX3U_PULSE_RAMP_STEPS 段梯形斜坡，距离不足时截去高速段 (三角形)。
+ *
+ * 与 FX3U 相同的特殊软元件 (Y1 为 +10，Y2 为 +20，如 D8350 为 Y1 当前位置):
+ * - D8340/D8341 当前位置 (32 位，可改写)      D8342 基底速度 (Hz)
+ * - D8343/D8344 最高速度 (Hz，默认 200000)     D8345 爬行速度 (Hz，ZRN)
+ * - D8348 加速时间 (ms)                       D8349 减速时间 (ms)
+ * - M8340 脉冲输出中   M8342 正方向回原点   M8349 脉冲停止指令 (立即停止)
+ * - M8029 指令执行结束 (紧跟定位指令读取)，M8329 指令执行异常结束
+ *
+ * 方向输出固定为 Y4 (Y0) / Y5 (Y1) / Y6 (Y2)，ON = 正方向。
+ * 脉冲程序不能与高速计数器共用一个 PIO 块，两个块都被高速计数器占用时定位指令异常结束。
+ *
+ * 主机构建没有 PIO，由 fx3u_pulse_sim_run() 按同一张段表输出脉冲。
+ */
+
+#ifndef __FX3U_PULSE_H__
+#define __FX3U_PULSE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fx3u_core.h"
+
+#define FX3U_PULSE_CHANNELS     3       /* Y0-Y2 */
+#define FX3U_PULSE_MAX_HZ       200000
+#define FX3U_PULSE_RAMP_STEPS   16      /* 加速 / 减速各 16 段 */
+#define FX3U_PULSE_SEGMENTS     96      /* 段表长度: 斜坡 32 段 + 巡航 */
+#define FX3U_PULSE_CRUISE_MS    20      /* 巡航按约 20ms 分段，当前位置按段更新 */
+#define FX3U_PULSE_DIR_BASE     4       /* 方向输出 Y4-Y6 */
+#define FX3U_PULSE_DEVICE_STEP  10      /* 特殊软元件按输出间隔 10 */
+
+#define M8029   8029    /* 指令执行结束 */
+#define M8329   8329    /* 指令执行异常结束 */
+#define M8340   8340    /* Y0 脉冲输出中 */
+#define M8342   8342    /* Y0 正方向回原点 */
+#define M8349   8349    /* Y0 脉冲停止指令 */
+#define D8340   8340    /* Y0 当前位置 (32 位) */
+#define D8342   8342    /* Y0 基底速度 */
+#define D8343   8343    /* Y0 最高速度 (32 位) */
+#define D8345   8345    /* Y0 爬行速度 */
+#define D8348   8348    /* Y0 加速时间 */
+#define D8349   8349    /* Y0 减速时间 */
+
+typedef enum {
+    FX3U_PULSE_IDLE = 0,
+    FX3U_PULSE_RUNNING = 1,
+    FX3U_PULSE_DONE = 2,                /* 按规划输出完毕 (ZRN: 已回原点) */
+    FX3U_PULSE_STOPPED = 3              /* 被停止 (驱动 OFF / M8349 / STOP) */
+} fx3u_pulse_state_t;
+
+typedef struct {
+    uint32_t moves;                     /* 启动的运动 */
+    uint32_t pulses;                    /* 已输出脉冲 (停止或完成时累计) */
+    uint32_t stops;
+    uint32_t allocation_failures;       /* 无可用 PIO 块 / 状态机 / DMA */
+    uint32_t halt_retries;              /* 停止时处于高电平，延后到轮询 */
+} fx3u_pulse_stats_t;
+
+void fx3u_pulse_init(fx3u_core_t *plc);
+
+/*
+ * 启动运动，返回运动编号 (0 = 通道忙、参数无效或无可用 PIO，M8329 置位)
+ * PLSY: 无斜坡，pulses = 0 为无限；PLSR: 加减速时间均为 D8348；
+ * DRVI / DRVA: 加速 D8348，减速 D8349；ZRN: 以 hz 反方向运行，DOG 为 ON 后减速到爬行速度，
+ * DOG 变为 OFF 时停止并把当前位置清零
+ */
+uint32_t fx3u_pulse_plsy(uint8_t channel, uint32_t hz, uint32_t pulses);
+uint32_t fx3u_pulse_plsr(uint8_t channel, uint32_t hz, uint32_t pulses);
+uint32_t fx3u_pulse_drvi(uint8_t channel, int32_t distance, uint32_t hz);
+uint32_t fx3u_pulse_drva(uint8_t channel, int32_t position, uint32_t hz);
+uint32_t fx3u_pulse_zrn(uint8_t channel, uint32_t hz, uint16_t dog);
+
+/* 停止运动 (move = 0 为当前运动)；decelerate 为 true 时按 D8349 减速停止 */
+void fx3u_pulse_stop(uint8_t channel, uint32_t move, bool decelerate);
+
+/* 运动状态: move 不是当前运动时返回 STOPPED */
+fx3u_pulse_state_t fx3u_pulse_state(uint8_t channel, uint32_t move);
+int32_t fx3u_pulse_position(uint8_t channel);
+uint32_t fx3u_pulse_frequency(uint8_t channel);     /* 当前段的输出频率 (Hz)，空闲为 0 */
+
+/* 主循环调用: M8349 / STOP / ZRN 的 DOG 信号，停止时处于高电平的延后处理，更新当前位置 */
+void fx3u_pulse_poll(void);
+
+void fx3u_pulse_get_stats(fx3u_pulse_stats_t *stats);
+
+/* 模拟输出 (仅主机构建 PICO_ON_DEVICE == 0): 输出至多 pulses 个脉冲，返回实际个数 */
+uint32_t fx3u_pulse_sim_run(uint8_t channel, uint32_t pulses);
+
+#endif /* __FX3U_PULSE_H__ */
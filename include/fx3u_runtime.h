@@ -0,0 +1,69 @@
+/**
+ * PLC 运行时 (固件主程序与 Arduino 示例共用)
+ *
+ * 持有 PLC 实例与全部外设 / 通信对象。扫描 (输入展开、程序执行、发布映像、写出 Y)
+ * 由调度策略按周期触发；主循环的工作 (输入锁存、RS485 / TCP / USB 通信、
+ * 指示灯、外设轮询、日志) 是 fx3u_tasks 中按优先级与周期运行的任务，
+ * 指示灯任务由扫描结束触发，没有就绪任务时主循环休眠 (负载见 D8490)。
+ *
+ * 保证:
+ * - 同一时刻只有一次扫描: 扫描进行中到达的沿扫描合并为当前扫描之后补做一次
+ * - 每个周期至多一次常规扫描: 定时器追赶积压的节拍被丢弃 (计入 late_ticks)
+ * - 扫描超过 D8000 或主循环停滞时输出置安全状态并复位，故障记录跨复位保留 (fx3u_watchdog.h)
+ *
+ * 前端只需:
+ *   fx3u_runtime_init(&config);
+ *   fx3u_runtime_start();
+ *   while (1) fx3u_runtime_poll();
+ */
+
+#ifndef __FX3U_RUNTIME_H__
+#define __FX3U_RUNTIME_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fx3u_core.h"
+
+#define FX3U_RUNTIME_SCAN_PERIOD_US     200000      /* 默认扫描周期 */
+
+/* 调度策略: start 之后按周期调用 tick；poll 非 NULL 时作为 1ms 周期的最高优先级任务运行 */
+typedef struct {
+    void (*start)(uint32_t period_us, void (*tick)(void));
+    void (*stop)(void);
+    void (*poll)(void);
+} fx3u_runtime_scheduler_t;
+
+/* 重复定时器中断 (默认，与沿中断 / PIO 中断同优先级，互不抢占) */
+extern const fx3u_runtime_scheduler_t fx3u_runtime_timer_scheduler;
+/* 主循环按时间轮询 (没有可用定时器中断的前端)，扫描在主循环上下文执行 */
+extern const fx3u_runtime_scheduler_t fx3u_runtime_loop_scheduler;
+
+typedef struct {
+    const char *banner;                 /* 启动时打印的标题 */
+    uint32_t scan_period_us;            /* 0 为默认 */
+    const fx3u_runtime_scheduler_t *scheduler;  /* NULL 为定时器中断 */
+    uint32_t safe_outputs;              /* 看门狗跳闸时 Y0-Y8 的值 (默认全部 OFF) */
+    bool hold_outputs;                  /* 跳闸时 Y 保持不变 (脉冲输出仍立即停止) */
+} fx3u_runtime_config_t;
+
+typedef struct {
+    uint32_t scans;                     /* 常规扫描 */
+    uint32_t edge_scans;                /* 快速输入沿触发的周期外扫描 */
+    uint32_t merged;                    /* 扫描进行中到达、合并补做的请求 */
+    uint32_t late_ticks;                /* 距上次常规扫描不足半个周期而丢弃的节拍 */
+} fx3u_runtime_stats_t;
+
+/* 初始化 PLC 核心、程序、I/O、PIO 外设与通信 (不启动扫描) */
+void fx3u_runtime_init(const fx3u_runtime_config_t *config);
+
+/* PLC 进入 RUN 并启动调度 */
+void fx3u_runtime_start(void);
+void fx3u_runtime_stop(void);
+
+/* 主循环反复调用: 执行一个就绪任务，空闲时休眠 */
+void fx3u_runtime_poll(void);
+
+fx3u_core_t *fx3u_runtime_plc(void);
+void fx3u_runtime_get_stats(fx3u_runtime_stats_t *stats);
+
+#endif /* __FX3U_RUNTIME_H__ */
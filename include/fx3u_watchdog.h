@@ -0,0 +1,102 @@
+/**
+ * 扫描看门狗 (D8000) 与复位后的故障记录
+ *
+ * 与 FX3U 相同，D8000 为看门狗时间 (ms，默认 200，程序或通信可改写，下一扫描生效)。
+ * 两级监视:
+ * - 预看门狗: 每次扫描开始把独立的硬件 alarm 设为 开始 + D8000，扫描结束取消；
+ *   alarm 中断优先级最高，可以抢占卡在扫描中断或主循环中的程序。
+ *   到期时记录故障、输出置安全状态，然后经硬件看门狗复位
+ * - 硬件看门狗: 只在扫描正常结束且主循环心跳未超时时喂狗，
+ *   关中断死循环 / flash 停滞等预看门狗无法执行的情况由它复位
+ *
+ * 关中断的长操作 (Flash 擦除) 之前调用 fx3u_watchdog_extend(): 刷新主循环心跳，
+ * 硬件看门狗临时放宽到该操作的最长时间，下一次扫描结束恢复。
+ *
+ * 故障记录放在不初始化的 RAM 中，复位后仍保留: 原因、阶段、执行中的程序步与指令、
+ * 主循环任务、扫描次数与时刻。硬件看门狗直接复位时只有扫描开始时留下的阶段与时刻。
+ * 复位后 fx3u_watchdog_last_record() 取出上一次的记录，运行时置错误码 6105。
+ *
+ * 主机构建没有 alarm / 看门狗，fx3u_watchdog_sim_expire() 模拟预看门狗到期，
+ * 再次 fx3u_watchdog_init() 相当于复位后启动。
+ */
+
+#ifndef __FX3U_WATCHDOG_H__
+#define __FX3U_WATCHDOG_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fx3u_core.h"
+
+#define FX3U_WATCHDOG_DEFAULT_MS        200     /* D8000 默认值 */
+#define FX3U_WATCHDOG_MAX_MS            4000    /* D8000 上限 (硬件看门狗最长约 8.3s) */
+#define FX3U_WATCHDOG_LOOP_LIMIT_MS     1000    /* 主循环心跳超时默认值 */
+#define FX3U_WATCHDOG_HW_MARGIN_MS      100     /* 硬件看门狗 = 扫描周期 + D8000 + 余量 */
+#define FX3U_WATCHDOG_RESET_DELAY_MS    10      /* 跳闸到复位 */
+#define FX3U_WATCHDOG_ERROR             6105    /* 看门狗错误 (D8006) */
+
+typedef enum {
+    FX3U_WATCHDOG_PHASE_IDLE = 0,       /* 扫描之间 */
+    FX3U_WATCHDOG_PHASE_INPUT = 1,      /* 扩展输入 */
+    FX3U_WATCHDOG_PHASE_PROGRAM = 2,    /* 输入展开、程序执行、发布映像 */
+    FX3U_WATCHDOG_PHASE_OUTPUT = 3      /* 扩展输出、写出 Y */
+} fx3u_watchdog_phase_t;
+
+typedef enum {
+    FX3U_WATCHDOG_CAUSE_NONE = 0,
+    FX3U_WATCHDOG_CAUSE_SCAN = 1,       /* 扫描超过 D8000 */
+    FX3U_WATCHDOG_CAUSE_LOOP = 2,       /* 主循环心跳超时 */
+    FX3U_WATCHDOG_CAUSE_HARDWARE = 3    /* 硬件看门狗复位 (预看门狗未能执行) */
+} fx3u_watchdog_cause_t;
+
+typedef struct {
+    uint32_t magic;
+    uint8_t cause;                      /* fx3u_watchdog_cause_t */
+    uint8_t phase;                      /* fx3u_watchdog_phase_t */
+    int8_t task;                        /* 执行中的主循环任务，-1 = 无 */
+    uint8_t reserved;
+    uint32_t step;                      /* 执行中的程序步 (PROGRAM 阶段有效) */
+    uint16_t opcode;                    /* 该步的指令 */
+    uint16_t limit_ms;                  /* 当时的 D8000 */
+    uint32_t scan_count;
+    uint64_t scan_start_us;             /* 扫描开始时刻 (启动后 us) */
+    uint64_t timestamp_us;              /* 跳闸时刻，硬件复位时为 0 */
+    uint32_t resets;                    /* 累计看门狗复位次数 (上电清零) */
+} fx3u_watchdog_record_t;
+
+typedef struct {
+    uint32_t scan_period_us;            /* 常规扫描周期，决定硬件看门狗时间 */
+    uint32_t loop_limit_ms;             /* 0 为默认 */
+    void (*safe_state)(void);           /* 跳闸时在中断中调用: 输出置安全状态 */
+} fx3u_watchdog_config_t;
+
+/* 读取并清除上一次复位留下的记录 (init 前的复位原因在此判断) */
+void fx3u_watchdog_init(fx3u_core_t *plc, const fx3u_watchdog_config_t *config);
+
+/* 启动后开始喂狗 (与扫描调度同时启动 / 停止) */
+void fx3u_watchdog_start(void);
+void fx3u_watchdog_stop(void);
+
+/* 扫描引擎调用 (扫描上下文) */
+void fx3u_watchdog_scan_begin(void);
+void fx3u_watchdog_phase(fx3u_watchdog_phase_t phase);
+void fx3u_watchdog_scan_end(void);
+
+/* 主循环心跳 (低优先级任务调用) */
+void fx3u_watchdog_poll(void);
+
+/* 主循环中的长操作之前调用: 刷新心跳，硬件看门狗至少放宽到 ms + 余量 */
+void fx3u_watchdog_extend(uint32_t ms);
+
+/* 已跳闸、等待复位: 扫描与中断不应再写输出 */
+bool fx3u_watchdog_tripped(void);
+uint16_t fx3u_watchdog_limit_ms(void);
+
+/* 上一次复位的记录 (没有看门狗复位返回 false) */
+bool fx3u_watchdog_last_record(fx3u_watchdog_record_t *record);
+const char *fx3u_watchdog_cause_name(uint8_t cause);
+const char *fx3u_watchdog_phase_name(uint8_t phase);
+
+/* 主机构建: 预看门狗到期 */
+void fx3u_watchdog_sim_expire(void);
+
+#endif /* __FX3U_WATCHDOG_H__ */
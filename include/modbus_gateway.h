@@ -0,0 +1,98 @@
+/**
+ * MODBUS TCP -> RTU 网关
+ *
+ * - 单元标识非本机的 TCP 请求转发到 RS485 下游总线
+ * - 多个 TCP 客户端的请求在队列中按客户端轮转，复用单条半双工总线
+ * - 应答按入队时记录的 (连接, 事务标识) 送回，连接已断开则丢弃
+ * - 相同读请求 (FC01-04) 在短 TTL 内由应答缓存直接应答；
+ *   转发到同一单元的写请求使该单元的缓存失效
+ */
+
+#ifndef __MODBUS_GATEWAY_H__
+#define __MODBUS_GATEWAY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "modbus_master.h"
+#include "modbus_tcp.h"
+
+/* 网关模式下 RS485 作为主站，不再响应本机从站请求 */
+#ifndef PICO_MODBUS_GATEWAY_ENABLED
+#define PICO_MODBUS_GATEWAY_ENABLED     0
+#endif
+
+#if PICO_MODBUS_GATEWAY_ENABLED && !PICO_ETHERNET_ENABLED
+#error "PICO_MODBUS_GATEWAY_ENABLED requires PICO_ETHERNET_ENABLED"
+#endif
+
+#define MODBUS_GATEWAY_QUEUE_SIZE       16
+#define MODBUS_GATEWAY_CACHE_SIZE       8
+#define MODBUS_GATEWAY_CACHE_TTL_MS     50
+#define MODBUS_GATEWAY_UTIL_WINDOW_MS   1000    /* 总线占用率统计窗口 */
+
+/* ===== 排队中的转发请求 ===== */
+typedef struct {
+    bool in_use;
+    uint8_t socket;
+    uint32_t generation;            /* 入队时的连接代次 */
+    uint16_t transaction_id;
+    uint32_t order;                 /* 入队序号，同一客户端内先进先出 */
+    uint16_t length;                /* RTU 帧长度 (含CRC) */
+    uint8_t frame[MODBUS_MASTER_FRAME_SIZE];
+} modbus_gateway_request_t;
+
+/* ===== 应答缓存项 ===== */
+typedef struct {
+    bool valid;
+    uint8_t key[6];                 /* 单元 功能码 地址(2) 数量(2) */
+    uint64_t stored_us;
+    uint16_t length;                /* [单元][PDU]，不含CRC */
+    uint8_t response[MODBUS_TCP_MAX_ADU - 6];
+} modbus_gateway_cache_entry_t;
+
+/* ===== 诊断 ===== */
+typedef struct {
+    uint8_t queue_depth[MODBUS_TCP_MAX_CONNECTIONS];
+    uint8_t max_queue_depth[MODBUS_TCP_MAX_CONNECTIONS];
+    uint32_t forwarded;
+    uint32_t cache_hits;
+    uint32_t timeouts;              /* 下游无应答，返回异常 0x0B */
+    uint32_t bad_responses;         /* 下游应答无效 (CRC / 站号 / 功能码 / 长度)，返回异常 0x0B */
+    uint32_t queue_full;            /* 队列满，返回异常 0x06 */
+    uint32_t dropped;               /* 客户端已断开，请求或应答被丢弃 */
+    uint16_t bus_utilisation;       /* 上一统计窗口的总线占用率 (千分比) */
+} modbus_gateway_diag_t;
+
+typedef struct modbus_gateway {
+    modbus_master_t *master;
+    modbus_tcp_server_t *server;
+    uint32_t cache_ttl_us;
+
+    modbus_gateway_request_t queue[MODBUS_GATEWAY_QUEUE_SIZE];
+    uint32_t next_order;
+    int8_t active;                  /* 正在总线上的队列项，-1 表示无 */
+    uint8_t last_socket;            /* 轮转起点 */
+
+    modbus_gateway_cache_entry_t cache[MODBUS_GATEWAY_CACHE_SIZE];
+    uint8_t cache_next;
+
+    uint8_t tx[MODBUS_TCP_MAX_ADU];
+    uint64_t last_poll_us;
+    uint64_t window_start_us;
+    uint64_t busy_us;
+    modbus_gateway_diag_t diag;
+} modbus_gateway_t;
+
+void modbus_gateway_init(modbus_gateway_t *gateway, modbus_master_t *master,
+                         modbus_tcp_server_t *server);
+
+/* 由 TCP 服务端调用: 立即可应答 (缓存命中/队列满) 时返回 MBAP 响应长度，已排队返回 0 */
+int modbus_gateway_forward(modbus_gateway_t *gateway, uint8_t socket,
+                           const uint8_t *request, uint16_t length, uint8_t *response);
+
+/* 主循环中调用，须位于 modbus_master_poll 之前 */
+void modbus_gateway_poll(modbus_gateway_t *gateway);
+
+const modbus_gateway_diag_t *modbus_gateway_get_diag(const modbus_gateway_t *gateway);
+
+#endif /* __MODBUS_GATEWAY_H__ */
@@ -0,0 +1,127 @@
+/**
+ * MODBUS RTU 主站引擎
+ *
+ * - 轮询表: (从站, 功能码, 地址范围, 周期) -> 本地 D/M 映射
+ * - 同一从站/功能码下相邻或重叠的范围自动合并为最少的请求
+ * - 按截止时间 (最早到期优先) 调度，单总线同一时刻仅一个事务
+ * - 响应直接解析到过程映像写队列，下一次扫描开始时生效
+ * - 按从站统计延迟、超时与重试
+ */
+
+#ifndef __MODBUS_MASTER_H__
+#define __MODBUS_MASTER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "modbus_protocol.h"
+#include "fx3u_image.h"
+
+#define MODBUS_MASTER_MAX_POLLS         32      /* 轮询表容量 */
+#define MODBUS_MASTER_MAX_BLOCKS        32      /* 合并后的请求块容量 */
+#define MODBUS_MASTER_MAX_SLAVES        16      /* 统计的从站数量 */
+#define MODBUS_MASTER_MAX_GAP           8       /* 合并时允许跨越的地址空洞 */
+#define MODBUS_MASTER_MAX_READ_BITS     2000    /* FC01/02 单次上限 */
+#define MODBUS_MASTER_FRAME_SIZE        256
+
+/* ===== 轮询表项 ===== */
+typedef struct {
+    uint8_t slave_id;
+    uint8_t function;               /* 0x01 / 0x02 / 0x03 / 0x04 */
+    uint16_t address;               /* 远端起始地址 */
+    uint16_t quantity;
+    uint32_t period_ms;
+    fx3u_image_area_t local_area;   /* 寄存器映射到 D，位映射到 M/Y/X */
+    uint16_t local_address;
+} modbus_poll_entry_t;
+
+/* ===== 合并后的请求块 ===== */
+typedef struct {
+    uint8_t slave_id;
+    uint8_t function;
+    uint16_t address;
+    uint16_t quantity;
+    uint32_t period_us;             /* 成员中的最短周期 */
+    uint64_t next_due_us;
+    uint8_t first_member;           /* 排序后轮询表中的起始下标 */
+    uint8_t member_count;
+} modbus_poll_block_t;
+
+/* ===== 从站统计 ===== */
+typedef struct {
+    uint8_t slave_id;
+    uint32_t requests;
+    uint32_t responses;
+    uint32_t timeouts;
+    uint32_t retries;
+    uint32_t crc_errors;
+    uint32_t exceptions;
+    uint32_t last_latency_us;
+    uint32_t min_latency_us;
+    uint32_t max_latency_us;
+    uint32_t avg_latency_us;        /* 指数滑动平均 (1/8) */
+} modbus_slave_stats_t;
+
+/* ===== 事务结果 ===== */
+typedef enum {
+    MODBUS_MASTER_OK = 0,
+    MODBUS_MASTER_TIMEOUT = 1,
+    MODBUS_MASTER_EXCEPTION = 2,
+    MODBUS_MASTER_BAD_RESPONSE = 3
+} modbus_master_result_t;
+
+typedef void (*modbus_master_callback_t)(void *user, modbus_master_result_t result,
+                                         const uint8_t *response, uint16_t length);
+
+/* ===== 传输层 (RS485 等半双工总线) ===== */
+typedef struct {
+    void (*send)(uint8_t *buffer, uint16_t length);
+    int (*receive)(uint8_t *buffer, uint16_t max_len);
+} modbus_master_transport_t;
+
+/* ===== 主站引擎 ===== */
+typedef struct {
+    modbus_master_transport_t transport;
+    uint32_t timeout_us;
+    uint32_t frame_gap_us;          /* 无法预知长度时按帧间静默判定结束 */
+    uint8_t max_retries;
+
+    modbus_poll_entry_t polls[MODBUS_MASTER_MAX_POLLS];
+    uint8_t poll_count;
+    modbus_poll_block_t blocks[MODBUS_MASTER_MAX_BLOCKS];
+    uint8_t block_count;
+    modbus_slave_stats_t slaves[MODBUS_MASTER_MAX_SLAVES];
+    uint8_t slave_count;
+
+    /* 当前事务 */
+    modbus_state_t state;
+    int16_t active_block;           /* -1 表示外部提交的事务 */
+    uint8_t tx[MODBUS_MASTER_FRAME_SIZE];
+    uint16_t tx_len;
+    uint8_t rx[MODBUS_MASTER_FRAME_SIZE];
+    uint16_t rx_len;
+    uint16_t expected_len;
+    modbus_crc_ctx_t rx_crc;
+    uint64_t sent_us;
+    uint64_t last_rx_us;
+    uint8_t retries_left;
+    modbus_master_callback_t callback;
+    void *callback_user;
+} modbus_master_t;
+
+void modbus_master_init(modbus_master_t *master, const modbus_master_transport_t *transport);
+bool modbus_master_set_poll_table(modbus_master_t *master,
+                                  const modbus_poll_entry_t *entries, uint8_t count);
+void modbus_master_poll(modbus_master_t *master);
+bool modbus_master_is_idle(const modbus_master_t *master);
+
+/* 外部事务 (网关转发等) - 仅在空闲时接受 */
+bool modbus_master_submit(modbus_master_t *master, const uint8_t *request, uint16_t length,
+                          modbus_master_callback_t callback, void *user);
+
+/* 响应长度推算，无法推算时返回 0 */
+uint16_t modbus_expected_response_length(const uint8_t *request, uint16_t length);
+
+const modbus_slave_stats_t *modbus_master_get_stats(const modbus_master_t *master,
+                                                    uint8_t slave_id);
+
+#endif /* __MODBUS_MASTER_H__ */
@@ -9,6 +9,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "fx3u_core.h"
+#include "modbus_crc.h"
 
 /* ===== MODBUS 功能码 ===== */
 #define MODBUS_READ_COIL_STATUS         0x01
@@ -19,6 +20,66 @@
 #define MODBUS_WRITE_SINGLE_REGISTER    0x06
 #define MODBUS_WRITE_MULTIPLE_COILS     0x0F
 #define MODBUS_WRITE_MULTIPLE_REGISTERS 0x10
+#define MODBUS_READ_FILE_RECORD         0x14
+#define MODBUS_WRITE_FILE_RECORD        0x15
+#define MODBUS_READ_WRITE_MULTIPLE_REGISTERS 0x17
+
+/* 用户自定义功能码 (65-72) */
+#define MODBUS_READ_CHANGED_REGISTERS   0x41    /* 读取自某变化序号以来改变的保持寄存器 */
+
+/* 单次事务数量上限 (协议规定) */
+#define MODBUS_MAX_READ_REGISTERS       125
+#define MODBUS_MAX_WRITE_REGISTERS      123
+#define MODBUS_RW_MAX_READ              125
+#define MODBUS_RW_MAX_WRITE             121
+#define MODBUS_MAX_READ_BITS            2000
+#define MODBUS_MAX_WRITE_BITS           1968
+#define MODBUS_CHANGES_MAX_ENTRIES      60      /* 0x41 每次应答的条目上限 (4 字节/条) */
+#define MODBUS_FILE_MAX_READ_BYTES      0xF5    /* 0x14 应答数据长度上限 */
+#define MODBUS_FILE_MAX_WRITE_BYTES     0xFB    /* 0x15 请求数据长度上限 (单条最多 122 记录) */
+
+/* ===== 文件记录 (0x14 / 0x15)，记录为 16 位 ===== */
+#define MODBUS_FILE_REFERENCE_TYPE      0x06
+#define MODBUS_FILE_CONTROL             0x0001  /* 记录 0 写命令；读为下载状态 */
+#define MODBUS_FILE_ADDRESS_MAP         0x0002  /* 地址映射表镜像: 写入暂存，读出当前映射 */
+#define MODBUS_FILE_PROFILE             0x0003  /* 扫描时间分析摘要 (只读) */
+#define MODBUS_FILE_PROFILE_STEPS       0x0004  /* 逐步统计 (只读，条目格式见下) */
+#define MODBUS_FILE_PROFILE_OPCODES     0x0005  /* 逐指令统计 */
+#define MODBUS_FILE_PROFILE_RUNGS       0x0006  /* 逐梯级统计 */
+#define MODBUS_FILE_PROGRAM             0x0100  /* 程序镜像首文件，每文件 16KB，连续编号 */
+#define MODBUS_FILE_PROGRAM_RECORDS     8192
+
+/* 控制文件命令 (记录 0) 及其后的参数记录 */
+#define MODBUS_FILE_CMD_BEGIN           1       /* 步数(2) CRC32(2)，立即应答，目标槽在后台擦除 */
+#define MODBUS_FILE_CMD_COMMIT          2       /* 校验并在下一扫描开始时切换 */
+#define MODBUS_FILE_CMD_ABORT           3
+#define MODBUS_FILE_CMD_APPLY_MAP       4       /* 镜像字节数(1)，加载暂存的映射表镜像 */
+#define MODBUS_FILE_CMD_PROFILE         5       /* 操作(1): 0 停止 / 1 启动 / 2 清零 */
+
+/* 控制文件状态记录 (32 位值高字在前) */
+#define MODBUS_FILE_STATUS_STATE        0       /* fx3u_program_stage_state_t */
+#define MODBUS_FILE_STATUS_ERROR        1       /* fx3u_program_result_t */
+#define MODBUS_FILE_STATUS_EXPECTED     2       /* 镜像字节数 */
+#define MODBUS_FILE_STATUS_RECEIVED     4       /* 已接收字节数 */
+#define MODBUS_FILE_STATUS_CRC          6       /* 已接收部分 CRC32 */
+#define MODBUS_FILE_STATUS_EXPECTED_CRC 8
+#define MODBUS_FILE_STATUS_STEPS        10      /* 运行中程序步数 */
+#define MODBUS_FILE_STATUS_GENERATION   12      /* 运行中程序代数 */
+#define MODBUS_FILE_STATUS_ERASED       14      /* 程序区已擦除字节数 */
+#define MODBUS_FILE_STATUS_RECORDS      16
+
+/* 分析摘要记录 (32 / 64 位值高字在前) */
+#define MODBUS_FILE_PROFILE_ENABLED     0
+#define MODBUS_FILE_PROFILE_CYCLES_US   1       /* 计数 / us */
+#define MODBUS_FILE_PROFILE_SCANS       2
+#define MODBUS_FILE_PROFILE_TOTAL       4       /* 64 位 */
+#define MODBUS_FILE_PROFILE_UNCOVERED   8       /* 64 位 */
+#define MODBUS_FILE_PROFILE_STEP_COUNT  12
+#define MODBUS_FILE_PROFILE_RUNG_COUNT  13
+#define MODBUS_FILE_PROFILE_RECORDS     14
+
+/* 分析条目: 编号(1) 次数(2) 累计(4) 最大(2)，条目 n 从记录 n * 9 开始 */
+#define MODBUS_FILE_PROFILE_ENTRY_RECORDS   9
 
 /* ===== 异常码 ===== */
 #define MODBUS_EXCEPTION_INVALID_FUNCTION   0x01
@@ -29,6 +90,8 @@
 #define MODBUS_EXCEPTION_DEVICE_BUSY        0x06
 #define MODBUS_EXCEPTION_NAK                0x07
 #define MODBUS_EXCEPTION_MEMORY_ERROR       0x08
+#define MODBUS_EXCEPTION_GATEWAY_PATH       0x0A
+#define MODBUS_EXCEPTION_GATEWAY_TARGET     0x0B
 
 /* ===== MODBUS 帧结构 ===== */
 typedef struct {
@@ -73,6 +136,11 @@ uint16_t modbus_crc16(uint8_t *data, uint16_t length);
 /* 从机操作 */
 int modbus_slave_process(fx3u_core_t *plc, uint8_t *rx_buffer, uint16_t rx_len, 
                          uint8_t *tx_buffer);
+int modbus_slave_process_crc(fx3u_core_t *plc, uint8_t *rx_buffer, uint16_t rx_len,
+                             uint8_t *tx_buffer, const modbus_crc_ctx_t *rx_crc);
+/* [单元标识][PDU]，不含CRC (MODBUS TCP)；返回响应长度，同样不含CRC */
+int modbus_slave_process_pdu(fx3u_core_t *plc, uint8_t *adu, uint16_t adu_len,
+                             uint8_t *tx_buffer);
 
 /* 主机操作 */
 int modbus_master_read_coils(uint8_t *buffer, uint8_t slave_id, 
@@ -83,6 +151,17 @@ int modbus_master_write_register(uint8_t *buffer, uint8_t slave_id,
                                  uint16_t address, uint16_t value);
 int modbus_master_write_registers(uint8_t *buffer, uint8_t slave_id, 
                                   uint16_t start_addr, uint16_t *values, uint16_t quantity);
+int modbus_master_read_write_registers(uint8_t *buffer, uint8_t slave_id,
+                                       uint16_t read_addr, uint16_t read_qty,
+                                       uint16_t write_addr, uint16_t *values,
+                                       uint16_t write_qty);
+int modbus_master_read_changes(uint8_t *buffer, uint8_t slave_id,
+                               uint16_t start_addr, uint16_t quantity, uint32_t since);
+int modbus_master_read_file_record(uint8_t *buffer, uint8_t slave_id,
+                                   uint16_t file, uint16_t record, uint16_t count);
+int modbus_master_write_file_record(uint8_t *buffer, uint8_t slave_id,
+                                    uint16_t file, uint16_t record,
+                                    const uint8_t *data, uint16_t count);
 
 /* 错误处理 */
 void modbus_send_exception(uint8_t *buffer, uint8_t slave_id, uint8_t function_code, 
@@ -1,5 +1,10 @@
 /**
  * RS485驱动程序
+ *
+ * RTU 帧接收 (rs485_frame_*): 字节跨多次轮询累计到同一缓冲，CRC 在出 FIFO 时同步累计，
+ * 最后一个字节之后总线静默满 t3.5 才交付整帧，帧尾校验为 O(1)。
+ * 字符时间按数据格式计算 (起始位 + 数据位 + 校验位 + 停止位)，
+ * 波特率高于 19200 时按 MODBUS 规定取固定值 t1.5 = 750us、t3.5 = 1750us。
  */
 
 #ifndef __RS485_DRIVER_H__
@@ -7,6 +12,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "modbus_crc.h"
 
 typedef struct {
     uint32_t baudrate;
@@ -16,10 +22,31 @@ typedef struct {
     bool rts_enabled;
 } rs485_config_t;
 
+/* ===== RTU 帧接收 ===== */
+typedef struct {
+    uint8_t *buffer;
+    uint16_t size;
+    uint16_t length;                    /* 已接收字节数 */
+    bool overflow;                      /* 超过 size 的帧在结束时整帧丢弃 */
+    uint32_t gap_us;                    /* 帧结束判定 (t3.5) */
+    uint64_t last_rx_us;                /* 最近一次收到字节的时刻 */
+    modbus_crc_ctx_t crc;               /* 已接收部分的 CRC */
+} rs485_frame_t;
+
 void rs485_init(rs485_config_t *config);
 void rs485_send(uint8_t *buffer, uint16_t length);
 int rs485_receive(uint8_t *buffer, uint16_t max_len);
 void rs485_set_receive_mode(void);
 void rs485_set_transmit_mode(void);
 
+/* 字符时间与 MODBUS 帧间隔 (us) */
+uint32_t rs485_char_time_us(const rs485_config_t *config);
+uint32_t rs485_frame_gap_us(const rs485_config_t *config);     /* t3.5 */
+uint32_t rs485_char_gap_us(const rs485_config_t *config);      /* t1.5 */
+
+void rs485_frame_init(rs485_frame_t *frame, uint8_t *buffer, uint16_t size, uint32_t gap_us);
+/* 收取 FIFO 中的字节；帧已结束时返回帧长度 (处理后须 rs485_frame_reset)，否则返回 0 */
+uint16_t rs485_frame_poll(rs485_frame_t *frame);
+void rs485_frame_reset(rs485_frame_t *frame);
+
 #endif
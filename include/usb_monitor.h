@@ -0,0 +1,115 @@
+/**
+ * USB 二进制监视协议
+ *
+ * 取代逐字符的本地命令，供上位机监视 / 调试软件使用:
+ * 帧: 0xA5 0x5A 命令(1) 序号(1) 长度(2, LE) 数据(长度) CRC16(2, LE)
+ * CRC 与 MODBUS 相同，覆盖 命令..数据。
+ * 应答命令为 请求命令 | 0x80，回送序号，数据首字节为状态码。
+ *
+ * - 批量读取: 一帧可含多个区段，全部来自同一次扫描的快照
+ * - 写入进入过程映像写队列，强制在扫描边界生效，扫描本身不做任何监视工作
+ * - 趋势: 主循环按快照变化序号采样并主动上送，发送缓冲不足时跳过并计数
+ * - 会话期间延迟日志改为 LOG 帧输出，监视器是 CDC 唯一写者
+ */
+
+#ifndef __USB_MONITOR_H__
+#define __USB_MONITOR_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fx3u_core.h"
+#include "fx3u_image.h"
+
+#define USB_MONITOR_VERSION             1
+#define USB_MONITOR_SYNC0               0xA5
+#define USB_MONITOR_SYNC1               0x5A
+#define USB_MONITOR_HEADER_SIZE         6
+#define USB_MONITOR_MAX_PAYLOAD         1024
+#define USB_MONITOR_MAX_FRAME           (USB_MONITOR_HEADER_SIZE + USB_MONITOR_MAX_PAYLOAD + 2)
+#define USB_MONITOR_TX_BUFFER           4096    /* 发送缓冲 (2的幂) */
+#define USB_MONITOR_TREND_RANGES        8
+#define USB_MONITOR_WRITE_MAX           128     /* 单帧写入字数上限 */
+
+/* ===== 命令 ===== */
+#define USB_MONITOR_CMD_HELLO           0x01    /* 打开会话，返回版本与各区大小 */
+#define USB_MONITOR_CMD_READ            0x02    /* N x [区(1) 起始(2) 个数(2)] */
+#define USB_MONITOR_CMD_WRITE           0x03    /* 区(1) 起始(2) 个数(2) 数据 */
+#define USB_MONITOR_CMD_FORCE           0x04    /* N x [X=0/Y=1(1) 编号(2) 方式(1)] */
+#define USB_MONITOR_CMD_RELEASE_FORCES  0x05
+#define USB_MONITOR_CMD_TREND_START     0x06    /* 周期(2, 发布次数) + N x 区段 */
+#define USB_MONITOR_CMD_TREND_STOP      0x07
+#define USB_MONITOR_CMD_STATS           0x08
+#define USB_MONITOR_CMD_RUN             0x09    /* 0 停止 / 1 运行 */
+#define USB_MONITOR_CMD_CLOSE           0x0A
+#define USB_MONITOR_CMD_PROFILE         0x0B    /* 操作(1) [视图(1) 起始(2) 个数(2)]，见 fx3u_profile.h */
+#define USB_MONITOR_REPLY               0x80
+
+/* PROFILE 操作 */
+#define USB_MONITOR_PROFILE_SUMMARY     0       /* 应答: 启用(1) 计数/us(2) 扫描(4) 合计(8) 未覆盖(8) 步数(2) 梯级数(2) */
+#define USB_MONITOR_PROFILE_READ        1       /* 应答: 视图(1) 条目总数(2) N x [编号(2) 次数(4) 累计(8) 最大(4)] */
+#define USB_MONITOR_PROFILE_START       2
+#define USB_MONITOR_PROFILE_STOP        3
+#define USB_MONITOR_PROFILE_RESET       4
+
+/* ===== 主动上送 (序号为本机递增) ===== */
+#define USB_MONITOR_CMD_TREND           0xC0    /* 扫描计数(4) 变化序号(4) 数据 */
+#define USB_MONITOR_CMD_LOG             0xC1    /* 一行日志文本 */
+
+/* ===== 状态码 ===== */
+#define USB_MONITOR_OK                  0x00
+#define USB_MONITOR_ERR_BAD_FRAME       0x01    /* CRC / 长度错误 */
+#define USB_MONITOR_ERR_UNKNOWN_CMD     0x02
+#define USB_MONITOR_ERR_RANGE           0x03    /* 区 / 编号 / 个数越界 */
+#define USB_MONITOR_ERR_NOT_WRITABLE    0x04
+#define USB_MONITOR_ERR_QUEUE_FULL      0x05
+#define USB_MONITOR_ERR_TOO_LARGE       0x06    /* 应答超出最大数据长度 */
+#define USB_MONITOR_ERR_UNAVAILABLE     0x07    /* 功能未编译 (如扫描时间分析) */
+
+/* ===== 传输 (默认为 USB CDC) ===== */
+typedef struct {
+    int (*read)(uint8_t *buffer, uint16_t max_len);             /* 非阻塞，返回读取字节数 */
+    int (*write)(const uint8_t *buffer, uint16_t length);       /* 非阻塞，返回写入字节数 */
+    bool (*connected)(void);
+} usb_monitor_transport_t;
+
+extern const usb_monitor_transport_t usb_monitor_cdc_transport;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t bad_frames;
+    uint32_t trend_samples;
+    uint32_t trend_skipped;             /* 发送缓冲不足而跳过的采样 */
+    uint32_t log_dropped;
+} usb_monitor_stats_t;
+
+typedef struct {
+    fx3u_core_t *plc;
+    usb_monitor_transport_t transport;
+    bool session;
+
+    /* 接收 */
+    uint8_t rx[USB_MONITOR_MAX_FRAME];
+    uint16_t rx_len;
+
+    /* 发送缓冲 (环形) */
+    uint8_t tx[USB_MONITOR_TX_BUFFER];
+    uint32_t tx_head;
+    uint32_t tx_tail;
+    uint8_t event_seq;
+
+    /* 趋势 */
+    fx3u_image_span_t trend[USB_MONITOR_TREND_RANGES];
+    uint8_t trend_count;
+    uint16_t trend_period;
+    uint32_t trend_last;                /* 上次采样的变化序号 */
+
+    usb_monitor_stats_t stats;
+} usb_monitor_t;
+
+void usb_monitor_init(usb_monitor_t *mon, fx3u_core_t *plc,
+                      const usb_monitor_transport_t *transport);
+
+/* 主循环调用: 解析请求、采样趋势、输出发送缓冲 */
+void usb_monitor_poll(usb_monitor_t *mon);
+
+#endif /* __USB_MONITOR_H__ */
@@ -0,0 +1,302 @@
+/**
+ * 模拟量后台采集实现
+ *
+ * DMA 写地址按环大小回绕，传输计数设为最大值，
+ * 已传输样本数 = 初始计数 - 剩余计数，即单调递增的写位置；
+ * 样本 k 属于通道 k % 3 (轮转从通道 0 开始)。
+ * 计数将尽 (12 kS/s 下约 99 小时) 时停止 ADC、清空 FIFO 后从通道 0 重新开始。
+ */
+
+#include "fx3u_analog.h"
+#include "fx3u_io.h"
+#include "fx3u_image.h"
+#include "pico/stdlib.h"
+#include <string.h>
+
+#if PICO_ON_DEVICE
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#endif
+
+#define RING_MASK           (FX3U_ANALOG_RING_SIZE - 1)
+#define RING_BYTES_LOG2     11                  /* 1024 个 16 位样本 */
+#define DMA_COUNT           0xFFFFFFFFu
+#define DMA_RESYNC_LEFT     0x00100000u         /* 剩余计数低于此值时重新同步 */
+#define ADC_CLOCK_HZ        48000000.0f
+#define ACC_SHIFT           2                   /* 16 次累加 (16 位) -> 14 位 */
+#define IIR_FRAC            8
+
+_Static_assert((1u << RING_BYTES_LOG2) == FX3U_ANALOG_RING_SIZE * sizeof(uint16_t),
+               "DMA ring size must match the sample ring");
+
+typedef struct {
+    fx3u_analog_channel_config_t config;
+
+    /* 过采样 */
+    uint32_t acc;
+    uint8_t acc_count;
+
+    /* 滤波状态 */
+    bool primed;
+    int32_t iir;                        /* Q8 */
+    uint16_t window[FX3U_ANALOG_AVERAGE_MAX];
+    uint32_t window_sum;
+    uint8_t window_pos;
+
+    bool valid;                         /* 已有抽取值 */
+    volatile uint16_t raw;              /* 12 位刻度 */
+    volatile int16_t value;             /* 工程值 */
+} analog_channel_t;
+
+static uint16_t g_ring[FX3U_ANALOG_RING_SIZE] __attribute__((aligned(FX3U_ANALOG_RING_SIZE * 2)));
+static analog_channel_t g_channels[FX3U_ANALOG_CHANNELS];
+static fx3u_analog_stats_t g_stats;
+static uint32_t g_read = 0;             /* 已处理的样本数 */
+static uint8_t g_phase = 0;             /* g_read 对应的通道 */
+static uint32_t g_published_seq = 0;
+static bool g_running = false;
+
+/* ===== 硬件 ===== */
+
+#if PICO_ON_DEVICE
+static int g_dma_channel = -1;
+
+static void hw_start(void)
+{
+    adc_run(false);
+    adc_fifo_drain();
+    adc_select_input(0);
+    adc_set_round_robin((1u << FX3U_ANALOG_CHANNELS) - 1u);
+    adc_fifo_setup(true, true, 1, false, false);
+    adc_set_clkdiv(ADC_CLOCK_HZ / FX3U_ANALOG_SAMPLE_RATE_HZ - 1.0f);
+
+    if (g_dma_channel < 0) {
+        g_dma_channel = dma_claim_unused_channel(true);
+    }
+    dma_channel_config cfg = dma_channel_get_default_config(g_dma_channel);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_16);
+    channel_config_set_read_increment(&cfg, false);
+    channel_config_set_write_increment(&cfg, true);
+    channel_config_set_ring(&cfg, true, RING_BYTES_LOG2);
+    channel_config_set_dreq(&cfg, DREQ_ADC);
+    dma_channel_configure(g_dma_channel, &cfg, g_ring, &adc_hw->fifo, DMA_COUNT, true);
+
+    adc_run(true);
+}
+
+static void hw_stop(void)
+{
+    adc_run(false);
+    if (g_dma_channel >= 0) {
+        dma_channel_abort(g_dma_channel);
+    }
+    adc_fifo_drain();
+    adc_set_round_robin(0);
+    adc_fifo_setup(false, false, 0, false, false);
+}
+
+static inline uint32_t hw_remaining(void)
+{
+    return dma_channel_hw_addr(g_dma_channel)->transfer_count;
+}
+#else
+/* 主机构建没有 ADC: 不产生样本 */
+static void hw_start(void) {}
+static void hw_stop(void) {}
+static inline uint32_t hw_remaining(void) { return DMA_COUNT; }
+#endif
+
+/* ===== 滤波与换算 ===== */
+
+static uint16_t apply_filter(analog_channel_t *ch, uint16_t x)
+{
+    const fx3u_analog_channel_config_t *cfg = &ch->config;
+
+    switch (cfg->filter) {
+        case FX3U_ANALOG_FILTER_IIR:
+            if (!ch->primed) {
+                ch->iir = (int32_t)x << IIR_FRAC;
+            } else {
+                ch->iir += (((int32_t)x << IIR_FRAC) - ch->iir) >> cfg->strength;
+            }
+            ch->primed = true;
+            return (uint16_t)(ch->iir >> IIR_FRAC);
+
+        case FX3U_ANALOG_FILTER_AVERAGE: {
+            uint8_t size = (uint8_t)(1u << cfg->strength);
+            if (!ch->primed) {
+                for (uint8_t i = 0; i < size; i++) ch->window[i] = x;
+                ch->window_sum = (uint32_t)x * size;
+                ch->window_pos = 0;
+                ch->primed = true;
+            }
+            ch->window_sum += x;
+            ch->window_sum -= ch->window[ch->window_pos];
+            ch->window[ch->window_pos] = x;
+            ch->window_pos = (uint8_t)((ch->window_pos + 1) & (size - 1));
+            return (uint16_t)(ch->window_sum >> cfg->strength);
+        }
+
+        default:
+            return x;
+    }
+}
+
+static int16_t scale(const fx3u_analog_channel_config_t *cfg, uint16_t filtered)
+{
+    int32_t v = (int32_t)(((int64_t)filtered * cfg->scale_mul) >> cfg->scale_shift) + cfg->offset;
+    if (v > INT16_MAX) return INT16_MAX;
+    if (v < INT16_MIN) return INT16_MIN;
+    return (int16_t)v;
+}
+
+static void take_sample(analog_channel_t *ch, uint16_t sample)
+{
+    ch->acc += sample & 0x0FFFu;
+    if (++ch->acc_count < FX3U_ANALOG_OVERSAMPLE) return;
+
+    uint16_t decimated = (uint16_t)(ch->acc >> ACC_SHIFT);
+    ch->raw = (uint16_t)(ch->acc / FX3U_ANALOG_OVERSAMPLE);
+    ch->acc = 0;
+    ch->acc_count = 0;
+
+    ch->value = scale(&ch->config, apply_filter(ch, decimated));
+    ch->valid = true;
+}
+
+/* ===== 发布 ===== */
+
+static void publish(void)
+{
+    uint32_t seq;
+    const fx3u_image_snapshot_t *snap = fx3u_image_snapshot_begin(&seq);
+    uint32_t change_seq = snap->change_seq;
+    if (change_seq == g_published_seq) return;
+
+    fx3u_image_write_t writes[FX3U_ANALOG_CHANNELS];
+    for (uint8_t i = 0; i < FX3U_ANALOG_CHANNELS; i++) {
+        if (!g_channels[i].valid) return;   /* 首个抽取值之前不发布 */
+        writes[i].area = FX3U_IMAGE_D;
+        writes[i].count = 1;
+        writes[i].addr = FX3U_ANALOG_D_BASE + i;
+        writes[i].value = g_channels[i].value;
+    }
+
+    /* 写队列满时留待下次轮询 */
+    if (fx3u_image_queue_writes(writes, FX3U_ANALOG_CHANNELS)) {
+        g_published_seq = change_seq;
+        g_stats.publishes++;
+    }
+}
+
+/**
+ * 启动采集
+ */
+void fx3u_analog_init(void)
+{
+    memset(g_channels, 0, sizeof(g_channels));
+    memset(&g_stats, 0, sizeof(g_stats));
+
+    for (uint8_t i = 0; i < FX3U_ANALOG_CHANNELS; i++) {
+        fx3u_analog_channel_config_t *cfg = &g_channels[i].config;
+        cfg->filter = FX3U_ANALOG_FILTER_IIR;
+        cfg->strength = 3;
+        cfg->scale_mul = PICO_ADC_VREF;
+        cfg->scale_shift = FX3U_ANALOG_RESULT_BITS;
+        cfg->offset = 0;
+    }
+
+    g_read = 0;
+    g_phase = 0;
+    g_published_seq = 0;
+    hw_start();
+    g_running = true;
+}
+
+/**
+ * 停止采集 (之后 io_read_adc_* 恢复为单次阻塞转换)
+ */
+void fx3u_analog_stop(void)
+{
+    if (!g_running) return;
+    hw_stop();
+    g_running = false;
+}
+
+bool fx3u_analog_running(void)
+{
+    return g_running;
+}
+
+/**
+ * 修改通道滤波与换算，滤波状态重新初始化
+ */
+bool fx3u_analog_configure(uint8_t channel, const fx3u_analog_channel_config_t *config)
+{
+    if (channel >= FX3U_ANALOG_CHANNELS || !config) return false;
+    if (config->filter > FX3U_ANALOG_FILTER_AVERAGE) return false;
+    if (config->filter == FX3U_ANALOG_FILTER_AVERAGE &&
+        (config->strength > 4 || (1u << config->strength) > FX3U_ANALOG_AVERAGE_MAX)) return false;
+    if (config->filter == FX3U_ANALOG_FILTER_IIR && config->strength > 15) return false;
+    if (config->scale_shift > 31) return false;
+
+    analog_channel_t *ch = &g_channels[channel];
+    ch->config = *config;
+    ch->primed = false;
+    return true;
+}
+
+/**
+ * 主循环轮询
+ */
+void fx3u_analog_poll(void)
+{
+    if (!g_running) return;
+
+    uint32_t remaining = hw_remaining();
+    uint32_t written = DMA_COUNT - remaining;
+
+    /* 环已被覆盖: 跳到最近半环，保持通道相位 */
+    if (written - g_read > FX3U_ANALOG_RING_SIZE) {
+        uint32_t skip = written - FX3U_ANALOG_RING_SIZE / 2 - g_read;
+        g_read += skip;
+        g_phase = (uint8_t)((g_phase + skip % FX3U_ANALOG_CHANNELS) % FX3U_ANALOG_CHANNELS);
+        g_stats.overruns++;
+    }
+
+    g_stats.samples += written - g_read;
+    while (g_read != written) {
+        take_sample(&g_channels[g_phase], g_ring[g_read & RING_MASK]);
+        if (++g_phase == FX3U_ANALOG_CHANNELS) g_phase = 0;
+        g_read++;
+    }
+
+    if (remaining < DMA_RESYNC_LEFT) {
+        /* 计数将尽: 从通道 0 重新开始，未满的累加丢弃 */
+        hw_start();
+        for (uint8_t i = 0; i < FX3U_ANALOG_CHANNELS; i++) {
+            g_channels[i].acc = 0;
+            g_channels[i].acc_count = 0;
+        }
+        g_read = 0;
+        g_phase = 0;
+        g_stats.restarts++;
+    }
+
+    publish();
+}
+
+uint16_t fx3u_analog_get_raw(uint8_t channel)
+{
+    return channel < FX3U_ANALOG_CHANNELS ? g_channels[channel].raw : 0;
+}
+
+int16_t fx3u_analog_get_value(uint8_t channel)
+{
+    return channel < FX3U_ANALOG_CHANNELS ? g_channels[channel].value : 0;
+}
+
+const fx3u_analog_stats_t *fx3u_analog_get_stats(void)
+{
+    return &g_stats;
+}
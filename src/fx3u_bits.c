@@ -0,0 +1,127 @@
+/**
+ * 位区批量操作实现
+ */
+
+#include "fx3u_bits.h"
+#include <string.h>
+
+static inline uint32_t low_mask(uint8_t count)
+{
+    return count >= 32 ? 0xFFFFFFFFu : ((1u << count) - 1u);
+}
+
+/**
+ * 读取 count 个位，允许跨越字边界
+ */
+uint32_t fx3u_bits_read(const uint32_t *words, uint32_t start, uint8_t count)
+{
+    if (!words || count == 0) return 0;
+
+    uint32_t idx = start >> 5;
+    uint32_t shift = start & 31u;
+    uint32_t value = words[idx] >> shift;
+
+    if (shift != 0 && shift + count > 32) {
+        value |= words[idx + 1] << (32 - shift);
+    }
+    return value & low_mask(count);
+}
+
+/**
+ * 写入 count 个位，范围外的位保持不变
+ */
+void fx3u_bits_write(uint32_t *words, uint32_t start, uint8_t count, uint32_t value)
+{
+    if (!words || count == 0) return;
+
+    uint32_t idx = start >> 5;
+    uint32_t shift = start & 31u;
+    uint32_t mask = low_mask(count);
+    value &= mask;
+
+    words[idx] = (words[idx] & ~(mask << shift)) | (value << shift);
+    if (shift != 0 && shift + count > 32) {
+        uint32_t spill = 32 - shift;
+        words[idx + 1] = (words[idx + 1] & ~(mask >> spill)) | (value >> spill);
+    }
+}
+
+/**
+ * 位区 -> 字节流，末字节高位补 0
+ */
+void fx3u_bits_to_bytes(uint8_t *dst, const uint32_t *words, uint32_t start, uint32_t count)
+{
+    if (!dst || !words) return;
+
+    for (uint32_t i = 0; i < count; i += 32) {
+        uint8_t n = (uint8_t)(count - i < 32 ? count - i : 32);
+        uint32_t value = fx3u_bits_read(words, start + i, n);
+        uint8_t *out = &dst[i / 8];
+        for (uint8_t b = 0; b < (n + 7) / 8; b++) {
+            out[b] = (uint8_t)(value >> (b * 8));
+        }
+    }
+}
+
+/**
+ * 字节流 -> 位区
+ */
+void fx3u_bits_from_bytes(uint32_t *words, uint32_t start, const uint8_t *src, uint32_t count)
+{
+    if (!words || !src) return;
+
+    for (uint32_t i = 0; i < count; i += 32) {
+        uint8_t n = (uint8_t)(count - i < 32 ? count - i : 32);
+        const uint8_t *in = &src[i / 8];
+        uint32_t value = 0;
+        for (uint8_t b = 0; b < (n + 7) / 8; b++) {
+            value |= (uint32_t)in[b] << (b * 8);
+        }
+        fx3u_bits_write(words, start + i, n, value);
+    }
+}
+
+/**
+ * 每元素一字节 -> 字打包
+ *
+ * 每次取 4 个 0/1 字节 (小端装载)，乘以 0x01020408 后第 24-27 位恰为这 4 个位，
+ * 各部分积互不重叠，不会产生进位。
+ */
+void fx3u_bits_pack(uint32_t *words, const uint8_t *flags, uint32_t count)
+{
+    if (!words || !flags) return;
+
+    uint32_t full = count / 32;
+    for (uint32_t w = 0; w < full; w++) {
+        const uint8_t *f = &flags[w * 32];
+        uint32_t value = 0;
+        for (uint8_t q = 0; q < 8; q++) {
+            uint32_t x;
+            memcpy(&x, &f[q * 4], 4);
+            x &= 0x01010101u;
+            value |= ((x * 0x01020408u) >> 24 & 0x0Fu) << (q * 4);
+        }
+        words[w] = value;
+    }
+
+    uint32_t rest = count % 32;
+    if (rest) {
+        uint32_t value = 0;
+        for (uint32_t i = 0; i < rest; i++) {
+            value |= (uint32_t)(flags[full * 32 + i] & 1u) << i;
+        }
+        words[full] = value;
+    }
+}
+
+/**
+ * 字 -> 每元素一字节
+ */
+void fx3u_bits_unpack(uint8_t *flags, uint32_t value, uint8_t count)
+{
+    if (!flags) return;
+
+    for (uint8_t i = 0; i < count && i < 32; i++) {
+        flags[i] = (uint8_t)((value >> i) & 1u);
+    }
+}
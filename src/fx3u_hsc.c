@@ -0,0 +1,654 @@
+/**
+ * 高速计数器实现
+ *
+ * PIO 程序 (装在地址 0，前 16 条为跳转表，按计数方式生成):
+ *
+ *      0-15    jmp <表项>          索引 = 上次 (B A) << 2 | 本次 (B A)
+ *   sample:
+ *      16      out isr, 2          ISR = 上次电平
+ *      17      pull noblock        新比较值 (TX FIFO 空时 OSR = X，X 不变)
+ *      18      mov x, osr
+ *      19      in pins, 2          ISR = 索引
+ *      20      mov osr, isr        低 2 位留作下次的 "上次电平"
+ *      21      mov pc, isr
+ *   inc:
+ *      22      mov y, ~y           Y + 1 = ~(~Y - 1)
+ *      23      jmp y--, 24
+ *      24      mov y, ~y
+ *   changed:
+ *      25      mov isr, y
+ *      26      push noblock        由 DMA 搬到内存
+ *      27      jmp x!=y, sample
+ *      28      irq nowait 0 rel    比较一致 (.wrap -> sample)
+ *   dec:
+ *      29      jmp y--, changed
+ *      30      jmp changed
+ *
+ * 一次采样 6 条指令，125MHz 下约 50ns，计数频率远高于 100kHz。
+ *
+ * PIO 的 Y 为原始计数 (只增减 1)，软件值 = base ± (raw - raw0)：
+ * 停止计数、复位、改写、1相1输入改变方向时都只重新取 base / raw0，状态机一直运行。
+ */
+
+#include "fx3u_hsc.h"
+#include "fx3u_instructions.h"
+#include "fx3u_io.h"
+#include "logger.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include <string.h>
+
+#if PICO_ON_DEVICE
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#endif
+
+#define COUNTER_COUNT       (FX3U_HSC_LAST - FX3U_HSC_FIRST + 1)
+#define BLOCK_COUNT         2
+#define BLOCK_SMS           4
+#define DMA_COUNT           0xFFFFFFFFu
+#define DMA_RESYNC_LEFT     0x00100000u
+
+_Static_assert(PICO_INPUT_X9_GPIO == PICO_INPUT_X0_GPIO + 9,
+               "high-speed counter inputs need consecutive X pins");
+
+/* ===== 跳转表 ===== */
+enum { ACT_SAMPLE = 0, ACT_INC = 1, ACT_DEC = 2 };
+
+#define PROG_SAMPLE         16
+#define PROG_INC            22
+#define PROG_CHANGED        25
+#define PROG_WRAP           28
+#define PROG_DEC            29
+#define PROG_LENGTH         31
+
+/* 索引位: 3 = 上次 B，2 = 上次 A，1 = 本次 B，0 = 本次 A */
+static const uint8_t g_tables[FX3U_HSC_MODE_COUNT][16] = {
+    [FX3U_HSC_MODE_SINGLE] = {      /* A 0 -> 1 */
+        0, 1, 0, 1,  0, 0, 0, 0,  0, 1, 0, 1,  0, 0, 0, 0
+    },
+    [FX3U_HSC_MODE_UPDOWN] = {      /* A 0 -> 1 加，B 0 -> 1 减，同时则不变 */
+        0, 1, 2, 0,  0, 0, 2, 2,  0, 1, 0, 1,  0, 0, 0, 0
+    },
+    [FX3U_HSC_MODE_QUAD1] = {       /* B = 0 时 A 的上升沿加 / 下降沿减 */
+        0, 1, 0, 0,  2, 0, 0, 0,  0, 0, 0, 0,  0, 0, 0, 0
+    },
+    [FX3U_HSC_MODE_QUAD2] = {       /* A 的全部沿 */
+        0, 1, 0, 0,  2, 0, 0, 0,  0, 0, 0, 2,  0, 0, 1, 0
+    },
+    [FX3U_HSC_MODE_QUAD4] = {       /* 00 -> 01 -> 11 -> 10 -> 00 为加 */
+        0, 1, 2, 0,  2, 0, 0, 1,  1, 0, 0, 2,  0, 2, 1, 0
+    },
+};
+
+/* ===== 计数器编号 -> 输入 ===== */
+enum { KIND_SINGLE = 0, KIND_UPDOWN = 1, KIND_QUAD = 2 };
+
+static const struct {
+    uint8_t kind;
+    uint8_t x;                          /* A 相 / 计数输入，B 相 / 减计数输入为 x + 1 */
+} g_inputs[COUNTER_COUNT] = {
+    {KIND_SINGLE, 0}, {KIND_SINGLE, 1}, {KIND_SINGLE, 2}, {KIND_SINGLE, 3},     /* C235-C238 */
+    {KIND_SINGLE, 4}, {KIND_SINGLE, 5}, {KIND_SINGLE, 0}, {KIND_SINGLE, 2},     /* C239-C242 */
+    {KIND_SINGLE, 3}, {KIND_SINGLE, 0}, {KIND_SINGLE, 2},                       /* C243-C245 */
+    {KIND_UPDOWN, 0}, {KIND_UPDOWN, 0}, {KIND_UPDOWN, 3}, {KIND_UPDOWN, 0},     /* C246-C249 */
+    {KIND_UPDOWN, 3},                                                           /* C250 */
+    {KIND_QUAD, 0}, {KIND_QUAD, 0}, {KIND_QUAD, 3}, {KIND_QUAD, 0},             /* C251-C254 */
+    {KIND_QUAD, 3}                                                              /* C255 */
+};
+
+typedef struct {
+    int8_t channel;                     /* -1: 未分配状态机 */
+    bool unavailable;                   /* 分配失败，不再重试 */
+    uint8_t multiplier;                 /* 0: 按 M8198 / M8199 */
+    bool counting;
+    bool down;
+    int32_t base;
+    uint32_t raw0;
+    int32_t preset;
+    int32_t last_value;
+
+    /* DHSCS / DHSCR */
+    bool armed;
+    int32_t target;
+    uint16_t device;
+    uint8_t device_value;
+} hsc_counter_t;
+
+typedef struct {
+    uint16_t counter;                   /* 0: 空闲 */
+    uint8_t block;
+    uint8_t sm;
+    uint8_t x;
+    volatile uint32_t raw;              /* DMA 写入的 Y */
+#if PICO_ON_DEVICE
+    int dma;
+#else
+    uint8_t prev;
+    uint32_t compare_raw;
+    bool irq_enabled;
+#endif
+} hsc_channel_t;
+
+typedef struct {
+    bool loaded;
+    uint8_t mode;
+} hsc_block_t;
+
+static fx3u_core_t *g_plc = NULL;
+static hsc_counter_t g_counters[COUNTER_COUNT];
+static hsc_channel_t g_channels[FX3U_HSC_CHANNELS];
+static hsc_block_t g_blocks[BLOCK_COUNT];
+static fx3u_hsc_event_callback_t g_callback = NULL;
+static fx3u_hsc_stats_t g_stats;
+
+static void fire(uint16_t number);
+#if PICO_ON_DEVICE
+static void hsc_irq(void);
+#endif
+
+static inline hsc_counter_t *counter_of(uint16_t number)
+{
+    return FX3U_HSC_IS_COUNTER(number) ? &g_counters[number - FX3U_HSC_FIRST] : NULL;
+}
+
+/* ===== 硬件 ===== */
+
+#if PICO_ON_DEVICE
+static inline PIO block_pio(uint8_t block)
+{
+    return block ? pio1 : pio0;
+}
+
+/**
+ * 生成程序并装入 PIO 地址 0 (PIO 中已有其他程序时失败)
+ */
+static bool hw_load_block(uint8_t block, uint8_t mode)
+{
+    static const uint8_t action_target[] = {PROG_SAMPLE, PROG_INC, PROG_DEC};
+    uint16_t code[PROG_LENGTH];
+
+    for (uint8_t i = 0; i < 16; i++) {
+        code[i] = pio_encode_jmp(action_target[g_tables[mode][i]]);
+    }
+    code[16] = pio_encode_out(pio_isr, 2);
+    code[17] = pio_encode_pull(false, false);
+    code[18] = pio_encode_mov(pio_x, pio_osr);
+    code[19] = pio_encode_in(pio_pins, 2);
+    code[20] = pio_encode_mov(pio_osr, pio_isr);
+    code[21] = pio_encode_mov(pio_pc, pio_isr);
+    code[22] = pio_encode_mov_not(pio_y, pio_y);
+    code[23] = pio_encode_jmp_y_dec(PROG_INC + 2);
+    code[24] = pio_encode_mov_not(pio_y, pio_y);
+    code[25] = pio_encode_mov(pio_isr, pio_y);
+    code[26] = pio_encode_push(false, false);
+    code[27] = pio_encode_jmp_x_ne_y(PROG_SAMPLE);
+    code[28] = pio_encode_irq_set(true, 0);
+    code[29] = pio_encode_jmp_y_dec(PROG_CHANGED);
+    code[30] = pio_encode_jmp(PROG_CHANGED);
+
+    const pio_program_t program = {
+        .instructions = code,
+        .length = PROG_LENGTH,
+        .origin = 0,
+    };
+    PIO pio = block_pio(block);
+    if (!pio_can_add_program(pio, &program)) return false;
+    pio_add_program(pio, &program);
+
+    uint irq_num = block ? PIO1_IRQ_0 : PIO0_IRQ_0;
+    irq_add_shared_handler(irq_num, hsc_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(irq_num, true);
+    return true;
+}
+
+static bool hw_start_channel(hsc_channel_t *ch)
+{
+    PIO pio = block_pio(ch->block);
+    int sm = pio_claim_unused_sm(pio, false);
+    if (sm < 0) return false;
+    ch->sm = (uint8_t)sm;
+
+    pio_sm_config cfg = pio_get_default_sm_config();
+    sm_config_set_wrap(&cfg, PROG_SAMPLE, PROG_WRAP);
+    sm_config_set_in_pins(&cfg, PICO_INPUT_X0_GPIO + ch->x);
+    sm_config_set_in_shift(&cfg, false, false, 32);
+    sm_config_set_out_shift(&cfg, true, false, 32);
+    pio_sm_init(pio, ch->sm, PROG_SAMPLE, &cfg);
+
+    /* Y = X = 0，"上次电平" 取当前引脚，启动时不产生计数 */
+    pio_sm_exec(pio, ch->sm, pio_encode_mov(pio_y, pio_null));
+    pio_sm_exec(pio, ch->sm, pio_encode_mov(pio_x, pio_null));
+    pio_sm_exec(pio, ch->sm, pio_encode_mov(pio_isr, pio_null));
+    pio_sm_exec(pio, ch->sm, pio_encode_in(pio_pins, 2));
+    pio_sm_exec(pio, ch->sm, pio_encode_mov(pio_osr, pio_isr));
+    ch->raw = 0;
+
+    ch->dma = dma_claim_unused_channel(false);
+    if (ch->dma < 0) {
+        pio_sm_unclaim(pio, ch->sm);
+        return false;
+    }
+    dma_channel_config dc = dma_channel_get_default_config(ch->dma);
+    channel_config_set_transfer_data_size(&dc, DMA_SIZE_32);
+    channel_config_set_read_increment(&dc, false);
+    channel_config_set_write_increment(&dc, false);
+    channel_config_set_dreq(&dc, pio_get_dreq(pio, ch->sm, false));
+    dma_channel_configure(ch->dma, &dc, &ch->raw, &pio->rxf[ch->sm], DMA_COUNT, true);
+
+    pio_sm_set_enabled(pio, ch->sm, true);
+    return true;
+}
+
+/**
+ * 装入比较值: 先关中断源，等状态机取走比较值后清标志再打开
+ */
+static void hw_set_compare(hsc_channel_t *ch, uint32_t raw_target, bool enable)
+{
+    PIO pio = block_pio(ch->block);
+    pio_set_irq0_source_enabled(pio, (enum pio_interrupt_source)(pis_interrupt0 + ch->sm), false);
+    if (!enable) return;
+
+    pio_sm_put(pio, ch->sm, raw_target);
+    while (!pio_sm_is_tx_fifo_empty(pio, ch->sm)) {
+        tight_loop_contents();
+    }
+    pio_interrupt_clear(pio, ch->sm);
+    pio_set_irq0_source_enabled(pio, (enum pio_interrupt_source)(pis_interrupt0 + ch->sm), true);
+}
+
+static void hw_poll(hsc_channel_t *ch)
+{
+    if (dma_channel_hw_addr(ch->dma)->transfer_count >= DMA_RESYNC_LEFT) return;
+    /* 计数 (即计数变化次数) 将尽: 重新启动，期间的推送留在 RX FIFO */
+    dma_channel_abort(ch->dma);
+    dma_channel_set_trans_count(ch->dma, DMA_COUNT, true);
+    g_stats.dma_restarts++;
+}
+
+/**
+ * PIO 中断: 比较一致
+ */
+static void hsc_irq(void)
+{
+    for (uint8_t i = 0; i < FX3U_HSC_CHANNELS; i++) {
+        hsc_channel_t *ch = &g_channels[i];
+        if (!ch->counter) continue;
+
+        PIO pio = block_pio(ch->block);
+        if (!pio_interrupt_get(pio, ch->sm)) continue;
+        pio_interrupt_clear(pio, ch->sm);
+        fire(ch->counter);
+    }
+}
+#else
+/* 主机构建: 同一张跳转表由 fx3u_hsc_sim_input() 驱动 */
+static uint32_t g_sim_pins = 0;
+
+static bool hw_load_block(uint8_t block, uint8_t mode)
+{
+    (void)block;
+    (void)mode;
+    return true;
+}
+
+static bool hw_start_channel(hsc_channel_t *ch)
+{
+    uint8_t used = 0;
+    for (uint8_t i = 0; i < FX3U_HSC_CHANNELS; i++) {
+        if (&g_channels[i] != ch && g_channels[i].counter && g_channels[i].block == ch->block) {
+            used++;
+        }
+    }
+    if (used >= BLOCK_SMS) return false;
+
+    ch->sm = used;
+    ch->raw = 0;
+    ch->prev = (uint8_t)((g_sim_pins >> ch->x) & 3u);
+    ch->compare_raw = 0;
+    ch->irq_enabled = false;
+    return true;
+}
+
+static void hw_set_compare(hsc_channel_t *ch, uint32_t raw_target, bool enable)
+{
+    ch->compare_raw = raw_target;
+    ch->irq_enabled = enable;
+}
+
+static void hw_poll(hsc_channel_t *ch)
+{
+    (void)ch;
+}
+#endif
+
+/* ===== 当前值 ===== */
+
+static int32_t value_of(const hsc_counter_t *c)
+{
+    if (!c->counting) return c->base;
+
+    uint32_t delta = g_channels[c->channel].raw - c->raw0;
+    return c->down ? c->base - (int32_t)delta : c->base + (int32_t)delta;
+}
+
+/**
+ * 按当前 base / raw0 / 方向重新装入比较值
+ */
+static void update_compare(hsc_counter_t *c)
+{
+    if (c->channel < 0) return;
+
+    hsc_channel_t *ch = &g_channels[c->channel];
+    bool enable = c->armed && c->counting;
+    uint32_t span = c->down ? (uint32_t)(c->base - c->target) : (uint32_t)(c->target - c->base);
+    hw_set_compare(ch, c->raw0 + span, enable);
+}
+
+/**
+ * 以 value 为新起点 (调用者已关中断)
+ */
+static void rebase(hsc_counter_t *c, int32_t value)
+{
+    c->base = value;
+    if (c->channel >= 0) {
+        c->raw0 = g_channels[c->channel].raw;
+    }
+    update_compare(c);
+}
+
+static uint8_t counter_mode(uint16_t number, const hsc_counter_t *c)
+{
+    switch (g_inputs[number - FX3U_HSC_FIRST].kind) {
+        case KIND_SINGLE:
+            return FX3U_HSC_MODE_SINGLE;
+        case KIND_UPDOWN:
+            return FX3U_HSC_MODE_UPDOWN;
+        default:
+            break;
+    }
+
+    uint8_t multiplier = c->multiplier;
+    if (!multiplier) {
+        uint16_t flag = (number == 253 || number == 255) ? M8199 : M8198;
+        multiplier = (g_plc && fx3u_get_special_relay(g_plc, flag)) ? 4 : 1;
+    }
+    return multiplier == 4 ? FX3U_HSC_MODE_QUAD4 :
+           multiplier == 2 ? FX3U_HSC_MODE_QUAD2 : FX3U_HSC_MODE_QUAD1;
+}
+
+/**
+ * 为计数器分配状态机: 优先使用已装入同一跳转表的 PIO 块
+ */
+static bool allocate(uint16_t number, hsc_counter_t *c)
+{
+    uint8_t mode = counter_mode(number, c);
+
+    int slot = -1;
+    for (uint8_t i = 0; i < FX3U_HSC_CHANNELS; i++) {
+        if (!g_channels[i].counter) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) {
+        g_stats.allocation_failures++;
+        return false;
+    }
+
+    hsc_channel_t *ch = &g_channels[slot];
+    ch->x = g_inputs[number - FX3U_HSC_FIRST].x;
+
+    for (uint8_t pass = 0; pass < 2; pass++) {
+        for (uint8_t b = 0; b < BLOCK_COUNT; b++) {
+            hsc_block_t *block = &g_blocks[b];
+            if (pass == 0 && !(block->loaded && block->mode == mode)) continue;
+            if (pass == 1) {
+                if (block->loaded || !hw_load_block(b, mode)) continue;
+                block->loaded = true;
+                block->mode = mode;
+            }
+
+            ch->block = b;
+            if (!hw_start_channel(ch)) continue;
+
+            ch->counter = number;
+            c->channel = (int8_t)slot;
+            g_stats.allocations++;
+            /* 计数输入不再走快速输入沿中断，避免脉冲触发周期外扫描 */
+            io_claim_inputs(g_inputs[number - FX3U_HSC_FIRST].kind == KIND_SINGLE ?
+                            1u << ch->x : 3u << ch->x);
+            return true;
+        }
+    }
+
+    g_stats.allocation_failures++;
+    return false;
+}
+
+/* ===== 比较动作 ===== */
+
+/**
+ * DHSCS / DHSCR 动作 (PIO 中断，与扫描中断同优先级，不会打断扫描)
+ */
+static void fire(uint16_t number)
+{
+    hsc_counter_t *c = counter_of(number);
+    if (!c || !c->armed || !c->counting || !g_plc) return;
+
+    g_stats.compare_events++;
+
+    uint16_t target_num = c->device & FX3U_ADDR_MASK;
+    if ((c->device >> 12) == REG_COUNTER && FX3U_HSC_IS_COUNTER(target_num)) {
+        if (!c->device_value) {
+            hsc_counter_t *t = counter_of(target_num);
+            rebase(t, 0);
+        }
+    } else {
+        fx3u_set_bit(g_plc, c->device, c->device_value);
+    }
+
+    if (g_callback) {
+        g_callback(number);
+    }
+}
+
+/**
+ * 初始化 (PLC 核心初始化之后调用)
+ */
+void fx3u_hsc_init(fx3u_core_t *plc)
+{
+    g_plc = plc;
+    memset(g_counters, 0, sizeof(g_counters));
+    memset(g_channels, 0, sizeof(g_channels));
+    memset(g_blocks, 0, sizeof(g_blocks));
+    memset(&g_stats, 0, sizeof(g_stats));
+    for (uint8_t i = 0; i < COUNTER_COUNT; i++) {
+        g_counters[i].channel = -1;
+    }
+}
+
+void fx3u_hsc_set_event_callback(fx3u_hsc_event_callback_t callback)
+{
+    g_callback = callback;
+}
+
+bool fx3u_hsc_set_multiplier(uint16_t counter, uint8_t multiplier)
+{
+    hsc_counter_t *c = counter_of(counter);
+    if (!c || g_inputs[counter - FX3U_HSC_FIRST].kind != KIND_QUAD) return false;
+    if (multiplier != 1 && multiplier != 2 && multiplier != 4) return false;
+    if (c->channel >= 0) return false;
+
+    c->multiplier = multiplier;
+    return true;
+}
+
+/**
+ * OUT Cnnn (扫描中每次执行)
+ */
+void fx3u_hsc_drive(uint16_t counter, bool enable, int32_t preset)
+{
+    hsc_counter_t *c = counter_of(counter);
+    if (!c) return;
+
+    c->preset = preset;
+    if (enable && c->channel < 0) {
+        if (c->unavailable) return;
+        if (!allocate(counter, c)) {
+            c->unavailable = true;
+            LOG_WARN("[HSC] C%d: no free PIO state machine\r\n", counter);
+            return;
+        }
+    }
+
+    uint32_t ints = save_and_disable_interrupts();
+    uint8_t kind = g_inputs[counter - FX3U_HSC_FIRST].kind;
+    bool down = kind == KIND_SINGLE && g_plc &&
+                fx3u_get_special_relay(g_plc, M8235 + (counter - FX3U_HSC_FIRST));
+
+    if (enable != c->counting || down != c->down) {
+        int32_t value = value_of(c);
+        c->counting = enable;
+        c->down = down;
+        rebase(c, value);
+    }
+
+    int32_t value = value_of(c);
+    restore_interrupts(ints);
+
+    /* 方向监视 M8246-M8255 */
+    if (kind != KIND_SINGLE && g_plc && value != c->last_value) {
+        fx3u_set_special_relay(g_plc, M8246 + (counter - 246), value < c->last_value);
+    }
+    c->last_value = value;
+}
+
+void fx3u_hsc_reset(uint16_t counter)
+{
+    fx3u_hsc_write(counter, 0);
+}
+
+int32_t fx3u_hsc_read(uint16_t counter)
+{
+    hsc_counter_t *c = counter_of(counter);
+    return c ? value_of(c) : 0;
+}
+
+void fx3u_hsc_write(uint16_t counter, int32_t value)
+{
+    hsc_counter_t *c = counter_of(counter);
+    if (!c) return;
+
+    uint32_t ints = save_and_disable_interrupts();
+    rebase(c, value);
+    c->last_value = value;
+    restore_interrupts(ints);
+}
+
+bool fx3u_hsc_done(uint16_t counter)
+{
+    hsc_counter_t *c = counter_of(counter);
+    return c && c->channel >= 0 && value_of(c) >= c->preset;
+}
+
+/**
+ * DHSCS / DHSCR 登记 (扫描中每次执行，参数不变时不访问 PIO)
+ */
+bool fx3u_hsc_compare(uint16_t counter, bool armed, int32_t target, uint16_t device, uint8_t value)
+{
+    hsc_counter_t *c = counter_of(counter);
+    if (!c) return false;
+
+    if (c->armed == armed && (!armed || (c->target == target && c->device == device &&
+                                         c->device_value == value))) {
+        return true;
+    }
+
+    uint32_t ints = save_and_disable_interrupts();
+    c->armed = armed;
+    c->target = target;
+    c->device = device;
+    c->device_value = value;
+    update_compare(c);
+    restore_interrupts(ints);
+    return true;
+}
+
+/**
+ * 主循环轮询
+ */
+void fx3u_hsc_poll(void)
+{
+    for (uint8_t i = 0; i < FX3U_HSC_CHANNELS; i++) {
+        if (g_channels[i].counter) {
+            hw_poll(&g_channels[i]);
+        }
+    }
+}
+
+void fx3u_hsc_get_stats(fx3u_hsc_stats_t *stats)
+{
+    if (!stats) return;
+    *stats = g_stats;
+}
+
+/* ===== 模拟脉冲源 ===== */
+
+#if !PICO_ON_DEVICE
+void fx3u_hsc_sim_input(uint8_t x, bool level)
+{
+    if (x >= PICO_TOTAL_INPUTS) return;
+
+    if (level) {
+        g_sim_pins |= 1u << x;
+    } else {
+        g_sim_pins &= ~(1u << x);
+    }
+
+    for (uint8_t i = 0; i < FX3U_HSC_CHANNELS; i++) {
+        hsc_channel_t *ch = &g_channels[i];
+        if (!ch->counter || (x != ch->x && x != ch->x + 1)) continue;
+
+        uint8_t cur = (uint8_t)((g_sim_pins >> ch->x) & 3u);
+        uint8_t action = g_tables[g_blocks[ch->block].mode][(ch->prev << 2) | cur];
+        ch->prev = cur;
+        if (action == ACT_SAMPLE) continue;
+
+        ch->raw += action == ACT_INC ? 1u : (uint32_t)-1;
+        if (ch->irq_enabled && ch->raw == ch->compare_raw) {
+            fire(ch->counter);
+        }
+    }
+}
+
+void fx3u_hsc_sim_pulses(uint8_t x, uint32_t count)
+{
+    while (count--) {
+        fx3u_hsc_sim_input(x, true);
+        fx3u_hsc_sim_input(x, false);
+    }
+}
+
+void fx3u_hsc_sim_quadrature(uint8_t x_a, int32_t edges)
+{
+    /* 格雷码顺序 (B A): 00 -> 01 -> 11 -> 10 */
+    static const uint8_t order[4] = {0, 1, 3, 2};
+    uint8_t state = (uint8_t)((g_sim_pins >> x_a) & 3u);
+    uint8_t pos = 0;
+    while (order[pos] != state) pos++;
+
+    while (edges) {
+        pos = (uint8_t)((pos + (edges > 0 ? 1 : 3)) & 3u);
+        uint8_t next = order[pos];
+        if ((next ^ state) & 1u) {
+            fx3u_hsc_sim_input(x_a, next & 1u);
+        } else {
+            fx3u_hsc_sim_input(x_a + 1, (next >> 1) & 1u);
+        }
+        state = next;
+        edges += edges > 0 ? -1 : 1;
+    }
+}
+#endif
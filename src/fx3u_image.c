@@ -0,0 +1,560 @@
+/**
+ * FX3U 过程映像实现
+ *
+ * 写者为扫描 (定时器中断)，读者为主循环通信处理。
+ * 双缓冲保证读者通常读取的是扫描不会触碰的那一份，
+ * 每份缓冲自带 seqlock，极少数跨越两次发布的读取会自动重试。
+ */
+
+#include "fx3u_image.h"
+#include "hardware/sync.h"
+#include <string.h>
+
+#define WRITE_QUEUE_MASK    (FX3U_IMAGE_WRITE_QUEUE_SIZE - 1)
+
+static fx3u_image_snapshot_t g_snapshots[2];
+static volatile uint8_t g_front = 0;
+
+static fx3u_image_write_t g_write_queue[FX3U_IMAGE_WRITE_QUEUE_SIZE];
+static volatile uint16_t g_write_head = 0;     /* 扫描侧消费位置 */
+static volatile uint16_t g_write_tail = 0;     /* 通信侧生产位置 */
+
+static fx3u_image_stats_t g_stats;
+
+/* 变化检测: D 在前，D8000- 紧随其后。
+ * 脏标志每寄存器一个字节而非一个位，主循环与扫描中断同时标记时不存在读改写竞争。 */
+#define CHANGE_TRACKED      (PLC_MAX_REGISTERS + PLC_MAX_SPECIAL)
+#define CHANGE_BLOCKS       (CHANGE_TRACKED / FX3U_IMAGE_CHANGE_BLOCK)
+
+static volatile uint8_t g_dirty[CHANGE_TRACKED];
+static volatile uint8_t g_dirty_block[CHANGE_BLOCKS];
+static uint16_t g_change_stamp[CHANGE_TRACKED];
+static uint32_t g_block_seq[CHANGE_BLOCKS];
+static uint32_t g_change_seq = 0;
+
+static const uint32_t *snapshot_bits(const fx3u_image_snapshot_t *snap,
+                                     fx3u_image_area_t area, uint16_t *limit)
+{
+    *limit = fx3u_image_area_size(area);
+    switch (area) {
+        case FX3U_IMAGE_X:  return snap->inputs;
+        case FX3U_IMAGE_Y:  return snap->outputs;
+        case FX3U_IMAGE_M:  return snap->internals;
+        case FX3U_IMAGE_S:  return snap->states;
+        case FX3U_IMAGE_TS: return snap->timer_contacts;
+        case FX3U_IMAGE_CS: return snap->counter_contacts;
+        case FX3U_IMAGE_SM: return snap->special_relays;
+        default:
+            *limit = 0;
+            return NULL;
+    }
+}
+
+/* 通信侧可写的位区 (触点由扫描产生，不在此列) */
+static uint8_t *core_bits(fx3u_core_t *plc, uint8_t area, uint16_t *limit)
+{
+    *limit = fx3u_image_area_size((fx3u_image_area_t)area);
+    switch (area) {
+        case FX3U_IMAGE_X:  return plc->inputs;
+        case FX3U_IMAGE_Y:  return plc->outputs;
+        case FX3U_IMAGE_M:  return plc->internals;
+        case FX3U_IMAGE_S:  return plc->states;
+        case FX3U_IMAGE_SM: return plc->special_relays;
+        default:
+            *limit = 0;
+            return NULL;
+    }
+}
+
+/* 字区写入 */
+static void apply_word(fx3u_core_t *plc, const fx3u_image_write_t *w)
+{
+    switch (w->area) {
+        case FX3U_IMAGE_D:
+            fx3u_set_register(plc, w->addr, w->value);
+            break;
+
+        case FX3U_IMAGE_SD:
+            fx3u_set_special_register(plc, PLC_SPECIAL_BASE + w->addr, w->value);
+            break;
+
+        case FX3U_IMAGE_TN:
+            if (w->addr < PLC_MAX_TIMERS) {
+                plc->timers[w->addr].elapsed_us = w->value > 0 ? (uint64_t)w->value * 1000u : 0;
+            }
+            break;
+
+        case FX3U_IMAGE_CN:
+            if (w->addr < PLC_MAX_COUNTERS) {
+                uint32_t cur = (uint32_t)plc->counters[w->addr].current_value;
+                if (w->count == FX3U_IMAGE_CN_LOW) {
+                    cur = (cur & 0xFFFF0000u) | (uint16_t)w->value;
+                } else if (w->count == FX3U_IMAGE_CN_HIGH) {
+                    cur = (cur & 0x0000FFFFu) | ((uint32_t)(uint16_t)w->value << 16);
+                } else {
+                    cur = (uint32_t)(int32_t)w->value;
+                }
+                plc->counters[w->addr].current_value = (int32_t)cur;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * seqlock 读开始: 返回当前前台快照与其序号
+ */
+const fx3u_image_snapshot_t *fx3u_image_snapshot_begin(uint32_t *seq)
+{
+    for (;;) {
+        const fx3u_image_snapshot_t *snap = &g_snapshots[g_front];
+        uint32_t s = snap->seq;
+        if ((s & 1u) == 0) {
+            __dmb();
+            *seq = s;
+            return snap;
+        }
+        g_stats.read_retries++;
+    }
+}
+
+/**
+ * seqlock 读结束: 读取期间快照被改写则需重试
+ */
+bool fx3u_image_snapshot_retry(const fx3u_image_snapshot_t *snap, uint32_t seq)
+{
+    __dmb();
+    if (snap->seq != seq) {
+        g_stats.read_retries++;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * 各区域元素个数
+ */
+uint16_t fx3u_image_area_size(fx3u_image_area_t area)
+{
+    switch (area) {
+        case FX3U_IMAGE_X:  return PLC_MAX_INPUTS;
+        case FX3U_IMAGE_Y:  return PLC_MAX_OUTPUTS;
+        case FX3U_IMAGE_M:  return PLC_MAX_INTERNALS;
+        case FX3U_IMAGE_D:  return PLC_MAX_REGISTERS;
+        case FX3U_IMAGE_S:  return PLC_MAX_STATES;
+        case FX3U_IMAGE_TS:
+        case FX3U_IMAGE_TN: return PLC_MAX_TIMERS;
+        case FX3U_IMAGE_CS:
+        case FX3U_IMAGE_CN: return PLC_MAX_COUNTERS;
+        case FX3U_IMAGE_SM:
+        case FX3U_IMAGE_SD: return PLC_MAX_SPECIAL;
+        default:            return 0;
+    }
+}
+
+/**
+ * 快照中读取 count (1-32) 个位，越界部分读作 0
+ */
+uint32_t fx3u_image_snapshot_bits(const fx3u_image_snapshot_t *snap, fx3u_image_area_t area,
+                                  uint16_t start, uint8_t count)
+{
+    if (!snap) return 0;
+
+    uint16_t limit;
+    const uint32_t *bits = snapshot_bits(snap, area, &limit);
+    if (!bits || start >= limit) return 0;
+    if ((uint32_t)start + count > limit) {
+        count = (uint8_t)(limit - start);
+    }
+    return fx3u_bits_read(bits, start, count);
+}
+
+/**
+ * 快照中读取一个字区元素 (CN 为 32 位，其余为 16 位符号扩展)，越界读作 0
+ */
+int32_t fx3u_image_snapshot_value(const fx3u_image_snapshot_t *snap, fx3u_image_area_t area,
+                                  uint16_t index)
+{
+    if (!snap || index >= fx3u_image_area_size(area)) return 0;
+
+    switch (area) {
+        case FX3U_IMAGE_D:  return snap->registers[index];
+        case FX3U_IMAGE_TN: return snap->timer_values[index];
+        case FX3U_IMAGE_CN: return snap->counter_values[index];
+        case FX3U_IMAGE_SD: return snap->special_registers[index];
+        default:            return 0;
+    }
+}
+
+/* 受变化检测的寄存器在跟踪数组中的下标，未跟踪返回 -1 */
+static int32_t change_index(fx3u_image_area_t area, uint16_t index)
+{
+    if (area == FX3U_IMAGE_D && index < PLC_MAX_REGISTERS) return index;
+    if (area == FX3U_IMAGE_SD && index < PLC_MAX_SPECIAL) return PLC_MAX_REGISTERS + index;
+    return -1;
+}
+
+/* 发布时把脏标志折算为变化序号 */
+static void fold_changes(uint32_t seq)
+{
+    for (uint16_t b = 0; b < CHANGE_BLOCKS; b++) {
+        if (!g_dirty_block[b]) continue;
+        g_dirty_block[b] = 0;
+        g_block_seq[b] = seq;
+
+        uint16_t base = b * FX3U_IMAGE_CHANGE_BLOCK;
+        for (uint16_t i = base; i < base + FX3U_IMAGE_CHANGE_BLOCK; i++) {
+            if (g_dirty[i]) {
+                g_dirty[i] = 0;
+                g_change_stamp[i] = (uint16_t)seq;
+            }
+        }
+    }
+}
+
+/**
+ * 标记寄存器已改变 (值未变时调用方不应调用)
+ */
+void fx3u_image_mark_changed(fx3u_image_area_t area, uint16_t index)
+{
+    int32_t t = change_index(area, index);
+    if (t < 0) return;
+
+    g_dirty[t] = 1;
+    g_dirty_block[t / FX3U_IMAGE_CHANGE_BLOCK] = 1;
+}
+
+/**
+ * since 是否仍可用于增量查询
+ */
+bool fx3u_image_changes_valid(const fx3u_image_snapshot_t *snap, uint32_t since)
+{
+    if (!snap || since == 0) return false;
+
+    uint32_t span = snap->change_seq - since;
+    return (int32_t)span >= 0 && span < FX3U_IMAGE_CHANGE_WINDOW;
+}
+
+/**
+ * 寄存器在 (since, snap->change_seq] 内是否改变过；未跟踪的区域总视为已改变
+ *
+ * 读取期间扫描可能已发布更新的序号，序号大于快照的变化留待下次查询报告。
+ */
+bool fx3u_image_changed_since(const fx3u_image_snapshot_t *snap, fx3u_image_area_t area,
+                              uint16_t index, uint32_t since)
+{
+    int32_t t = change_index(area, index);
+    if (t < 0 || !fx3u_image_changes_valid(snap, since)) return true;
+
+    if ((int32_t)(g_block_seq[t / FX3U_IMAGE_CHANGE_BLOCK] - since) <= 0) return false;
+
+    uint16_t d = (uint16_t)(g_change_stamp[t] - (uint16_t)since);
+    return d != 0 && d <= (uint16_t)(snap->change_seq - since);
+}
+
+static uint16_t queue_free(void)
+{
+    return (uint16_t)(FX3U_IMAGE_WRITE_QUEUE_SIZE - 1 -
+                      ((g_write_tail - g_write_head) & WRITE_QUEUE_MASK));
+}
+
+/**
+ * 初始化过程映像并发布初始快照
+ */
+void fx3u_image_init(fx3u_core_t *plc)
+{
+    memset(g_snapshots, 0, sizeof(g_snapshots));
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_front = 0;
+    g_write_head = 0;
+    g_write_tail = 0;
+
+    memset((void *)g_dirty, 0, sizeof(g_dirty));
+    memset((void *)g_dirty_block, 0, sizeof(g_dirty_block));
+    memset(g_change_stamp, 0, sizeof(g_change_stamp));
+    memset(g_block_seq, 0, sizeof(g_block_seq));
+    g_change_seq = 0;
+
+    if (plc) {
+        fx3u_image_publish(plc);
+    }
+}
+
+/**
+ * 扫描开始: 应用通信侧排队的写入
+ */
+uint32_t fx3u_image_apply_writes(fx3u_core_t *plc)
+{
+    if (!plc) return 0;
+
+    uint16_t head = g_write_head;
+    uint16_t tail = g_write_tail;
+    __dmb();
+
+    uint32_t applied = 0;
+    while (head != tail) {
+        const fx3u_image_write_t *w = &g_write_queue[head];
+        if (!FX3U_IMAGE_IS_BIT_AREA(w->area)) {
+            apply_word(plc, w);
+        } else {
+            uint16_t limit;
+            uint8_t *bits = core_bits(plc, w->area, &limit);
+            if (bits && (uint32_t)w->addr + w->count <= limit) {
+                fx3u_bits_unpack(&bits[w->addr], (uint16_t)w->value, w->count);
+            }
+        }
+        head = (head + 1) & WRITE_QUEUE_MASK;
+        applied++;
+    }
+
+    __dmb();
+    g_write_head = head;
+    g_stats.writes_applied += applied;
+    return applied;
+}
+
+/**
+ * 扫描结束: 将当前状态拷贝到后台缓冲并切换为前台
+ */
+void fx3u_image_publish(const fx3u_core_t *plc)
+{
+    if (!plc) return;
+
+    uint8_t back = g_front ^ 1u;
+    fx3u_image_snapshot_t *snap = &g_snapshots[back];
+
+    snap->seq++;
+    __dmb();
+    snap->scan_count = plc->cycle_count;
+    fold_changes(++g_change_seq);
+    snap->change_seq = g_change_seq;
+    fx3u_bits_pack(snap->inputs, plc->inputs, PLC_MAX_INPUTS);
+    fx3u_bits_pack(snap->outputs, plc->outputs, PLC_MAX_OUTPUTS);
+    fx3u_bits_pack(snap->internals, plc->internals, PLC_MAX_INTERNALS);
+    fx3u_bits_pack(snap->states, plc->states, PLC_MAX_STATES);
+    fx3u_bits_pack(snap->special_relays, plc->special_relays, PLC_MAX_SPECIAL);
+    memset(snap->timer_contacts, 0, sizeof(snap->timer_contacts));
+    memset(snap->counter_contacts, 0, sizeof(snap->counter_contacts));
+    memcpy(snap->registers, plc->registers, sizeof(snap->registers));
+    memcpy(snap->special_registers, plc->special_registers, sizeof(snap->special_registers));
+    for (uint16_t i = 0; i < PLC_MAX_TIMERS; i++) {
+        uint64_t ms = plc->timers[i].elapsed_us / 1000u;
+        snap->timer_values[i] = (int16_t)(ms > INT16_MAX ? INT16_MAX : ms);
+        snap->timer_contacts[i / 32] |= (uint32_t)plc->timers[i].is_done << (i % 32);
+    }
+    for (uint16_t i = 0; i < PLC_MAX_COUNTERS; i++) {
+        snap->counter_values[i] = plc->counters[i].current_value;
+        snap->counter_contacts[i / 32] |= (uint32_t)plc->counters[i].is_done << (i % 32);
+    }
+    __dmb();
+    snap->seq++;
+    __dmb();
+
+    g_front = back;
+    g_stats.publish_count++;
+}
+
+/**
+ * 从快照读取多个位区，按顺序首尾相接打包 (LSB 优先)
+ *
+ * 所有区段在同一次 seqlock 读取中完成，结果来自同一次扫描。
+ */
+uint32_t fx3u_image_read_bit_spans(const fx3u_image_span_t *spans, uint8_t span_count,
+                                   uint8_t *packed)
+{
+    if (!spans || !packed || span_count == 0) return 0;
+
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < span_count; i++) {
+        total += spans[i].count;
+    }
+    if (total == 0 || total > FX3U_IMAGE_MAX_SPAN_BITS) return 0;
+
+    uint32_t out[FX3U_BITS_WORDS(FX3U_IMAGE_MAX_SPAN_BITS)];
+    const fx3u_image_snapshot_t *snap;
+    uint32_t seq;
+    uint32_t scan;
+
+    do {
+        snap = fx3u_image_snapshot_begin(&seq);
+        memset(out, 0, FX3U_BITS_WORDS(total) * sizeof(uint32_t));
+
+        uint32_t pos = 0;
+        for (uint8_t i = 0; i < span_count; i++) {
+            const fx3u_image_span_t *sp = &spans[i];
+            uint16_t limit;
+            const uint32_t *bits = snapshot_bits(snap, sp->area, &limit);
+
+            /* 越界部分读作 0 */
+            uint16_t valid = 0;
+            if (bits && sp->start < limit) {
+                valid = (uint32_t)sp->start + sp->count > limit ?
+                        (uint16_t)(limit - sp->start) : sp->count;
+            }
+            for (uint16_t k = 0; k < valid; k += 32) {
+                uint8_t n = (uint8_t)(valid - k < 32 ? valid - k : 32);
+                fx3u_bits_write(out, pos + k, n, fx3u_bits_read(bits, sp->start + k, n));
+            }
+            pos += sp->count;
+        }
+        scan = snap->scan_count;
+    } while (fx3u_image_snapshot_retry(snap, seq));
+
+    fx3u_bits_to_bytes(packed, out, 0, total);
+    return scan;
+}
+
+/**
+ * 从快照读取位区 (LSB 优先打包)
+ */
+uint32_t fx3u_image_read_bits(fx3u_image_area_t area, uint16_t start,
+                              uint16_t count, uint8_t *packed)
+{
+    fx3u_image_span_t span = { area, start, count };
+    return fx3u_image_read_bit_spans(&span, 1, packed);
+}
+
+/**
+ * 从快照读取数据寄存器
+ */
+uint32_t fx3u_image_read_registers(uint16_t start, uint16_t count, int16_t *out)
+{
+    if (!out || count == 0) return 0;
+    if ((uint32_t)start + count > PLC_MAX_REGISTERS) return 0;
+
+    const fx3u_image_snapshot_t *snap;
+    uint32_t seq;
+    uint32_t scan;
+
+    do {
+        snap = fx3u_image_snapshot_begin(&seq);
+        memcpy(out, &snap->registers[start], (size_t)count * sizeof(int16_t));
+        scan = snap->scan_count;
+    } while (fx3u_image_snapshot_retry(snap, seq));
+
+    return scan;
+}
+
+/* 从字节流任意位偏移处取 n (<= 16) 个位 */
+static uint16_t stream_bits(const uint8_t *src, uint32_t pos, uint8_t n)
+{
+    const uint8_t *in = &src[pos >> 3];
+    uint8_t shift = pos & 7;
+    uint8_t bytes = (uint8_t)((shift + n + 7) / 8);
+
+    uint32_t value = 0;
+    for (uint8_t b = 0; b < bytes; b++) {
+        value |= (uint32_t)in[b] << (b * 8);
+    }
+    return (uint16_t)((value >> shift) & ((1u << n) - 1u));
+}
+
+/**
+ * 多个位区写入入队，数据按顺序首尾相接打包 (LSB 优先)
+ */
+bool fx3u_image_queue_bit_spans(const fx3u_image_span_t *spans, uint8_t span_count,
+                                const uint8_t *packed)
+{
+    if (!spans || !packed || span_count == 0) return false;
+
+    uint16_t entries = 0;
+    for (uint8_t i = 0; i < span_count; i++) {
+        if (!FX3U_IMAGE_IS_BIT_AREA(spans[i].area) || spans[i].count == 0) return false;
+        entries += (spans[i].count + FX3U_IMAGE_BITS_PER_WRITE - 1) / FX3U_IMAGE_BITS_PER_WRITE;
+    }
+    if (entries > queue_free()) {
+        g_stats.writes_rejected++;
+        return false;
+    }
+
+    /* 每项携带 16 个位，2000 线圈仅占 125 项 */
+    uint16_t tail = g_write_tail;
+    uint32_t pos = 0;
+    for (uint8_t i = 0; i < span_count; i++) {
+        const fx3u_image_span_t *sp = &spans[i];
+        for (uint16_t k = 0; k < sp->count; k += FX3U_IMAGE_BITS_PER_WRITE) {
+            uint8_t n = (uint8_t)(sp->count - k < FX3U_IMAGE_BITS_PER_WRITE ?
+                                  sp->count - k : FX3U_IMAGE_BITS_PER_WRITE);
+            fx3u_image_write_t *w = &g_write_queue[tail];
+            w->area = (uint8_t)sp->area;
+            w->count = n;
+            w->addr = sp->start + k;
+            w->value = (int16_t)stream_bits(packed, pos + k, n);
+            tail = (tail + 1) & WRITE_QUEUE_MASK;
+        }
+        pos += sp->count;
+    }
+
+    /* 整批写完后再发布尾指针，扫描侧要么看到全部要么一个也看不到 */
+    __dmb();
+    g_write_tail = tail;
+    return true;
+}
+
+/**
+ * 位区写入入队 (LSB 优先打包)
+ */
+bool fx3u_image_queue_bits(fx3u_image_area_t area, uint16_t start,
+                           const uint8_t *packed, uint16_t count)
+{
+    fx3u_image_span_t span = { area, start, count };
+    return fx3u_image_queue_bit_spans(&span, 1, packed);
+}
+
+/**
+ * 数据寄存器写入入队
+ */
+bool fx3u_image_queue_registers(uint16_t start, const int16_t *values, uint16_t count)
+{
+    if (!values || count == 0) return false;
+    if (count > queue_free()) {
+        g_stats.writes_rejected++;
+        return false;
+    }
+
+    uint16_t tail = g_write_tail;
+    for (uint16_t i = 0; i < count; i++) {
+        fx3u_image_write_t *w = &g_write_queue[tail];
+        w->area = FX3U_IMAGE_D;
+        w->count = 1;
+        w->addr = start + i;
+        w->value = values[i];
+        tail = (tail + 1) & WRITE_QUEUE_MASK;
+    }
+
+    __dmb();
+    g_write_tail = tail;
+    return true;
+}
+
+/**
+ * 任意写入项整批入队 (调用方已按区域组装好)
+ */
+bool fx3u_image_queue_writes(const fx3u_image_write_t *writes, uint16_t count)
+{
+    if (!writes || count == 0) return false;
+    if (count > queue_free()) {
+        g_stats.writes_rejected++;
+        return false;
+    }
+
+    uint16_t tail = g_write_tail;
+    for (uint16_t i = 0; i < count; i++) {
+        g_write_queue[tail] = writes[i];
+        tail = (tail + 1) & WRITE_QUEUE_MASK;
+    }
+
+    __dmb();
+    g_write_tail = tail;
+    return true;
+}
+
+/**
+ * 获取映像统计
+ */
+const fx3u_image_stats_t *fx3u_image_get_stats(void)
+{
+    return &g_stats;
+}
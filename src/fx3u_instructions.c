@@ -3,14 +3,31 @@
  */
 
 #include "fx3u_instructions.h"
+#include "fx3u_hsc.h"
+#include "fx3u_pulse.h"
 #include <stddef.h>
 
+#define POSITIONING_MAX     16
+
 /* 指令执行状态机 */
 static struct {
     bool bus_state;  /* 当前逻辑线状态 */
     bool block_out;  /* 逻辑块输出 */
 } g_exec_context;
 
+/* 定位指令的驱动状态: 同一输出可有多条定位指令，按操作码与操作数区分 */
+typedef struct {
+    uint8_t opcode;
+    uint16_t operand1;
+    uint16_t operand2;
+    uint16_t output;
+    bool driven;
+    uint32_t move;      /* 本次驱动启动的运动，0 = 无 */
+} positioning_state_t;
+
+static positioning_state_t g_positioning[POSITIONING_MAX];
+static uint8_t g_positioning_count = 0;
+
 /**
  * 执行单条指令
  */
@@ -51,6 +68,20 @@ inst_result_t fx3u_execute_instruction(fx3u_core_t *plc, fx3u_instruction_t *ins
             return fx3u_rst(plc, inst->operand1);
         case OP_PLS:
             return fx3u_pls(plc, inst->operand1);
+        case OP_DHSCS:
+            return fx3u_dhscs(plc, inst->operand1, inst->operand2, inst->operand3);
+        case OP_DHSCR:
+            return fx3u_dhscr(plc, inst->operand1, inst->operand2, inst->operand3);
+        case OP_PLSY:
+            return fx3u_plsy(plc, inst->operand1, inst->operand2, inst->operand3);
+        case OP_PLSR:
+            return fx3u_plsr(plc, inst->operand1, inst->operand2, inst->operand3);
+        case OP_DRVI:
+            return fx3u_drvi(plc, inst->operand1, inst->operand2, inst->operand3);
+        case OP_DRVA:
+            return fx3u_drva(plc, inst->operand1, inst->operand2, inst->operand3);
+        case OP_ZRN:
+            return fx3u_zrn(plc, inst->operand1, inst->operand2, inst->operand3);
         case OP_NOP:
             return INST_OK;
         default:
@@ -133,11 +164,28 @@ inst_result_t fx3u_tmr(fx3u_core_t *plc, uint16_t timer_num, uint16_t preset_add
 }
 
 /**
- * CNT 计数器指令
+ * 32 位字 (低字在 address，高字在 address + 1)
+ */
+static int32_t get_dword(fx3u_core_t *plc, uint16_t address)
+{
+    uint16_t low = (uint16_t)fx3u_get_word(plc, address);
+    uint16_t high = (uint16_t)fx3u_get_word(plc, (uint16_t)(address + 1));
+    return (int32_t)(((uint32_t)high << 16) | low);
+}
+
+/**
+ * CNT 计数器指令 (C235-C255 为高速计数器，设定值为 32 位)
  */
 inst_result_t fx3u_cnt(fx3u_core_t *plc, uint16_t counter_num, uint16_t preset_addr)
 {
-    if (!plc || counter_num >= PLC_MAX_COUNTERS) return INST_INVALID;
+    if (!plc) return INST_INVALID;
+    
+    if (FX3U_HSC_IS_COUNTER(counter_num)) {
+        fx3u_hsc_drive(counter_num, g_exec_context.bus_state, get_dword(plc, preset_addr));
+        g_exec_context.bus_state = fx3u_hsc_done(counter_num);
+        return INST_OK;
+    }
+    if (counter_num >= PLC_MAX_COUNTERS) return INST_INVALID;
     
     int16_t preset = fx3u_get_word(plc, preset_addr);
     
@@ -304,6 +352,165 @@ inst_result_t fx3u_pls(fx3u_core_t *plc, uint16_t address)
     return INST_OK;
 }
 
+/**
+ * 高速计数器比较 - 驱动为 ON 期间，当前值变为比较值时在中断中执行动作
+ */
+static inst_result_t hsc_compare(fx3u_core_t *plc, uint16_t target_addr, uint16_t counter_addr,
+                                 uint16_t device, uint8_t value)
+{
+    if (!plc) return INST_INVALID;
+    
+    uint16_t counter = counter_addr & FX3U_ADDR_MASK;
+    if ((counter_addr >> 12) != REG_COUNTER || !FX3U_HSC_IS_COUNTER(counter)) {
+        return INST_INVALID;
+    }
+    
+    fx3u_hsc_compare(counter, g_exec_context.bus_state, get_dword(plc, target_addr),
+                     device, value);
+    return INST_OK;
+}
+
+/**
+ * DHSCS 比较置位
+ */
+inst_result_t fx3u_dhscs(fx3u_core_t *plc, uint16_t target_addr, uint16_t counter_addr,
+                         uint16_t device)
+{
+    return hsc_compare(plc, target_addr, counter_addr, device, 1);
+}
+
+/**
+ * DHSCR 比较复位 (device 为计数器本身时复位当前值)
+ */
+inst_result_t fx3u_dhscr(fx3u_core_t *plc, uint16_t target_addr, uint16_t counter_addr,
+                         uint16_t device)
+{
+    return hsc_compare(plc, target_addr, counter_addr, device, 0);
+}
+
+/**
+ * 查找定位指令的驱动状态，没有时占用一个空闲项 (未驱动且运动已结束)
+ */
+static positioning_state_t *positioning_state(uint8_t opcode, uint16_t operand1, uint16_t operand2,
+                                              uint16_t output)
+{
+    positioning_state_t *spare = NULL;
+    for (uint8_t i = 0; i < g_positioning_count; i++) {
+        positioning_state_t *st = &g_positioning[i];
+        if (st->opcode == opcode && st->operand1 == operand1 && st->operand2 == operand2 &&
+            st->output == output) {
+            return st;
+        }
+        if (!spare && !st->driven && !st->move) {
+            spare = st;
+        }
+    }
+    if (!spare && g_positioning_count < POSITIONING_MAX) {
+        spare = &g_positioning[g_positioning_count++];
+    }
+    if (spare) {
+        spare->opcode = opcode;
+        spare->operand1 = operand1;
+        spare->operand2 = operand2;
+        spare->output = output;
+        spare->driven = false;
+        spare->move = 0;
+    }
+    return spare;
+}
+
+/**
+ * 定位指令公共部分: 驱动上升沿启动，驱动 OFF 时停止 (PLSY 立即停止，其余减速停止)，
+ * 执行后 M8029 反映本指令的运动是否完成
+ */
+static inst_result_t positioning(fx3u_core_t *plc, uint8_t opcode, uint16_t operand1,
+                                 uint16_t operand2, uint16_t output)
+{
+    if (!plc) return INST_INVALID;
+    
+    uint16_t channel = output & FX3U_ADDR_MASK;
+    if ((output >> 12) != REG_OUTPUT || channel >= FX3U_PULSE_CHANNELS) {
+        return INST_INVALID;
+    }
+    positioning_state_t *st = positioning_state(opcode, operand1, operand2, output);
+    if (!st) return INST_INVALID;
+    
+    bool drive = g_exec_context.bus_state;
+    if (drive && !st->driven) {
+        switch (opcode) {
+            case OP_PLSY:
+                st->move = fx3u_pulse_plsy((uint8_t)channel, (uint32_t)get_dword(plc, operand1),
+                                           (uint32_t)get_dword(plc, operand2));
+                break;
+            case OP_PLSR:
+                st->move = fx3u_pulse_plsr((uint8_t)channel, (uint32_t)get_dword(plc, operand1),
+                                           (uint32_t)get_dword(plc, operand2));
+                break;
+            case OP_DRVI:
+                st->move = fx3u_pulse_drvi((uint8_t)channel, get_dword(plc, operand1),
+                                           (uint32_t)get_dword(plc, operand2));
+                break;
+            case OP_DRVA:
+                st->move = fx3u_pulse_drva((uint8_t)channel, get_dword(plc, operand1),
+                                           (uint32_t)get_dword(plc, operand2));
+                break;
+            default:
+                st->move = fx3u_pulse_zrn((uint8_t)channel, (uint32_t)get_dword(plc, operand1), operand2);
+                break;
+        }
+    } else if (!drive && st->driven) {
+        if (st->move) {
+            fx3u_pulse_stop((uint8_t)channel, st->move, opcode != OP_PLSY);
+        }
+        st->move = 0;
+    }
+    st->driven = drive;
+    
+    fx3u_set_special_relay(plc, M8029, drive && st->move &&
+                           fx3u_pulse_state((uint8_t)channel, st->move) == FX3U_PULSE_DONE);
+    return INST_OK;
+}
+
+/**
+ * PLSY 脉冲输出 (无加减速，脉冲数为 0 时一直输出)
+ */
+inst_result_t fx3u_plsy(fx3u_core_t *plc, uint16_t freq_addr, uint16_t count_addr, uint16_t output)
+{
+    return positioning(plc, OP_PLSY, freq_addr, count_addr, output);
+}
+
+/**
+ * PLSR 带加减速的脉冲输出 (加减速时间 D8348)
+ */
+inst_result_t fx3u_plsr(fx3u_core_t *plc, uint16_t freq_addr, uint16_t count_addr, uint16_t output)
+{
+    return positioning(plc, OP_PLSR, freq_addr, count_addr, output);
+}
+
+/**
+ * DRVI 相对定位 (方向输出 Y4-Y6)
+ */
+inst_result_t fx3u_drvi(fx3u_core_t *plc, uint16_t distance_addr, uint16_t freq_addr, uint16_t output)
+{
+    return positioning(plc, OP_DRVI, distance_addr, freq_addr, output);
+}
+
+/**
+ * DRVA 绝对定位 (以 D8340 起的当前位置为基准)
+ */
+inst_result_t fx3u_drva(fx3u_core_t *plc, uint16_t position_addr, uint16_t freq_addr, uint16_t output)
+{
+    return positioning(plc, OP_DRVA, position_addr, freq_addr, output);
+}
+
+/**
+ * ZRN 原点回归 (爬行速度 D8345，DOG 为位地址)
+ */
+inst_result_t fx3u_zrn(fx3u_core_t *plc, uint16_t speed_addr, uint16_t dog, uint16_t output)
+{
+    return positioning(plc, OP_ZRN, speed_addr, dog, output);
+}
+
 /**
  * 获取位值 (通用)
  */
@@ -335,7 +542,13 @@ uint8_t fx3u_get_bit(fx3u_core_t *plc, uint16_t address)
         case 4: /* C */
             if (num < PLC_MAX_COUNTERS)
                 return fx3u_counter_done(plc, num) ? 1 : 0;
+            if (FX3U_HSC_IS_COUNTER(num))
+                return fx3u_hsc_done(num) ? 1 : 0;
             break;
+        case 6: /* S */
+            return fx3u_get_state(plc, num);
+        case 7: /* M8000- */
+            return fx3u_get_special_relay(plc, PLC_SPECIAL_BASE + num);
     }
     
     return 0;
@@ -360,6 +573,16 @@ void fx3u_set_bit(fx3u_core_t *plc, uint16_t address, uint8_t value)
             if (num < PLC_MAX_INTERNALS)
                 fx3u_set_internal(plc, num, value);
             break;
+        case 4: /* C: RST 复位高速计数器 */
+            if (FX3U_HSC_IS_COUNTER(num) && !value)
+                fx3u_hsc_reset(num);
+            break;
+        case 6: /* S */
+            fx3u_set_state(plc, num, value);
+            break;
+        case 7: /* M8000- */
+            fx3u_set_special_relay(plc, PLC_SPECIAL_BASE + num, value);
+            break;
     }
 }
 
@@ -376,6 +599,12 @@ int16_t fx3u_get_word(fx3u_core_t *plc, uint16_t address)
     if (type == 5 && num < PLC_MAX_REGISTERS) {
         return fx3u_get_register(plc, num);
     }
+    if (type == 8) {
+        return fx3u_get_special_register(plc, PLC_SPECIAL_BASE + num);
+    }
+    if (type == 4 && FX3U_HSC_IS_COUNTER(num)) {
+        return (int16_t)fx3u_hsc_read(num);     /* 当前值低 16 位 */
+    }
     
     return 0;
 }
@@ -393,6 +622,9 @@ void fx3u_set_word(fx3u_core_t *plc, uint16_t address, int16_t value)
     if (type == 5 && num < PLC_MAX_REGISTERS) {
         fx3u_set_register(plc, num, value);
     }
+    if (type == 8) {
+        fx3u_set_special_register(plc, PLC_SPECIAL_BASE + num, value);
+    }
 }
 
 /**
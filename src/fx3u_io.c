@@ -17,7 +17,8 @@
  * 电气特性：
  * - 工作电压：3.3V (3.0..3.6V)
  * - GPIO 驱动：单个 ≤12mA，推荐；绝对最大 16mA
- * - 输入去抖：20ms (可配置)
+ * - 输入去抖：20ms (可配置)，一次 gpio_get_all() 采样全部输入，
+ *   查表换算为 X 顺序后用垂直计数器并行去抖
  * - ADC：12-bit, 0..3.3V, 3 通道
  */
 
@@ -25,16 +26,109 @@
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include "hardware/pwm.h"
+#include "hardware/clocks.h"
 #include "hardware/adc.h"
+#include "hardware/sync.h"
 #include "pico/time.h"
+#include "logger.h"
+#include "fx3u_analog.h"
 #include <stdio.h>
 #include <string.h>
 
 static io_manager_t *g_io_mgr = NULL;
 
-/* 去抖动计时器 */
-static uint32_t g_input_debounce_time[PICO_TOTAL_INPUTS];
-static uint8_t g_input_stable[PICO_TOTAL_INPUTS];
+static const uint8_t g_input_gpios[PICO_TOTAL_INPUTS] = {
+    PICO_INPUT_X0_GPIO,  PICO_INPUT_X1_GPIO,  PICO_INPUT_X2_GPIO,
+    PICO_INPUT_X3_GPIO,  PICO_INPUT_X4_GPIO,  PICO_INPUT_X5_GPIO,
+    PICO_INPUT_X6_GPIO,  PICO_INPUT_X7_GPIO,  PICO_INPUT_X8_GPIO,
+    PICO_INPUT_X9_GPIO
+};
+
+static const uint8_t g_output_gpios[PICO_OUTPUT_COUNT] = {
+    PICO_OUTPUT_Y0_GPIO,  PICO_OUTPUT_Y1_GPIO,  PICO_OUTPUT_Y2_GPIO,
+    PICO_OUTPUT_Y3_GPIO,  PICO_OUTPUT_Y4_GPIO,  PICO_OUTPUT_Y5_GPIO,
+    PICO_OUTPUT_Y6_GPIO,  PICO_OUTPUT_Y7_GPIO,  PICO_OUTPUT_Y8_GPIO
+};
+
+_Static_assert(PICO_TOTAL_INPUTS <= 16, "input LUT entries are 16 bits");
+_Static_assert(PICO_OUTPUT_COUNT <= 16, "output LUT covers Y0-Y15");
+
+/* gpio_get_all() 每个字节 -> X 位 的查找表，引脚任意排列都只需 4 次查表 */
+static uint16_t g_input_lut[4][256];
+
+/* 去抖: 去抖后的 X 字与 2 位垂直计数器 (每个输入一列，连续 4 次不同才翻转) */
+static uint32_t g_input_word = 0;
+static uint32_t g_input_cnt0 = ~0u;
+static uint32_t g_input_cnt1 = ~0u;
+static uint32_t g_input_sample_ms = 0;
+
+/* 输入沿中断 */
+#define EDGE_LOCKOUT_US     (PICO_INPUT_DEBOUNCE_MS * 1000u)
+#define GPIO_COUNT          30
+
+static int8_t g_gpio_to_input[GPIO_COUNT];
+static uint32_t g_fast_mask = 0;        /* 实际开启沿中断的 X = 请求 & ~占用 */
+static uint32_t g_fast_request = 0;
+static uint32_t g_claimed_mask = 0;     /* 由高速计数器等占用的 X */
+static uint32_t g_edge_time[PICO_TOTAL_INPUTS];
+static io_input_edge_callback_t g_edge_callback = NULL;
+
+/* 响应时间: 从被接受的输入沿到其后第一次输出变化 */
+static io_reaction_stats_t g_reaction;
+static uint32_t g_reaction_stamp = 0;
+static bool g_reaction_armed = false;
+
+static void build_input_lut(void)
+{
+    for (int b = 0; b < 4; b++) {
+        for (int v = 0; v < 256; v++) {
+            uint16_t x = 0;
+            for (int i = 0; i < PICO_TOTAL_INPUTS; i++) {
+                uint8_t gpio = g_input_gpios[i];
+                if (gpio / 8 == b && (v >> (gpio % 8)) & 1) {
+                    x |= (uint16_t)(1u << i);
+                }
+            }
+            g_input_lut[b][v] = x;
+        }
+    }
+}
+
+/* Y 字的低 / 高字节 -> GPIO 位 的查找表 */
+static uint32_t g_output_lut[2][256];
+static uint16_t g_output_word = 0;     /* 最近一次写到引脚的 Y 字 */
+
+static void build_output_lut(void)
+{
+    for (int b = 0; b < 2; b++) {
+        for (int v = 0; v < 256; v++) {
+            uint32_t gpio_bits = 0;
+            for (int i = 0; i < 8 && b * 8 + i < PICO_OUTPUT_COUNT; i++) {
+                if ((v >> i) & 1) {
+                    gpio_bits |= 1u << g_output_gpios[b * 8 + i];
+                }
+            }
+            g_output_lut[b][v] = gpio_bits;
+        }
+    }
+}
+
+static void record_reaction(uint32_t latency_us)
+{
+    uint32_t bucket = latency_us ? 31u - (uint32_t)__builtin_clz(latency_us) : 0;
+    if (bucket >= IO_REACTION_BUCKETS) bucket = IO_REACTION_BUCKETS - 1;
+    
+    g_reaction.buckets[bucket]++;
+    g_reaction.count++;
+    if (latency_us < g_reaction.min_us) g_reaction.min_us = latency_us;
+    if (latency_us > g_reaction.max_us) g_reaction.max_us = latency_us;
+}
+
+static inline uint32_t gpio_to_inputs(uint32_t all)
+{
+    return g_input_lut[0][all & 0xFF] | g_input_lut[1][(all >> 8) & 0xFF] |
+           g_input_lut[2][(all >> 16) & 0xFF] | g_input_lut[3][all >> 24];
+}
 
 /**
  * io_manager_init - 初始化所有 I/O 端口
@@ -54,15 +148,8 @@ void io_manager_init(io_manager_t *io_mgr)
     g_io_mgr = io_mgr;
     
     /* ===== 初始化数字输入 (X0-X9) ===== */
-    uint8_t input_gpios[] = {
-        PICO_INPUT_X0_GPIO,  PICO_INPUT_X1_GPIO,  PICO_INPUT_X2_GPIO,
-        PICO_INPUT_X3_GPIO,  PICO_INPUT_X4_GPIO,  PICO_INPUT_X5_GPIO,
-        PICO_INPUT_X6_GPIO,  PICO_INPUT_X7_GPIO,  PICO_INPUT_X8_GPIO,
-        PICO_INPUT_X9_GPIO
-    };
-    
     for (int i = 0; i < PICO_TOTAL_INPUTS; i++) {
-        uint8_t gpio = input_gpios[i];
+        uint8_t gpio = g_input_gpios[i];
         gpio_init(gpio);
         gpio_set_dir(gpio, GPIO_IN);
         
@@ -73,24 +160,33 @@ void io_manager_init(io_manager_t *io_mgr)
         }
         
         g_io_mgr->input_gpio_mask |= (1 << gpio);
-        g_input_stable[i] = 0;
-        g_input_debounce_time[i] = 0;
     }
     
-    /* ===== 初始化数字输出 (Y0-Y8) ===== */
-    uint8_t output_gpios[] = {
-        PICO_OUTPUT_Y0_GPIO,  PICO_OUTPUT_Y1_GPIO,  PICO_OUTPUT_Y2_GPIO,
-        PICO_OUTPUT_Y3_GPIO,  PICO_OUTPUT_Y4_GPIO,  PICO_OUTPUT_Y5_GPIO,
-        PICO_OUTPUT_Y6_GPIO,  PICO_OUTPUT_Y7_GPIO,  PICO_OUTPUT_Y8_GPIO
-    };
+    for (int g = 0; g < GPIO_COUNT; g++) {
+        g_gpio_to_input[g] = -1;
+    }
+    for (int i = 0; i < PICO_TOTAL_INPUTS; i++) {
+        g_gpio_to_input[g_input_gpios[i]] = (int8_t)i;
+    }
+    io_reset_reaction_stats();
     
+    /* 上电时的电平直接作为稳定值，不经过去抖 */
+    build_input_lut();
+    g_input_word = gpio_to_inputs(gpio_get_all());
+    g_input_cnt0 = ~0u;
+    g_input_cnt1 = ~0u;
+    g_input_sample_ms = to_ms_since_boot(get_absolute_time());
+    
+    /* ===== 初始化数字输出 (Y0-Y8) ===== */
     for (int i = 0; i < PICO_OUTPUT_COUNT; i++) {
-        uint8_t gpio = output_gpios[i];
+        uint8_t gpio = g_output_gpios[i];
         gpio_init(gpio);
         gpio_set_dir(gpio, GPIO_OUT);
         gpio_put(gpio, 0);  /* 初始化为低电平 */
         g_io_mgr->output_gpio_mask |= (1 << gpio);
     }
+    build_output_lut();
+    g_output_word = 0;
     
     /* ===== 初始化 RUN LED (GPIO2) ===== */
     gpio_init(PICO_LED_RUN_GPIO);
@@ -149,12 +245,12 @@ void io_manager_init(io_manager_t *io_mgr)
     
     g_io_mgr->initialized = true;
     
-    printf("[IO] I/O 管理器初始化完成\n");
-    printf("[IO] 数字输入: %d 路 (X0-X9)\n", PICO_TOTAL_INPUTS);
-    printf("[IO] 数字输出: %d 路 (Y0-Y8)\n", PICO_OUTPUT_COUNT);
-    printf("[IO] 模拟输入: %d 路 (AI0, AI1, PVD)\n", PICO_TOTAL_ADC);
-    printf("[IO] LED: %d 个 (RUN, ERR)\n", PICO_TOTAL_LEDS);
-    printf("[IO] UART: %d bps @ GPIO%d/GPIO%d\n", PICO_UART_BAUDRATE, PICO_UART_TX_GPIO, PICO_UART_RX_GPIO);
+    LOG_INFO("[IO] I/O 管理器初始化完成\n");
+    LOG_INFO("[IO] 数字输入: %d 路 (X0-X9)\n", PICO_TOTAL_INPUTS);
+    LOG_INFO("[IO] 数字输出: %d 路 (Y0-Y8)\n", PICO_OUTPUT_COUNT);
+    LOG_INFO("[IO] 模拟输入: %d 路 (AI0, AI1, PVD)\n", PICO_TOTAL_ADC);
+    LOG_INFO("[IO] LED: %d 个 (RUN, ERR)\n", PICO_TOTAL_LEDS);
+    LOG_INFO("[IO] UART: %d bps @ GPIO%d/GPIO%d\n", PICO_UART_BAUDRATE, PICO_UART_TX_GPIO, PICO_UART_RX_GPIO);
 }
 
 /**
@@ -184,41 +280,28 @@ void io_write_output_relay(uint8_t relay_num, uint8_t value)
 {
     if (!g_io_mgr || relay_num >= PICO_OUTPUT_COUNT) return;
     
-    uint8_t output_gpios[] = {
-        PICO_OUTPUT_Y0_GPIO,  PICO_OUTPUT_Y1_GPIO,  PICO_OUTPUT_Y2_GPIO,
-        PICO_OUTPUT_Y3_GPIO,  PICO_OUTPUT_Y4_GPIO,  PICO_OUTPUT_Y5_GPIO,
-        PICO_OUTPUT_Y6_GPIO,  PICO_OUTPUT_Y7_GPIO,  PICO_OUTPUT_Y8_GPIO
-    };
-    
-    uint8_t gpio = output_gpios[relay_num];
+    uint8_t gpio = g_output_gpios[relay_num];
     io_set_gpio_output(gpio, value ? true : false);
     
     /* 更新缓冲 */
     if (value) {
-        g_io_mgr->output_state[relay_num / 8] |= (1 << (relay_num % 8));
+        g_output_word |= (uint16_t)(1u << relay_num);
     } else {
-        g_io_mgr->output_state[relay_num / 8] &= ~(1 << (relay_num % 8));
+        g_output_word &= (uint16_t)~(1u << relay_num);
     }
+    g_io_mgr->output_state[0] = (uint8_t)g_output_word;
+    g_io_mgr->output_state[1] = (uint8_t)(g_output_word >> 8);
 }
 
 /**
  * io_read_input_relay - 读 FX3U 输入继电器 (X0-X9)
  * 
- * 返回：0 或 1
+ * 返回：去抖后的 0 或 1
  */
 uint8_t io_read_input_relay(uint8_t relay_num)
 {
     if (relay_num >= PICO_TOTAL_INPUTS) return 0;
-    
-    uint8_t input_gpios[] = {
-        PICO_INPUT_X0_GPIO,  PICO_INPUT_X1_GPIO,  PICO_INPUT_X2_GPIO,
-        PICO_INPUT_X3_GPIO,  PICO_INPUT_X4_GPIO,  PICO_INPUT_X5_GPIO,
-        PICO_INPUT_X6_GPIO,  PICO_INPUT_X7_GPIO,  PICO_INPUT_X8_GPIO,
-        PICO_INPUT_X9_GPIO
-    };
-    
-    uint8_t gpio = input_gpios[relay_num];
-    return io_get_gpio_input(gpio) ? 1 : 0;
+    return (uint8_t)((g_input_word >> relay_num) & 1u);
 }
 
 /**
@@ -252,14 +335,31 @@ bool io_get_switch_run(void)
 /**
  * io_write_output_word - 批量写输出 (Y0-Y8 as uint16_t)
  * 
- * value 的 bit[0..8] 对应 Y0..Y8
+ * value 的 bit[0..8] 对应 Y0..Y8。查表换算为 GPIO 位后一次 gpio_put_masked，
+ * 所有输出在同一时钟沿翻转；与上次相同则不访问 GPIO。
  */
 void io_write_output_word(uint16_t value)
 {
-    for (int i = 0; i < PICO_OUTPUT_COUNT; i++) {
-        uint8_t bit_val = (value >> i) & 1;
-        io_write_output_relay(i, bit_val);
+    if (!g_io_mgr) return;
+    
+    value &= (uint16_t)((1u << PICO_OUTPUT_COUNT) - 1u);
+    if (value == g_output_word) return;
+    
+    /* 主循环与输入沿中断都会调用 */
+    uint32_t ints = save_and_disable_interrupts();
+    if (value != g_output_word) {
+        gpio_put_masked(g_io_mgr->output_gpio_mask,
+                        g_output_lut[0][value & 0xFF] | g_output_lut[1][value >> 8]);
+        g_output_word = value;
+        g_io_mgr->output_state[0] = (uint8_t)value;
+        g_io_mgr->output_state[1] = (uint8_t)(value >> 8);
+        
+        if (g_reaction_armed) {
+            record_reaction(time_us_32() - g_reaction_stamp);
+            g_reaction_armed = false;
+        }
     }
+    restore_interrupts(ints);
 }
 
 /**
@@ -270,20 +370,159 @@ void io_write_output_word(uint16_t value)
 uint16_t io_read_input_word(void)
 {
     if (!g_io_mgr) return 0;
-    uint16_t value = 0;
+    return (uint16_t)g_input_word;
+}
+
+/**
+ * io_sample_inputs - 采样一次全部输入并去抖
+ * 
+ * 一次 gpio_get_all()，4 次查表换算为 X 顺序，
+ * 垂直计数器对所有通道同时计数，开销与输入点数无关。
+ * 每 PICO_INPUT_SAMPLE_MS 调用一次，连续 4 次与稳定值不同才翻转。
+ */
+uint32_t io_sample_inputs(void)
+{
+    /* 与输入沿中断共享去抖状态 */
+    uint32_t ints = save_and_disable_interrupts();
+    uint32_t delta = g_input_word ^ gpio_to_inputs(gpio_get_all());
+    
+    g_input_cnt0 = ~(g_input_cnt0 & delta);
+    g_input_cnt1 = g_input_cnt0 ^ (g_input_cnt1 & delta);
+    g_input_word ^= delta & g_input_cnt0 & g_input_cnt1;
+    uint32_t word = g_input_word;
+    restore_interrupts(ints);
+    return word;
+}
+
+/**
+ * 输入沿中断 - 首沿立即更新去抖后的 X 字 (前沿去抖)
+ * 
+ * 接受一个沿后该通道锁定 PICO_INPUT_DEBOUNCE_MS，期间的沿计为抖动；
+ * 锁定期内的真实释放由周期采样的垂直计数器在 4 次采样后确认。
+ */
+static void input_edge_irq(uint gpio, uint32_t events)
+{
+    uint32_t now = time_us_32();
+    if (gpio >= GPIO_COUNT || g_gpio_to_input[gpio] < 0) return;
+    
+    int x = g_gpio_to_input[gpio];
+    uint32_t bit = 1u << x;
+    if (!(g_fast_mask & bit)) return;
+    
+    if (now - g_edge_time[x] < EDGE_LOCKOUT_US) {
+        g_reaction.bounces++;
+        return;
+    }
+    
+    uint32_t level;
+    if ((events & GPIO_IRQ_EDGE_RISE) && !(events & GPIO_IRQ_EDGE_FALL)) {
+        level = 1;
+    } else if ((events & GPIO_IRQ_EDGE_FALL) && !(events & GPIO_IRQ_EDGE_RISE)) {
+        level = 0;
+    } else {
+        level = gpio_get(gpio) ? 1 : 0;
+    }
+    if (((g_input_word >> x) & 1u) == level) return;
+    
+    /* 接受: 更新稳定值，该通道垂直计数器回到空闲 */
+    g_edge_time[x] = now;
+    g_input_word ^= bit;
+    g_input_cnt0 |= bit;
+    g_input_cnt1 |= bit;
+    g_reaction.edges++;
+    
+    if (!g_reaction_armed) {
+        g_reaction_stamp = now;
+        g_reaction_armed = true;
+    }
+    
+    if (g_edge_callback) {
+        g_edge_callback(bit, now);
+    }
+}
+
+/* 按 请求 & ~占用 开关各 X 的沿中断 */
+static void apply_input_irq(void)
+{
+    g_fast_mask = g_fast_request & ~g_claimed_mask;
     for (int i = 0; i < PICO_TOTAL_INPUTS; i++) {
-        if (g_input_stable[i]) {  /* 使用去抖后的值 */
-            value |= (1 << i);
-        }
+        bool enable = (g_fast_mask >> i) & 1u;
+        gpio_set_irq_enabled_with_callback(g_input_gpios[i],
+                                           GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL,
+                                           enable, input_edge_irq);
+    }
+}
+
+/**
+ * io_enable_input_irq - 为指定 X 启用沿中断
+ * 
+ * callback 在 GPIO 中断中调用，可用于立即执行一次周期外扫描；
+ * 已被 io_claim_inputs() 占用的 X 不开启
+ */
+void io_enable_input_irq(uint32_t x_mask, io_input_edge_callback_t callback)
+{
+    if (!g_io_mgr) return;
+    
+    x_mask &= (1u << PICO_TOTAL_INPUTS) - 1u;
+    uint32_t now = time_us_32();
+    
+    g_edge_callback = callback;
+    g_fast_request = x_mask;
+    for (int i = 0; i < PICO_TOTAL_INPUTS; i++) {
+        g_edge_time[i] = now - EDGE_LOCKOUT_US;
+    }
+    apply_input_irq();
+}
+
+/**
+ * io_claim_inputs - 其他外设 (高速计数器 PIO) 占用的 X 关闭沿中断
+ * 
+ * 脉冲输入上的沿不再进入 GPIO 中断、不触发周期外扫描、不计入响应统计；
+ * X 字仍由周期采样更新
+ */
+void io_claim_inputs(uint32_t x_mask)
+{
+    x_mask &= (1u << PICO_TOTAL_INPUTS) - 1u;
+    if (!x_mask || (g_claimed_mask & x_mask) == x_mask) return;
+    
+    g_claimed_mask |= x_mask;
+    if (g_fast_request & x_mask) {
+        apply_input_irq();
     }
-    return value;
+}
+
+/**
+ * io_get_reaction_stats - 获取输入沿到输出变化的响应时间统计
+ */
+void io_get_reaction_stats(io_reaction_stats_t *stats)
+{
+    if (!stats) return;
+    
+    uint32_t ints = save_and_disable_interrupts();
+    *stats = g_reaction;
+    restore_interrupts(ints);
+}
+
+/**
+ * io_reset_reaction_stats - 清除响应时间统计
+ */
+void io_reset_reaction_stats(void)
+{
+    uint32_t ints = save_and_disable_interrupts();
+    memset(&g_reaction, 0, sizeof(g_reaction));
+    g_reaction.min_us = UINT32_MAX;
+    g_reaction_armed = false;
+    restore_interrupts(ints);
 }
 
 /**
  * io_read_adc_ai0 - 读 AI0 (GPIO26, ADC0)
+ * 
+ * 后台采集运行时返回最近一次过采样平均值 (不等待转换)，否则做一次阻塞转换
  */
 uint16_t io_read_adc_ai0(void)
 {
+    if (fx3u_analog_running()) return fx3u_analog_get_raw(0);
     adc_select_input(0);  /* ADC channel 0 */
     return adc_read();
 }
@@ -293,6 +532,7 @@ uint16_t io_read_adc_ai0(void)
  */
 uint16_t io_read_adc_ai1(void)
 {
+    if (fx3u_analog_running()) return fx3u_analog_get_raw(1);
     adc_select_input(1);  /* ADC channel 1 */
     return adc_read();
 }
@@ -302,6 +542,7 @@ uint16_t io_read_adc_ai1(void)
  */
 uint16_t io_read_adc_pvd(void)
 {
+    if (fx3u_analog_running()) return fx3u_analog_get_raw(2);
     adc_select_input(2);  /* ADC channel 2 */
     return adc_read();
 }
@@ -312,6 +553,7 @@ uint16_t io_read_adc_pvd(void)
 uint16_t io_read_adc_raw(uint8_t channel)
 {
     if (channel > 2) return 0;
+    if (fx3u_analog_running()) return fx3u_analog_get_raw(channel);
     adc_select_input(channel);
     return adc_read();
 }
@@ -352,7 +594,7 @@ void io_rs485_set_re(bool enable)
  */
 void io_enable_pwm(uint8_t gpio_num, uint16_t frequency_hz, uint8_t duty_percent)
 {
-    if (gpio_num >= 30) return;
+    if (gpio_num >= 30 || frequency_hz == 0) return;
     if (duty_percent > 100) duty_percent = 100;
     
     gpio_set_function(gpio_num, GPIO_FUNC_PWM);
@@ -360,15 +602,15 @@ void io_enable_pwm(uint8_t gpio_num, uint16_t frequency_hz, uint8_t duty_percent
     
     pwm_config config = pwm_get_default_config();
     
-    /* 设置分频与计数值以达到目标频率 */
-    /* Pico 系统时钟 125MHz */
-    uint32_t period = 125000000 / frequency_hz;  /* 计数周期 */
+    /* 按实际系统时钟取最小的整数分频，使计数周期不超过 16 位 */
+    uint32_t sys_hz = clock_get_hz(clk_sys);
+    uint32_t div = sys_hz / ((uint32_t)frequency_hz * 65536u) + 1;
+    if (div > 255) div = 255;
+    pwm_config_set_clkdiv(&config, (float)div);
     
-    if (period > 65535) {
-        /* 需要分频 */
-        pwm_config_set_clkdiv(&config, 16.0f);  /* 125MHz / 16 = 7.8125 MHz */
-        period = 7812500 / frequency_hz;
-    }
+    uint32_t period = sys_hz / div / frequency_hz;  /* 计数周期 */
+    if (period < 2) period = 2;
+    if (period > 65536) period = 65536;
     
     pwm_config_set_wrap(&config, period - 1);
     pwm_init(slice_num, &config, true);
@@ -405,41 +647,17 @@ void io_manager_update(void)
     
     uint32_t now = to_ms_since_boot(get_absolute_time());
     
-    /* 扫描数字输入并去抖动 */
-    uint8_t input_gpios[] = {
-        PICO_INPUT_X0_GPIO,  PICO_INPUT_X1_GPIO,  PICO_INPUT_X2_GPIO,
-        PICO_INPUT_X3_GPIO,  PICO_INPUT_X4_GPIO,  PICO_INPUT_X5_GPIO,
-        PICO_INPUT_X6_GPIO,  PICO_INPUT_X7_GPIO,  PICO_INPUT_X8_GPIO,
-        PICO_INPUT_X9_GPIO
-    };
-    
-    for (int i = 0; i < PICO_TOTAL_INPUTS; i++) {
-        bool pin_state = gpio_get(input_gpios[i]);
-        
-        if (pin_state != g_input_stable[i]) {
-            /* 状态改变，启动去抖定时器 */
-            if (g_input_debounce_time[i] == 0) {
-                g_input_debounce_time[i] = now;
-            } else if (now - g_input_debounce_time[i] >= PICO_INPUT_DEBOUNCE_MS) {
-                /* 去抖完成，确认新状态 */
-                g_input_stable[i] = pin_state ? 1 : 0;
-                g_input_debounce_time[i] = 0;
-                
-                /* 可在此处添加状态变化回调 */
-            }
-        } else {
-            g_input_debounce_time[i] = 0;
-        }
+    /* 按固定间隔采样数字输入并去抖动 */
+    if (now - g_input_sample_ms >= PICO_INPUT_SAMPLE_MS) {
+        g_input_sample_ms = now;
+        uint32_t word = io_sample_inputs();
         
         /* 更新输入缓冲 */
-        if (g_input_stable[i]) {
-            g_io_mgr->input_state[i / 8] |= (1 << (i % 8));
-        } else {
-            g_io_mgr->input_state[i / 8] &= ~(1 << (i % 8));
-        }
+        g_io_mgr->input_state[0] = (uint8_t)word;
+        g_io_mgr->input_state[1] = (uint8_t)(word >> 8);
     }
     
-    /* 采样 ADC 值 */
+    /* ADC 值 (后台采集运行时直接取最近结果) */
     g_io_mgr->adc_values[0] = io_read_adc_ai0();
     g_io_mgr->adc_values[1] = io_read_adc_ai1();
     g_io_mgr->adc_values[2] = io_read_adc_pvd();
@@ -476,7 +694,19 @@ void io_diagnostic_report(void)
     
     printf("\n数字输入 (X0-X9):\n");
     for (int i = 0; i < PICO_TOTAL_INPUTS; i++) {
-        printf("  X%d: %d\n", i, g_input_stable[i]);
+        printf("  X%d: %d\n", i, (int)((g_input_word >> i) & 1u));
+    }
+    
+    io_reaction_stats_t reaction;
+    io_get_reaction_stats(&reaction);
+    printf("\n输入响应 (沿 -> 输出): %lu 次, 最小 %lu us, 最大 %lu us, 抖动沿 %lu\n",
+           (unsigned long)reaction.count,
+           (unsigned long)(reaction.count ? reaction.min_us : 0),
+           (unsigned long)reaction.max_us, (unsigned long)reaction.bounces);
+    for (int i = 0; i < IO_REACTION_BUCKETS; i++) {
+        if (reaction.buckets[i]) {
+            printf("  < %lu us: %lu\n", 2ul << i, (unsigned long)reaction.buckets[i]);
+        }
     }
     
     printf("\n模拟输入:\n");
@@ -510,5 +740,5 @@ void io_manager_shutdown(void)
     /* 禁用 ADC */
     adc_init();  /* 重置 */
     
-    printf("[IO] I/O 管理器已关闭\n");
+    LOG_INFO("[IO] I/O 管理器已关闭\n");
 }
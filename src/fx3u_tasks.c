@@ -0,0 +1,221 @@
+/**
+ * 协作式任务调度实现
+ *
+ * 任务表很小 (至多 16 项)，每次挑选线性扫描全表；
+ * 事件标志在中断中置位、在主循环执行前清除，执行期间再次触发会在下一轮重新就绪。
+ * 负载 = 1 - 窗口内休眠时间 / 窗口时长，中断服务时间计入负载。
+ */
+
+#include "fx3u_tasks.h"
+#include "fx3u_image.h"
+#include "pico/stdlib.h"
+#include "pico/time.h"
+#include "hardware/sync.h"
+#include <string.h>
+
+typedef struct {
+    fx3u_task_config_t config;
+    fx3u_task_stats_t stats;
+    uint64_t next_due_us;               /* 周期任务的下次就绪时刻 */
+    volatile bool pending;              /* 事件已触发 */
+    volatile uint64_t signaled_us;
+} task_t;
+
+static fx3u_core_t *g_plc = NULL;
+static task_t g_tasks[FX3U_TASKS_MAX];
+static uint8_t g_count = 0;
+static volatile int8_t g_current = -1;
+
+static uint64_t g_window_start_us = 0;
+static uint64_t g_idle_us = 0;
+static uint8_t g_load = 0;
+static uint8_t g_peak_load = 0;
+
+/**
+ * 任务就绪时刻 (未就绪返回 false)
+ */
+static bool ready_at(const task_t *t, uint64_t now, uint64_t *at)
+{
+    if (t->pending) {
+        *at = t->signaled_us;
+        return true;
+    }
+    if (t->config.period_us && now >= t->next_due_us) {
+        *at = t->next_due_us;
+        return true;
+    }
+    return false;
+}
+
+/* 就绪任务中优先级最高、同级最早就绪者 */
+static task_t *pick(uint64_t now, uint64_t *ready_us)
+{
+    task_t *best = NULL;
+    uint64_t best_at = 0;
+
+    for (uint8_t i = 0; i < g_count; i++) {
+        task_t *t = &g_tasks[i];
+        uint64_t at;
+        if (!ready_at(t, now, &at)) continue;
+        if (!best || t->config.priority < best->config.priority ||
+            (t->config.priority == best->config.priority && at < best_at)) {
+            best = t;
+            best_at = at;
+        }
+    }
+    *ready_us = best_at;
+    return best;
+}
+
+static void dispatch(task_t *t, uint64_t ready_us)
+{
+    uint64_t start = time_us_64();
+
+    /* 先清事件再执行: 执行期间的新事件不会丢 */
+    t->pending = false;
+    if (t->config.period_us && start >= t->next_due_us) {
+        t->next_due_us += t->config.period_us;
+        if (t->next_due_us <= start) {
+            t->next_due_us = start + t->config.period_us;
+        }
+    }
+
+    uint32_t latency = start > ready_us ? (uint32_t)(start - ready_us) : 0;
+    if (latency > t->stats.max_latency_us) t->stats.max_latency_us = latency;
+    if (t->config.deadline_us && latency > t->config.deadline_us) {
+        t->stats.deadline_misses++;
+    }
+
+    g_current = (int8_t)(t - g_tasks);
+    t->config.run();
+    g_current = -1;
+
+    uint32_t elapsed = (uint32_t)(time_us_64() - start);
+    t->stats.runs++;
+    if (elapsed > t->stats.max_run_us) t->stats.max_run_us = elapsed;
+    if (t->config.budget_us && elapsed > t->config.budget_us) {
+        t->stats.overruns++;
+    }
+}
+
+/**
+ * 休眠到最近的周期任务就绪 (或任意中断 / 事件)
+ */
+static void idle(uint64_t now)
+{
+    uint64_t wake = now + FX3U_TASKS_IDLE_MAX_US;
+    for (uint8_t i = 0; i < g_count; i++) {
+        const task_t *t = &g_tasks[i];
+        if (t->config.period_us && t->next_due_us < wake) {
+            wake = t->next_due_us;
+        }
+    }
+    if (wake <= now) return;
+
+    best_effort_wfe_or_timeout(from_us_since_boot(wake));
+    g_idle_us += time_us_64() - now;
+}
+
+/* 窗口结束时折算负载并经写队列发布 (下一次扫描开始时生效) */
+static void update_load(uint64_t now)
+{
+    uint64_t elapsed = now - g_window_start_us;
+    if (elapsed < FX3U_TASKS_LOAD_WINDOW_US) return;
+
+    uint64_t idle = g_idle_us < elapsed ? g_idle_us : elapsed;
+    g_load = (uint8_t)(100u - (uint32_t)(idle * 100u / elapsed));
+    if (g_load > g_peak_load) g_peak_load = g_load;
+    g_window_start_us = now;
+    g_idle_us = 0;
+
+    if (g_plc) {
+        fx3u_image_write_t writes[2] = {
+            { .area = FX3U_IMAGE_SD, .count = 1, .addr = D8490 - PLC_SPECIAL_BASE, .value = g_load },
+            { .area = FX3U_IMAGE_SD, .count = 1, .addr = D8491 - PLC_SPECIAL_BASE, .value = g_peak_load },
+        };
+        fx3u_image_queue_writes(writes, 2);
+    }
+}
+
+void fx3u_tasks_init(fx3u_core_t *plc)
+{
+    g_plc = plc;
+    memset(g_tasks, 0, sizeof(g_tasks));
+    g_count = 0;
+    g_current = -1;
+    g_window_start_us = time_us_64();
+    g_idle_us = 0;
+    g_load = 0;
+    g_peak_load = 0;
+}
+
+/**
+ * 添加任务: 周期任务的首次就绪在一个周期之后
+ */
+int fx3u_tasks_add(const fx3u_task_config_t *config)
+{
+    if (!config || !config->run || g_count >= FX3U_TASKS_MAX) return -1;
+
+    task_t *t = &g_tasks[g_count];
+    memset(t, 0, sizeof(*t));
+    t->config = *config;
+    t->next_due_us = time_us_64() + config->period_us;
+    return g_count++;
+}
+
+void fx3u_tasks_signal(int task)
+{
+    if (task < 0 || task >= g_count) return;
+
+    task_t *t = &g_tasks[task];
+    if (!t->pending) {
+        t->signaled_us = time_us_64();
+        t->pending = true;
+    }
+    __sev();
+}
+
+/**
+ * 主循环调用: 执行一个就绪任务，没有则休眠
+ */
+void fx3u_tasks_run(void)
+{
+    uint64_t now = time_us_64();
+    uint64_t ready_us;
+    task_t *t = pick(now, &ready_us);
+
+    if (t) {
+        dispatch(t, ready_us);
+    } else {
+        idle(now);
+    }
+    update_load(time_us_64());
+}
+
+uint8_t fx3u_tasks_load(void)
+{
+    return g_load;
+}
+
+uint8_t fx3u_tasks_peak_load(void)
+{
+    return g_peak_load;
+}
+
+bool fx3u_tasks_get_stats(int task, fx3u_task_stats_t *stats)
+{
+    if (task < 0 || task >= g_count || !stats) return false;
+    *stats = g_tasks[task].stats;
+    return true;
+}
+
+int fx3u_tasks_current(void)
+{
+    return g_current;
+}
+
+const char *fx3u_tasks_name(int task)
+{
+    if (task < 0 || task >= g_count) return NULL;
+    return g_tasks[task].config.name;
+}
@@ -0,0 +1,309 @@
+/**
+ * 扫描看门狗实现
+ *
+ * 故障记录在正常运行时也持续更新 (扫描开始写阶段与时刻)，
+ * 硬件看门狗直接复位时记录中仍有最后一次扫描的位置。
+ * 魔数不符 (上电后 RAM 为随机值) 视为没有记录。
+ */
+
+#include "fx3u_watchdog.h"
+#include "fx3u_instructions.h"
+#include "fx3u_tasks.h"
+#include "pico/stdlib.h"
+#include "pico/time.h"
+#include "hardware/watchdog.h"
+#include "hardware/sync.h"
+#include <string.h>
+
+#if PICO_ON_DEVICE
+#include "hardware/timer.h"
+#include "hardware/irq.h"
+#endif
+
+#define RECORD_MAGIC    0x57445446u     /* "FTDW" */
+
+static fx3u_watchdog_record_t __uninitialized_ram(g_record);
+static fx3u_watchdog_record_t g_last;
+static bool g_has_last = false;
+
+static fx3u_core_t *g_plc = NULL;
+static fx3u_watchdog_config_t g_config;
+static uint16_t g_limit_ms = FX3U_WATCHDOG_DEFAULT_MS;
+static uint32_t g_hw_timeout_ms = 0;
+static volatile uint64_t g_heartbeat_us = 0;
+static volatile bool g_running = false;
+static volatile bool g_tripped = false;
+
+static void trip(uint8_t cause);
+
+/* ===== 预看门狗 alarm ===== */
+
+#if PICO_ON_DEVICE
+static int g_alarm = -1;
+
+static void alarm_callback(uint alarm_num)
+{
+    (void)alarm_num;
+    trip(FX3U_WATCHDOG_CAUSE_SCAN);
+}
+
+static void alarm_init(void)
+{
+    if (g_alarm >= 0) return;
+    g_alarm = hardware_alarm_claim_unused(true);
+    hardware_alarm_set_callback((uint)g_alarm, alarm_callback);
+    /* 高于扫描所在的定时器 / GPIO / PIO 中断 */
+    irq_set_priority(TIMER_IRQ_0 + (uint)g_alarm, PICO_HIGHEST_IRQ_PRIORITY);
+}
+
+static void alarm_arm(uint64_t at_us)
+{
+    /* 时刻已过: 扫描开始就已超时 (不会发生，D8000 至少 1ms) */
+    if (hardware_alarm_set_target((uint)g_alarm, from_us_since_boot(at_us))) {
+        trip(FX3U_WATCHDOG_CAUSE_SCAN);
+    }
+}
+
+static void alarm_cancel(void)
+{
+    hardware_alarm_cancel((uint)g_alarm);
+}
+
+static bool hw_caused_reboot(void)
+{
+    return watchdog_enable_caused_reboot();
+}
+
+static void hw_enable(uint32_t timeout_ms)
+{
+    watchdog_enable(timeout_ms, true);
+}
+
+static void hw_feed(void)
+{
+    watchdog_update();
+}
+
+static void hw_disable(void)
+{
+    watchdog_disable();
+}
+
+static void hw_reset(void)
+{
+    watchdog_reboot(0, 0, FX3U_WATCHDOG_RESET_DELAY_MS);
+}
+#else
+static void alarm_init(void) {}
+static void alarm_arm(uint64_t at_us) { (void)at_us; }
+static void alarm_cancel(void) {}
+static bool hw_caused_reboot(void) { return false; }
+static void hw_enable(uint32_t timeout_ms) { (void)timeout_ms; }
+static void hw_feed(void) {}
+static void hw_disable(void) {}
+static void hw_reset(void) {}
+#endif
+
+/* ===== 跳闸 ===== */
+
+/**
+ * 记录故障、输出置安全状态并复位 (预看门狗中断 / 扫描结束)
+ */
+static void trip(uint8_t cause)
+{
+    if (g_tripped || !g_plc) return;
+    g_tripped = true;
+
+    g_record.cause = cause;
+    g_record.timestamp_us = time_us_64();
+    g_record.task = (int8_t)fx3u_tasks_current();
+    if (cause == FX3U_WATCHDOG_CAUSE_LOOP) {
+        g_record.phase = FX3U_WATCHDOG_PHASE_IDLE;
+    }
+
+    /* 程序步在每条指令前更新，被抢占时即为卡住的那一步 */
+    uint32_t step = g_plc->program_counter;
+    g_record.step = step;
+    g_record.opcode = 0;
+    if (g_plc->program && step < g_plc->program_size) {
+        g_record.opcode = g_plc->program[step].opcode;
+    }
+
+    if (g_config.safe_state) {
+        g_config.safe_state();
+    }
+    hw_reset();
+}
+
+/* ===== 接口 ===== */
+
+void fx3u_watchdog_init(fx3u_core_t *plc, const fx3u_watchdog_config_t *config)
+{
+    g_plc = plc;
+    memset(&g_config, 0, sizeof(g_config));
+    if (config) g_config = *config;
+    if (!g_config.loop_limit_ms) g_config.loop_limit_ms = FX3U_WATCHDOG_LOOP_LIMIT_MS;
+
+    /* 上一次运行留下的记录: 没有软件跳闸但由硬件看门狗复位，即为关中断卡死 */
+    uint32_t resets = 0;
+    g_has_last = false;
+    if (g_record.magic == RECORD_MAGIC && g_record.cause <= FX3U_WATCHDOG_CAUSE_HARDWARE) {
+        resets = g_record.resets;
+        if (g_record.cause == FX3U_WATCHDOG_CAUSE_NONE && hw_caused_reboot()) {
+            g_record.cause = FX3U_WATCHDOG_CAUSE_HARDWARE;
+            g_record.timestamp_us = 0;
+        }
+        if (g_record.cause != FX3U_WATCHDOG_CAUSE_NONE) {
+            g_last = g_record;
+            g_last.resets = ++resets;
+            g_has_last = true;
+        }
+    }
+
+    memset(&g_record, 0, sizeof(g_record));
+    g_record.magic = RECORD_MAGIC;
+    g_record.task = -1;
+    g_record.resets = resets;
+
+    g_running = false;
+    g_tripped = false;
+    g_hw_timeout_ms = 0;
+    g_limit_ms = FX3U_WATCHDOG_DEFAULT_MS;
+    alarm_init();
+}
+
+void fx3u_watchdog_start(void)
+{
+    g_heartbeat_us = time_us_64();
+    g_running = true;
+}
+
+void fx3u_watchdog_stop(void)
+{
+    g_running = false;
+    alarm_cancel();
+    hw_disable();
+    g_hw_timeout_ms = 0;
+}
+
+/**
+ * 扫描开始: 读取 D8000，预看门狗设为 开始 + D8000
+ */
+void fx3u_watchdog_scan_begin(void)
+{
+    if (!g_running || !g_plc) return;
+
+    int16_t limit = fx3u_get_special_register(g_plc, D8000);
+    if (limit <= 0) limit = FX3U_WATCHDOG_DEFAULT_MS;
+    if (limit > FX3U_WATCHDOG_MAX_MS) limit = FX3U_WATCHDOG_MAX_MS;
+    g_limit_ms = (uint16_t)limit;
+
+    uint64_t now = time_us_64();
+    g_record.phase = FX3U_WATCHDOG_PHASE_INPUT;
+    g_record.limit_ms = g_limit_ms;
+    g_record.scan_start_us = now;
+    g_record.scan_count = g_plc->cycle_count;
+    alarm_arm(now + (uint64_t)g_limit_ms * 1000u);
+}
+
+void fx3u_watchdog_phase(fx3u_watchdog_phase_t phase)
+{
+    g_record.phase = (uint8_t)phase;
+}
+
+/**
+ * 扫描结束: 取消预看门狗；主循环心跳未超时才喂硬件看门狗
+ */
+void fx3u_watchdog_scan_end(void)
+{
+    if (!g_running) return;
+
+    alarm_cancel();
+    g_record.phase = FX3U_WATCHDOG_PHASE_IDLE;
+    if (g_tripped) return;
+
+    uint64_t now = time_us_64();
+    if (now - g_heartbeat_us > (uint64_t)g_config.loop_limit_ms * 1000u) {
+        trip(FX3U_WATCHDOG_CAUSE_LOOP);
+        return;
+    }
+
+    /* D8000 改变后重新设定硬件看门狗时间 */
+    uint32_t timeout = g_config.scan_period_us / 1000u + g_limit_ms + FX3U_WATCHDOG_HW_MARGIN_MS;
+    if (timeout != g_hw_timeout_ms) {
+        g_hw_timeout_ms = timeout;
+        hw_enable(timeout);
+    } else {
+        hw_feed();
+    }
+}
+
+void fx3u_watchdog_poll(void)
+{
+    g_heartbeat_us = time_us_64();
+}
+
+/**
+ * 长操作之前: 心跳记为当前时刻，硬件看门狗重新计时并放宽到 ms + 余量
+ *
+ * 放宽后的时间记入 g_hw_timeout_ms，下一次扫描结束发现与正常值不同即恢复
+ */
+void fx3u_watchdog_extend(uint32_t ms)
+{
+    g_heartbeat_us = time_us_64();
+    if (!g_running || g_tripped) return;
+
+    uint32_t ints = save_and_disable_interrupts();
+    uint32_t timeout = ms + FX3U_WATCHDOG_HW_MARGIN_MS;
+    if (timeout > g_hw_timeout_ms) {
+        g_hw_timeout_ms = timeout;
+        hw_enable(timeout);
+    } else {
+        hw_feed();
+    }
+    restore_interrupts(ints);
+}
+
+bool fx3u_watchdog_tripped(void)
+{
+    return g_tripped;
+}
+
+uint16_t fx3u_watchdog_limit_ms(void)
+{
+    return g_limit_ms;
+}
+
+bool fx3u_watchdog_last_record(fx3u_watchdog_record_t *record)
+{
+    if (!g_has_last) return false;
+    if (record) *record = g_last;
+    return true;
+}
+
+const char *fx3u_watchdog_cause_name(uint8_t cause)
+{
+    switch (cause) {
+        case FX3U_WATCHDOG_CAUSE_SCAN:     return "scan";
+        case FX3U_WATCHDOG_CAUSE_LOOP:     return "loop";
+        case FX3U_WATCHDOG_CAUSE_HARDWARE: return "hardware";
+        default:                           return "none";
+    }
+}
+
+const char *fx3u_watchdog_phase_name(uint8_t phase)
+{
+    switch (phase) {
+        case FX3U_WATCHDOG_PHASE_INPUT:    return "input";
+        case FX3U_WATCHDOG_PHASE_PROGRAM:  return "program";
+        case FX3U_WATCHDOG_PHASE_OUTPUT:   return "output";
+        default:                           return "idle";
+    }
+}
+
+#if !PICO_ON_DEVICE
+void fx3u_watchdog_sim_expire(void)
+{
+    if (g_running) trip(FX3U_WATCHDOG_CAUSE_SCAN);
+}
+#endif
@@ -0,0 +1,598 @@
+/**
+ * 三菱计算机链接实现
+ */
+
+#include "mitsubishi_link.h"
+#include <string.h>
+
+#define HEADER_LEN      8       /* ENQ 站号(2) PC号(2) 命令(2) 报文等待(1) */
+#define DEVICE_LEN      5
+
+static const char g_hex[] = "0123456789ABCDEF";
+
+/* 写入批次缓冲 (主循环单生产者) */
+static fx3u_image_write_t g_write_batch[MITSUBISHI_LINK_WW_MAX];
+
+/* ===== 字符处理 ===== */
+
+static bool hex_digit(uint8_t c, uint8_t *value)
+{
+    if (c >= '0' && c <= '9') {
+        *value = c - '0';
+    } else if (c >= 'A' && c <= 'F') {
+        *value = c - 'A' + 10;
+    } else if (c >= 'a' && c <= 'f') {
+        *value = c - 'a' + 10;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool parse_hex(const uint8_t *p, uint8_t digits, uint16_t *value)
+{
+    uint16_t v = 0;
+    for (uint8_t i = 0; i < digits; i++) {
+        uint8_t d;
+        if (!hex_digit(p[i], &d)) return false;
+        v = (uint16_t)((v << 4) | d);
+    }
+    *value = v;
+    return true;
+}
+
+/* 十进制 (X/Y 为八进制) 编号 */
+static bool parse_number(const uint8_t *p, uint8_t digits, uint8_t radix, uint16_t *value)
+{
+    uint16_t v = 0;
+    for (uint8_t i = 0; i < digits; i++) {
+        if (p[i] < '0' || p[i] >= '0' + radix) return false;
+        v = (uint16_t)(v * radix + (p[i] - '0'));
+    }
+    *value = v;
+    return true;
+}
+
+static void put_hex(uint8_t *p, uint16_t value, uint8_t digits)
+{
+    for (uint8_t i = 0; i < digits; i++) {
+        p[digits - 1 - i] = (uint8_t)g_hex[(value >> (i * 4)) & 0x0F];
+    }
+}
+
+static uint8_t sum_of(const uint8_t *p, uint16_t len)
+{
+    uint8_t sum = 0;
+    for (uint16_t i = 0; i < len; i++) {
+        sum += p[i];
+    }
+    return sum;
+}
+
+/* ===== 软元件 ===== */
+
+/* 解析 5 字符软元件名: X0000 / M8000 / D0100 / TS000 / CN010 等 */
+static uint8_t parse_device(const uint8_t *p, mitsubishi_link_device_t *dev)
+{
+    uint16_t n;
+
+    switch (p[0]) {
+        case 'X':
+        case 'Y':
+            if (!parse_number(&p[1], 4, 8, &n)) return MITSUBISHI_LINK_ERR_CHARACTER;
+            dev->area = p[0] == 'X' ? FX3U_IMAGE_X : FX3U_IMAGE_Y;
+            dev->index = n;
+            break;
+
+        case 'M':
+        case 'D':
+            if (!parse_number(&p[1], 4, 10, &n)) return MITSUBISHI_LINK_ERR_CHARACTER;
+            if (n >= PLC_SPECIAL_BASE) {
+                dev->area = p[0] == 'M' ? FX3U_IMAGE_SM : FX3U_IMAGE_SD;
+                dev->index = n - PLC_SPECIAL_BASE;
+            } else {
+                dev->area = p[0] == 'M' ? FX3U_IMAGE_M : FX3U_IMAGE_D;
+                dev->index = n;
+            }
+            break;
+
+        case 'S':
+            if (!parse_number(&p[1], 4, 10, &n)) return MITSUBISHI_LINK_ERR_CHARACTER;
+            dev->area = FX3U_IMAGE_S;
+            dev->index = n;
+            break;
+
+        case 'T':
+        case 'C':
+            if (!parse_number(&p[2], 3, 10, &n)) return MITSUBISHI_LINK_ERR_CHARACTER;
+            if (p[1] == 'S') {
+                dev->area = p[0] == 'T' ? FX3U_IMAGE_TS : FX3U_IMAGE_CS;
+            } else if (p[1] == 'N') {
+                dev->area = p[0] == 'T' ? FX3U_IMAGE_TN : FX3U_IMAGE_CN;
+            } else {
+                return MITSUBISHI_LINK_ERR_CHARACTER;
+            }
+            dev->index = n;
+            break;
+
+        default:
+            return MITSUBISHI_LINK_ERR_CHARACTER;
+    }
+
+    if (dev->index >= fx3u_image_area_size((fx3u_image_area_t)dev->area)) {
+        return MITSUBISHI_LINK_ERR_AREA;
+    }
+    return 0;
+}
+
+/* 范围 [index, index + count) 是否在区域内 */
+static bool device_fits(const mitsubishi_link_device_t *dev, uint32_t count)
+{
+    return dev->index + count <= fx3u_image_area_size((fx3u_image_area_t)dev->area);
+}
+
+/* 通信侧可写的位区 (触点由扫描产生) */
+static bool bit_writable(uint8_t area)
+{
+    return FX3U_IMAGE_IS_BIT_AREA(area) && area != FX3U_IMAGE_TS && area != FX3U_IMAGE_CS;
+}
+
+/* 快照中的一个字: 字软元件取当前值，位软元件取自 index 起的 16 点 */
+static uint16_t snapshot_word(const fx3u_image_snapshot_t *snap,
+                              const mitsubishi_link_device_t *dev, uint16_t offset)
+{
+    fx3u_image_area_t area = (fx3u_image_area_t)dev->area;
+    if (FX3U_IMAGE_IS_BIT_AREA(area)) {
+        return (uint16_t)fx3u_image_snapshot_bits(snap, area, dev->index + offset * 16, 16);
+    }
+    return (uint16_t)fx3u_image_snapshot_value(snap, area, dev->index + offset);
+}
+
+/* 组装一个字写入项 */
+static void word_write(fx3u_image_write_t *w, const mitsubishi_link_device_t *dev,
+                       uint16_t offset, uint16_t value)
+{
+    w->area = dev->area;
+    w->value = (int16_t)value;
+    if (FX3U_IMAGE_IS_BIT_AREA(dev->area)) {
+        w->addr = dev->index + offset * 16;
+        w->count = 16;
+    } else {
+        w->addr = dev->index + offset;
+        /* C0-C199 为 16 位计数器，写入按符号扩展 */
+        w->count = dev->area == FX3U_IMAGE_CN ? FX3U_IMAGE_CN_SIGNED : 1;
+    }
+}
+
+/* ===== 应答 ===== */
+
+static uint16_t reply_header(const mitsubishi_link_t *link, uint8_t *tx, uint8_t control,
+                             uint8_t pc_number)
+{
+    tx[0] = control;
+    put_hex(&tx[1], link->station, 2);
+    put_hex(&tx[3], pc_number, 2);
+    return 5;
+}
+
+static int reply_end(const mitsubishi_link_t *link, uint8_t *tx, uint16_t pos)
+{
+    if (link->format4) {
+        tx[pos++] = '\r';
+        tx[pos++] = '\n';
+    }
+    return pos;
+}
+
+/* STX 帧: 数据已写在 tx[5] 起 */
+static int reply_data(const mitsubishi_link_t *link, uint8_t *tx, uint8_t pc_number,
+                      uint16_t data_len)
+{
+    uint16_t pos = reply_header(link, tx, MITSUBISHI_LINK_STX, pc_number) + data_len;
+    tx[pos++] = MITSUBISHI_LINK_ETX;
+    if (link->sum_check) {
+        put_hex(&tx[pos], sum_of(&tx[1], pos - 1), 2);
+        pos += 2;
+    }
+    return reply_end(link, tx, pos);
+}
+
+static int reply_ack(const mitsubishi_link_t *link, uint8_t *tx, uint8_t pc_number)
+{
+    return reply_end(link, tx, reply_header(link, tx, MITSUBISHI_LINK_ACK, pc_number));
+}
+
+static int reply_nak(mitsubishi_link_t *link, uint8_t *tx, uint8_t pc_number, uint8_t code)
+{
+    link->stats.naks++;
+    uint16_t pos = reply_header(link, tx, MITSUBISHI_LINK_NAK, pc_number);
+    put_hex(&tx[pos], code, 2);
+    return reply_end(link, tx, pos + 2);
+}
+
+/* ===== 命令 ===== */
+
+/* BR: 位单位批量读出 */
+static uint8_t cmd_bit_read(const uint8_t *data, uint16_t len, uint8_t *out, uint16_t *out_len)
+{
+    mitsubishi_link_device_t dev;
+    uint16_t count;
+    uint8_t err;
+
+    if (len != DEVICE_LEN + 2) return MITSUBISHI_LINK_ERR_PROTOCOL;
+    if ((err = parse_device(data, &dev)) != 0) return err;
+    if (!parse_hex(&data[DEVICE_LEN], 2, &count)) return MITSUBISHI_LINK_ERR_CHARACTER;
+    if (count == 0) count = MITSUBISHI_LINK_BR_MAX;
+    if (!FX3U_IMAGE_IS_BIT_AREA(dev.area) || !device_fits(&dev, count)) {
+        return MITSUBISHI_LINK_ERR_AREA;
+    }
+
+    uint8_t packed[MITSUBISHI_LINK_BR_MAX / 8];
+    fx3u_image_read_bits((fx3u_image_area_t)dev.area, dev.index, count, packed);
+    for (uint16_t i = 0; i < count; i++) {
+        out[i] = (packed[i / 8] >> (i % 8)) & 1u ? '1' : '0';
+    }
+    *out_len = count;
+    return 0;
+}
+
+/* WR: 字单位批量读出 (位软元件按 16 点一字) */
+static uint8_t cmd_word_read(const uint8_t *data, uint16_t len, uint8_t *out, uint16_t *out_len)
+{
+    mitsubishi_link_device_t dev;
+    uint16_t count;
+    uint8_t err;
+
+    if (len != DEVICE_LEN + 2) return MITSUBISHI_LINK_ERR_PROTOCOL;
+    if ((err = parse_device(data, &dev)) != 0) return err;
+    if (!parse_hex(&data[DEVICE_LEN], 2, &count)) return MITSUBISHI_LINK_ERR_CHARACTER;
+
+    uint32_t points = FX3U_IMAGE_IS_BIT_AREA(dev.area) ? (uint32_t)count * 16 : count;
+    if (count == 0 || count > MITSUBISHI_LINK_WR_MAX || !device_fits(&dev, points)) {
+        return MITSUBISHI_LINK_ERR_AREA;
+    }
+
+    const fx3u_image_snapshot_t *snap;
+    uint32_t seq;
+    do {
+        snap = fx3u_image_snapshot_begin(&seq);
+        for (uint16_t i = 0; i < count; i++) {
+            put_hex(&out[i * 4], snapshot_word(snap, &dev, i), 4);
+        }
+    } while (fx3u_image_snapshot_retry(snap, seq));
+
+    *out_len = count * 4;
+    return 0;
+}
+
+/* BW: 位单位批量写入 */
+static uint8_t cmd_bit_write(const uint8_t *data, uint16_t len)
+{
+    mitsubishi_link_device_t dev;
+    uint16_t count;
+    uint8_t err;
+
+    if (len < DEVICE_LEN + 2) return MITSUBISHI_LINK_ERR_PROTOCOL;
+    if ((err = parse_device(data, &dev)) != 0) return err;
+    if (!parse_hex(&data[DEVICE_LEN], 2, &count)) return MITSUBISHI_LINK_ERR_CHARACTER;
+    if (len != DEVICE_LEN + 2 + count) return MITSUBISHI_LINK_ERR_PROTOCOL;
+    if (count == 0 || count > MITSUBISHI_LINK_BW_MAX || !bit_writable(dev.area) ||
+        !device_fits(&dev, count)) {
+        return MITSUBISHI_LINK_ERR_AREA;
+    }
+
+    uint8_t packed[MITSUBISHI_LINK_BW_MAX / 8];
+    memset(packed, 0, sizeof(packed));
+    const uint8_t *bits = &data[DEVICE_LEN + 2];
+    for (uint16_t i = 0; i < count; i++) {
+        if (bits[i] != '0' && bits[i] != '1') return MITSUBISHI_LINK_ERR_CHARACTER;
+        packed[i / 8] |= (uint8_t)((bits[i] - '0') << (i % 8));
+    }
+
+    if (!fx3u_image_queue_bits((fx3u_image_area_t)dev.area, dev.index, packed, count)) {
+        return MITSUBISHI_LINK_ERR_AREA;
+    }
+    return 0;
+}
+
+/* WW: 字单位批量写入 */
+static uint8_t cmd_word_write(const uint8_t *data, uint16_t len)
+{
+    mitsubishi_link_device_t dev;
+    uint16_t count;
+    uint8_t err;
+
+    if (len < DEVICE_LEN + 2) return MITSUBISHI_LINK_ERR_PROTOCOL;
+    if ((err = parse_device(data, &dev)) != 0) return err;
+    if (!parse_hex(&data[DEVICE_LEN], 2, &count)) return MITSUBISHI_LINK_ERR_CHARACTER;
+    if (len != DEVICE_LEN + 2 + count * 4) return MITSUBISHI_LINK_ERR_PROTOCOL;
+
+    bool bits = FX3U_IMAGE_IS_BIT_AREA(dev.area);
+    uint32_t points = bits ? (uint32_t)count * 16 : count;
+    if (count == 0 || count > MITSUBISHI_LINK_WW_MAX || !device_fits(&dev, points) ||
+        (bits && !bit_writable(dev.area))) {
+        return MITSUBISHI_LINK_ERR_AREA;
+    }
+
+    const uint8_t *words = &data[DEVICE_LEN + 2];
+    for (uint16_t i = 0; i < count; i++) {
+        uint16_t value;
+        if (!parse_hex(&words[i * 4], 4, &value)) return MITSUBISHI_LINK_ERR_CHARACTER;
+        word_write(&g_write_batch[i], &dev, i, value);
+    }
+
+    if (!fx3u_image_queue_writes(g_write_batch, count)) {
+        return MITSUBISHI_LINK_ERR_AREA;
+    }
+    return 0;
+}
+
+/* BT / WT: 随机写入，各点独立指定软元件 */
+static uint8_t cmd_random_write(const uint8_t *data, uint16_t len, bool words)
+{
+    uint16_t count;
+    uint16_t item = DEVICE_LEN + (words ? 4 : 1);
+    uint16_t max = words ? MITSUBISHI_LINK_WT_MAX : MITSUBISHI_LINK_BT_MAX;
+
+    if (len < 2) return MITSUBISHI_LINK_ERR_PROTOCOL;
+    if (!parse_hex(data, 2, &count)) return MITSUBISHI_LINK_ERR_CHARACTER;
+    if (len != 2 + count * item) return MITSUBISHI_LINK_ERR_PROTOCOL;
+    if (count == 0 || count > max) return MITSUBISHI_LINK_ERR_AREA;
+
+    for (uint16_t i = 0; i < count; i++) {
+        const uint8_t *p = &data[2 + i * item];
+        mitsubishi_link_device_t dev;
+        uint8_t err = parse_device(p, &dev);
+        if (err != 0) return err;
+
+        fx3u_image_write_t *w = &g_write_batch[i];
+        if (words) {
+            uint16_t value;
+            if (!parse_hex(&p[DEVICE_LEN], 4, &value)) return MITSUBISHI_LINK_ERR_CHARACTER;
+            bool bits = FX3U_IMAGE_IS_BIT_AREA(dev.area);
+            if ((bits && !bit_writable(dev.area)) || !device_fits(&dev, bits ? 16 : 1)) {
+                return MITSUBISHI_LINK_ERR_AREA;
+            }
+            word_write(w, &dev, 0, value);
+        } else {
+            uint8_t c = p[DEVICE_LEN];
+            if (c != '0' && c != '1') return MITSUBISHI_LINK_ERR_CHARACTER;
+            if (!bit_writable(dev.area)) return MITSUBISHI_LINK_ERR_AREA;
+            w->area = dev.area;
+            w->count = 1;
+            w->addr = dev.index;
+            w->value = c - '0';
+        }
+    }
+
+    if (!fx3u_image_queue_writes(g_write_batch, count)) {
+        return MITSUBISHI_LINK_ERR_AREA;
+    }
+    return 0;
+}
+
+/* MS / MN: 监视登记，整组替换 */
+static uint8_t cmd_monitor_register(mitsubishi_link_t *link, const uint8_t *data, uint16_t len,
+                                    bool words)
+{
+    uint16_t count;
+    uint16_t max = words ? MITSUBISHI_LINK_MN_MAX : MITSUBISHI_LINK_MS_MAX;
+    mitsubishi_link_device_t devs[MITSUBISHI_LINK_MS_MAX];
+
+    if (len < 2) return MITSUBISHI_LINK_ERR_PROTOCOL;
+    if (!parse_hex(data, 2, &count)) return MITSUBISHI_LINK_ERR_CHARACTER;
+    if (len != 2 + count * DEVICE_LEN) return MITSUBISHI_LINK_ERR_PROTOCOL;
+    if (count == 0 || count > max) return MITSUBISHI_LINK_ERR_AREA;
+
+    for (uint16_t i = 0; i < count; i++) {
+        uint8_t err = parse_device(&data[2 + i * DEVICE_LEN], &devs[i]);
+        if (err != 0) return err;
+
+        bool bits = FX3U_IMAGE_IS_BIT_AREA(devs[i].area);
+        if (words ? !device_fits(&devs[i], bits ? 16 : 1) : !bits) {
+            return MITSUBISHI_LINK_ERR_AREA;
+        }
+    }
+
+    if (words) {
+        memcpy(link->monitor_words, devs, count * sizeof(devs[0]));
+        link->monitor_word_count = (uint8_t)count;
+    } else {
+        memcpy(link->monitor_bits, devs, count * sizeof(devs[0]));
+        link->monitor_bit_count = (uint8_t)count;
+    }
+    return 0;
+}
+
+/* MM: 监视执行，先位后字，全部来自同一次扫描 */
+static uint8_t cmd_monitor(mitsubishi_link_t *link, uint16_t len, uint8_t *out,
+                           uint16_t *out_len)
+{
+    if (len != 0) return MITSUBISHI_LINK_ERR_PROTOCOL;
+    if (link->monitor_bit_count == 0 && link->monitor_word_count == 0) {
+        return MITSUBISHI_LINK_ERR_AREA;
+    }
+
+    const fx3u_image_snapshot_t *snap;
+    uint32_t seq;
+    uint16_t pos;
+    do {
+        snap = fx3u_image_snapshot_begin(&seq);
+        pos = 0;
+        for (uint8_t i = 0; i < link->monitor_bit_count; i++) {
+            const mitsubishi_link_device_t *dev = &link->monitor_bits[i];
+            out[pos++] = fx3u_image_snapshot_bits(snap, (fx3u_image_area_t)dev->area,
+                                                  dev->index, 1) ? '1' : '0';
+        }
+        for (uint8_t i = 0; i < link->monitor_word_count; i++) {
+            put_hex(&out[pos], snapshot_word(snap, &link->monitor_words[i], 0), 4);
+            pos += 4;
+        }
+    } while (fx3u_image_snapshot_retry(snap, seq));
+
+    link->stats.monitor_polls++;
+    *out_len = pos;
+    return 0;
+}
+
+/* TT: 回送测试 */
+static uint8_t cmd_loopback(const uint8_t *data, uint16_t len, uint8_t *out, uint16_t *out_len)
+{
+    uint16_t count;
+    if (len < 2) return MITSUBISHI_LINK_ERR_PROTOCOL;
+    if (!parse_hex(data, 2, &count)) return MITSUBISHI_LINK_ERR_CHARACTER;
+    if (count == 0 || len != 2 + count) return MITSUBISHI_LINK_ERR_PROTOCOL;
+
+    memcpy(out, data, len);
+    *out_len = len;
+    return 0;
+}
+
+/**
+ * 初始化
+ */
+void mitsubishi_link_init(mitsubishi_link_t *link, fx3u_core_t *plc)
+{
+    if (!link) return;
+
+    memset(link, 0, sizeof(mitsubishi_link_t));
+    link->plc = plc;
+}
+
+/**
+ * 判断是否为计算机链接请求帧
+ */
+bool mitsubishi_link_is_frame(const uint8_t *rx, uint16_t rx_len)
+{
+    if (!rx || rx_len < HEADER_LEN || rx[0] != MITSUBISHI_LINK_ENQ) return false;
+
+    for (uint16_t i = 1; i < rx_len; i++) {
+        uint8_t c = rx[i];
+        if ((c < 0x20 || c > 0x7E) && c != '\r' && c != '\n') return false;
+    }
+    return true;
+}
+
+/**
+ * 处理一帧请求
+ */
+int mitsubishi_link_process(mitsubishi_link_t *link, const uint8_t *rx, uint16_t rx_len,
+                            uint8_t *tx)
+{
+    if (!link || !link->plc || !tx || !mitsubishi_link_is_frame(rx, rx_len)) return 0;
+
+    /* 站号与传输格式每帧从 D8121 / D8120 读取 */
+    uint16_t d8120 = (uint16_t)fx3u_get_special_register(link->plc, D8120);
+    link->station = (uint8_t)fx3u_get_special_register(link->plc, D8121);
+    link->sum_check = (d8120 & MITSUBISHI_LINK_D8120_SUM) != 0;
+    link->format4 = (d8120 & MITSUBISHI_LINK_D8120_FORMAT4) != 0;
+
+    uint16_t len = rx_len;
+    if (len >= 2 && rx[len - 2] == '\r' && rx[len - 1] == '\n') {
+        len -= 2;
+    }
+
+    uint16_t station;
+    uint16_t pc_number;
+    if (len < HEADER_LEN || !parse_hex(&rx[1], 2, &station) || station != link->station) {
+        link->stats.ignored++;
+        return 0;
+    }
+    if (!parse_hex(&rx[3], 2, &pc_number)) {
+        pc_number = 0;
+    }
+    link->stats.frames++;
+
+    if (link->sum_check) {
+        uint16_t sum;
+        if (len < HEADER_LEN + 2) {
+            return reply_nak(link, tx, (uint8_t)pc_number, MITSUBISHI_LINK_ERR_PROTOCOL);
+        }
+        if (!parse_hex(&rx[len - 2], 2, &sum) || sum != sum_of(&rx[1], len - 3)) {
+            return reply_nak(link, tx, (uint8_t)pc_number, MITSUBISHI_LINK_ERR_SUM);
+        }
+        len -= 2;
+    }
+    if (pc_number != 0xFF) {
+        return reply_nak(link, tx, (uint8_t)pc_number, MITSUBISHI_LINK_ERR_PC_NUMBER);
+    }
+
+    uint8_t wait;
+    if (!hex_digit(rx[7], &wait)) {
+        return reply_nak(link, tx, 0xFF, MITSUBISHI_LINK_ERR_CHARACTER);
+    }
+
+    const uint8_t *data = &rx[HEADER_LEN];
+    uint16_t data_len = len - HEADER_LEN;
+    uint8_t *out = &tx[5];
+    uint16_t out_len = 0;
+    uint8_t err;
+    bool has_data = true;
+
+    uint16_t cmd = ((uint16_t)rx[5] << 8) | rx[6];
+    switch (cmd) {
+        case ('B' << 8) | 'R':
+            err = cmd_bit_read(data, data_len, out, &out_len);
+            break;
+        case ('W' << 8) | 'R':
+            err = cmd_word_read(data, data_len, out, &out_len);
+            break;
+        case ('M' << 8) | 'M':
+            err = cmd_monitor(link, data_len, out, &out_len);
+            break;
+        case ('T' << 8) | 'T':
+            err = cmd_loopback(data, data_len, out, &out_len);
+            break;
+        case ('P' << 8) | 'C':
+            /* PLC 型号: FX3U */
+            err = data_len == 0 ? 0 : MITSUBISHI_LINK_ERR_PROTOCOL;
+            out[0] = 'F';
+            out[1] = '3';
+            out_len = 2;
+            break;
+
+        case ('B' << 8) | 'W':
+            err = cmd_bit_write(data, data_len);
+            has_data = false;
+            break;
+        case ('W' << 8) | 'W':
+            err = cmd_word_write(data, data_len);
+            has_data = false;
+            break;
+        case ('B' << 8) | 'T':
+            err = cmd_random_write(data, data_len, false);
+            has_data = false;
+            break;
+        case ('W' << 8) | 'T':
+            err = cmd_random_write(data, data_len, true);
+            has_data = false;
+            break;
+        case ('M' << 8) | 'S':
+            err = cmd_monitor_register(link, data, data_len, false);
+            has_data = false;
+            break;
+        case ('M' << 8) | 'N':
+            err = cmd_monitor_register(link, data, data_len, true);
+            has_data = false;
+            break;
+        case ('R' << 8) | 'R':
+            err = data_len == 0 ? 0 : MITSUBISHI_LINK_ERR_PROTOCOL;
+            if (err == 0) fx3u_core_start(link->plc);
+            has_data = false;
+            break;
+        case ('R' << 8) | 'S':
+            err = data_len == 0 ? 0 : MITSUBISHI_LINK_ERR_PROTOCOL;
+            if (err == 0) fx3u_core_stop(link->plc);
+            has_data = false;
+            break;
+
+        default:
+            err = MITSUBISHI_LINK_ERR_PROTOCOL;
+            break;
+    }
+
+    if (err != 0) {
+        return reply_nak(link, tx, 0xFF, err);
+    }
+    return has_data ? reply_data(link, tx, 0xFF, out_len) : reply_ack(link, tx, 0xFF);
+}
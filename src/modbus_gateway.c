@@ -0,0 +1,275 @@
+/**
+ * MODBUS TCP -> RTU 网关实现
+ */
+
+#include "modbus_gateway.h"
+#include "modbus_protocol.h"
+#include "pico/stdlib.h"
+#include <string.h>
+
+static bool is_cacheable(const uint8_t *adu, uint16_t length)
+{
+    if (length != 6) return false;
+    return adu[1] == MODBUS_READ_COIL_STATUS ||
+           adu[1] == MODBUS_READ_INPUT_STATUS ||
+           adu[1] == MODBUS_READ_HOLDING_REGISTERS ||
+           adu[1] == MODBUS_READ_INPUT_REGISTERS;
+}
+
+static modbus_gateway_cache_entry_t *cache_lookup(modbus_gateway_t *gateway,
+                                                  const uint8_t *adu, uint64_t now)
+{
+    for (uint8_t i = 0; i < MODBUS_GATEWAY_CACHE_SIZE; i++) {
+        modbus_gateway_cache_entry_t *e = &gateway->cache[i];
+        if (!e->valid) continue;
+        if (now - e->stored_us > gateway->cache_ttl_us) {
+            e->valid = false;
+            continue;
+        }
+        if (memcmp(e->key, adu, sizeof(e->key)) == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void cache_store(modbus_gateway_t *gateway, const uint8_t *key,
+                        const uint8_t *adu, uint16_t length)
+{
+    if (length > sizeof(gateway->cache[0].response)) return;
+
+    uint64_t now = time_us_64();
+    modbus_gateway_cache_entry_t *e = cache_lookup(gateway, key, now);
+    if (!e) {
+        e = &gateway->cache[gateway->cache_next];
+        gateway->cache_next = (gateway->cache_next + 1) % MODBUS_GATEWAY_CACHE_SIZE;
+    }
+
+    memcpy(e->key, key, sizeof(e->key));
+    memcpy(e->response, adu, length);
+    e->length = length;
+    e->stored_us = now;
+    e->valid = true;
+}
+
+static void cache_invalidate_unit(modbus_gateway_t *gateway, uint8_t unit_id)
+{
+    for (uint8_t i = 0; i < MODBUS_GATEWAY_CACHE_SIZE; i++) {
+        if (gateway->cache[i].key[0] == unit_id) {
+            gateway->cache[i].valid = false;
+        }
+    }
+}
+
+/* 组装 MBAP 响应: 事务标识 + [单元][PDU] */
+static int build_response(uint8_t *response, uint16_t transaction_id,
+                          const uint8_t *adu, uint16_t length)
+{
+    response[0] = (uint8_t)(transaction_id >> 8);
+    response[1] = (uint8_t)(transaction_id & 0xFF);
+    response[2] = 0;
+    response[3] = 0;
+    response[4] = (uint8_t)(length >> 8);
+    response[5] = (uint8_t)(length & 0xFF);
+    memmove(&response[6], adu, length);
+    return 6 + length;
+}
+
+static int build_exception(uint8_t *response, uint16_t transaction_id,
+                           uint8_t unit_id, uint8_t function_code, uint8_t code)
+{
+    uint8_t adu[3] = { unit_id, (uint8_t)(function_code | 0x80), code };
+    return build_response(response, transaction_id, adu, sizeof(adu));
+}
+
+static void release_request(modbus_gateway_t *gateway, modbus_gateway_request_t *req)
+{
+    req->in_use = false;
+    if (gateway->diag.queue_depth[req->socket] > 0) {
+        gateway->diag.queue_depth[req->socket]--;
+    }
+}
+
+/* 下游事务结束: 将应答送回发起请求的连接 */
+static void on_response(void *user, modbus_master_result_t result,
+                        const uint8_t *response, uint16_t length)
+{
+    modbus_gateway_t *gateway = (modbus_gateway_t *)user;
+    if (gateway->active < 0) return;
+
+    modbus_gateway_request_t *req = &gateway->queue[gateway->active];
+    gateway->active = -1;
+
+    int tx_len;
+    if ((result == MODBUS_MASTER_OK || result == MODBUS_MASTER_EXCEPTION) && length >= 4) {
+        uint16_t adu_len = length - 2;  /* 去掉CRC */
+        if (result == MODBUS_MASTER_OK && is_cacheable(req->frame, req->length - 2)) {
+            cache_store(gateway, req->frame, response, adu_len);
+        }
+        tx_len = build_response(gateway->tx, req->transaction_id, response, adu_len);
+    } else {
+        if (result == MODBUS_MASTER_TIMEOUT) {
+            gateway->diag.timeouts++;
+        } else {
+            gateway->diag.bad_responses++;
+        }
+        tx_len = build_exception(gateway->tx, req->transaction_id, req->frame[0],
+                                 req->frame[1], MODBUS_EXCEPTION_GATEWAY_TARGET);
+    }
+
+    if (!modbus_tcp_server_deliver(gateway->server, req->socket, req->generation,
+                                   gateway->tx, (uint16_t)tx_len)) {
+        gateway->diag.dropped++;
+    }
+    release_request(gateway, req);
+}
+
+/* 从 start 之后的客户端开始轮转，取该客户端最早入队的请求 */
+static int8_t next_request(modbus_gateway_t *gateway)
+{
+    for (uint8_t k = 1; k <= MODBUS_TCP_MAX_CONNECTIONS; k++) {
+        uint8_t socket = (uint8_t)((gateway->last_socket + k) % MODBUS_TCP_MAX_CONNECTIONS);
+        if (gateway->diag.queue_depth[socket] == 0) continue;
+
+        int8_t best = -1;
+        for (uint8_t i = 0; i < MODBUS_GATEWAY_QUEUE_SIZE; i++) {
+            const modbus_gateway_request_t *r = &gateway->queue[i];
+            if (!r->in_use || r->socket != socket) continue;
+            if (best < 0 || (int32_t)(r->order - gateway->queue[best].order) < 0) {
+                best = (int8_t)i;
+            }
+        }
+        if (best >= 0) return best;
+    }
+    return -1;
+}
+
+/**
+ * 初始化网关并挂接到 TCP 服务端
+ */
+void modbus_gateway_init(modbus_gateway_t *gateway, modbus_master_t *master,
+                         modbus_tcp_server_t *server)
+{
+    if (!gateway) return;
+
+    memset(gateway, 0, sizeof(modbus_gateway_t));
+    gateway->master = master;
+    gateway->server = server;
+    gateway->cache_ttl_us = MODBUS_GATEWAY_CACHE_TTL_MS * 1000u;
+    gateway->active = -1;
+    gateway->last_socket = MODBUS_TCP_MAX_CONNECTIONS - 1;
+    gateway->window_start_us = time_us_64();
+
+    if (server) {
+        server->gateway = gateway;
+    }
+}
+
+/**
+ * 接收一条需转发的 MBAP 请求
+ */
+int modbus_gateway_forward(modbus_gateway_t *gateway, uint8_t socket,
+                           const uint8_t *request, uint16_t length, uint8_t *response)
+{
+    if (!gateway || !request || !response || length < 8) return 0;
+    if (socket >= MODBUS_TCP_MAX_CONNECTIONS) return 0;
+
+    uint16_t transaction_id = ((uint16_t)request[0] << 8) | request[1];
+    const uint8_t *adu = &request[6];
+    uint16_t adu_len = length - 6;
+
+    if (is_cacheable(adu, adu_len)) {
+        const modbus_gateway_cache_entry_t *e = cache_lookup(gateway, adu, time_us_64());
+        if (e) {
+            gateway->diag.cache_hits++;
+            return build_response(response, transaction_id, e->response, e->length);
+        }
+    } else {
+        cache_invalidate_unit(gateway, adu[0]);
+    }
+
+    modbus_gateway_request_t *slot = NULL;
+    for (uint8_t i = 0; i < MODBUS_GATEWAY_QUEUE_SIZE; i++) {
+        if (!gateway->queue[i].in_use) {
+            slot = &gateway->queue[i];
+            break;
+        }
+    }
+    if (!slot || adu_len + 2 > MODBUS_MASTER_FRAME_SIZE) {
+        gateway->diag.queue_full++;
+        return build_exception(response, transaction_id, adu[0], adu[1],
+                               MODBUS_EXCEPTION_DEVICE_BUSY);
+    }
+
+    memcpy(slot->frame, adu, adu_len);
+    uint16_t crc = modbus_crc16(slot->frame, adu_len);
+    slot->frame[adu_len] = crc & 0xFF;
+    slot->frame[adu_len + 1] = (crc >> 8) & 0xFF;
+    slot->length = adu_len + 2;
+    slot->socket = socket;
+    slot->generation = modbus_tcp_server_generation(gateway->server, socket);
+    slot->transaction_id = transaction_id;
+    slot->order = gateway->next_order++;
+    slot->in_use = true;
+
+    uint8_t depth = ++gateway->diag.queue_depth[socket];
+    if (depth > gateway->diag.max_queue_depth[socket]) {
+        gateway->diag.max_queue_depth[socket] = depth;
+    }
+    return 0;
+}
+
+/**
+ * 网关轮询: 统计总线占用并在总线空闲时提交下一条请求
+ */
+void modbus_gateway_poll(modbus_gateway_t *gateway)
+{
+    if (!gateway || !gateway->master) return;
+
+    uint64_t now = time_us_64();
+
+    /* 按轮询间隔采样总线忙闲，轮询表事务同样计入 */
+    if (gateway->last_poll_us && !modbus_master_is_idle(gateway->master)) {
+        gateway->busy_us += now - gateway->last_poll_us;
+    }
+    gateway->last_poll_us = now;
+
+    uint64_t window = now - gateway->window_start_us;
+    if (window >= MODBUS_GATEWAY_UTIL_WINDOW_MS * 1000ull) {
+        gateway->diag.bus_utilisation = (uint16_t)(gateway->busy_us * 1000 / window);
+        gateway->busy_us = 0;
+        gateway->window_start_us = now;
+    }
+
+    if (gateway->active >= 0 || !modbus_master_is_idle(gateway->master)) return;
+
+    int8_t idx;
+    while ((idx = next_request(gateway)) >= 0) {
+        modbus_gateway_request_t *req = &gateway->queue[idx];
+
+        /* 发起请求的连接已断开，不再占用总线 */
+        if (!modbus_tcp_server_is_current(gateway->server, req->socket, req->generation)) {
+            gateway->diag.dropped++;
+            release_request(gateway, req);
+            continue;
+        }
+
+        gateway->active = idx;
+        gateway->last_socket = req->socket;
+        if (!modbus_master_submit(gateway->master, req->frame, req->length,
+                                  on_response, gateway)) {
+            gateway->active = -1;
+            return;
+        }
+        gateway->diag.forwarded++;
+        return;
+    }
+}
+
+/**
+ * 获取网关诊断
+ */
+const modbus_gateway_diag_t *modbus_gateway_get_diag(const modbus_gateway_t *gateway)
+{
+    return gateway ? &gateway->diag : NULL;
+}
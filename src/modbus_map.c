@@ -0,0 +1,532 @@
+/**
+ * MODBUS 地址映射表实现
+ */
+
+#include "modbus_map.h"
+#include "modbus_protocol.h"
+#include <string.h>
+
+/* ===== 区段内的一段访问 ===== */
+typedef struct {
+    const modbus_map_region_t *region;
+    uint16_t offset;                    /* 相对区段起始的 MODBUS 地址偏移 */
+    uint16_t count;
+} modbus_map_segment_t;
+
+typedef struct {
+    modbus_map_region_t regions[MODBUS_MAP_MAX_REGIONS];
+    uint8_t count;
+} modbus_map_table_data_t;
+
+static modbus_map_table_data_t g_tables[MODBUS_MAP_TABLE_COUNT];
+static bool g_loaded = false;
+
+/* 写入批次缓冲 (主循环单生产者)，每个 MODBUS 字或每 16 个位一项 */
+static fx3u_image_write_t g_write_batch[MODBUS_MAX_WRITE_REGISTERS];
+
+/* ===== 默认映射 ===== */
+static const modbus_map_region_t g_default_coils[] = {
+    { 0,    PLC_MAX_OUTPUTS,   0, FX3U_IMAGE_Y,  0 },
+    { 256,  PLC_MAX_INTERNALS, 0, FX3U_IMAGE_M,  0 },
+    { 4096, PLC_MAX_STATES,    0, FX3U_IMAGE_S,  0 },
+    { 5120, PLC_MAX_TIMERS,    0, FX3U_IMAGE_TS, MODBUS_MAP_READ_ONLY },
+    { 5376, PLC_MAX_COUNTERS,  0, FX3U_IMAGE_CS, MODBUS_MAP_READ_ONLY },
+    { 8000, PLC_MAX_SPECIAL,   0, FX3U_IMAGE_SM, 0 },
+};
+
+static const modbus_map_region_t g_default_discrete[] = {
+    { 0,    PLC_MAX_INPUTS,    0, FX3U_IMAGE_X,  0 },
+    { 5120, PLC_MAX_TIMERS,    0, FX3U_IMAGE_TS, MODBUS_MAP_READ_ONLY },
+    { 5376, PLC_MAX_COUNTERS,  0, FX3U_IMAGE_CS, MODBUS_MAP_READ_ONLY },
+};
+
+static const modbus_map_region_t g_default_registers[] = {
+    { 0,    PLC_MAX_REGISTERS,    0, FX3U_IMAGE_D,  0 },
+    { 4096, PLC_MAX_TIMERS,       0, FX3U_IMAGE_TN, 0 },
+    { 4352, PLC_MAX_COUNTERS * 2, 0, FX3U_IMAGE_CN, MODBUS_MAP_32BIT },
+    { 8000, PLC_MAX_SPECIAL,      0, FX3U_IMAGE_SD, 0 },
+};
+
+#define ARRAY_COUNT(a)  ((uint8_t)(sizeof(a) / sizeof((a)[0])))
+
+static bool table_is_bits(modbus_map_table_t table)
+{
+    return table == MODBUS_MAP_COILS || table == MODBUS_MAP_DISCRETE_INPUTS;
+}
+
+/* 区段覆盖的软元件个数 */
+static uint16_t region_elements(const modbus_map_region_t *r)
+{
+    if (r->area == FX3U_IMAGE_CN && (r->flags & MODBUS_MAP_32BIT)) {
+        return r->count / 2;
+    }
+    return r->count;
+}
+
+static bool region_valid(modbus_map_table_t table, modbus_map_region_t *r)
+{
+    if (r->count == 0 || (uint32_t)r->start + r->count > 0x10000u) return false;
+    if (r->area >= FX3U_IMAGE_AREA_COUNT) return false;
+    if (FX3U_IMAGE_IS_BIT_AREA(r->area) != table_is_bits(table)) return false;
+
+    if (r->flags & (MODBUS_MAP_32BIT | MODBUS_MAP_WORD_SWAP)) {
+        if (table_is_bits(table) || !(r->flags & MODBUS_MAP_32BIT)) return false;
+        if (r->count & 1u) return false;
+    }
+    if ((uint32_t)r->device_start + region_elements(r) >
+        fx3u_image_area_size((fx3u_image_area_t)r->area)) {
+        return false;
+    }
+
+    /* 触点由扫描产生，不接受通信写入 */
+    if (r->area == FX3U_IMAGE_TS || r->area == FX3U_IMAGE_CS) {
+        r->flags |= MODBUS_MAP_READ_ONLY;
+    }
+    return true;
+}
+
+/* 校验、排序并写入 dst，失败时 dst 内容无意义 */
+static bool build_table(modbus_map_table_t table, const modbus_map_region_t *regions,
+                        uint8_t count, modbus_map_table_data_t *dst)
+{
+    if (table >= MODBUS_MAP_TABLE_COUNT || count > MODBUS_MAP_MAX_REGIONS) return false;
+    if (count > 0 && !regions) return false;
+
+    dst->count = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        modbus_map_region_t r = regions[i];
+        if (!region_valid(table, &r)) return false;
+
+        /* 插入排序，区段数很少 */
+        uint8_t j = dst->count;
+        while (j > 0 && dst->regions[j - 1].start > r.start) {
+            dst->regions[j] = dst->regions[j - 1];
+            j--;
+        }
+        dst->regions[j] = r;
+        dst->count++;
+    }
+
+    for (uint8_t i = 1; i < dst->count; i++) {
+        const modbus_map_region_t *prev = &dst->regions[i - 1];
+        if ((uint32_t)prev->start + prev->count > dst->regions[i].start) return false;
+    }
+    return true;
+}
+
+static void ensure_loaded(void)
+{
+    if (!g_loaded) {
+        modbus_map_load_defaults();
+    }
+}
+
+/**
+ * 把 [start, start + quantity) 拆分为各区段内的访问段，存在空隙返回 0
+ */
+static uint8_t map_segments(modbus_map_table_t table, uint16_t start, uint16_t quantity,
+                            modbus_map_segment_t *segments)
+{
+    ensure_loaded();
+    if (table >= MODBUS_MAP_TABLE_COUNT || quantity == 0) return 0;
+
+    const modbus_map_table_data_t *t = &g_tables[table];
+
+    /* 二分查找最后一个起始地址 <= start 的区段 */
+    uint8_t lo = 0;
+    uint8_t hi = t->count;
+    while (lo < hi) {
+        uint8_t mid = (uint8_t)((lo + hi) / 2);
+        if (t->regions[mid].start <= start) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0) return 0;
+
+    uint8_t idx = lo - 1;
+    uint8_t n = 0;
+    uint32_t addr = start;
+    uint32_t end = (uint32_t)start + quantity;
+
+    while (addr < end) {
+        if (idx >= t->count) return 0;
+        const modbus_map_region_t *r = &t->regions[idx];
+        uint32_t r_end = (uint32_t)r->start + r->count;
+        if (addr < r->start || addr >= r_end) return 0;
+
+        uint32_t take = (end < r_end ? end : r_end) - addr;
+        segments[n].region = r;
+        segments[n].offset = (uint16_t)(addr - r->start);
+        segments[n].count = (uint16_t)take;
+        n++;
+
+        addr += take;
+        idx++;
+    }
+    return n;
+}
+
+/* 区段内第 offset 个 MODBUS 字对应的软元件下标与半字 (0 低字，1 高字，仅 CN 32 位使用) */
+static uint16_t word_index(const modbus_map_region_t *r, uint16_t offset, uint8_t *half)
+{
+    *half = 0;
+    if (!(r->flags & MODBUS_MAP_32BIT)) {
+        return r->device_start + offset;
+    }
+
+    uint8_t h = (uint8_t)((offset & 1u) ^ ((r->flags & MODBUS_MAP_WORD_SWAP) ? 1u : 0u));
+    if (r->area == FX3U_IMAGE_CN) {
+        *half = h;
+        return r->device_start + offset / 2;
+    }
+    /* 16 位软元件成对组成 32 位值: 低编号为低字 */
+    return r->device_start + (uint16_t)((offset & ~1u) | h);
+}
+
+/**
+ * 恢复默认映射
+ */
+void modbus_map_load_defaults(void)
+{
+    build_table(MODBUS_MAP_COILS, g_default_coils, ARRAY_COUNT(g_default_coils),
+                &g_tables[MODBUS_MAP_COILS]);
+    build_table(MODBUS_MAP_DISCRETE_INPUTS, g_default_discrete,
+                ARRAY_COUNT(g_default_discrete), &g_tables[MODBUS_MAP_DISCRETE_INPUTS]);
+    build_table(MODBUS_MAP_HOLDING_REGISTERS, g_default_registers,
+                ARRAY_COUNT(g_default_registers), &g_tables[MODBUS_MAP_HOLDING_REGISTERS]);
+    build_table(MODBUS_MAP_INPUT_REGISTERS, g_default_registers,
+                ARRAY_COUNT(g_default_registers), &g_tables[MODBUS_MAP_INPUT_REGISTERS]);
+    g_loaded = true;
+}
+
+/**
+ * 替换一张映射表 (区段顺序任意，不得重叠)，校验失败时原表不变
+ */
+bool modbus_map_load(modbus_map_table_t table, const modbus_map_region_t *regions,
+                     uint8_t count)
+{
+    modbus_map_table_data_t staged;
+    if (!build_table(table, regions, count, &staged)) return false;
+
+    ensure_loaded();
+    g_tables[table] = staged;
+    return true;
+}
+
+/**
+ * 从二进制镜像加载映射表，整个镜像有效才生效
+ */
+bool modbus_map_load_image(const uint8_t *data, uint16_t length)
+{
+    if (!data || length < 2) return false;
+
+    static modbus_map_table_data_t staged[MODBUS_MAP_TABLE_COUNT];
+    bool present[MODBUS_MAP_TABLE_COUNT] = { false };
+    uint16_t pos = 0;
+
+    while (pos < length) {
+        if (length - pos < 2) return false;
+        uint8_t table = data[pos];
+        uint8_t count = data[pos + 1];
+        pos += 2;
+
+        if (table >= MODBUS_MAP_TABLE_COUNT || present[table] ||
+            count > MODBUS_MAP_MAX_REGIONS ||
+            length - pos < (uint16_t)count * MODBUS_MAP_IMAGE_REGION_SIZE) {
+            return false;
+        }
+
+        modbus_map_region_t regions[MODBUS_MAP_MAX_REGIONS];
+        for (uint8_t i = 0; i < count; i++) {
+            const uint8_t *p = &data[pos];
+            regions[i].start = ((uint16_t)p[0] << 8) | p[1];
+            regions[i].count = ((uint16_t)p[2] << 8) | p[3];
+            regions[i].device_start = ((uint16_t)p[4] << 8) | p[5];
+            regions[i].area = p[6];
+            regions[i].flags = p[7];
+            pos += MODBUS_MAP_IMAGE_REGION_SIZE;
+        }
+
+        if (!build_table((modbus_map_table_t)table, regions, count, &staged[table])) {
+            return false;
+        }
+        present[table] = true;
+    }
+
+    ensure_loaded();
+    for (uint8_t t = 0; t < MODBUS_MAP_TABLE_COUNT; t++) {
+        if (present[t]) {
+            g_tables[t] = staged[t];
+        }
+    }
+    return true;
+}
+
+/**
+ * 把当前映射表 (全部四张表) 输出为二进制镜像，返回镜像长度，空间不足返回 0
+ */
+uint16_t modbus_map_save_image(uint8_t *data, uint16_t max_length)
+{
+    if (!data) return 0;
+
+    uint16_t pos = 0;
+    for (uint8_t t = 0; t < MODBUS_MAP_TABLE_COUNT; t++) {
+        uint8_t count;
+        const modbus_map_region_t *regions = modbus_map_regions((modbus_map_table_t)t, &count);
+
+        if (max_length - pos < 2 + (uint16_t)count * MODBUS_MAP_IMAGE_REGION_SIZE) return 0;
+        data[pos++] = t;
+        data[pos++] = count;
+        for (uint8_t i = 0; i < count; i++) {
+            uint8_t *p = &data[pos];
+            p[0] = (uint8_t)(regions[i].start >> 8);
+            p[1] = (uint8_t)regions[i].start;
+            p[2] = (uint8_t)(regions[i].count >> 8);
+            p[3] = (uint8_t)regions[i].count;
+            p[4] = (uint8_t)(regions[i].device_start >> 8);
+            p[5] = (uint8_t)regions[i].device_start;
+            p[6] = regions[i].area;
+            p[7] = regions[i].flags;
+            pos += MODBUS_MAP_IMAGE_REGION_SIZE;
+        }
+    }
+    return pos;
+}
+
+/**
+ * 查找包含 address 的区段
+ */
+const modbus_map_region_t *modbus_map_find(modbus_map_table_t table, uint16_t address)
+{
+    modbus_map_segment_t seg;
+    if (map_segments(table, address, 1, &seg) == 0) return NULL;
+    return seg.region;
+}
+
+/**
+ * 获取映射表当前区段 (按起始地址排序)
+ */
+const modbus_map_region_t *modbus_map_regions(modbus_map_table_t table, uint8_t *count)
+{
+    ensure_loaded();
+    if (table >= MODBUS_MAP_TABLE_COUNT) {
+        if (count) *count = 0;
+        return NULL;
+    }
+    if (count) *count = g_tables[table].count;
+    return g_tables[table].regions;
+}
+
+/**
+ * 检查地址范围是否全部映射 (写入时还要求可写)
+ */
+uint8_t modbus_map_check(modbus_map_table_t table, uint16_t start, uint16_t quantity,
+                         bool write)
+{
+    modbus_map_segment_t segments[MODBUS_MAP_MAX_REGIONS];
+    uint8_t n = map_segments(table, start, quantity, segments);
+    if (n == 0) return MODBUS_EXCEPTION_INVALID_ADDRESS;
+
+    if (write) {
+        for (uint8_t i = 0; i < n; i++) {
+            if (segments[i].region->flags & MODBUS_MAP_READ_ONLY) {
+                return MODBUS_EXCEPTION_INVALID_ADDRESS;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * 读取位 (LSB 优先打包)，所有区段来自同一次扫描
+ */
+uint8_t modbus_map_read_bits(modbus_map_table_t table, uint16_t start, uint16_t quantity,
+                             uint8_t *packed)
+{
+    if (!packed || !table_is_bits(table)) return MODBUS_EXCEPTION_INVALID_ADDRESS;
+
+    modbus_map_segment_t segments[MODBUS_MAP_MAX_REGIONS];
+    uint8_t n = map_segments(table, start, quantity, segments);
+    if (n == 0) return MODBUS_EXCEPTION_INVALID_ADDRESS;
+
+    fx3u_image_span_t spans[MODBUS_MAP_MAX_REGIONS];
+    for (uint8_t i = 0; i < n; i++) {
+        spans[i].area = (fx3u_image_area_t)segments[i].region->area;
+        spans[i].start = segments[i].region->device_start + segments[i].offset;
+        spans[i].count = segments[i].count;
+    }
+
+    fx3u_image_read_bit_spans(spans, n, packed);
+    return 0;
+}
+
+/**
+ * 写入位 (LSB 优先打包)，整批入队
+ */
+uint8_t modbus_map_write_bits(modbus_map_table_t table, uint16_t start, uint16_t quantity,
+                              const uint8_t *packed)
+{
+    if (!packed || table != MODBUS_MAP_COILS) return MODBUS_EXCEPTION_INVALID_ADDRESS;
+
+    modbus_map_segment_t segments[MODBUS_MAP_MAX_REGIONS];
+    uint8_t n = map_segments(table, start, quantity, segments);
+    if (n == 0) return MODBUS_EXCEPTION_INVALID_ADDRESS;
+
+    fx3u_image_span_t spans[MODBUS_MAP_MAX_REGIONS];
+    for (uint8_t i = 0; i < n; i++) {
+        if (segments[i].region->flags & MODBUS_MAP_READ_ONLY) {
+            return MODBUS_EXCEPTION_INVALID_ADDRESS;
+        }
+        spans[i].area = (fx3u_image_area_t)segments[i].region->area;
+        spans[i].start = segments[i].region->device_start + segments[i].offset;
+        spans[i].count = segments[i].count;
+    }
+
+    if (!fx3u_image_queue_bit_spans(spans, n, packed)) {
+        return MODBUS_EXCEPTION_DEVICE_BUSY;
+    }
+    return 0;
+}
+
+/**
+ * 读取寄存器 (大端)，所有区段在同一次 seqlock 读取中完成
+ */
+uint8_t modbus_map_read_registers(modbus_map_table_t table, uint16_t start, uint16_t quantity,
+                                  uint8_t *data)
+{
+    if (!data || table_is_bits(table)) return MODBUS_EXCEPTION_INVALID_ADDRESS;
+
+    modbus_map_segment_t segments[MODBUS_MAP_MAX_REGIONS];
+    uint8_t n = map_segments(table, start, quantity, segments);
+    if (n == 0) return MODBUS_EXCEPTION_INVALID_ADDRESS;
+
+    const fx3u_image_snapshot_t *snap;
+    uint32_t seq;
+
+    do {
+        snap = fx3u_image_snapshot_begin(&seq);
+        uint8_t *out = data;
+        for (uint8_t i = 0; i < n; i++) {
+            const modbus_map_region_t *r = segments[i].region;
+            for (uint16_t k = 0; k < segments[i].count; k++) {
+                uint8_t half;
+                uint16_t index = word_index(r, segments[i].offset + k, &half);
+                uint32_t value = (uint32_t)fx3u_image_snapshot_value(
+                    snap, (fx3u_image_area_t)r->area, index);
+                if (half) {
+                    value >>= 16;
+                }
+                *out++ = (uint8_t)(value >> 8);
+                *out++ = (uint8_t)value;
+            }
+        }
+    } while (fx3u_image_snapshot_retry(snap, seq));
+
+    return 0;
+}
+
+/**
+ * 写入寄存器 (大端)，整批入队，下一扫描开始时原子生效
+ */
+uint8_t modbus_map_write_registers(modbus_map_table_t table, uint16_t start, uint16_t quantity,
+                                   const uint8_t *data)
+{
+    if (!data || table != MODBUS_MAP_HOLDING_REGISTERS ||
+        quantity > MODBUS_MAX_WRITE_REGISTERS) {
+        return MODBUS_EXCEPTION_INVALID_ADDRESS;
+    }
+
+    modbus_map_segment_t segments[MODBUS_MAP_MAX_REGIONS];
+    uint8_t n = map_segments(table, start, quantity, segments);
+    if (n == 0) return MODBUS_EXCEPTION_INVALID_ADDRESS;
+
+    uint16_t count = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        const modbus_map_region_t *r = segments[i].region;
+        if (r->flags & MODBUS_MAP_READ_ONLY) return MODBUS_EXCEPTION_INVALID_ADDRESS;
+
+        for (uint16_t k = 0; k < segments[i].count; k++) {
+            fx3u_image_write_t *w = &g_write_batch[count++];
+            uint8_t half;
+            w->area = r->area;
+            w->addr = word_index(r, segments[i].offset + k, &half);
+            w->value = (int16_t)(((uint16_t)data[0] << 8) | data[1]);
+            data += 2;
+
+            if (r->area != FX3U_IMAGE_CN) {
+                w->count = 1;
+            } else if (r->flags & MODBUS_MAP_32BIT) {
+                w->count = half ? FX3U_IMAGE_CN_HIGH : FX3U_IMAGE_CN_LOW;
+            } else {
+                w->count = FX3U_IMAGE_CN_SIGNED;
+            }
+        }
+    }
+
+    if (!fx3u_image_queue_writes(g_write_batch, count)) {
+        return MODBUS_EXCEPTION_DEVICE_BUSY;
+    }
+    return 0;
+}
+
+/**
+ * 变化查询，条目按地址升序，全部来自同一次快照
+ *
+ * 结果因条目数上限被截断时置 MORE，客户端应以相同 since 从 next 继续，
+ * 整轮结束后采用第一次应答中的 seq，期间的新变化会在下一轮报告。
+ */
+uint8_t modbus_map_read_changes(modbus_map_table_t table, uint16_t start, uint16_t quantity,
+                                uint32_t since, uint8_t max_entries, uint8_t *data,
+                                modbus_map_changes_t *result)
+{
+    if (!data || !result || table_is_bits(table)) return MODBUS_EXCEPTION_INVALID_ADDRESS;
+
+    modbus_map_segment_t segments[MODBUS_MAP_MAX_REGIONS];
+    uint8_t n = map_segments(table, start, quantity, segments);
+    if (n == 0) return MODBUS_EXCEPTION_INVALID_ADDRESS;
+
+    const fx3u_image_snapshot_t *snap;
+    uint32_t seq;
+
+    do {
+        snap = fx3u_image_snapshot_begin(&seq);
+        result->seq = snap->change_seq;
+        result->flags = fx3u_image_changes_valid(snap, since) ? 0 : MODBUS_MAP_CHANGES_FULL;
+        result->count = 0;
+        result->next = 0;
+
+        uint8_t *out = data;
+        for (uint8_t i = 0; i < n && !(result->flags & MODBUS_MAP_CHANGES_MORE); i++) {
+            const modbus_map_region_t *r = segments[i].region;
+            fx3u_image_area_t area = (fx3u_image_area_t)r->area;
+
+            for (uint16_t k = 0; k < segments[i].count; k++) {
+                uint16_t offset = segments[i].offset + k;
+                uint8_t half;
+                uint16_t index = word_index(r, offset, &half);
+                if (!fx3u_image_changed_since(snap, area, index, since)) continue;
+
+                uint16_t address = r->start + offset;
+                if (result->count == max_entries) {
+                    result->flags |= MODBUS_MAP_CHANGES_MORE;
+                    result->next = address;
+                    break;
+                }
+
+                uint32_t value = (uint32_t)fx3u_image_snapshot_value(snap, area, index);
+                if (half) {
+                    value >>= 16;
+                }
+                *out++ = (uint8_t)(address >> 8);
+                *out++ = (uint8_t)address;
+                *out++ = (uint8_t)(value >> 8);
+                *out++ = (uint8_t)value;
+                result->count++;
+            }
+        }
+    } while (fx3u_image_snapshot_retry(snap, seq));
+
+    return 0;
+}
@@ -3,57 +3,28 @@
  */
 
 #include "modbus_protocol.h"
+#include "modbus_crc.h"
+#include "modbus_map.h"
+#include "fx3u_program.h"
+#include "fx3u_profile.h"
 #include <string.h>
 
-static bool modbus_check_address(uint16_t start, uint16_t quantity, uint16_t max_count);
-
-/* CRC16查询表 */
-static const uint16_t crc16_table[256] = {
-    0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
-    0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
-    0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
-    0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
-    0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
-    0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
-    0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
-    0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
-    0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
-    0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
-    0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
-    0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
-    0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
-    0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
-    0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
-    0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
-    0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
-    0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
-    0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
-    0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
-    0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
-    0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
-    0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
-    0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
-    0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
-    0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
-    0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
-    0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
-    0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
-    0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
-    0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
-    0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4000
-};
-
-static bool modbus_check_address(uint16_t start, uint16_t quantity, uint16_t max_count)
-{
-    if (quantity == 0) {
-        return false;
-    }
-    if (start >= max_count) {
-        return false;
-    }
-    uint32_t end = (uint32_t)start + (uint32_t)quantity;
-    return end <= max_count;
-}
+#define MODBUS_FILE_PROGRAM_FILES   (FX3U_PROGRAM_MAX_BYTES / (MODBUS_FILE_PROGRAM_RECORDS * 2))
+
+/* 映射表镜像暂存 (文件 2)，APPLY_MAP 时整体加载 */
+static uint8_t g_map_staging[MODBUS_MAP_IMAGE_MAX_SIZE];
+
+static void modbus_decode_header(uint8_t *buffer, uint16_t length, modbus_frame_t *frame);
+static int modbus_slave_dispatch(fx3u_core_t *plc, const modbus_frame_t *frame,
+                                 uint8_t *rx_buffer, uint16_t rx_len,
+                                 uint8_t *tx_buffer);
+static int modbus_build_exception(uint8_t *buffer, uint8_t slave_id, uint8_t function_code,
+                                  uint8_t exception_code);
+static int modbus_append_crc(uint8_t *buffer, int length);
+static uint8_t modbus_file_read(fx3u_core_t *plc, uint16_t file, uint16_t record,
+                                uint16_t count, uint8_t *data);
+static uint8_t modbus_file_write(fx3u_core_t *plc, uint16_t file, uint16_t record,
+                                 uint16_t count, const uint8_t *data);
 
 /**
  * 初始化MODBUS
@@ -79,21 +50,11 @@ void modbus_set_master(modbus_config_t *config, bool is_master)
 }
 
 /**
- * 计算MODBUS CRC16校验码
+ * 计算MODBUS CRC16校验码 (使用当前CRC引擎)
  */
 uint16_t modbus_crc16(uint8_t *data, uint16_t length)
 {
-    uint16_t crc = 0xFFFF;
-    uint16_t i;
-    
-    if (!data || length == 0) return crc;
-    
-    for (i = 0; i < length; i++) {
-        uint8_t index = (uint8_t)(crc ^ data[i]);
-        crc = (crc >> 8) ^ crc16_table[index];
-    }
-    
-    return crc;
+    return modbus_crc_update(MODBUS_CRC_INIT, data, length);
 }
 
 /**
@@ -123,20 +84,24 @@ bool modbus_parse_frame(uint8_t *buffer, uint16_t length, modbus_frame_t *frame)
     
     if (!modbus_validate_frame(buffer, length)) return false;
     
+    modbus_decode_header(buffer, length, frame);
+    return true;
+}
+
+/**
+ * 解码帧头字段 (调用者已完成CRC校验)
+ */
+static void modbus_decode_header(uint8_t *buffer, uint16_t length, modbus_frame_t *frame)
+{
     frame->slave_id = buffer[0];
     frame->function_code = buffer[1];
     frame->start_address = ((uint16_t)buffer[2] << 8) | buffer[3];
     frame->quantity = ((uint16_t)buffer[4] << 8) | buffer[5];
-    
-    if (length > 6) {
-        frame->byte_count = buffer[6];
-    }
-    
+    frame->byte_count = length > 6 ? buffer[6] : 0;
+    frame->data = NULL;
     frame->crc = (uint16_t)buffer[length - 2] |
                  ((uint16_t)buffer[length - 1] << 8);
-    frame->is_valid = true;
-    
-    return true;
+    frame->lrc = 0;
 }
 
 /**
@@ -182,276 +147,365 @@ int modbus_slave_process(fx3u_core_t *plc, uint8_t *rx_buffer, uint16_t rx_len,
         return 0;
     }
     
+    int tx_len = modbus_slave_dispatch(plc, &frame, rx_buffer, rx_len - 2, tx_buffer);
+    return modbus_append_crc(tx_buffer, tx_len);
+}
+
+/**
+ * MODBUS从机处理 - 接收时已增量累计CRC，帧尾只做 O(1) 判定
+ */
+int modbus_slave_process_crc(fx3u_core_t *plc, uint8_t *rx_buffer, uint16_t rx_len,
+                             uint8_t *tx_buffer, const modbus_crc_ctx_t *rx_crc)
+{
+    if (!plc || !rx_buffer || !tx_buffer || rx_len < 8) return 0;
+    if (!rx_crc || rx_crc->length != rx_len || !modbus_crc_frame_ok(rx_crc)) {
+        return 0;
+    }
+    
+    modbus_frame_t frame;
+    modbus_decode_header(rx_buffer, rx_len, &frame);
+    int tx_len = modbus_slave_dispatch(plc, &frame, rx_buffer, rx_len - 2, tx_buffer);
+    return modbus_append_crc(tx_buffer, tx_len);
+}
+
+/**
+ * MODBUS从机处理 - 不含CRC的 [单元标识][PDU] (MODBUS TCP 等)
+ */
+int modbus_slave_process_pdu(fx3u_core_t *plc, uint8_t *adu, uint16_t adu_len,
+                             uint8_t *tx_buffer)
+{
+    if (!plc || !adu || !tx_buffer || adu_len < 6) return 0;
+    
+    modbus_frame_t frame;
+    modbus_decode_header(adu, adu_len, &frame);
+    frame.crc = 0;
+    return modbus_slave_dispatch(plc, &frame, adu, adu_len, tx_buffer);
+}
+
+/**
+ * 按功能码分发已校验的请求
+ *
+ * rx_buffer/rx_len 为不含CRC的 [从站][PDU]，响应同样不含CRC，
+ * 由 RTU 或 TCP 外层各自封装。
+ */
+static int modbus_slave_dispatch(fx3u_core_t *plc, const modbus_frame_t *frame,
+                                 uint8_t *rx_buffer, uint16_t rx_len,
+                                 uint8_t *tx_buffer)
+{
     uint8_t function_code = rx_buffer[1];
     int tx_len = 0;
     
     switch (function_code) {
-        case MODBUS_READ_COIL_STATUS: {
-            if (!modbus_check_address(frame.start_address, frame.quantity,
-                                      PLC_MAX_OUTPUTS)) {
-                modbus_send_exception(tx_buffer, frame.slave_id, function_code,
-                                      MODBUS_EXCEPTION_INVALID_ADDRESS);
-                return 5;
-            }
-            
-            /* 读输出继电器 */
-            tx_buffer[0] = rx_buffer[0];
-            tx_buffer[1] = function_code;
-            uint8_t byte_count = (frame.quantity + 7) / 8;
-            tx_buffer[2] = byte_count;
-            
-            for (int i = 0; i < byte_count; i++) {
-                uint8_t byte_val = 0;
-                for (int j = 0; j < 8; j++) {
-                    uint16_t addr = frame.start_address + i * 8 + j;
-                    if (addr < PLC_MAX_OUTPUTS) {
-                        if (fx3u_get_output(plc, addr)) {
-                            byte_val |= (1 << j);
-                        }
-                    }
-                }
-                tx_buffer[3 + i] = byte_val;
-            }
-            
-            uint16_t crc = modbus_crc16(tx_buffer, 3 + byte_count);
-            tx_buffer[3 + byte_count] = crc & 0xFF;
-            tx_buffer[4 + byte_count] = (crc >> 8) & 0xFF;
-            tx_len = 5 + byte_count;
-            break;
-        }
-        
+        case MODBUS_READ_COIL_STATUS:
         case MODBUS_READ_INPUT_STATUS: {
-            if (!modbus_check_address(frame.start_address, frame.quantity,
-                                      PLC_MAX_INPUTS)) {
-                modbus_send_exception(tx_buffer, frame.slave_id, function_code,
-                                      MODBUS_EXCEPTION_INVALID_ADDRESS);
-                return 5;
+            if (frame->quantity == 0 || frame->quantity > MODBUS_MAX_READ_BITS) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code,
+                                              MODBUS_EXCEPTION_INVALID_VALUE);
             }
             
-            /* 读输入继电器 */
-            tx_buffer[0] = rx_buffer[0];
-            tx_buffer[1] = function_code;
-            uint8_t byte_count = (frame.quantity + 7) / 8;
-            tx_buffer[2] = byte_count;
-            
-            for (int i = 0; i < byte_count; i++) {
-                uint8_t byte_val = 0;
-                for (int j = 0; j < 8; j++) {
-                    uint16_t addr = frame.start_address + i * 8 + j;
-                    if (addr < PLC_MAX_INPUTS) {
-                        if (fx3u_get_input(plc, addr)) {
-                            byte_val |= (1 << j);
-                        }
-                    }
-                }
-                tx_buffer[3 + i] = byte_val;
-            }
-            
-            uint16_t crc = modbus_crc16(tx_buffer, 3 + byte_count);
-            tx_buffer[3 + byte_count] = crc & 0xFF;
-            tx_buffer[4 + byte_count] = (crc >> 8) & 0xFF;
-            tx_len = 5 + byte_count;
-            break;
-        }
-        
-        case MODBUS_READ_HOLDING_REGISTERS: {
-            if (!modbus_check_address(frame.start_address, frame.quantity,
-                                      PLC_MAX_REGISTERS)) {
-                modbus_send_exception(tx_buffer, frame.slave_id, function_code,
-                                      MODBUS_EXCEPTION_INVALID_ADDRESS);
-                return 5;
+            /* 读线圈 / 离散输入，按映射表跨区段读取 */
+            modbus_map_table_t table = function_code == MODBUS_READ_COIL_STATUS ?
+                                       MODBUS_MAP_COILS : MODBUS_MAP_DISCRETE_INPUTS;
+            uint8_t byte_count = (frame->quantity + 7) / 8;
+            uint8_t code = modbus_map_read_bits(table, frame->start_address, frame->quantity,
+                                                &tx_buffer[3]);
+            if (code != 0) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code, code);
             }
             
-            /* 读数据寄存器 */
             tx_buffer[0] = rx_buffer[0];
             tx_buffer[1] = function_code;
-            uint8_t byte_count = frame.quantity * 2;
             tx_buffer[2] = byte_count;
-            
-            int idx = 3;
-            for (int i = 0; i < frame.quantity; i++) {
-                uint16_t addr = frame.start_address + i;
-                int16_t value = fx3u_get_register(plc, addr);
-                tx_buffer[idx++] = (value >> 8) & 0xFF;
-                tx_buffer[idx++] = value & 0xFF;
-            }
-            
-            uint16_t crc = modbus_crc16(tx_buffer, 3 + byte_count);
-            tx_buffer[idx++] = crc & 0xFF;
-            tx_buffer[idx++] = (crc >> 8) & 0xFF;
-            tx_len = idx;
+            tx_len = 3 + byte_count;
             break;
         }
         
+        case MODBUS_READ_HOLDING_REGISTERS:
         case MODBUS_READ_INPUT_REGISTERS: {
-            if (!modbus_check_address(frame.start_address, frame.quantity,
-                                      PLC_MAX_REGISTERS)) {
-                modbus_send_exception(tx_buffer, frame.slave_id, function_code,
-                                      MODBUS_EXCEPTION_INVALID_ADDRESS);
-                return 5;
+            if (frame->quantity == 0 || frame->quantity > MODBUS_MAX_READ_REGISTERS) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code,
+                                              MODBUS_EXCEPTION_INVALID_VALUE);
             }
             
-            tx_buffer[0] = rx_buffer[0];
-            tx_buffer[1] = function_code;
-            uint8_t byte_count = frame.quantity * 2;
-            tx_buffer[2] = byte_count;
-            
-            int idx = 3;
-            for (int i = 0; i < frame.quantity; i++) {
-                uint16_t addr = frame.start_address + i;
-                int16_t value = fx3u_get_register(plc, addr);
-                tx_buffer[idx++] = (value >> 8) & 0xFF;
-                tx_buffer[idx++] = value & 0xFF;
+            /* 读寄存器 (D/T/C/特殊寄存器等，按映射表) */
+            modbus_map_table_t table = function_code == MODBUS_READ_HOLDING_REGISTERS ?
+                                       MODBUS_MAP_HOLDING_REGISTERS : MODBUS_MAP_INPUT_REGISTERS;
+            uint8_t code = modbus_map_read_registers(table, frame->start_address,
+                                                     frame->quantity, &tx_buffer[3]);
+            if (code != 0) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code, code);
             }
             
-            uint16_t crc = modbus_crc16(tx_buffer, 3 + byte_count);
-            tx_buffer[idx++] = crc & 0xFF;
-            tx_buffer[idx++] = (crc >> 8) & 0xFF;
-            tx_len = idx;
+            tx_buffer[0] = rx_buffer[0];
+            tx_buffer[1] = function_code;
+            tx_buffer[2] = frame->quantity * 2;
+            tx_len = 3 + frame->quantity * 2;
             break;
         }
         
         case MODBUS_WRITE_SINGLE_COIL: {
-            if (!modbus_check_address(frame.start_address, 1, PLC_MAX_OUTPUTS)) {
-                modbus_send_exception(tx_buffer, frame.slave_id, function_code,
-                                      MODBUS_EXCEPTION_INVALID_ADDRESS);
-                return 5;
+            uint8_t code = modbus_map_check(MODBUS_MAP_COILS, frame->start_address, 1, true);
+            if (code != 0) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code, code);
             }
-            if (rx_len < 8) {
-                modbus_send_exception(tx_buffer, frame.slave_id, function_code,
-                                      MODBUS_EXCEPTION_INVALID_VALUE);
-                return 5;
+            if (rx_len < 6) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code,
+                                              MODBUS_EXCEPTION_INVALID_VALUE);
             }
             
-            /* 写单个输出继电器 */
+            /* 写单个线圈 */
             uint16_t raw = ((uint16_t)rx_buffer[4] << 8) | rx_buffer[5];
             if (raw != 0xFF00 && raw != 0x0000) {
-                modbus_send_exception(tx_buffer, frame.slave_id, function_code,
-                                      MODBUS_EXCEPTION_INVALID_VALUE);
-                return 5;
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code,
+                                              MODBUS_EXCEPTION_INVALID_VALUE);
+            }
+            uint8_t bit = raw == 0xFF00 ? 1 : 0;
+            code = modbus_map_write_bits(MODBUS_MAP_COILS, frame->start_address, 1, &bit);
+            if (code != 0) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code, code);
             }
-            fx3u_set_output(plc, frame.start_address, raw == 0xFF00 ? 1 : 0);
             
             /* 回送相同的请求 */
             memcpy(tx_buffer, rx_buffer, 6);
-            uint16_t crc = modbus_crc16(tx_buffer, 6);
-            tx_buffer[6] = crc & 0xFF;
-            tx_buffer[7] = (crc >> 8) & 0xFF;
-            tx_len = 8;
+            tx_len = 6;
             break;
         }
         
         case MODBUS_WRITE_SINGLE_REGISTER: {
-            if (!modbus_check_address(frame.start_address, 1, PLC_MAX_REGISTERS)) {
-                modbus_send_exception(tx_buffer, frame.slave_id, function_code,
-                                      MODBUS_EXCEPTION_INVALID_ADDRESS);
-                return 5;
+            uint8_t code = modbus_map_check(MODBUS_MAP_HOLDING_REGISTERS, frame->start_address,
+                                            1, true);
+            if (code != 0) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code, code);
             }
-            if (rx_len < 8) {
-                modbus_send_exception(tx_buffer, frame.slave_id, function_code,
-                                      MODBUS_EXCEPTION_INVALID_VALUE);
-                return 5;
+            if (rx_len < 6) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code,
+                                              MODBUS_EXCEPTION_INVALID_VALUE);
             }
             
             /* 写单个寄存器 */
-            int16_t value = ((int16_t)rx_buffer[4] << 8) | rx_buffer[5];
-            fx3u_set_register(plc, frame.start_address, value);
+            code = modbus_map_write_registers(MODBUS_MAP_HOLDING_REGISTERS,
+                                              frame->start_address, 1, &rx_buffer[4]);
+            if (code != 0) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code, code);
+            }
             
             /* 回送相同的请求 */
             memcpy(tx_buffer, rx_buffer, 6);
-            uint16_t crc = modbus_crc16(tx_buffer, 6);
-            tx_buffer[6] = crc & 0xFF;
-            tx_buffer[7] = (crc >> 8) & 0xFF;
-            tx_len = 8;
+            tx_len = 6;
             break;
         }
         
         case MODBUS_WRITE_MULTIPLE_COILS: {
-            if (!modbus_check_address(frame.start_address, frame.quantity,
-                                      PLC_MAX_OUTPUTS)) {
-                modbus_send_exception(tx_buffer, frame.slave_id, function_code,
-                                      MODBUS_EXCEPTION_INVALID_ADDRESS);
-                return 5;
+            if (frame->quantity == 0 || frame->quantity > MODBUS_MAX_WRITE_BITS ||
+                rx_len < 7 || rx_buffer[6] == 0 ||
+                rx_len != (uint16_t)(rx_buffer[6] + 7) ||
+                rx_buffer[6] < (frame->quantity + 7) / 8) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code,
+                                              MODBUS_EXCEPTION_INVALID_VALUE);
             }
-            if (rx_len < 9 || rx_buffer[6] == 0 ||
-                rx_len != (uint16_t)(rx_buffer[6] + 9)) {
-                modbus_send_exception(tx_buffer, frame.slave_id, function_code,
-                                      MODBUS_EXCEPTION_INVALID_VALUE);
-                return 5;
+            
+            /* 写多个线圈 (可跨区段，下一扫描开始时整批生效) */
+            uint8_t code = modbus_map_write_bits(MODBUS_MAP_COILS, frame->start_address,
+                                                 frame->quantity, &rx_buffer[7]);
+            if (code != 0) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code, code);
             }
             
-            /* 写多个输出继电器 */
-            uint8_t byte_count = rx_buffer[6];
+            /* 返回确认 */
+            tx_buffer[0] = rx_buffer[0];
+            tx_buffer[1] = function_code;
+            tx_buffer[2] = (frame->start_address >> 8) & 0xFF;
+            tx_buffer[3] = frame->start_address & 0xFF;
+            tx_buffer[4] = (frame->quantity >> 8) & 0xFF;
+            tx_buffer[5] = frame->quantity & 0xFF;
+            tx_len = 6;
+            break;
+        }
+        
+        case MODBUS_WRITE_MULTIPLE_REGISTERS: {
+            if (frame->quantity == 0 || frame->quantity > MODBUS_MAX_WRITE_REGISTERS ||
+                rx_len < 7 || rx_buffer[6] != frame->quantity * 2 ||
+                rx_len != (uint16_t)(frame->quantity * 2 + 7)) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code,
+                                              MODBUS_EXCEPTION_INVALID_VALUE);
+            }
             
-            for (int i = 0; i < byte_count; i++) {
-                for (int j = 0; j < 8; j++) {
-                    uint16_t addr = frame.start_address + i * 8 + j;
-                    if (addr < PLC_MAX_OUTPUTS) {
-                        uint8_t value = (rx_buffer[7 + i] >> j) & 1;
-                        fx3u_set_output(plc, addr, value);
-                    }
-                }
+            /* 写多个寄存器 (可跨区段，下一扫描开始时整批生效) */
+            uint8_t code = modbus_map_write_registers(MODBUS_MAP_HOLDING_REGISTERS,
+                                                      frame->start_address, frame->quantity,
+                                                      &rx_buffer[7]);
+            if (code != 0) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code, code);
             }
             
             /* 返回确认 */
             tx_buffer[0] = rx_buffer[0];
             tx_buffer[1] = function_code;
-            tx_buffer[2] = (frame.start_address >> 8) & 0xFF;
-            tx_buffer[3] = frame.start_address & 0xFF;
-            tx_buffer[4] = (frame.quantity >> 8) & 0xFF;
-            tx_buffer[5] = frame.quantity & 0xFF;
+            tx_buffer[2] = (frame->start_address >> 8) & 0xFF;
+            tx_buffer[3] = frame->start_address & 0xFF;
+            tx_buffer[4] = (frame->quantity >> 8) & 0xFF;
+            tx_buffer[5] = frame->quantity & 0xFF;
+            tx_len = 6;
+            break;
+        }
+        
+        case MODBUS_READ_WRITE_MULTIPLE_REGISTERS: {
+            /* 请求: 读起始(2) 读数量(2) 写起始(2) 写数量(2) 字节数(1) 数据(N) */
+            if (rx_len < 11) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code,
+                                              MODBUS_EXCEPTION_INVALID_VALUE);
+            }
+            uint16_t write_addr = ((uint16_t)rx_buffer[6] << 8) | rx_buffer[7];
+            uint16_t write_qty = ((uint16_t)rx_buffer[8] << 8) | rx_buffer[9];
+            
+            if (frame->quantity == 0 || frame->quantity > MODBUS_RW_MAX_READ ||
+                write_qty == 0 || write_qty > MODBUS_RW_MAX_WRITE ||
+                rx_buffer[10] != write_qty * 2 ||
+                rx_len != (uint16_t)(write_qty * 2 + 11)) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code,
+                                              MODBUS_EXCEPTION_INVALID_VALUE);
+            }
+            uint8_t code = modbus_map_check(MODBUS_MAP_HOLDING_REGISTERS, frame->start_address,
+                                            frame->quantity, false);
+            if (code == 0) {
+                code = modbus_map_write_registers(MODBUS_MAP_HOLDING_REGISTERS, write_addr,
+                                                  write_qty, &rx_buffer[11]);
+            }
+            if (code != 0) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code, code);
+            }
             
-            uint16_t crc = modbus_crc16(tx_buffer, 6);
-            tx_buffer[6] = crc & 0xFF;
-            tx_buffer[7] = (crc >> 8) & 0xFF;
-            tx_len = 8;
+            /* 写入已整批入队；读取来自快照并按地址叠加本次写入，等效于先写后读 */
+            modbus_map_read_registers(MODBUS_MAP_HOLDING_REGISTERS, frame->start_address,
+                                      frame->quantity, &tx_buffer[3]);
+            for (int i = 0; i < frame->quantity; i++) {
+                uint32_t addr = (uint32_t)frame->start_address + i;
+                if (addr >= write_addr && addr < (uint32_t)write_addr + write_qty) {
+                    const uint8_t *src = &rx_buffer[11 + (addr - write_addr) * 2];
+                    tx_buffer[3 + i * 2] = src[0];
+                    tx_buffer[4 + i * 2] = src[1];
+                }
+            }
+            
+            tx_buffer[0] = rx_buffer[0];
+            tx_buffer[1] = function_code;
+            tx_buffer[2] = frame->quantity * 2;
+            tx_len = 3 + frame->quantity * 2;
             break;
         }
         
-        case MODBUS_WRITE_MULTIPLE_REGISTERS: {
-            if (!modbus_check_address(frame.start_address, frame.quantity,
-                                      PLC_MAX_REGISTERS)) {
-                modbus_send_exception(tx_buffer, frame.slave_id, function_code,
-                                      MODBUS_EXCEPTION_INVALID_ADDRESS);
-                return 5;
+        case MODBUS_READ_CHANGED_REGISTERS: {
+            /* 请求: 起始(2) 数量(2) 上次序号(4)
+             * 应答: 字节数(1) 当前序号(4) 标志(1) 续查地址(2) + N x [地址(2) 值(2)] */
+            if (rx_len != 10 || frame->quantity == 0) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code,
+                                              MODBUS_EXCEPTION_INVALID_VALUE);
             }
-            if (rx_len < 9 || rx_buffer[6] != frame.quantity * 2 ||
-                rx_len != (uint16_t)(frame.quantity * 2 + 9)) {
-                modbus_send_exception(tx_buffer, frame.slave_id, function_code,
-                                      MODBUS_EXCEPTION_INVALID_VALUE);
-                return 5;
+            uint32_t since = ((uint32_t)rx_buffer[6] << 24) | ((uint32_t)rx_buffer[7] << 16) |
+                             ((uint32_t)rx_buffer[8] << 8) | rx_buffer[9];
+            
+            modbus_map_changes_t changes;
+            uint8_t code = modbus_map_read_changes(MODBUS_MAP_HOLDING_REGISTERS,
+                                                   frame->start_address, frame->quantity, since,
+                                                   MODBUS_CHANGES_MAX_ENTRIES, &tx_buffer[10],
+                                                   &changes);
+            if (code != 0) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code, code);
             }
             
-            /* 写多个寄存器 */
-            uint8_t byte_count = rx_buffer[6];
-            int qty = byte_count / 2;
+            tx_buffer[0] = rx_buffer[0];
+            tx_buffer[1] = function_code;
+            tx_buffer[2] = (uint8_t)(7 + changes.count * 4);
+            tx_buffer[3] = (uint8_t)(changes.seq >> 24);
+            tx_buffer[4] = (uint8_t)(changes.seq >> 16);
+            tx_buffer[5] = (uint8_t)(changes.seq >> 8);
+            tx_buffer[6] = (uint8_t)changes.seq;
+            tx_buffer[7] = changes.flags;
+            tx_buffer[8] = (uint8_t)(changes.next >> 8);
+            tx_buffer[9] = (uint8_t)changes.next;
+            tx_len = 10 + changes.count * 4;
+            break;
+        }
+        
+        case MODBUS_READ_FILE_RECORD: {
+            /* 请求: 字节数(1) + N x [参考类型(1) 文件号(2) 记录号(2) 记录数(2)]
+             * 应答: 字节数(1) + N x [长度(1) 参考类型(1) 数据(2 x 记录数)] */
+            uint8_t byte_count = rx_len >= 3 ? rx_buffer[2] : 0;
+            if (byte_count < 7 || byte_count % 7 != 0 || rx_len != 3 + byte_count) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code,
+                                              MODBUS_EXCEPTION_INVALID_VALUE);
+            }
             
-            for (int i = 0; i < qty; i++) {
-                uint16_t addr = frame.start_address + i;
-                int16_t value = ((int16_t)rx_buffer[7 + i * 2] << 8) | rx_buffer[8 + i * 2];
-                fx3u_set_register(plc, addr, value);
+            uint16_t out = 3;
+            for (uint16_t pos = 3; pos < rx_len; pos += 7) {
+                const uint8_t *sub = &rx_buffer[pos];
+                uint16_t file = ((uint16_t)sub[1] << 8) | sub[2];
+                uint16_t record = ((uint16_t)sub[3] << 8) | sub[4];
+                uint16_t count = ((uint16_t)sub[5] << 8) | sub[6];
+                
+                if (sub[0] != MODBUS_FILE_REFERENCE_TYPE || count == 0 ||
+                    out + 2 + count * 2 > 3 + MODBUS_FILE_MAX_READ_BYTES) {
+                    return modbus_build_exception(tx_buffer, frame->slave_id, function_code,
+                                                  MODBUS_EXCEPTION_INVALID_VALUE);
+                }
+                uint8_t code = modbus_file_read(plc, file, record, count, &tx_buffer[out + 2]);
+                if (code != 0) {
+                    return modbus_build_exception(tx_buffer, frame->slave_id, function_code, code);
+                }
+                tx_buffer[out] = (uint8_t)(1 + count * 2);
+                tx_buffer[out + 1] = MODBUS_FILE_REFERENCE_TYPE;
+                out += 2 + count * 2;
             }
             
-            /* 返回确认 */
             tx_buffer[0] = rx_buffer[0];
             tx_buffer[1] = function_code;
-            tx_buffer[2] = (frame.start_address >> 8) & 0xFF;
-            tx_buffer[3] = frame.start_address & 0xFF;
-            tx_buffer[4] = (frame.quantity >> 8) & 0xFF;
-            tx_buffer[5] = frame.quantity & 0xFF;
+            tx_buffer[2] = (uint8_t)(out - 3);
+            tx_len = out;
+            break;
+        }
+        
+        case MODBUS_WRITE_FILE_RECORD: {
+            /* 请求: 字节数(1) + N x [参考类型(1) 文件号(2) 记录号(2) 记录数(2) 数据]
+             * 应答为请求原样回送。先检查全部子请求的格式，再依次执行 */
+            uint8_t byte_count = rx_len >= 3 ? rx_buffer[2] : 0;
+            if (byte_count < 9 || byte_count > MODBUS_FILE_MAX_WRITE_BYTES ||
+                rx_len != 3 + byte_count) {
+                return modbus_build_exception(tx_buffer, frame->slave_id, function_code,
+                                              MODBUS_EXCEPTION_INVALID_VALUE);
+            }
+            for (uint16_t pos = 3; pos < rx_len; ) {
+                uint16_t count = rx_len - pos >= 7 ?
+                                 (((uint16_t)rx_buffer[pos + 5] << 8) | rx_buffer[pos + 6]) : 0;
+                if (count == 0 || rx_buffer[pos] != MODBUS_FILE_REFERENCE_TYPE ||
+                    rx_len - pos < 7 + count * 2) {
+                    return modbus_build_exception(tx_buffer, frame->slave_id, function_code,
+                                                  MODBUS_EXCEPTION_INVALID_VALUE);
+                }
+                pos += 7 + count * 2;
+            }
             
-            uint16_t crc = modbus_crc16(tx_buffer, 6);
-            tx_buffer[6] = crc & 0xFF;
-            tx_buffer[7] = (crc >> 8) & 0xFF;
-            tx_len = 8;
+            for (uint16_t pos = 3; pos < rx_len; ) {
+                const uint8_t *sub = &rx_buffer[pos];
+                uint16_t file = ((uint16_t)sub[1] << 8) | sub[2];
+                uint16_t record = ((uint16_t)sub[3] << 8) | sub[4];
+                uint16_t count = ((uint16_t)sub[5] << 8) | sub[6];
+                
+                uint8_t code = modbus_file_write(plc, file, record, count, &sub[7]);
+                if (code != 0) {
+                    return modbus_build_exception(tx_buffer, frame->slave_id, function_code, code);
+                }
+                pos += 7 + count * 2;
+            }
+            
+            memcpy(tx_buffer, rx_buffer, rx_len);
+            tx_len = rx_len;
             break;
         }
         
         default: {
             /* 不支持的功能码 */
-            modbus_send_exception(tx_buffer, rx_buffer[0], function_code,
-                                 MODBUS_EXCEPTION_INVALID_FUNCTION);
-            tx_len = 5;
+            tx_len = modbus_build_exception(tx_buffer, rx_buffer[0], function_code,
+                                            MODBUS_EXCEPTION_INVALID_FUNCTION);
             break;
         }
     }
@@ -459,21 +513,253 @@ int modbus_slave_process(fx3u_core_t *plc, uint8_t *rx_buffer, uint16_t rx_len,
     return tx_len;
 }
 
+/* ===== 文件记录 ===== */
+
+static uint8_t program_exception(fx3u_program_result_t result)
+{
+    switch (result) {
+        case FX3U_PROGRAM_OK:           return 0;
+        case FX3U_PROGRAM_ERR_BUSY:     return MODBUS_EXCEPTION_DEVICE_BUSY;
+        case FX3U_PROGRAM_ERR_RANGE:    return MODBUS_EXCEPTION_INVALID_ADDRESS;
+        case FX3U_PROGRAM_ERR_SEQUENCE: return MODBUS_EXCEPTION_INVALID_VALUE;
+        case FX3U_PROGRAM_ERR_MISMATCH: return MODBUS_EXCEPTION_MEMORY_ERROR;
+        default:                        return MODBUS_EXCEPTION_DEVICE_FAILURE;
+    }
+}
+
+static void put_u32(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)(value >> 24);
+    p[1] = (uint8_t)(value >> 16);
+    p[2] = (uint8_t)(value >> 8);
+    p[3] = (uint8_t)value;
+}
+
+static void put_u64(uint8_t *p, uint64_t value)
+{
+    put_u32(p, (uint32_t)(value >> 32));
+    put_u32(p + 4, (uint32_t)value);
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/* 程序文件中的记录换算为镜像字节偏移，越界返回 false */
+static bool program_offset(uint16_t file, uint16_t record, uint16_t count, uint32_t *offset)
+{
+    if (file < MODBUS_FILE_PROGRAM || file >= MODBUS_FILE_PROGRAM + MODBUS_FILE_PROGRAM_FILES ||
+        (uint32_t)record + count > MODBUS_FILE_PROGRAM_RECORDS) {
+        return false;
+    }
+    *offset = ((uint32_t)(file - MODBUS_FILE_PROGRAM) * MODBUS_FILE_PROGRAM_RECORDS + record) * 2;
+    return true;
+}
+
 /**
- * 发送异常响应
+ * 读分析条目文件: 覆盖 [record, record + count) 的条目编码后截取
  */
-void modbus_send_exception(uint8_t *buffer, uint8_t slave_id, uint8_t function_code,
-                           uint8_t exception_code)
+static uint8_t profile_file_read(fx3u_core_t *plc, fx3u_profile_view_t view, uint16_t record,
+                                 uint16_t count, uint8_t *data)
 {
-    if (!buffer) return;
+    const uint16_t size = MODBUS_FILE_PROFILE_ENTRY_RECORDS;
+    uint16_t total = fx3u_profile_entries(plc, view);
+    if ((uint32_t)record + count > (uint32_t)total * size) {
+        return MODBUS_EXCEPTION_INVALID_ADDRESS;
+    }
     
+    uint16_t first = record / size;
+    uint16_t last = (uint16_t)((record + count - 1) / size);
+    fx3u_profile_entry_t entries[MODBUS_FILE_MAX_READ_BYTES / 2 / MODBUS_FILE_PROFILE_ENTRY_RECORDS + 2];
+    uint16_t n = fx3u_profile_read(plc, view, first, (uint16_t)(last - first + 1), entries);
+    
+    uint8_t image[sizeof(entries) / sizeof(entries[0]) * MODBUS_FILE_PROFILE_ENTRY_RECORDS * 2];
+    memset(image, 0, sizeof(image));
+    for (uint16_t i = 0; i < n; i++) {
+        uint8_t *p = &image[i * size * 2];
+        p[0] = (uint8_t)(entries[i].index >> 8);
+        p[1] = (uint8_t)entries[i].index;
+        put_u32(&p[2], entries[i].count);
+        put_u64(&p[6], entries[i].cycles);
+        put_u32(&p[14], entries[i].max_cycles);
+    }
+    memcpy(data, &image[(record - first * size) * 2], count * 2);
+    return 0;
+}
+
+/**
+ * 读文件记录 - 数据按记录大端写入 data，返回 0 或异常码
+ */
+static uint8_t modbus_file_read(fx3u_core_t *plc, uint16_t file, uint16_t record,
+                                uint16_t count, uint8_t *data)
+{
+    uint32_t offset;
+    
+    if (file == MODBUS_FILE_CONTROL) {
+        if ((uint32_t)record + count > MODBUS_FILE_STATUS_RECORDS) {
+            return MODBUS_EXCEPTION_INVALID_ADDRESS;
+        }
+        const fx3u_program_stage_t *stage = fx3u_program_get_stage();
+        uint8_t status[MODBUS_FILE_STATUS_RECORDS * 2];
+        status[0] = 0;
+        status[1] = stage->state;
+        status[2] = 0;
+        status[3] = stage->last_error;
+        put_u32(&status[MODBUS_FILE_STATUS_EXPECTED * 2], stage->expected_bytes);
+        put_u32(&status[MODBUS_FILE_STATUS_RECEIVED * 2], stage->received_bytes);
+        put_u32(&status[MODBUS_FILE_STATUS_CRC * 2], stage->crc);
+        put_u32(&status[MODBUS_FILE_STATUS_EXPECTED_CRC * 2], stage->expected_crc);
+        put_u32(&status[MODBUS_FILE_STATUS_STEPS * 2], plc->program_size);
+        put_u32(&status[MODBUS_FILE_STATUS_GENERATION * 2], stage->generation);
+        put_u32(&status[MODBUS_FILE_STATUS_ERASED * 2], stage->erased_bytes);
+        memcpy(data, &status[record * 2], count * 2);
+        return 0;
+    }
+    
+    if (file == MODBUS_FILE_ADDRESS_MAP) {
+        if (((uint32_t)record + count) * 2 > MODBUS_MAP_IMAGE_MAX_SIZE) {
+            return MODBUS_EXCEPTION_INVALID_ADDRESS;
+        }
+        uint8_t image[MODBUS_MAP_IMAGE_MAX_SIZE];
+        memset(image, 0, sizeof(image));
+        modbus_map_save_image(image, sizeof(image));
+        memcpy(data, &image[record * 2], count * 2);
+        return 0;
+    }
+    
+    if (file == MODBUS_FILE_PROFILE) {
+        if ((uint32_t)record + count > MODBUS_FILE_PROFILE_RECORDS) {
+            return MODBUS_EXCEPTION_INVALID_ADDRESS;
+        }
+        fx3u_profile_summary_t summary;
+        fx3u_profile_get_summary(plc, &summary);
+        uint8_t status[MODBUS_FILE_PROFILE_RECORDS * 2];
+        memset(status, 0, sizeof(status));
+        status[MODBUS_FILE_PROFILE_ENABLED * 2 + 1] = summary.enabled ? 1 : 0;
+        status[MODBUS_FILE_PROFILE_CYCLES_US * 2] = (uint8_t)(summary.cycles_per_us >> 8);
+        status[MODBUS_FILE_PROFILE_CYCLES_US * 2 + 1] = (uint8_t)summary.cycles_per_us;
+        put_u32(&status[MODBUS_FILE_PROFILE_SCANS * 2], summary.scans);
+        put_u64(&status[MODBUS_FILE_PROFILE_TOTAL * 2], summary.total_cycles);
+        put_u64(&status[MODBUS_FILE_PROFILE_UNCOVERED * 2], summary.uncovered_cycles);
+        status[MODBUS_FILE_PROFILE_STEP_COUNT * 2] = (uint8_t)(summary.steps >> 8);
+        status[MODBUS_FILE_PROFILE_STEP_COUNT * 2 + 1] = (uint8_t)summary.steps;
+        status[MODBUS_FILE_PROFILE_RUNG_COUNT * 2] = (uint8_t)(summary.rungs >> 8);
+        status[MODBUS_FILE_PROFILE_RUNG_COUNT * 2 + 1] = (uint8_t)summary.rungs;
+        memcpy(data, &status[record * 2], count * 2);
+        return 0;
+    }
+    
+    if (file >= MODBUS_FILE_PROFILE_STEPS && file <= MODBUS_FILE_PROFILE_RUNGS) {
+        return profile_file_read(plc, (fx3u_profile_view_t)(file - MODBUS_FILE_PROFILE_STEPS),
+                                 record, count, data);
+    }
+    
+    if (!program_offset(file, record, count, &offset)) {
+        return MODBUS_EXCEPTION_INVALID_ADDRESS;
+    }
+    return program_exception(fx3u_program_read(plc, offset, data, count * 2));
+}
+
+/**
+ * 写文件记录 - 返回 0 或异常码
+ */
+static uint8_t modbus_file_write(fx3u_core_t *plc, uint16_t file, uint16_t record,
+                                 uint16_t count, const uint8_t *data)
+{
+    uint32_t offset;
+    
+    if (file == MODBUS_FILE_CONTROL) {
+        if (record != 0) return MODBUS_EXCEPTION_INVALID_ADDRESS;
+        
+        uint16_t command = ((uint16_t)data[0] << 8) | data[1];
+        switch (command) {
+            case MODBUS_FILE_CMD_BEGIN:
+                if (count != 5) return MODBUS_EXCEPTION_INVALID_VALUE;
+                return program_exception(fx3u_program_stage_begin(plc, get_u32(&data[2]),
+                                                                  get_u32(&data[6])));
+            case MODBUS_FILE_CMD_COMMIT:
+                return program_exception(fx3u_program_stage_commit(plc));
+            case MODBUS_FILE_CMD_ABORT:
+                fx3u_program_stage_abort();
+                return 0;
+            case MODBUS_FILE_CMD_APPLY_MAP: {
+                if (count != 2) return MODBUS_EXCEPTION_INVALID_VALUE;
+                uint16_t length = ((uint16_t)data[2] << 8) | data[3];
+                if (length > sizeof(g_map_staging) ||
+                    !modbus_map_load_image(g_map_staging, length)) {
+                    return MODBUS_EXCEPTION_INVALID_VALUE;
+                }
+                return 0;
+            }
+            case MODBUS_FILE_CMD_PROFILE:
+                if (count != 2) return MODBUS_EXCEPTION_INVALID_VALUE;
+                switch (((uint16_t)data[2] << 8) | data[3]) {
+                    case 0:
+                        fx3u_profile_stop();
+                        return 0;
+                    case 1:
+                        return fx3u_profile_start() ? 0 : MODBUS_EXCEPTION_INVALID_FUNCTION;
+                    case 2:
+                        fx3u_profile_reset();
+                        return 0;
+                    default:
+                        return MODBUS_EXCEPTION_INVALID_VALUE;
+                }
+            default:
+                return MODBUS_EXCEPTION_INVALID_VALUE;
+        }
+    }
+    
+    if (file == MODBUS_FILE_ADDRESS_MAP) {
+        if (((uint32_t)record + count) * 2 > sizeof(g_map_staging)) {
+            return MODBUS_EXCEPTION_INVALID_ADDRESS;
+        }
+        memcpy(&g_map_staging[record * 2], data, count * 2);
+        return 0;
+    }
+    
+    if (!program_offset(file, record, count, &offset)) {
+        return MODBUS_EXCEPTION_INVALID_ADDRESS;
+    }
+    return program_exception(fx3u_program_stage_write(offset, data, count * 2));
+}
+
+/**
+ * 构建不含CRC的异常响应，返回长度
+ */
+static int modbus_build_exception(uint8_t *buffer, uint8_t slave_id, uint8_t function_code,
+                                  uint8_t exception_code)
+{
     buffer[0] = slave_id;
     buffer[1] = function_code | 0x80;  /* 设置异常位 */
     buffer[2] = exception_code;
+    return 3;
+}
+
+/**
+ * 追加RTU CRC，返回总长度
+ */
+static int modbus_append_crc(uint8_t *buffer, int length)
+{
+    if (length <= 0) return 0;
+    
+    uint16_t crc = modbus_crc16(buffer, length);
+    buffer[length++] = crc & 0xFF;
+    buffer[length++] = (crc >> 8) & 0xFF;
+    return length;
+}
+
+/**
+ * 发送异常响应
+ */
+void modbus_send_exception(uint8_t *buffer, uint8_t slave_id, uint8_t function_code,
+                           uint8_t exception_code)
+{
+    if (!buffer) return;
     
-    uint16_t crc = modbus_crc16(buffer, 3);
-    buffer[3] = crc & 0xFF;
-    buffer[4] = (crc >> 8) & 0xFF;
+    modbus_append_crc(buffer, modbus_build_exception(buffer, slave_id, function_code,
+                                                     exception_code));
 }
 
 /**
@@ -579,3 +865,125 @@ int modbus_master_write_registers(uint8_t *buffer, uint8_t slave_id,
     
     return idx;
 }
+
+/**
+ * MODBUS主机操作 - 读写多个寄存器 (0x17, 先写后读)
+ */
+int modbus_master_read_write_registers(uint8_t *buffer, uint8_t slave_id,
+                                       uint16_t read_addr, uint16_t read_qty,
+                                       uint16_t write_addr, uint16_t *values,
+                                       uint16_t write_qty)
+{
+    if (!buffer || !values) return 0;
+    if (read_qty == 0 || read_qty > MODBUS_RW_MAX_READ ||
+        write_qty == 0 || write_qty > MODBUS_RW_MAX_WRITE) {
+        return 0;
+    }
+    
+    buffer[0] = slave_id;
+    buffer[1] = MODBUS_READ_WRITE_MULTIPLE_REGISTERS;
+    buffer[2] = (read_addr >> 8) & 0xFF;
+    buffer[3] = read_addr & 0xFF;
+    buffer[4] = (read_qty >> 8) & 0xFF;
+    buffer[5] = read_qty & 0xFF;
+    buffer[6] = (write_addr >> 8) & 0xFF;
+    buffer[7] = write_addr & 0xFF;
+    buffer[8] = (write_qty >> 8) & 0xFF;
+    buffer[9] = write_qty & 0xFF;
+    buffer[10] = write_qty * 2;  /* 字节数 */
+    
+    int idx = 11;
+    for (int i = 0; i < write_qty; i++) {
+        buffer[idx++] = (values[i] >> 8) & 0xFF;
+        buffer[idx++] = values[i] & 0xFF;
+    }
+    
+    uint16_t crc = modbus_crc16(buffer, idx);
+    buffer[idx++] = crc & 0xFF;
+    buffer[idx++] = (crc >> 8) & 0xFF;
+    
+    return idx;
+}
+
+/**
+ * MODBUS主机操作 - 读取变化的寄存器 (0x41)
+ */
+int modbus_master_read_changes(uint8_t *buffer, uint8_t slave_id,
+                               uint16_t start_addr, uint16_t quantity, uint32_t since)
+{
+    if (!buffer || quantity == 0) return 0;
+    
+    buffer[0] = slave_id;
+    buffer[1] = MODBUS_READ_CHANGED_REGISTERS;
+    buffer[2] = (start_addr >> 8) & 0xFF;
+    buffer[3] = start_addr & 0xFF;
+    buffer[4] = (quantity >> 8) & 0xFF;
+    buffer[5] = quantity & 0xFF;
+    buffer[6] = (since >> 24) & 0xFF;
+    buffer[7] = (since >> 16) & 0xFF;
+    buffer[8] = (since >> 8) & 0xFF;
+    buffer[9] = since & 0xFF;
+    
+    uint16_t crc = modbus_crc16(buffer, 10);
+    buffer[10] = crc & 0xFF;
+    buffer[11] = (crc >> 8) & 0xFF;
+    
+    return 12;
+}
+
+/**
+ * MODBUS主机操作 - 读文件记录 (0x14，单条子请求)
+ */
+int modbus_master_read_file_record(uint8_t *buffer, uint8_t slave_id,
+                                   uint16_t file, uint16_t record, uint16_t count)
+{
+    if (!buffer || count == 0 || 2 + count * 2 > MODBUS_FILE_MAX_READ_BYTES) return 0;
+    
+    buffer[0] = slave_id;
+    buffer[1] = MODBUS_READ_FILE_RECORD;
+    buffer[2] = 7;  /* 字节数 */
+    buffer[3] = MODBUS_FILE_REFERENCE_TYPE;
+    buffer[4] = (file >> 8) & 0xFF;
+    buffer[5] = file & 0xFF;
+    buffer[6] = (record >> 8) & 0xFF;
+    buffer[7] = record & 0xFF;
+    buffer[8] = (count >> 8) & 0xFF;
+    buffer[9] = count & 0xFF;
+    
+    uint16_t crc = modbus_crc16(buffer, 10);
+    buffer[10] = crc & 0xFF;
+    buffer[11] = (crc >> 8) & 0xFF;
+    
+    return 12;
+}
+
+/**
+ * MODBUS主机操作 - 写文件记录 (0x15，单条子请求，data 为 count x 2 字节原样发送)
+ */
+int modbus_master_write_file_record(uint8_t *buffer, uint8_t slave_id,
+                                    uint16_t file, uint16_t record,
+                                    const uint8_t *data, uint16_t count)
+{
+    if (!buffer || !data || count == 0 || 7 + count * 2 > MODBUS_FILE_MAX_WRITE_BYTES) {
+        return 0;
+    }
+    
+    buffer[0] = slave_id;
+    buffer[1] = MODBUS_WRITE_FILE_RECORD;
+    buffer[2] = (uint8_t)(7 + count * 2);  /* 字节数 */
+    buffer[3] = MODBUS_FILE_REFERENCE_TYPE;
+    buffer[4] = (file >> 8) & 0xFF;
+    buffer[5] = file & 0xFF;
+    buffer[6] = (record >> 8) & 0xFF;
+    buffer[7] = record & 0xFF;
+    buffer[8] = (count >> 8) & 0xFF;
+    buffer[9] = count & 0xFF;
+    memcpy(&buffer[10], data, count * 2);
+    
+    int idx = 10 + count * 2;
+    uint16_t crc = modbus_crc16(buffer, idx);
+    buffer[idx++] = crc & 0xFF;
+    buffer[idx++] = (crc >> 8) & 0xFF;
+    
+    return idx;
+}
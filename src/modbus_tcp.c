@@ -0,0 +1,235 @@
+/**
+ * MODBUS TCP 服务端实现
+ */
+
+#include "modbus_tcp.h"
+#include "modbus_protocol.h"
+#include "modbus_gateway.h"
+#include "pico/stdlib.h"
+#include <string.h>
+
+static bool modbus_tcp_is_local_unit(const modbus_tcp_server_t *server, uint8_t unit_id)
+{
+    return unit_id == server->unit_id || unit_id == 0x00 || unit_id == 0xFF;
+}
+
+/**
+ * 处理一条完整的 MBAP 请求，响应写入 server->tx，返回响应长度 (已转交网关时为 0)
+ */
+static int modbus_tcp_handle_request(modbus_tcp_server_t *server, uint8_t socket,
+                                     uint8_t *request, uint16_t length)
+{
+    uint8_t *tx = server->tx;
+    uint8_t *adu = &request[MODBUS_TCP_MBAP_SIZE - 1];
+    uint16_t adu_len = length - (MODBUS_TCP_MBAP_SIZE - 1);
+    int rsp_len;
+
+    if (!modbus_tcp_is_local_unit(server, adu[0])) {
+        if (server->gateway) {
+            return modbus_gateway_forward(server->gateway, socket, request, length, tx);
+        }
+        tx[6] = adu[0];
+        tx[7] = adu[1] | 0x80;
+        tx[8] = MODBUS_EXCEPTION_GATEWAY_PATH;
+        rsp_len = 3;
+    } else {
+        rsp_len = modbus_slave_process_pdu(server->plc, adu, adu_len, &tx[6]);
+        if (rsp_len <= 0) {
+            /* PDU 过短，无法解析出请求字段 */
+            tx[6] = adu[0];
+            tx[7] = adu[1] | 0x80;
+            tx[8] = MODBUS_EXCEPTION_INVALID_VALUE;
+            rsp_len = 3;
+        }
+    }
+
+    /* MBAP: 事务标识原样返回，长度字段含单元标识 */
+    tx[0] = request[0];
+    tx[1] = request[1];
+    tx[2] = 0;
+    tx[3] = 0;
+    tx[4] = (uint8_t)(rsp_len >> 8);
+    tx[5] = (uint8_t)(rsp_len & 0xFF);
+
+    return 6 + rsp_len;
+}
+
+/**
+ * 处理一个已建立的连接: 收取数据并依次应答缓冲中的所有完整请求
+ */
+static void modbus_tcp_service(modbus_tcp_server_t *server, uint8_t socket)
+{
+    modbus_tcp_conn_t *conn = &server->conns[socket];
+    uint64_t now = time_us_64();
+
+    uint16_t space = sizeof(conn->rx) - conn->rx_len;
+    if (space > 0 && ethernet_rx_available(socket) > 0) {
+        int n = ethernet_receive(socket, &conn->rx[conn->rx_len], space);
+        if (n > 0) {
+            conn->rx_len += (uint16_t)n;
+            conn->last_activity_us = now;
+        }
+    }
+
+    uint16_t offset = 0;
+    uint16_t handled = 0;
+
+    while (conn->rx_len - offset >= MODBUS_TCP_MBAP_SIZE + 1) {
+        uint8_t *req = &conn->rx[offset];
+        uint16_t protocol = ((uint16_t)req[2] << 8) | req[3];
+        uint16_t length = ((uint16_t)req[4] << 8) | req[5];
+
+        if (protocol != 0 || length < 2 || length > MODBUS_TCP_MAX_ADU - 6) {
+            /* 帧边界已无法恢复，断开连接 */
+            conn->errors++;
+            conn->rx_len = 0;
+            ethernet_socket_close(socket);
+            return;
+        }
+
+        uint16_t frame_len = 6 + length;
+        if (conn->rx_len - offset < frame_len) break;
+
+        /* 先确认响应放得下再执行，避免写请求已生效却无法应答 */
+        if (ethernet_tx_free(socket) < MODBUS_TCP_MAX_ADU) break;
+
+        int rsp_len = modbus_tcp_handle_request(server, socket, req, frame_len);
+        if (rsp_len > 0) {
+            ethernet_write(socket, server->tx, (uint16_t)rsp_len);
+        }
+
+        offset += frame_len;
+        handled++;
+    }
+
+    if (offset > 0) {
+        conn->rx_len -= offset;
+        memmove(conn->rx, &conn->rx[offset], conn->rx_len);
+    }
+
+    if (handled > 0) {
+        conn->requests += handled;
+        server->requests += handled;
+        if (handled > server->max_pipeline) {
+            server->max_pipeline = handled;
+        }
+    }
+
+    /* 上一次发送未完成时数据留在缓冲中，下次轮询合并发出 */
+    ethernet_flush(socket);
+
+    if (server->idle_timeout_ms > 0 &&
+        now - conn->last_activity_us > (uint64_t)server->idle_timeout_ms * 1000) {
+        ethernet_socket_close(socket);
+    }
+}
+
+/**
+ * 初始化 MODBUS TCP 服务端
+ */
+void modbus_tcp_server_init(modbus_tcp_server_t *server, fx3u_core_t *plc,
+                            uint16_t port, uint8_t unit_id)
+{
+    if (!server) return;
+
+    memset(server, 0, sizeof(modbus_tcp_server_t));
+    server->plc = plc;
+    server->port = port;
+    server->unit_id = unit_id;
+    server->idle_timeout_ms = MODBUS_TCP_IDLE_TIMEOUT_MS;
+
+    for (uint8_t s = 0; s < MODBUS_TCP_MAX_CONNECTIONS; s++) {
+        server->conns[s].state = ETH_SOCKET_CLOSED;
+    }
+}
+
+/**
+ * 轮询全部 socket (主循环中调用，不阻塞)
+ */
+void modbus_tcp_server_poll(modbus_tcp_server_t *server)
+{
+    if (!server || !server->plc) return;
+
+    for (uint8_t s = 0; s < MODBUS_TCP_MAX_CONNECTIONS; s++) {
+        modbus_tcp_conn_t *conn = &server->conns[s];
+        ethernet_socket_state_t state = ethernet_socket_state(s);
+
+        switch (state) {
+            case ETH_SOCKET_CLOSED:
+                conn->rx_len = 0;
+                ethernet_socket_listen(s, server->port);
+                break;
+
+            case ETH_SOCKET_CLOSING:
+                conn->rx_len = 0;
+                ethernet_socket_close(s);
+                break;
+
+            case ETH_SOCKET_ESTABLISHED:
+                if (conn->state != ETH_SOCKET_ESTABLISHED) {
+                    conn->rx_len = 0;
+                    conn->last_activity_us = time_us_64();
+                    conn->generation++;
+                    server->accepted++;
+                }
+                modbus_tcp_service(server, s);
+                break;
+
+            default:
+                break;
+        }
+
+        conn->state = state;
+    }
+}
+
+/**
+ * 当前已建立的连接数
+ */
+uint8_t modbus_tcp_server_connections(const modbus_tcp_server_t *server)
+{
+    if (!server) return 0;
+
+    uint8_t count = 0;
+    for (uint8_t s = 0; s < MODBUS_TCP_MAX_CONNECTIONS; s++) {
+        if (server->conns[s].state == ETH_SOCKET_ESTABLISHED) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * 连接当前代次
+ */
+uint32_t modbus_tcp_server_generation(const modbus_tcp_server_t *server, uint8_t socket)
+{
+    if (!server || socket >= MODBUS_TCP_MAX_CONNECTIONS) return 0;
+    return server->conns[socket].generation;
+}
+
+/**
+ * 连接是否仍是发起请求的那一个
+ */
+bool modbus_tcp_server_is_current(const modbus_tcp_server_t *server, uint8_t socket,
+                                  uint32_t generation)
+{
+    if (!server || socket >= MODBUS_TCP_MAX_CONNECTIONS) return false;
+
+    const modbus_tcp_conn_t *conn = &server->conns[socket];
+    return conn->state == ETH_SOCKET_ESTABLISHED && conn->generation == generation;
+}
+
+/**
+ * 发送异步应答
+ */
+bool modbus_tcp_server_deliver(modbus_tcp_server_t *server, uint8_t socket,
+                               uint32_t generation, const uint8_t *response, uint16_t length)
+{
+    if (!response || length == 0) return false;
+    if (!modbus_tcp_server_is_current(server, socket, generation)) return false;
+
+    if (ethernet_write(socket, response, length) != length) return false;
+    ethernet_flush(socket);
+    return true;
+}
@@ -0,0 +1,196 @@
+/**
+ * MODBUS TCP 服务端回环吞吐基准 (主机构建)
+ *
+ * 服务端为 ethernet_adapter 的 Linux socket 后端 + modbus_tcp 服务端，客户端在同一线程中
+ * 经 127.0.0.1 连接，每个连接保持 depth 个未应答请求 (FC03 读 16 个 D)。
+ * 输出各 连接数 x 流水线深度 组合的事务吞吐与平均往返时间。
+ *
+ * 用法: bench_modbus_tcp [每组时长 ms (默认 1000)] [端口 (默认 15502)]
+ */
+
+#include "modbus_tcp.h"
+#include "modbus_protocol.h"
+#include "fx3u_core.h"
+#include "pico/time.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define BENCH_REGISTERS     16
+#define BENCH_REQUEST_LEN   12
+#define BENCH_RESPONSE_LEN  (9 + BENCH_REGISTERS * 2)
+#define BENCH_MAX_DEPTH     16
+
+typedef struct {
+    int fd;
+    uint16_t next_tid;
+    uint16_t expect_tid;
+    uint16_t outstanding;
+    uint8_t rx[BENCH_RESPONSE_LEN * BENCH_MAX_DEPTH];
+    uint16_t rx_len;
+} bench_client_t;
+
+static fx3u_core_t g_plc;
+static modbus_tcp_server_t g_server;
+
+static int client_connect(uint16_t port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 && errno != EINPROGRESS) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool client_send(bench_client_t *c)
+{
+    uint8_t req[BENCH_REQUEST_LEN] = {
+        (uint8_t)(c->next_tid >> 8), (uint8_t)c->next_tid, 0, 0, 0, 6,
+        1, MODBUS_READ_HOLDING_REGISTERS, 0, 0, 0, BENCH_REGISTERS
+    };
+    if (send(c->fd, req, sizeof(req), MSG_DONTWAIT | MSG_NOSIGNAL) != (ssize_t)sizeof(req)) {
+        return false;
+    }
+    c->next_tid++;
+    c->outstanding++;
+    return true;
+}
+
+/* 收取并核对应答，返回完成的事务数，应答错误返回 -1 */
+static int client_receive(bench_client_t *c)
+{
+    ssize_t n = recv(c->fd, &c->rx[c->rx_len], sizeof(c->rx) - c->rx_len, MSG_DONTWAIT);
+    if (n > 0) c->rx_len += (uint16_t)n;
+
+    int done = 0;
+    while (c->rx_len >= BENCH_RESPONSE_LEN) {
+        uint16_t tid = ((uint16_t)c->rx[0] << 8) | c->rx[1];
+        if (tid != c->expect_tid || c->rx[7] != MODBUS_READ_HOLDING_REGISTERS ||
+            c->rx[8] != BENCH_REGISTERS * 2) {
+            return -1;
+        }
+        c->expect_tid++;
+        c->outstanding--;
+        c->rx_len -= BENCH_RESPONSE_LEN;
+        memmove(c->rx, &c->rx[BENCH_RESPONSE_LEN], c->rx_len);
+        done++;
+    }
+    return done;
+}
+
+/* 服务端轮询直到连接数达到 count (或超时) */
+static bool wait_connections(uint8_t count)
+{
+    uint64_t start = time_us_64();
+    while (modbus_tcp_server_connections(&g_server) != count) {
+        if (time_us_64() - start > 2000000u) return false;
+        modbus_tcp_server_poll(&g_server);
+    }
+    return true;
+}
+
+static bool run(uint16_t port, uint8_t conns, uint16_t depth, uint32_t duration_ms)
+{
+    bench_client_t clients[ETH_MAX_SOCKETS];
+    memset(clients, 0, sizeof(clients));
+
+    for (uint8_t i = 0; i < conns; i++) {
+        clients[i].fd = client_connect(port);
+        if (clients[i].fd < 0) return false;
+    }
+    if (!wait_connections(conns)) {
+        fprintf(stderr, "server accepted %u of %u connections\n",
+                modbus_tcp_server_connections(&g_server), conns);
+        return false;
+    }
+
+    uint64_t transactions = 0;
+    uint64_t start = time_us_64();
+    uint64_t end = start + (uint64_t)duration_ms * 1000u;
+    bool ok = true;
+
+    while (ok && time_us_64() < end) {
+        for (uint8_t i = 0; i < conns; i++) {
+            while (clients[i].outstanding < depth && client_send(&clients[i])) {}
+        }
+        modbus_tcp_server_poll(&g_server);
+        for (uint8_t i = 0; i < conns; i++) {
+            int done = client_receive(&clients[i]);
+            if (done < 0) {
+                fprintf(stderr, "bad response on connection %u\n", i);
+                ok = false;
+                break;
+            }
+            transactions += (uint64_t)done;
+        }
+    }
+    uint64_t elapsed = time_us_64() - start;
+
+    for (uint8_t i = 0; i < conns; i++) {
+        close(clients[i].fd);
+    }
+    if (!wait_connections(0)) {
+        fprintf(stderr, "server did not release connections\n");
+        return false;
+    }
+    if (!ok || transactions == 0) return false;
+
+    double per_s = (double)transactions * 1e6 / (double)elapsed;
+    printf("%5u %6u %12.0f %10.1f %10.2f\n", conns, depth, per_s,
+           (double)elapsed * conns * depth / (double)transactions,
+           per_s * BENCH_RESPONSE_LEN / 1e6);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t duration_ms = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : 1000;
+    uint16_t port = argc > 2 ? (uint16_t)strtoul(argv[2], NULL, 0) : 15502;
+
+    fx3u_core_init(&g_plc);
+    for (uint16_t i = 0; i < BENCH_REGISTERS; i++) {
+        fx3u_set_register(&g_plc, i, (int16_t)(i * 11));
+    }
+    fx3u_core_run_cycle(&g_plc);
+
+    ethernet_config_t config = { .port = port };
+    ethernet_init(&config);
+    modbus_tcp_server_init(&g_server, &g_plc, port, 1);
+    modbus_tcp_server_poll(&g_server);      /* 打开监听 */
+
+    static const uint8_t conns[] = {1, 4, 8};
+    static const uint16_t depths[] = {1, 8};
+
+    printf("MODBUS TCP loopback, FC03 x %u registers, %lu ms per run\n",
+           BENCH_REGISTERS, (unsigned long)duration_ms);
+    printf("conns  depth     trans/s     rtt_us  resp MB/s\n");
+    for (uint8_t c = 0; c < sizeof(conns); c++) {
+        for (uint8_t d = 0; d < sizeof(depths) / sizeof(depths[0]); d++) {
+            if (!run(port, conns[c], depths[d], duration_ms)) {
+                fprintf(stderr, "run failed: %u connections, depth %u\n", conns[c], depths[d]);
+                return 1;
+            }
+        }
+    }
+    printf("max pipeline per poll: %u\n", g_server.max_pipeline);
+    return 0;
+}
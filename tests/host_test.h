@@ -0,0 +1,38 @@
+/**
+ * 主机测试的断言: 失败时打印位置并计数，main 以 host_test_result() 返回
+ */
+
+#ifndef __HOST_TEST_H__
+#define __HOST_TEST_H__
+
+#include <stdio.h>
+
+static int g_host_test_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+        g_host_test_failures++; \
+    } \
+} while (0)
+
+#define CHECK_EQ(a, b) do { \
+    long long _a = (long long)(a), _b = (long long)(b); \
+    if (_a != _b) { \
+        fprintf(stderr, "%s:%d: CHECK_EQ failed: %s = %lld, %s = %lld\n", \
+                __FILE__, __LINE__, #a, _a, #b, _b); \
+        g_host_test_failures++; \
+    } \
+} while (0)
+
+static inline int host_test_result(const char *name)
+{
+    if (g_host_test_failures) {
+        fprintf(stderr, "%s: %d check(s) failed\n", name, g_host_test_failures);
+        return 1;
+    }
+    printf("%s: ok\n", name);
+    return 0;
+}
+
+#endif /* __HOST_TEST_H__ */
@@ -0,0 +1,176 @@
+/**
+ * 高速计数器: 主机脉冲源模拟 (单相 / 单相双输入 / A-B 相)，
+ * 检查计数、倍频、DHSCS / DHSCR 比较动作、方向标志、计数块分配，
+ * 以及计数输入从快速输入沿中断中移除
+ */
+
+#include "fx3u_core.h"
+#include "fx3u_instructions.h"
+#include "fx3u_hsc.h"
+#include "fx3u_io.h"
+#include "pico_host.h"
+#include "host_test.h"
+
+#define X_IRQ(n)    (1u << PICO_INPUT_X##n##_GPIO)
+
+static fx3u_core_t g_plc;
+static io_manager_t g_io;
+static int g_events = 0;
+
+static void on_event(uint16_t counter)
+{
+    (void)counter;
+    g_events++;
+}
+
+static void on_edge(uint32_t changed, uint32_t stamp_us)
+{
+    (void)changed;
+    (void)stamp_us;
+}
+
+static void set_dword(uint16_t d, int32_t value)
+{
+    fx3u_set_register(&g_plc, d, (int16_t)value);
+    fx3u_set_register(&g_plc, d + 1, (int16_t)(value >> 16));
+}
+
+/*
+ * C251 (A-B 相 1 倍频，X0/X1)、C252 (同输入 4 倍频) 由程序驱动；
+ * DHSCS C251 = 15 置 Y1，DHSCR C252 = 80 复位 C252；C235 与 C251 争用 X0，分配失败
+ */
+static const fx3u_instruction_t g_program[] = {
+    {OP_LD,    FX3U_ADDR_M(0), 0, 0},
+    {OP_CNT,   251, FX3U_ADDR_D(0), 0},
+    {OP_OUT,   FX3U_ADDR_Y(0), 0, 0},
+    {OP_LD,    FX3U_ADDR_M(0), 0, 0},
+    {OP_DHSCS, FX3U_ADDR_D(2), FX3U_ADDR_C(251), FX3U_ADDR_Y(1)},
+    {OP_LD,    FX3U_ADDR_M(0), 0, 0},
+    {OP_DHSCR, FX3U_ADDR_D(4), FX3U_ADDR_C(252), FX3U_ADDR_C(252)},
+    {OP_LD,    FX3U_ADDR_M(0), 0, 0},
+    {OP_CNT,   252, FX3U_ADDR_D(0), 0},
+    {OP_LD,    FX3U_ADDR_M(1), 0, 0},
+    {OP_CNT,   235, FX3U_ADDR_D(0), 0},
+};
+
+static void test_quadrature(void)
+{
+    CHECK(fx3u_core_load_program(&g_plc, g_program, sizeof(g_program) / sizeof(g_program[0])));
+    set_dword(0, 12);
+    set_dword(2, 15);
+    set_dword(4, 80);
+    CHECK(fx3u_hsc_set_multiplier(252, 4));
+
+    /* X0-X2 开沿中断；C251 分配后 X0/X1 的沿中断关闭，X2 不受影响 */
+    io_enable_input_irq(0x7, on_edge);
+    CHECK_EQ(pico_host_gpio_irq_mask() & (X_IRQ(0) | X_IRQ(1) | X_IRQ(2)),
+             X_IRQ(0) | X_IRQ(1) | X_IRQ(2));
+
+    fx3u_set_internal(&g_plc, 0, 1);
+    fx3u_core_start(&g_plc);
+    fx3u_core_run_cycle(&g_plc);
+    CHECK_EQ(pico_host_gpio_irq_mask() & (X_IRQ(0) | X_IRQ(1) | X_IRQ(2)), X_IRQ(2));
+
+    /* 重新请求也不会打开已占用的 X */
+    io_enable_input_irq(0x7, on_edge);
+    CHECK_EQ(pico_host_gpio_irq_mask() & (X_IRQ(0) | X_IRQ(1) | X_IRQ(2)), X_IRQ(2));
+
+    /* 40 个边沿 = 10 个整周期 */
+    fx3u_hsc_sim_quadrature(0, 40);
+    CHECK_EQ(fx3u_hsc_read(251), 10);
+    CHECK_EQ(fx3u_hsc_read(252), 40);
+    fx3u_core_run_cycle(&g_plc);
+    CHECK_EQ(g_plc.outputs[0], 0);
+
+    /* 到达设定值 12: 扫描中触点接通 */
+    fx3u_hsc_sim_quadrature(0, 8);
+    fx3u_core_run_cycle(&g_plc);
+    CHECK_EQ(fx3u_hsc_read(251), 12);
+    CHECK_EQ(g_plc.outputs[0], 1);
+
+    /* DHSCS 在计数到达时立即动作，不等扫描 */
+    fx3u_hsc_sim_quadrature(0, 12);
+    CHECK_EQ(fx3u_hsc_read(251), 15);
+    CHECK_EQ(g_plc.outputs[1], 1);
+    CHECK_EQ(g_events, 1);
+
+    /* DHSCR 复位 C252 自身 */
+    fx3u_hsc_sim_quadrature(0, 20);
+    CHECK_EQ(fx3u_hsc_read(252), 0);
+    CHECK_EQ(fx3u_hsc_read(251), 20);
+    CHECK_EQ(g_events, 2);
+
+    /* B 相超前为减计数，方向标志 M8251 */
+    fx3u_hsc_sim_quadrature(0, -88);
+    CHECK_EQ(fx3u_hsc_read(251), -2);
+    fx3u_core_run_cycle(&g_plc);
+    CHECK_EQ(g_plc.special_relays[251], 1);
+
+    /* C235 的输入 X0 已被 C251 占用 */
+    fx3u_set_internal(&g_plc, 1, 1);
+    fx3u_core_run_cycle(&g_plc);
+    fx3u_hsc_stats_t stats;
+    fx3u_hsc_get_stats(&stats);
+    CHECK_EQ(stats.allocation_failures, 1);
+    CHECK_EQ(stats.allocations, 2);
+    CHECK_EQ(stats.compare_events, 3);
+
+    /* 驱动断开时计数保持 */
+    fx3u_set_internal(&g_plc, 0, 0);
+    fx3u_core_run_cycle(&g_plc);
+    fx3u_hsc_sim_quadrature(0, 40);
+    CHECK_EQ(fx3u_hsc_read(251), -2);
+    fx3u_set_internal(&g_plc, 0, 1);
+    fx3u_core_run_cycle(&g_plc);
+    fx3u_hsc_sim_quadrature(0, 4);
+    CHECK_EQ(fx3u_hsc_read(251), -1);
+
+    /* RST C251 */
+    fx3u_set_bit(&g_plc, FX3U_ADDR_C(251), 0);
+    CHECK_EQ(fx3u_hsc_read(251), 0);
+}
+
+static void test_single_phase(void)
+{
+    fx3u_hsc_init(&g_plc);
+
+    /* C236 单相 (X1)；C246 单相双输入 (X0 加 / X1 减) */
+    fx3u_hsc_drive(236, true, 5);
+    fx3u_hsc_drive(246, true, 0);
+    fx3u_hsc_sim_pulses(1, 7);
+    CHECK_EQ(fx3u_hsc_read(236), 7);
+    CHECK_EQ(fx3u_hsc_read(246), -7);
+    fx3u_hsc_sim_pulses(0, 3);
+    CHECK_EQ(fx3u_hsc_read(246), -4);
+    CHECK_EQ(fx3u_hsc_read(236), 7);
+    CHECK(fx3u_hsc_done(236));
+
+    /* M8236 置位后 C236 减计数；比较动作置 M5 */
+    fx3u_set_special_relay(&g_plc, 8236, 1);
+    fx3u_hsc_drive(236, true, 5);
+    fx3u_hsc_compare(236, true, 4, FX3U_ADDR_M(5), 1);
+    fx3u_hsc_sim_pulses(1, 2);
+    CHECK_EQ(fx3u_hsc_read(236), 5);
+    CHECK_EQ(g_plc.internals[5], 0);
+    fx3u_hsc_sim_pulses(1, 1);
+    CHECK_EQ(fx3u_hsc_read(236), 4);
+    CHECK_EQ(g_plc.internals[5], 1);
+    CHECK(!fx3u_hsc_done(236));
+
+    fx3u_hsc_write(236, 100);
+    fx3u_hsc_sim_pulses(1, 1);
+    CHECK_EQ(fx3u_hsc_read(236), 99);
+}
+
+int main(void)
+{
+    fx3u_core_init(&g_plc);
+    io_manager_init(&g_io);
+    fx3u_hsc_init(&g_plc);
+    fx3u_hsc_set_event_callback(on_event);
+
+    test_quadrature();
+    test_single_phase();
+
+    return host_test_result("test_hsc_sim");
+}
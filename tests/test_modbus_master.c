@@ -0,0 +1,323 @@
+/**
+ * MODBUS RTU 主站: 经传输层钩子接入模拟从站
+ *
+ * 覆盖轮询表合并、分段到达的应答、丢帧重试、CRC 错误与超时。
+ * 模拟从站的保持寄存器 n 的值为 1000 + n，线圈 n 在 n % 3 == 0 时为 ON。
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico_host.h"
+#include "fx3u_core.h"
+#include "fx3u_image.h"
+#include "modbus_master.h"
+#include "host_test.h"
+
+typedef enum {
+    SLAVE_ANSWER = 0,
+    SLAVE_DROP,                         /* 不应答 */
+    SLAVE_BAD_CRC                       /* 应答最后一个字节出错 */
+} slave_mode_t;
+
+/* 模拟从站 */
+static slave_mode_t g_modes[8];         /* 依次用于每个请求，用完后正常应答 */
+static uint8_t g_mode_count = 0;
+static uint8_t g_mode_next = 0;
+static uint32_t g_requests = 0;
+static uint8_t g_request[MODBUS_MASTER_FRAME_SIZE];
+static uint16_t g_request_len = 0;
+static uint8_t g_response[MODBUS_MASTER_FRAME_SIZE];
+static uint16_t g_response_len = 0;
+static uint16_t g_response_pos = 0;
+static uint16_t g_chunk = 3;            /* 每次 receive 交付的字节数 */
+
+static void slave_script(const slave_mode_t *modes, uint8_t count)
+{
+    if (count) memcpy(g_modes, modes, count * sizeof(modes[0]));
+    g_mode_count = count;
+    g_mode_next = 0;
+}
+
+static uint16_t slave_answer(const uint8_t *req, uint8_t *rsp)
+{
+    uint16_t address = ((uint16_t)req[2] << 8) | req[3];
+    uint16_t quantity = ((uint16_t)req[4] << 8) | req[5];
+    uint16_t len = 0;
+
+    rsp[len++] = req[0];
+    rsp[len++] = req[1];
+    if (req[1] == MODBUS_READ_HOLDING_REGISTERS) {
+        rsp[len++] = (uint8_t)(quantity * 2);
+        for (uint16_t i = 0; i < quantity; i++) {
+            uint16_t value = (uint16_t)(1000 + address + i);
+            rsp[len++] = (uint8_t)(value >> 8);
+            rsp[len++] = (uint8_t)value;
+        }
+    } else if (req[1] == MODBUS_READ_COIL_STATUS) {
+        uint8_t bytes = (uint8_t)((quantity + 7) / 8);
+        rsp[len++] = bytes;
+        memset(&rsp[len], 0, bytes);
+        for (uint16_t i = 0; i < quantity; i++) {
+            if ((address + i) % 3 == 0) rsp[len + i / 8] |= (uint8_t)(1u << (i % 8));
+        }
+        len += bytes;
+    } else {
+        rsp[1] |= 0x80;
+        rsp[len++] = MODBUS_EXCEPTION_INVALID_FUNCTION;
+    }
+
+    uint16_t crc = modbus_crc16(rsp, len);
+    rsp[len++] = (uint8_t)(crc & 0xFF);
+    rsp[len++] = (uint8_t)(crc >> 8);
+    return len;
+}
+
+static void slave_send(uint8_t *buffer, uint16_t length)
+{
+    g_requests++;
+    memcpy(g_request, buffer, length);
+    g_request_len = length;
+
+    slave_mode_t mode = g_mode_next < g_mode_count ? g_modes[g_mode_next++] : SLAVE_ANSWER;
+    g_response_pos = 0;
+    g_response_len = 0;
+    if (mode == SLAVE_DROP) return;
+
+    g_response_len = slave_answer(buffer, g_response);
+    if (mode == SLAVE_BAD_CRC) g_response[g_response_len - 1] ^= 0x5A;
+}
+
+static int slave_receive(uint8_t *buffer, uint16_t max_len)
+{
+    uint16_t n = g_response_len - g_response_pos;
+    if (n > g_chunk) n = g_chunk;
+    if (n > max_len) n = max_len;
+    memcpy(buffer, &g_response[g_response_pos], n);
+    g_response_pos += n;
+    return n;
+}
+
+static const modbus_master_transport_t g_transport = {
+    .send = slave_send,
+    .receive = slave_receive
+};
+
+/* 事务结果 */
+static int g_result = -1;
+static uint16_t g_result_len = 0;
+
+static void on_result(void *user, modbus_master_result_t result,
+                      const uint8_t *response, uint16_t length)
+{
+    (void)user;
+    (void)response;
+    g_result = (int)result;
+    g_result_len = length;
+}
+
+/* 轮询到事务结束，每次轮询推进 step_us */
+static void run_until_idle(modbus_master_t *master, uint32_t step_us)
+{
+    for (int i = 0; i < 1000 && !modbus_master_is_idle(master); i++) {
+        modbus_master_poll(master);
+        pico_host_advance_us(step_us);
+    }
+}
+
+static void test_coalescing(fx3u_core_t *plc)
+{
+    static modbus_master_t master;
+    const modbus_poll_entry_t table[] = {
+        /* 从站 1 的 0-3、4-7、10-11 (空洞 2 个) 合为一个请求 0-11 */
+        { 1, MODBUS_READ_HOLDING_REGISTERS, 4,   4, 100, FX3U_IMAGE_D, 104 },
+        { 1, MODBUS_READ_HOLDING_REGISTERS, 0,   4, 50,  FX3U_IMAGE_D, 100 },
+        { 1, MODBUS_READ_HOLDING_REGISTERS, 10,  2, 100, FX3U_IMAGE_D, 110 },
+        /* 空洞超过 MODBUS_MASTER_MAX_GAP，单独请求 */
+        { 1, MODBUS_READ_HOLDING_REGISTERS, 100, 2, 100, FX3U_IMAGE_D, 200 },
+        /* 不同功能码不合并 */
+        { 1, MODBUS_READ_COIL_STATUS,       3,   10, 100, FX3U_IMAGE_M, 20 },
+    };
+
+    modbus_master_init(&master, &g_transport);
+    CHECK(modbus_master_set_poll_table(&master, table, 5));
+    /* 按 (从站, 功能码, 地址) 排序: 线圈块在前 */
+    CHECK_EQ(master.block_count, 3);
+    CHECK_EQ(master.blocks[0].function, MODBUS_READ_COIL_STATUS);
+    CHECK_EQ(master.blocks[1].address, 0);
+    CHECK_EQ(master.blocks[1].quantity, 12);
+    CHECK_EQ(master.blocks[1].member_count, 3);
+    CHECK_EQ(master.blocks[1].period_us, 50000);
+    CHECK_EQ(master.blocks[2].address, 100);
+
+    g_requests = 0;
+    slave_script(NULL, 0);
+    for (int i = 0; i < 3; i++) {
+        modbus_master_poll(&master);
+        run_until_idle(&master, 100);
+    }
+    CHECK_EQ(g_requests, 3);
+
+    /* 未到期不发送 */
+    modbus_master_poll(&master);
+    CHECK_EQ(g_requests, 3);
+
+    fx3u_core_run_cycle(plc);
+    CHECK_EQ(fx3u_get_register(plc, 100), 1000);
+    CHECK_EQ(fx3u_get_register(plc, 103), 1003);
+    CHECK_EQ(fx3u_get_register(plc, 107), 1007);
+    CHECK_EQ(fx3u_get_register(plc, 110), 1010);
+    CHECK_EQ(fx3u_get_register(plc, 111), 1011);
+    CHECK_EQ(fx3u_get_register(plc, 200), 1100);
+    CHECK_EQ(fx3u_get_register(plc, 201), 1101);
+
+    /* M20-M29 对应线圈 3-12: 3、6、9、12 为 ON */
+    uint8_t bits[2];
+    fx3u_image_read_bits(FX3U_IMAGE_M, 20, 10, bits);
+    CHECK_EQ(bits[0] | (bits[1] << 8), 0x249);
+
+    const modbus_slave_stats_t *stats = modbus_master_get_stats(&master, 1);
+    CHECK(stats != NULL);
+    if (stats) {
+        CHECK_EQ(stats->requests, 3);
+        CHECK_EQ(stats->responses, 3);
+        CHECK_EQ(stats->retries, 0);
+    }
+
+    /* 50ms 周期的块先于 100ms 的块再次到期 */
+    pico_host_advance_us(50000);
+    modbus_master_poll(&master);
+    CHECK_EQ(g_requests, 4);
+    CHECK_EQ(g_request[3], 0);
+    CHECK_EQ(g_request[5], 12);
+    run_until_idle(&master, 100);
+}
+
+static void submit_read(modbus_master_t *master, uint8_t slave)
+{
+    uint8_t req[8] = { slave, MODBUS_READ_HOLDING_REGISTERS, 0x00, 0x05, 0x00, 0x02 };
+    uint16_t crc = modbus_crc16(req, 6);
+    req[6] = (uint8_t)(crc & 0xFF);
+    req[7] = (uint8_t)(crc >> 8);
+
+    g_result = -1;
+    CHECK(modbus_master_submit(master, req, 8, on_result, NULL));
+}
+
+static void test_retry(modbus_master_t *master)
+{
+    const slave_mode_t drop_once[] = { SLAVE_DROP };
+    slave_script(drop_once, 1);
+    g_requests = 0;
+
+    submit_read(master, 2);
+    run_until_idle(master, 10000);
+    CHECK_EQ(g_requests, 2);
+    CHECK_EQ(g_result, MODBUS_MASTER_OK);
+    CHECK_EQ(g_result_len, 9);
+
+    const modbus_slave_stats_t *stats = modbus_master_get_stats(master, 2);
+    CHECK(stats != NULL);
+    if (stats) {
+        CHECK_EQ(stats->requests, 2);
+        CHECK_EQ(stats->retries, 1);
+        CHECK_EQ(stats->responses, 1);
+        CHECK_EQ(stats->timeouts, 0);
+        /* 延迟从重发时刻计 */
+        CHECK(stats->last_latency_us < master->timeout_us);
+    }
+}
+
+/* CRC 错误立即重发，不等超时 */
+static void test_crc_error(modbus_master_t *master)
+{
+    const slave_mode_t bad_once[] = { SLAVE_BAD_CRC };
+    slave_script(bad_once, 1);
+    g_requests = 0;
+
+    submit_read(master, 3);
+    run_until_idle(master, 100);
+    CHECK_EQ(g_requests, 2);
+    CHECK_EQ(g_result, MODBUS_MASTER_OK);
+
+    const modbus_slave_stats_t *stats = modbus_master_get_stats(master, 3);
+    CHECK(stats != NULL);
+    if (stats) {
+        CHECK_EQ(stats->crc_errors, 1);
+        CHECK_EQ(stats->retries, 1);
+        CHECK(stats->max_latency_us < master->timeout_us);
+    }
+
+    /* 每次都错: 重试用完后报告应答错误 */
+    const slave_mode_t bad_always[] = { SLAVE_BAD_CRC, SLAVE_BAD_CRC, SLAVE_BAD_CRC };
+    slave_script(bad_always, 3);
+    g_requests = 0;
+    submit_read(master, 3);
+    run_until_idle(master, 100);
+    CHECK_EQ(g_requests, 1 + master->max_retries);
+    CHECK_EQ(g_result, MODBUS_MASTER_BAD_RESPONSE);
+    if (stats) CHECK_EQ(stats->crc_errors, 4);
+}
+
+static void test_timeout(modbus_master_t *master)
+{
+    const slave_mode_t drop_all[] = { SLAVE_DROP, SLAVE_DROP, SLAVE_DROP };
+    slave_script(drop_all, 3);
+    g_requests = 0;
+
+    uint64_t start = time_us_64();
+    submit_read(master, 4);
+    run_until_idle(master, 1000);
+    uint64_t elapsed = time_us_64() - start;
+
+    CHECK_EQ(g_requests, 1 + master->max_retries);
+    CHECK_EQ(g_result, MODBUS_MASTER_TIMEOUT);
+    CHECK(elapsed >= (uint64_t)master->timeout_us * (1 + master->max_retries));
+
+    const modbus_slave_stats_t *stats = modbus_master_get_stats(master, 4);
+    CHECK(stats != NULL);
+    if (stats) {
+        CHECK_EQ(stats->timeouts, 1);
+        CHECK_EQ(stats->responses, 0);
+    }
+
+    /* 超时后仍可提交新事务 */
+    slave_script(NULL, 0);
+    submit_read(master, 4);
+    run_until_idle(master, 100);
+    CHECK_EQ(g_result, MODBUS_MASTER_OK);
+}
+
+static void test_exception(modbus_master_t *master)
+{
+    uint8_t req[8] = { 5, 0x07 };
+    uint16_t crc = modbus_crc16(req, 2);
+    req[2] = (uint8_t)(crc & 0xFF);
+    req[3] = (uint8_t)(crc >> 8);
+
+    slave_script(NULL, 0);
+    g_result = -1;
+    CHECK(modbus_master_submit(master, req, 4, on_result, NULL));
+    run_until_idle(master, 100);
+    CHECK_EQ(g_result, MODBUS_MASTER_EXCEPTION);
+    CHECK_EQ(g_result_len, 5);
+
+    const modbus_slave_stats_t *stats = modbus_master_get_stats(master, 5);
+    if (stats) CHECK_EQ(stats->exceptions, 1);
+}
+
+int main(void)
+{
+    static fx3u_core_t plc;
+    static modbus_master_t master;
+
+    fx3u_core_init(&plc);
+    test_coalescing(&plc);
+
+    modbus_master_init(&master, &g_transport);
+    test_retry(&master);
+    test_crc_error(&master);
+    test_timeout(&master);
+    test_exception(&master);
+
+    return host_test_result("test_modbus_master");
+}
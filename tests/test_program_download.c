@@ -0,0 +1,92 @@
+/**
+ * 在线下载: BEGIN 立即返回，目标槽逐扇区后台擦除，擦除中只接受已擦除部分的数据
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "fx3u_core.h"
+#include "fx3u_program.h"
+#include "host_test.h"
+
+#define TEST_STEPS      4096            /* 32KB = 8 个程序区扇区 + 1 个头扇区 */
+#define TEST_CHUNK      240
+
+static fx3u_instruction_t g_image[TEST_STEPS];
+
+static void make_image(void)
+{
+    for (uint32_t i = 0; i < TEST_STEPS; i += 2) {
+        g_image[i] = (fx3u_instruction_t){ OP_LD, FX3U_ADDR_X(i % 8), 0, 0 };
+        g_image[i + 1] = (fx3u_instruction_t){ OP_OUT, FX3U_ADDR_M(i % 1000), 0, 0 };
+    }
+}
+
+/* 从 offset 起写一块，返回写入结果 */
+static fx3u_program_result_t write_chunk(uint32_t offset)
+{
+    const uint8_t *bytes = (const uint8_t *)g_image;
+    uint32_t total = sizeof(g_image);
+    uint16_t n = (uint16_t)(total - offset < TEST_CHUNK ? total - offset : TEST_CHUNK);
+    return fx3u_program_stage_write(offset, &bytes[offset], n);
+}
+
+int main(void)
+{
+    static fx3u_core_t plc;
+    fx3u_core_init(&plc);
+    make_image();
+
+    uint32_t crc = fx3u_program_crc32(0, (const uint8_t *)g_image, sizeof(g_image));
+    const fx3u_program_stage_t *stage = fx3u_program_get_stage();
+
+    /* BEGIN 不擦除 */
+    CHECK_EQ(fx3u_program_stage_begin(&plc, TEST_STEPS, crc), FX3U_PROGRAM_OK);
+    CHECK_EQ(stage->state, FX3U_PROGRAM_ERASING);
+    CHECK_EQ(stage->erased_bytes, 0);
+    CHECK_EQ(write_chunk(0), FX3U_PROGRAM_ERR_BUSY);
+    CHECK_EQ(fx3u_program_stage_commit(&plc), FX3U_PROGRAM_ERR_BUSY);
+
+    /* 每次轮询一个扇区: 头扇区之后程序区逐扇区可写 */
+    fx3u_program_poll();
+    CHECK_EQ(stage->erased_bytes, 0);
+    fx3u_program_poll();
+    CHECK_EQ(stage->erased_bytes, 4096);
+
+    uint32_t offset = 0;
+    uint32_t polls = 2;
+    while (offset < sizeof(g_image)) {
+        fx3u_program_result_t result = write_chunk(offset);
+        if (result == FX3U_PROGRAM_ERR_BUSY) {
+            CHECK_EQ(stage->state, FX3U_PROGRAM_ERASING);
+            fx3u_program_poll();
+            polls++;
+            continue;
+        }
+        CHECK_EQ(result, FX3U_PROGRAM_OK);
+        if (result != FX3U_PROGRAM_OK) break;
+        offset += TEST_CHUNK;
+    }
+    CHECK_EQ(polls, 1 + sizeof(g_image) / 4096);
+    CHECK_EQ(stage->state, FX3U_PROGRAM_RECEIVING);
+
+    /* 擦除完成后轮询无动作 */
+    fx3u_program_poll();
+    CHECK_EQ(stage->erased_bytes, sizeof(g_image));
+
+    CHECK_EQ(fx3u_program_stage_commit(&plc), FX3U_PROGRAM_OK);
+    CHECK_EQ(stage->state, FX3U_PROGRAM_COMMITTED);
+    fx3u_core_run_cycle(&plc);
+    CHECK_EQ(plc.program_size, TEST_STEPS);
+    CHECK(memcmp(plc.program, g_image, sizeof(g_image)) == 0);
+
+    /* 第二次下载写入另一槽，期间运行程序不变 */
+    CHECK_EQ(fx3u_program_stage_begin(&plc, 2, 0), FX3U_PROGRAM_OK);
+    fx3u_program_poll();
+    fx3u_program_poll();
+    CHECK_EQ(stage->state, FX3U_PROGRAM_RECEIVING);
+    CHECK(memcmp(plc.program, g_image, sizeof(g_image)) == 0);
+    fx3u_program_stage_abort();
+    CHECK_EQ(stage->state, FX3U_PROGRAM_IDLE);
+
+    return host_test_result("test_program_download");
+}
@@ -0,0 +1,152 @@
+/**
+ * RTU 帧接收: 字节逐个到达、t3.5 判定帧结束、帧粘连与超长帧
+ *
+ * 主机时钟由 pico_host_advance_us 推进，字节间隔按 9600 8N1 的字符时间
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico_host.h"
+#include "rs485_driver.h"
+#include "modbus_crc.h"
+#include "host_test.h"
+
+static rs485_config_t g_cfg = { .baudrate = 9600, .data_bits = 8, .stop_bits = 1, .parity = 0 };
+
+/* FC03 读 D0 起 2 个，附 CRC */
+static uint16_t make_request(uint8_t *frame, uint8_t slave)
+{
+    const uint8_t pdu[] = { slave, 0x03, 0x00, 0x00, 0x00, 0x02 };
+    memcpy(frame, pdu, sizeof(pdu));
+    uint16_t crc = modbus_crc_update(0xFFFF, frame, sizeof(pdu));
+    frame[6] = (uint8_t)(crc & 0xFF);
+    frame[7] = (uint8_t)(crc >> 8);
+    return 8;
+}
+
+/* 每个字节到达后轮询一次，返回是否在帧中途交付 (不应发生) */
+static bool feed_bytes(rs485_frame_t *frame, const uint8_t *data, uint16_t length,
+                       uint32_t spacing_us)
+{
+    bool early = false;
+    for (uint16_t i = 0; i < length; i++) {
+        pico_host_uart_inject(uart0, &data[i], 1);
+        if (rs485_frame_poll(frame)) early = true;
+        pico_host_advance_us(spacing_us);
+        if (rs485_frame_poll(frame)) early = true;
+    }
+    return early;
+}
+
+static void test_timing(void)
+{
+    CHECK_EQ(rs485_char_time_us(&g_cfg), 1042);
+    CHECK_EQ(rs485_frame_gap_us(&g_cfg), 3647);
+    CHECK_EQ(rs485_char_gap_us(&g_cfg), 1563);
+
+    rs485_config_t fast = { .baudrate = 115200, .data_bits = 8, .stop_bits = 1 };
+    CHECK_EQ(rs485_frame_gap_us(&fast), 1750);
+    CHECK_EQ(rs485_char_gap_us(&fast), 750);
+}
+
+static void test_single_frame(rs485_frame_t *frame, uint32_t gap_us)
+{
+    uint8_t req[8];
+    uint16_t len = make_request(req, 1);
+    uint32_t spacing_us = rs485_char_gap_us(&g_cfg) - 10;
+
+    /* 字符间隔略小于 t1.5 也仍属同一帧；最后一个字节之后已静默 spacing_us */
+    CHECK(!feed_bytes(frame, req, len, spacing_us));
+    CHECK_EQ(frame->length, len);
+
+    /* 静默不足 t3.5 不交付 */
+    pico_host_advance_us(gap_us - spacing_us - 200);
+    CHECK_EQ(rs485_frame_poll(frame), 0);
+
+    pico_host_advance_us(200);
+    CHECK_EQ(rs485_frame_poll(frame), len);
+    CHECK(modbus_crc_frame_ok(&frame->crc));
+    CHECK_EQ(frame->crc.length, len);
+    CHECK(memcmp(frame->buffer, req, len) == 0);
+
+    /* 处理前再次轮询仍报告同一帧 */
+    CHECK_EQ(rs485_frame_poll(frame), len);
+    rs485_frame_reset(frame);
+    CHECK_EQ(rs485_frame_poll(frame), 0);
+}
+
+/* 两帧间隔不足 t3.5: 合为一帧，CRC 校验失败 */
+static void test_merged_frames(rs485_frame_t *frame, uint32_t gap_us)
+{
+    uint8_t req[8];
+    uint16_t len = make_request(req, 1);
+    uint32_t char_us = rs485_char_time_us(&g_cfg);
+
+    /* 第一帧最后一个字节之后静默 gap_us - 200 */
+    CHECK(!feed_bytes(frame, req, len, char_us));
+    pico_host_advance_us(gap_us - char_us - 200);
+    CHECK(!feed_bytes(frame, req, len, char_us));
+
+    pico_host_advance_us(gap_us);
+    CHECK_EQ(rs485_frame_poll(frame), 2 * len);
+    CHECK(!modbus_crc_frame_ok(&frame->crc));
+    rs485_frame_reset(frame);
+}
+
+/* 一次轮询收到整帧 (轮询晚于帧): 仍等满 t3.5 */
+static void test_burst(rs485_frame_t *frame, uint32_t gap_us)
+{
+    uint8_t req[8];
+    uint16_t len = make_request(req, 2);
+
+    pico_host_uart_inject(uart0, req, len);
+    CHECK_EQ(rs485_frame_poll(frame), 0);
+    pico_host_advance_us(gap_us - 500);
+    CHECK_EQ(rs485_frame_poll(frame), 0);
+    pico_host_advance_us(500);
+    CHECK_EQ(rs485_frame_poll(frame), len);
+    CHECK(modbus_crc_frame_ok(&frame->crc));
+    rs485_frame_reset(frame);
+}
+
+/* 超长帧整帧丢弃，之后的帧正常接收 */
+static void test_overflow(rs485_frame_t *frame, uint32_t gap_us)
+{
+    uint8_t junk[40];
+    memset(junk, 0x55, sizeof(junk));
+    pico_host_uart_inject(uart0, junk, sizeof(junk));
+    CHECK_EQ(rs485_frame_poll(frame), 0);
+    CHECK(frame->overflow);
+    pico_host_advance_us(gap_us);
+    CHECK_EQ(rs485_frame_poll(frame), 0);
+    CHECK_EQ(frame->length, 0);
+    CHECK(!frame->overflow);
+
+    uint8_t req[8];
+    uint16_t len = make_request(req, 3);
+    pico_host_uart_inject(uart0, req, len);
+    rs485_frame_poll(frame);
+    pico_host_advance_us(gap_us);
+    CHECK_EQ(rs485_frame_poll(frame), len);
+    CHECK(modbus_crc_frame_ok(&frame->crc));
+    rs485_frame_reset(frame);
+}
+
+int main(void)
+{
+    static uint8_t buffer[32];
+    rs485_frame_t frame;
+
+    modbus_crc_init();
+    rs485_init(&g_cfg);
+    uint32_t gap_us = rs485_frame_gap_us(&g_cfg);
+    rs485_frame_init(&frame, buffer, sizeof(buffer), gap_us);
+
+    test_timing();
+    test_single_frame(&frame, gap_us);
+    test_merged_frames(&frame, gap_us);
+    test_burst(&frame, gap_us);
+    test_overflow(&frame, gap_us);
+
+    return host_test_result("test_rs485_frame");
+}
@@ -0,0 +1,144 @@
+/**
+ * 软件定时器服务: 在虚拟时钟上检查到期顺序、周期定时器、TASK 回调合并与表满
+ */
+
+#include <stdint.h>
+#include "timer.h"
+#include "host_test.h"
+
+static int g_order[64];
+static uint64_t g_at[64];
+static int g_fired = 0;
+static int g_task_runs = 0;
+static int g_notified = 0;
+static int g_ticks = 0;
+
+static void record(void *arg)
+{
+    g_at[g_fired] = timer_now_us();
+    g_order[g_fired++] = (int)(intptr_t)arg;
+}
+
+static void task_callback(void *arg)
+{
+    (void)arg;
+    g_task_runs++;
+}
+
+static void notify(void)
+{
+    g_notified++;
+}
+
+static void tick(void)
+{
+    g_ticks++;
+}
+
+/* 单次定时器按到期时刻触发，已取消的不触发 */
+static void test_oneshot(void)
+{
+    timer_add_oneshot(300, record, (void *)3, TIMER_CONTEXT_IRQ);
+    timer_add_oneshot(100, record, (void *)1, TIMER_CONTEXT_IRQ);
+    timer_handle_t cancelled = timer_add_oneshot(200, record, (void *)2, TIMER_CONTEXT_IRQ);
+    timer_add_at(250, record, (void *)25, TIMER_CONTEXT_IRQ);
+    CHECK(timer_cancel(cancelled));
+    CHECK(!timer_cancel(cancelled));
+
+    timer_sim_advance(1000);
+    CHECK_EQ(g_fired, 3);
+    CHECK_EQ(g_order[0], 1);
+    CHECK_EQ(g_order[1], 25);
+    CHECK_EQ(g_order[2], 3);
+    CHECK_EQ(g_at[0], 100);
+    CHECK_EQ(g_at[2], 300);
+}
+
+/* 周期定时器按整周期触发，不累积漂移 */
+static void test_periodic(void)
+{
+    g_fired = 0;
+    uint64_t start = timer_now_us();
+    timer_handle_t h = timer_add_periodic(1000, record, (void *)9, TIMER_CONTEXT_IRQ);
+    timer_sim_advance(10500);
+    CHECK_EQ(g_fired, 10);
+    for (int i = 0; i < g_fired; i++) {
+        CHECK_EQ(g_at[i], start + (uint64_t)(i + 1) * 1000u);
+    }
+    CHECK(timer_cancel(h));
+}
+
+/* TASK 回调: 中断只通知，轮询前的多次到期合并为一次 */
+static void test_task_context(void)
+{
+    timer_service_set_notify(notify);
+    timer_handle_t h = timer_add_periodic(100, task_callback, NULL, TIMER_CONTEXT_TASK);
+    timer_sim_advance(350);
+    CHECK_EQ(g_task_runs, 0);
+    CHECK_EQ(g_notified, 3);
+
+    timer_service_poll();
+    CHECK_EQ(g_task_runs, 1);
+
+    timer_service_stats_t stats;
+    timer_service_get_stats(&stats);
+    CHECK_EQ(stats.coalesced, 2);
+    CHECK_EQ(stats.deferred, 3);
+
+    /* 已到期未执行的回调随取消一并丢弃 */
+    timer_sim_advance(100);
+    timer_cancel(h);
+    timer_service_poll();
+    CHECK_EQ(g_task_runs, 1);
+    timer_service_set_notify(NULL);
+}
+
+/* 扫描节拍接口 (timer_init / timer_start) */
+static void test_cycle_timer(void)
+{
+    timer_config_t config = { .period_us = 500, .callback = tick };
+    timer_init(&config);
+    timer_start(&config);
+    timer_sim_advance(5000);
+    CHECK_EQ(g_ticks, 10);
+    CHECK_EQ(timer_get_ticks(), 10);
+
+    timer_stop(&config);
+    timer_sim_advance(5000);
+    CHECK_EQ(g_ticks, 10);
+}
+
+/* 表满后添加失败；取消的槽位不触发 */
+static void test_table_full(void)
+{
+    timer_handle_t handles[40];
+    int added = 0;
+    for (int i = 0; i < 40; i++) {
+        handles[i] = timer_add_oneshot(1000 + i * 7 % 13, task_callback, NULL, TIMER_CONTEXT_IRQ);
+        if (handles[i]) added++;
+    }
+    CHECK_EQ(added, TIMER_MAX_TIMERS);
+
+    int cancelled = 0;
+    for (int i = 0; i < TIMER_MAX_TIMERS; i += 3) {
+        if (timer_cancel(handles[i])) cancelled++;
+    }
+
+    int before = g_task_runs;
+    timer_sim_advance(2000);
+    timer_service_stats_t stats;
+    timer_service_get_stats(&stats);
+    CHECK_EQ(g_task_runs - before, TIMER_MAX_TIMERS - cancelled);
+    CHECK_EQ(stats.active, 0);
+}
+
+int main(void)
+{
+    test_oneshot();
+    test_periodic();
+    test_task_context();
+    test_cycle_timer();
+    test_table_full();
+
+    return host_test_result("test_timer_service");
+}
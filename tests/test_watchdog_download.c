@@ -0,0 +1,77 @@
+/**
+ * 看门狗运行中下载程序: 逐扇区擦除累计超过主循环心跳超时 (1s) 也不跳闸
+ *
+ * 主机 Flash 擦除按 45ms / 扇区推进时钟。主循环被擦除任务占满、心跳任务得不到执行，
+ * 每个扇区之间插入一次扫描 (擦除结束、开中断后到期的扫描节拍)。
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico_host.h"
+#include "fx3u_core.h"
+#include "fx3u_program.h"
+#include "fx3u_watchdog.h"
+#include "host_test.h"
+
+#define TEST_STEPS      FX3U_PROGRAM_MAX_STEPS      /* 128KB = 33 个扇区 */
+
+static bool g_safe_state = false;
+
+static void safe_state(void)
+{
+    g_safe_state = true;
+}
+
+static void scan(fx3u_core_t *plc)
+{
+    fx3u_watchdog_scan_begin();
+    fx3u_core_run_cycle(plc);
+    fx3u_watchdog_scan_end();
+}
+
+int main(void)
+{
+    static fx3u_core_t plc;
+    fx3u_core_init(&plc);
+
+    const fx3u_watchdog_config_t config = {
+        .scan_period_us = 10000,
+        .loop_limit_ms = 0,
+        .safe_state = safe_state
+    };
+    fx3u_watchdog_init(&plc, &config);
+    fx3u_watchdog_start();
+    scan(&plc);
+
+    const fx3u_program_stage_t *stage = fx3u_program_get_stage();
+    CHECK_EQ(fx3u_program_stage_begin(&plc, TEST_STEPS, 0), FX3U_PROGRAM_OK);
+
+    uint64_t start_us = time_us_64();
+    uint32_t sectors = 0;
+    while (stage->state == FX3U_PROGRAM_ERASING && sectors < 100) {
+        fx3u_program_poll();
+        sectors++;
+        scan(&plc);
+    }
+    uint64_t elapsed_ms = (time_us_64() - start_us) / 1000u;
+
+    CHECK_EQ(sectors, 1 + FX3U_PROGRAM_MAX_BYTES / 4096);
+    CHECK(elapsed_ms > FX3U_WATCHDOG_LOOP_LIMIT_MS);
+    CHECK_EQ(stage->state, FX3U_PROGRAM_RECEIVING);
+    CHECK(!fx3u_watchdog_tripped());
+    CHECK(!g_safe_state);
+    fx3u_program_stage_abort();
+
+    /* 擦除结束后心跳检查照常: 主循环停顿超过 1s 即跳闸 */
+    pico_host_advance_us((FX3U_WATCHDOG_LOOP_LIMIT_MS + 100) * 1000u);
+    scan(&plc);
+    CHECK(fx3u_watchdog_tripped());
+    CHECK(g_safe_state);
+
+    fx3u_watchdog_init(&plc, &config);
+    fx3u_watchdog_record_t rec;
+    CHECK(fx3u_watchdog_last_record(&rec));
+    CHECK_EQ(rec.cause, FX3U_WATCHDOG_CAUSE_LOOP);
+
+    return host_test_result("test_watchdog_download");
+}